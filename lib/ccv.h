@@ -48,6 +48,7 @@ enum {
 	CCV_32F = 0x04000,
 	CCV_64S = 0x08000,
 	CCV_64F = 0x10000,
+	CCV_16F = 0x20000, // Half precision float point, only as a storage type for nnc tensors.
 };
 
 enum {
@@ -57,7 +58,7 @@ enum {
 	CCV_C4 = 0x004,
 };
 
-static const int _ccv_get_data_type_size[] = { -1, 1, 4, -1, 4, -1, -1, -1, 8, -1, -1, -1, -1, -1, -1, -1, 8 };
+static const int _ccv_get_data_type_size[] = { -1, 1, 4, -1, 4, -1, -1, -1, 8, -1, -1, -1, -1, -1, -1, -1, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2 };
 
 #define CCV_GET_DATA_TYPE(x) ((x) & 0xFF000)
 #define CCV_GET_DATA_TYPE_SIZE(x) _ccv_get_data_type_size[CCV_GET_DATA_TYPE(x) >> 12]
@@ -161,8 +162,27 @@ typedef struct {
 	size_t up;
 	size_t size;
 	ccv_cache_index_free_f ffree[16];
+	// counters, accumulated until the cache is initialized again
+	uint64_t hit;
+	uint64_t miss;
+	uint64_t evict;
 } ccv_cache_t;
 
+typedef struct {
+	uint64_t hit; /**< The number of lookups that found the object. */
+	uint64_t miss; /**< The number of lookups that didn't find the object. */
+	uint64_t evict; /**< The number of objects freed to stay within the upper limit. */
+	uint32_t rnum; /**< The number of objects in the cache. */
+	size_t size; /**< The bytes occupied by objects in the cache. */
+	size_t up; /**< The upper limit of the cache size in bytes. */
+} ccv_cache_stats_t;
+
+/**
+ * A cache that can be used from multiple threads. It is sharded by the signature, each shard is a ccv_cache_t
+ * with its own lock, and all shards share one upper limit in bytes.
+ */
+typedef struct ccv_shared_cache_s ccv_shared_cache_t;
+
 /* I made it as generic as possible */
 
 /**
@@ -216,6 +236,57 @@ void ccv_cache_cleanup(ccv_cache_t* cache);
  * @param cache The cache.
  */
 void ccv_cache_close(ccv_cache_t* cache);
+/**
+ * Create a cache that can be used from multiple threads.
+ * @param up The upper limit of cache size in bytes, for all shards combined.
+ * @param cache_types The number of cache types in this one cache instance.
+ * @param ffree The function that will be used to free cached object.
+ * @return The shared cache.
+ */
+CCV_WARN_UNUSED(ccv_shared_cache_t*) ccv_shared_cache_new(size_t up, int cache_types, ccv_cache_index_free_f ffree, ...);
+/**
+ * Get an object from the shared cache for its signature and then remove that object from the cache. 0 if cannot find the object.
+ * There is no shared counterpart of ccv_cache_get because an object left in the cache can be freed by another thread at any time.
+ * @param cache The shared cache.
+ * @param sign The signature.
+ * @param type The type of the object.
+ * @return The pointer to the object.
+ */
+void* ccv_shared_cache_out(ccv_shared_cache_t* cache, uint64_t sign, uint8_t* type);
+/**
+ * Put an object to the shared cache with its signature, size, and type. If the cache goes beyond its upper limit,
+ * the least recently used objects are freed, shard by shard in turn.
+ * @param cache The shared cache.
+ * @param sign The signature.
+ * @param x The pointer to the object.
+ * @param size The size of the object.
+ * @param type The type of the object.
+ * @return 0 - success, 1 - replace, -1 - failure.
+ */
+int ccv_shared_cache_put(ccv_shared_cache_t* cache, uint64_t sign, void* x, uint32_t size, uint8_t type);
+/**
+ * Delete an object from the shared cache for its signature and free it.
+ * @param cache The shared cache.
+ * @param sign The signature.
+ * @return -1 if cannot find the object, otherwise return 0.
+ */
+int ccv_shared_cache_delete(ccv_shared_cache_t* cache, uint64_t sign);
+/**
+ * Free all objects inside the shared cache.
+ * @param cache The shared cache.
+ */
+void ccv_shared_cache_cleanup(ccv_shared_cache_t* cache);
+/**
+ * Collect the counters of the shared cache.
+ * @param cache The shared cache.
+ * @param stats The counters, summed across all shards.
+ */
+void ccv_shared_cache_stats(ccv_shared_cache_t* cache, ccv_cache_stats_t* stats);
+/**
+ * Free all objects inside the shared cache and the cache itself.
+ * @param cache The shared cache.
+ */
+void ccv_shared_cache_free(ccv_shared_cache_t* cache);
 /** @} */
 
 /* deprecated methods, often these implemented in another way and no longer suitable for newer computer architecture */
@@ -439,7 +510,7 @@ uint64_t ccv_cache_generate_signature(const char* msg, int len, uint64_t sig_sta
  */
 void ccv_drain_cache(void);
 /**
- * Drain up and disable the application-wide cache.
+ * Drain up and disable the application-wide cache (including the process-wide one).
  */
 void ccv_disable_cache(void);
 /**
@@ -451,6 +522,18 @@ void ccv_enable_default_cache(void);
  * @param size The upper limit of the cache, in bytes.
  */
 void ccv_enable_cache(size_t size);
+/**
+ * Enable a process-wide cache for ccv, shared by all threads. Derived matrices computed on one thread can be
+ * reused by another, and the memory is bounded once rather than per thread. Once enabled, it takes precedence
+ * over the thread-local cache enabled by ccv_enable_cache. Enable / disable it when no other thread is using ccv.
+ * @param size The upper limit of the cache, in bytes.
+ */
+void ccv_enable_shared_cache(size_t size);
+/**
+ * Get the counters of the application-wide cache, the process-wide one if enabled, otherwise the one of the calling thread.
+ * @param stats The counters.
+ */
+void ccv_get_cache_stats(ccv_cache_stats_t* stats);
 
 #define ccv_get_dense_matrix_cell_by(type, x, row, col, ch) \
 	(((type) & CCV_32S) ? (void*)((x)->data.i32 + ((row) * (x)->cols + (col)) * CCV_GET_CHANNEL(type) + (ch)) : \
@@ -572,6 +655,37 @@ int ccv_read_impl(const void* in, ccv_dense_matrix_t** x, int type, int rows, in
 // this is a way to implement function-signature based dispatch, you can call either
 // ccv_read(in, x, type) or ccv_read(in, x, type, rows, cols, scanline)
 // notice that you can implement this with va_* functions, but that is not type-safe
+
+typedef struct {
+	int rows; /**< Decode the image (or the region) to at least this many rows, 0 to not scale on rows. */
+	int cols; /**< Decode the image (or the region) to at least this many columns, 0 to not scale on columns. */
+	int x; /**< The region of interest, in the coordinates of the original image. */
+	int y;
+	int width; /**< The width of the region of interest, 0 to decode the whole image. */
+	int height; /**< The height of the region of interest, 0 to decode the whole image. */
+} ccv_read_param_t;
+
+/**
+ * Read image from a file or a region of memory, only decode the region of interest and downscale while decoding. For JPEG, this uses the DCT scaling of libjpeg to decode at the smallest M / 8 scale that still keeps the region at least the size of params.rows x params.cols, thus, the output is at least that large and you need to resample it to the exact size. Only decodes the iMCU columns / rows that cover the region with libjpeg-turbo. Other formats are decoded at the full resolution and cropped to the region.
+ * @param in The file name or the data memory.
+ * @param x The output image.
+ * @param type CCV_IO_ANY_FILE or CCV_IO_ANY_STREAM (or the specific formats). CCV_IO_GRAY, convert to grayscale image. CCV_IO_RGB_COLOR, convert to color image.
+ * @param size The size of that data memory region, 0 when reading from a file.
+ * @param params The target size and the region of interest.
+ */
+int ccv_read_scaled(const void* in, ccv_dense_matrix_t** x, int type, int size, ccv_read_param_t params);
+/**
+ * Read a batch of images in parallel (with OpenMP or libdispatch, whichever ccv is built with). Optionally resize all of them to rows x cols in the same pass, in which case JPEG images are downscaled at decode time first.
+ * @param in The file names or the data memory regions.
+ * @param sizes The sizes of the data memory regions, 0 when reading from files.
+ * @param x The output images, an array of count matrices that are initialized to 0. Images failed to decode stay 0.
+ * @param count The number of images.
+ * @param type CCV_IO_ANY_FILE or CCV_IO_ANY_STREAM (or the specific formats). CCV_IO_GRAY, convert to grayscale image. CCV_IO_RGB_COLOR, convert to color image.
+ * @param rows Resize to this many rows, 0 to keep the original size.
+ * @param cols Resize to this many columns, 0 to keep the original size.
+ * @return The number of images decoded.
+ */
+int ccv_read_batch(const void* const* in, const int* sizes, ccv_dense_matrix_t** x, int count, int type, int rows, int cols);
 /**
  * Write image to a file. This function has soft dependencies on [LibJPEG](http://libjpeg.sourceforge.net/) and [LibPNG](http://www.libpng.org/pub/png/libpng.html). No these libraries, no JPEG nor PNG write support.
  * @param mat The input image.
@@ -931,6 +1045,14 @@ typedef int(*ccv_array_group_f)(const void*, const void*, void*);
  * @param data Any extra user data.
  */
 int ccv_array_group(ccv_array_t* array, ccv_array_t** index, ccv_array_group_f gfunc, void* data);
+/**
+ * Group rectangle elements (**ccv_comp_t**, or any struct that starts with a **ccv_rect_t** like **ccv_root_comp_t**) in the array from its similarity. It produces the same grouping as **ccv_array_group**, but only tests pairs whose rectangles intersect, found with a uniform grid. Thus, it is much faster on large detection sets.
+ * @param array The array of rectangle elements.
+ * @param index The output index, same group element will have the same index.
+ * @param gfunc int ccv_array_group_f(const void* a, const void* b, void* data). Return 1 if a and b are in the same group. It should only return 1 if the rectangles of a and b intersect (touch counts).
+ * @param data Any extra user data.
+ */
+int ccv_array_group_rect(ccv_array_t* array, ccv_array_t** index, ccv_array_group_f gfunc, void* data);
 void ccv_make_array_immutable(ccv_array_t* array);
 void ccv_make_array_mutable(ccv_array_t* array);
 /**
@@ -1081,6 +1203,32 @@ void ccv_minimize(ccv_dense_matrix_t* x, int length, double red, ccv_minimize_f
  * @param padding_pattern ccv doesn't support padding pattern for now.
  */
 void ccv_filter(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_dense_matrix_t** d, int type, int padding_pattern);
+
+enum {
+	CCV_FILTER_PLAN_ESTIMATE = 0x00,
+	CCV_FILTER_PLAN_MEASURE  = 0x01,
+};
+/**
+ * With FFTW3, ccv_filter plans the FFT once for each size, number of channels and precision, and reuses the plan from then on (the plan cache is shared by all threads). This sets how new plans are made. CCV_FILTER_PLAN_MEASURE takes much longer to plan (once) for a faster FFT. Plans already in the cache are not affected, drain it with ccv_filter_plan_drain. Without FFTW3, this does nothing.
+ * @param mode CCV_FILTER_PLAN_ESTIMATE (the default) or CCV_FILTER_PLAN_MEASURE.
+ */
+void ccv_filter_plan_mode(int mode);
+/**
+ * Destroy all the cached FFT plans of ccv_filter. It is safe to call while other threads are filtering, plans they are executing are destroyed once they finish.
+ */
+void ccv_filter_plan_drain(void);
+/**
+ * Load FFTW3 wisdom, thus, CCV_FILTER_PLAN_MEASURE can skip measuring for the sizes it already knows. As FFTW's system wisdom (/etc/fftw/wisdom and /etc/fftw/wisdomf), the double precision wisdom is read from filename, and the single precision one from filename with "f" appended. These are standard FFTW wisdom files, from ccv_filter_plan_export or the fftw-wisdom / fftwf-wisdom tools.
+ * @param filename The double precision wisdom file, the single precision one has an extra "f" at the end.
+ * @return 0 if the wisdom files that exist (at least one of them) are loaded, -1 otherwise (or without FFTW3).
+ */
+int ccv_filter_plan_import(const char* filename);
+/**
+ * Save FFTW3 wisdom accumulated from planning so far, the double precision wisdom to filename, and the single precision one to filename with "f" appended.
+ * @param filename The double precision wisdom file, the single precision one has an extra "f" at the end.
+ * @return 0 if the wisdom is saved, -1 otherwise (or without FFTW3).
+ */
+int ccv_filter_plan_export(const char* filename);
 typedef double(*ccv_filter_kernel_f)(double x, double y, void*);
 /**
  * Fill a given dense matrix with a kernel function.
@@ -1678,7 +1826,7 @@ enum {
 typedef struct {
 	int interval; /**< Interval images between the full size image and the half size one. e.g. 2 will generate 2 images in between full size image and half size one: image with full size, image with 5/6 size, image with 2/3 size, image with 1/2 size. */
 	int min_neighbors; /**< 0: no grouping afterwards. 1: group objects that intersects each other. > 1: group objects that intersects each other, and only passes these that have at least **min_neighbors** intersected objects. */
-	int flags; /**< CCV_BBF_NO_NESTED, if one class of object is inside another class of object, this flag will reject the first object. */
+	int flags; /**< CCV_BBF_NO_NESTED, if one class of object is inside another class of object, this flag will reject the first object. CCV_BBF_PARALLEL, scan the pyramid levels and the row bands inside each level in parallel, the result is identical to the serial scan. */
 	int accurate; /**< BBF will generates 4 spatial scale variations for better accuracy. Set this parameter to 0 will reduce to 1 scale variation, and thus 3 times faster but lower the general accuracy of the detector. */
 	ccv_size_t size; /**< The smallest object size that will be interesting to us. */
 } ccv_bbf_param_t;
@@ -1695,6 +1843,7 @@ typedef struct {
 
 enum {
 	CCV_BBF_NO_NESTED = 0x10000000,
+	CCV_BBF_PARALLEL = 0x20000000,
 };
 
 extern const ccv_bbf_param_t ccv_bbf_default_params;
@@ -2290,6 +2439,9 @@ typedef struct {
 	// these can be reused and we don't need to reallocate memory
 	ccv_dense_matrix_t** denoms; // denominators
 	ccv_dense_matrix_t** acts; // hidden layers and output layers
+	// if the weights are memory-mapped from a flat file (ccv_convnet_read_flat), the mapping
+	void* mapped;
+	size_t mapped_size;
 	void* reserved;
 } ccv_convnet_t;
 
@@ -2387,6 +2539,24 @@ CCV_WARN_UNUSED(ccv_convnet_t*) ccv_convnet_read(int use_cwc_accel, const char*
  * @param params A **ccv_convnet_write_param_t** to specify the write parameters.
  */
 void ccv_convnet_write(ccv_convnet_t* convnet, const char* filename, ccv_convnet_write_param_t params);
+/**
+ * Write a convolutional network to a flat file that can be memory-mapped by ccv_convnet_read_flat. The weights
+ * are stored as-is in single precision, aligned so that they can be used without copying.
+ * @param convnet A given convolutional network.
+ * @param filename The file on the disk.
+ * @return 0 on success, -1 if the file cannot be written.
+ */
+int ccv_convnet_write_flat(ccv_convnet_t* convnet, const char* filename);
+/**
+ * Read a convolutional network from a flat file written by ccv_convnet_write_flat. The file is memory-mapped
+ * and the layer weights point to the mapping directly, thus, loading cost doesn't scale with the model size and
+ * pages are shared between processes through the page cache. The mapping is private: writes to the weights
+ * are not carried back to the file. The mapping is released with ccv_convnet_free.
+ * @param use_cwc_accel Use CUDA-enabled GPU acceleration.
+ * @param filename The file on the disk.
+ * @return A convolutional network, or 0 if the file doesn't exist or is not a valid flat file.
+ */
+CCV_WARN_UNUSED(ccv_convnet_t*) ccv_convnet_read_flat(int use_cwc_accel, const char* filename);
 /**
  * Free up temporary resources of a given convolutional network.
  * @param convnet A convolutional network.
@@ -1188,6 +1188,69 @@ static int _ccv_is_equal_same_class(const void* _r1, const void* _r2, void* data
 		   (int)(r2->rect.width * 1.5 + 0.5) >= r1->rect.width;
 }
 
+#define CCV_BBF_BAND_ROWS (32)
+
+typedef struct {
+	int i;
+	int q;
+	int y_start;
+	int y_end;
+	float scale_x;
+	float scale_y;
+	ccv_array_t* seq;
+} ccv_bbf_scan_unit_t;
+
+// scan rows [y_start, y_end) of one pyramid level with spatial variation q, the pyr pointer points to that level
+static void _ccv_bbf_scan_rows(ccv_bbf_classifier_cascade_t* cascade, int t, ccv_dense_matrix_t** pyr, int next, int q, int y_start, int y_end, float scale_x, float scale_y, ccv_array_t* seq)
+{
+	int j, k, x, y;
+	int dx[] = {0, 1, 0, 1};
+	int dy[] = {0, 0, 1, 1};
+	int steps[] = { pyr[0]->step, pyr[next * 4]->step, pyr[next * 8]->step };
+	int i_cols = pyr[next * 8]->cols - (cascade->size.width >> 2);
+	int paddings[] = { pyr[0]->step * 4 - i_cols * 4,
+					   pyr[next * 4]->step * 2 - i_cols * 2,
+					   pyr[next * 8]->step - i_cols };
+	unsigned char* u8[] = { pyr[0]->data.u8 + dx[q] * 2 + dy[q] * pyr[0]->step * 2 + y_start * pyr[0]->step * 4, pyr[next * 4]->data.u8 + dx[q] + dy[q] * pyr[next * 4]->step + y_start * pyr[next * 4]->step * 2, pyr[next * 8 + q]->data.u8 + y_start * pyr[next * 8]->step };
+	for (y = y_start; y < y_end; y++)
+	{
+		for (x = 0; x < i_cols; x++)
+		{
+			float sum;
+			int flag = 1;
+			ccv_bbf_stage_classifier_t* classifier = cascade->stage_classifier;
+			for (j = 0; j < cascade->count; ++j, ++classifier)
+			{
+				sum = 0;
+				float* alpha = classifier->alpha;
+				ccv_bbf_feature_t* feature = classifier->feature;
+				for (k = 0; k < classifier->count; ++k, alpha += 2, ++feature)
+					sum += alpha[_ccv_run_bbf_feature(feature, steps, u8)];
+				if (sum < classifier->threshold)
+				{
+					flag = 0;
+					break;
+				}
+			}
+			if (flag)
+			{
+				ccv_comp_t comp;
+				comp.rect = ccv_rect((int)((x * 4 + dx[q] * 2) * scale_x + 0.5), (int)((y * 4 + dy[q] * 2) * scale_y + 0.5), (int)(cascade->size.width * scale_x + 0.5), (int)(cascade->size.height * scale_y + 0.5));
+				comp.neighbors = 1;
+				comp.classification.id = t;
+				comp.classification.confidence = sum;
+				ccv_array_push(seq, &comp);
+			}
+			u8[0] += 4;
+			u8[1] += 2;
+			u8[2] += 1;
+		}
+		u8[0] += paddings[0];
+		u8[1] += paddings[1];
+		u8[2] += paddings[2];
+	}
+}
+
 ccv_array_t* ccv_bbf_detect_objects(ccv_dense_matrix_t* a, ccv_bbf_classifier_cascade_t** _cascade, int count, ccv_bbf_param_t params)
 {
 	int hr = a->rows / params.size.height;
@@ -1201,7 +1264,7 @@ ccv_array_t* ccv_bbf_detect_objects(ccv_dense_matrix_t* a, ccv_bbf_classifier_ca
 		ccv_resample(a, &pyr[0], 0, a->rows * _cascade[0]->size.height / params.size.height, a->cols * _cascade[0]->size.width / params.size.width, CCV_INTER_AREA);
 	else
 		pyr[0] = a;
-	int i, j, k, t, x, y, q;
+	int i, j, k, t, y, q;
 	for (i = 1; i < ccv_min(params.interval + 1, scale_upto + next * 2); i++)
 		ccv_resample(pyr[0], &pyr[i * 4], 0, (int)(pyr[0]->rows / pow(scale, i)), (int)(pyr[0]->cols / pow(scale, i)), CCV_INTER_AREA);
 	for (i = next; i < scale_upto + next * 2; i++)
@@ -1224,59 +1287,58 @@ ccv_array_t* ccv_bbf_detect_objects(ccv_dense_matrix_t* a, ccv_bbf_classifier_ca
 		float scale_x = (float) params.size.width / (float) cascade->size.width;
 		float scale_y = (float) params.size.height / (float) cascade->size.height;
 		ccv_array_clear(seq);
-		for (i = 0; i < scale_upto; i++)
+		if (params.flags & CCV_BBF_PARALLEL)
 		{
-			int dx[] = {0, 1, 0, 1};
-			int dy[] = {0, 0, 1, 1};
-			int i_rows = pyr[i * 4 + next * 8]->rows - (cascade->size.height >> 2);
-			int steps[] = { pyr[i * 4]->step, pyr[i * 4 + next * 4]->step, pyr[i * 4 + next * 8]->step };
-			int i_cols = pyr[i * 4 + next * 8]->cols - (cascade->size.width >> 2);
-			int paddings[] = { pyr[i * 4]->step * 4 - i_cols * 4,
-							   pyr[i * 4 + next * 4]->step * 2 - i_cols * 2,
-							   pyr[i * 4 + next * 8]->step - i_cols };
-			for (q = 0; q < (params.accurate ? 4 : 1); q++)
+			int q_count = params.accurate ? 4 : 1;
+			int unit_count = 0;
+			for (i = 0; i < scale_upto; i++)
 			{
-				unsigned char* u8[] = { pyr[i * 4]->data.u8 + dx[q] * 2 + dy[q] * pyr[i * 4]->step * 2, pyr[i * 4 + next * 4]->data.u8 + dx[q] + dy[q] * pyr[i * 4 + next * 4]->step, pyr[i * 4 + next * 8 + q]->data.u8 };
-				for (y = 0; y < i_rows; y++)
-				{
-					for (x = 0; x < i_cols; x++)
+				int i_rows = pyr[i * 4 + next * 8]->rows - (cascade->size.height >> 2);
+				unit_count += q_count * ccv_max((i_rows + CCV_BBF_BAND_ROWS - 1) / CCV_BBF_BAND_ROWS, 1);
+			}
+			ccv_bbf_scan_unit_t* units = (ccv_bbf_scan_unit_t*)ccmalloc(sizeof(ccv_bbf_scan_unit_t) * unit_count);
+			k = 0;
+			// lay out the units in the same order the serial scan visits them, so the merged result is identical
+			for (i = 0; i < scale_upto; i++)
+			{
+				int i_rows = pyr[i * 4 + next * 8]->rows - (cascade->size.height >> 2);
+				for (q = 0; q < q_count; q++)
+					for (y = 0; y < ccv_max(i_rows, 1); y += CCV_BBF_BAND_ROWS)
 					{
-						float sum;
-						int flag = 1;
-						ccv_bbf_stage_classifier_t* classifier = cascade->stage_classifier;
-						for (j = 0; j < cascade->count; ++j, ++classifier)
-						{
-							sum = 0;
-							float* alpha = classifier->alpha;
-							ccv_bbf_feature_t* feature = classifier->feature;
-							for (k = 0; k < classifier->count; ++k, alpha += 2, ++feature)
-								sum += alpha[_ccv_run_bbf_feature(feature, steps, u8)];
-							if (sum < classifier->threshold)
-							{
-								flag = 0;
-								break;
-							}
-						}
-						if (flag)
-						{
-							ccv_comp_t comp;
-							comp.rect = ccv_rect((int)((x * 4 + dx[q] * 2) * scale_x + 0.5), (int)((y * 4 + dy[q] * 2) * scale_y + 0.5), (int)(cascade->size.width * scale_x + 0.5), (int)(cascade->size.height * scale_y + 0.5));
-							comp.neighbors = 1;
-							comp.classification.id = t;
-							comp.classification.confidence = sum;
-							ccv_array_push(seq, &comp);
-						}
-						u8[0] += 4;
-						u8[1] += 2;
-						u8[2] += 1;
+						units[k].i = i;
+						units[k].q = q;
+						units[k].y_start = y;
+						units[k].y_end = ccv_min(y + CCV_BBF_BAND_ROWS, i_rows);
+						units[k].scale_x = scale_x;
+						units[k].scale_y = scale_y;
+						units[k].seq = 0;
+						++k;
 					}
-					u8[0] += paddings[0];
-					u8[1] += paddings[1];
-					u8[2] += paddings[2];
-				}
+				scale_x *= scale;
+				scale_y *= scale;
+			}
+			assert(k == unit_count);
+			parallel_for(u, unit_count) {
+				ccv_bbf_scan_unit_t* unit = units + u;
+				unit->seq = ccv_array_new(sizeof(ccv_comp_t), 16, 0);
+				_ccv_bbf_scan_rows(cascade, t, pyr + unit->i * 4, next, unit->q, unit->y_start, unit->y_end, unit->scale_x, unit->scale_y, unit->seq);
+			} parallel_endfor
+			for (k = 0; k < unit_count; k++)
+			{
+				for (j = 0; j < units[k].seq->rnum; j++)
+					ccv_array_push(seq, ccv_array_get(units[k].seq, j));
+				ccv_array_free(units[k].seq);
+			}
+			ccfree(units);
+		} else {
+			for (i = 0; i < scale_upto; i++)
+			{
+				int i_rows = pyr[i * 4 + next * 8]->rows - (cascade->size.height >> 2);
+				for (q = 0; q < (params.accurate ? 4 : 1); q++)
+					_ccv_bbf_scan_rows(cascade, t, pyr + i * 4, next, q, 0, i_rows, scale_x, scale_y, seq);
+				scale_x *= scale;
+				scale_y *= scale;
 			}
-			scale_x *= scale;
-			scale_y *= scale;
 		}
 
 		/* the following code from OpenCV's haar feature implementation */
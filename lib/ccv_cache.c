@@ -1,26 +1,36 @@
 #include "ccv.h"
 #include "ccv_internal.h"
+#include <pthread.h>
 
 #define CCV_GET_CACHE_TYPE(x) ((x) >> 60)
 #define CCV_GET_TERMINAL_AGE(x) (((x) >> 32) & 0x0FFFFFFF)
 #define CCV_GET_TERMINAL_SIZE(x) ((x) & 0xFFFFFFFF)
 #define CCV_SET_TERMINAL_TYPE(x, y, z) (((uint64_t)(x) << 60) | ((uint64_t)(y) << 32) | (z))
 
-void ccv_cache_init(ccv_cache_t* cache, size_t up, int cache_types, ccv_cache_index_free_f ffree, ...)
+static void _ccv_cache_init(ccv_cache_t* cache, size_t up, int cache_types, ccv_cache_index_free_f* ffree)
 {
 	cache->rnum = 0;
 	cache->age = 0;
 	cache->up = up;
 	cache->size = 0;
+	cache->hit = cache->miss = cache->evict = 0;
+	assert(cache_types > 0 && cache_types <= 16);
+	memcpy(cache->ffree, ffree, sizeof(ccv_cache_index_free_f) * cache_types);
+	memset(&cache->origin, 0, sizeof(ccv_cache_index_t));
+}
+
+void ccv_cache_init(ccv_cache_t* cache, size_t up, int cache_types, ccv_cache_index_free_f ffree, ...)
+{
 	assert(cache_types > 0 && cache_types <= 16);
+	ccv_cache_index_free_f ffrees[16];
 	va_list arguments;
 	va_start(arguments, ffree);
 	int i;
-	cache->ffree[0] = ffree;
+	ffrees[0] = ffree;
 	for (i = 1; i < cache_types; i++)
-		cache->ffree[i] = va_arg(arguments, ccv_cache_index_free_f);
+		ffrees[i] = va_arg(arguments, ccv_cache_index_free_f);
 	va_end(arguments);
-	memset(&cache->origin, 0, sizeof(ccv_cache_index_t));
+	_ccv_cache_init(cache, up, cache_types, ffrees);
 }
 
 static int bits_in_16bits[0x1u << 16];
@@ -145,15 +155,17 @@ static ccv_cache_index_t* _ccv_cache_seek(ccv_cache_index_t* branch, uint64_t si
 void* ccv_cache_get(ccv_cache_t* cache, uint64_t sign, uint8_t* type)
 {
 	if (cache->rnum == 0)
+	{
+		++cache->miss;
 		return 0;
+	}
 	ccv_cache_index_t* branch = _ccv_cache_seek(&cache->origin, sign, 0);
-	if (!branch)
-		return 0;
-	int leaf = branch->terminal.off & 0x1;
-	if (!leaf)
-		return 0;
-	if (branch->terminal.sign != sign)
+	if (!branch || !(branch->terminal.off & 0x1) || branch->terminal.sign != sign)
+	{
+		++cache->miss;
 		return 0;
+	}
+	++cache->hit;
 	if (type)
 		*type = CCV_GET_CACHE_TYPE(branch->terminal.type);
 	return (void*)(branch->terminal.off - (branch->terminal.off & 0x3));
@@ -172,6 +184,7 @@ static void _ccv_cache_lru(ccv_cache_t* cache)
 		{
 			assert(type >= 0 && type < 16);
 			cache->ffree[type](result);
+			++cache->evict;
 		}
 		cache->rnum = 0;
 		cache->size = 0;
@@ -186,6 +199,7 @@ static void _ccv_cache_lru(ccv_cache_t* cache)
 		if (leaf)
 		{
 			ccv_cache_delete(cache, branch->terminal.sign);
+			++cache->evict;
 			break;
 		} else {
 			ccv_cache_index_t* set = (ccv_cache_index_t*)(branch->branch.set - (branch->branch.set & 0x3));
@@ -341,7 +355,7 @@ static void _ccv_cache_cleanup_and_free(ccv_cache_index_t* branch, ccv_cache_ind
 	}
 }
 
-void* ccv_cache_out(ccv_cache_t* cache, uint64_t sign, uint8_t* type)
+static void* _ccv_cache_out(ccv_cache_t* cache, uint64_t sign, uint8_t* type)
 {
 	if (!bits_in_16bits_init)
 		precomputed_16bits();
@@ -426,10 +440,20 @@ void* ccv_cache_out(ccv_cache_t* cache, uint64_t sign, uint8_t* type)
 	return result;
 }
 
+void* ccv_cache_out(ccv_cache_t* cache, uint64_t sign, uint8_t* type)
+{
+	void* result = _ccv_cache_out(cache, sign, type);
+	if (result)
+		++cache->hit;
+	else
+		++cache->miss;
+	return result;
+}
+
 int ccv_cache_delete(ccv_cache_t* cache, uint64_t sign)
 {
 	uint8_t type = 0;
-	void* result = ccv_cache_out(cache, sign, &type);
+	void* result = _ccv_cache_out(cache, sign, &type);
 	if (result != 0)
 	{
 		assert(type >= 0 && type < 16);
@@ -457,3 +481,183 @@ void ccv_cache_close(ccv_cache_t* cache)
 	// because for cuckoo based one, it will free up space in close whereas only cleanup space in cleanup
 	ccv_cache_cleanup(cache);
 }
+
+// the shard is picked by the top bits of the signature, the radix tree consumes the signature from the bottom,
+// thus, objects in one shard still spread out in its tree
+#define CCV_SHARED_CACHE_SHARD_BITS (4)
+#define CCV_SHARED_CACHE_SHARD_SIZE (1 << CCV_SHARED_CACHE_SHARD_BITS)
+
+typedef struct {
+	pthread_mutex_t mutex;
+	ccv_cache_t cache;
+} ccv_shared_cache_shard_t;
+
+struct ccv_shared_cache_s {
+	pthread_mutex_t mutex; // protects size and evict_cursor, never held while acquiring a shard
+	size_t up;
+	size_t size;
+	int evict_cursor;
+	ccv_shared_cache_shard_t shards[CCV_SHARED_CACHE_SHARD_SIZE];
+};
+
+ccv_shared_cache_t* ccv_shared_cache_new(size_t up, int cache_types, ccv_cache_index_free_f ffree, ...)
+{
+	assert(cache_types > 0 && cache_types <= 16);
+	// initialize the lookup table here rather than racing on it from multiple threads later
+	if (!bits_in_16bits_init)
+		precomputed_16bits();
+	ccv_cache_index_free_f ffrees[16];
+	va_list arguments;
+	va_start(arguments, ffree);
+	int i;
+	ffrees[0] = ffree;
+	for (i = 1; i < cache_types; i++)
+		ffrees[i] = va_arg(arguments, ccv_cache_index_free_f);
+	va_end(arguments);
+	ccv_shared_cache_t* cache = (ccv_shared_cache_t*)ccmalloc(sizeof(ccv_shared_cache_t));
+	pthread_mutex_init(&cache->mutex, 0);
+	cache->up = up;
+	cache->size = 0;
+	cache->evict_cursor = 0;
+	for (i = 0; i < CCV_SHARED_CACHE_SHARD_SIZE; i++)
+	{
+		pthread_mutex_init(&cache->shards[i].mutex, 0);
+		// each shard can grow up to the whole limit, the combined limit is enforced by the shared cache
+		_ccv_cache_init(&cache->shards[i].cache, up, cache_types, ffrees);
+	}
+	return cache;
+}
+
+static inline ccv_shared_cache_shard_t* _ccv_shared_cache_shard(ccv_shared_cache_t* cache, uint64_t sign)
+{
+	return cache->shards + (sign >> (64 - CCV_SHARED_CACHE_SHARD_BITS));
+}
+
+// account for the size change of a shard, returns whether the cache is over its limit
+static int _ccv_shared_cache_resize(ccv_shared_cache_t* cache, size_t old_size, size_t new_size)
+{
+	pthread_mutex_lock(&cache->mutex);
+	cache->size = cache->size + new_size - old_size;
+	const int over = cache->size > cache->up;
+	pthread_mutex_unlock(&cache->mutex);
+	return over;
+}
+
+// free the least recently used object of each shard in turn until the cache is back within its limit,
+// ages are not comparable across shards, therefore this only approximates the global LRU order
+static void _ccv_shared_cache_depleted(ccv_shared_cache_t* cache)
+{
+	for (;;)
+	{
+		pthread_mutex_lock(&cache->mutex);
+		if (cache->size <= cache->up)
+		{
+			pthread_mutex_unlock(&cache->mutex);
+			return;
+		}
+		const int start = cache->evict_cursor;
+		cache->evict_cursor = (start + 1) % CCV_SHARED_CACHE_SHARD_SIZE;
+		pthread_mutex_unlock(&cache->mutex);
+		int i;
+		for (i = 0; i < CCV_SHARED_CACHE_SHARD_SIZE; i++)
+		{
+			ccv_shared_cache_shard_t* shard = cache->shards + (start + i) % CCV_SHARED_CACHE_SHARD_SIZE;
+			pthread_mutex_lock(&shard->mutex);
+			if (shard->cache.rnum > 0)
+			{
+				const size_t old_size = shard->cache.size;
+				_ccv_cache_lru(&shard->cache);
+				_ccv_shared_cache_resize(cache, old_size, shard->cache.size);
+				pthread_mutex_unlock(&shard->mutex);
+				break;
+			}
+			pthread_mutex_unlock(&shard->mutex);
+		}
+		if (i == CCV_SHARED_CACHE_SHARD_SIZE) // nothing left to free, the rest is in flight on other threads
+			return;
+	}
+}
+
+void* ccv_shared_cache_out(ccv_shared_cache_t* cache, uint64_t sign, uint8_t* type)
+{
+	ccv_shared_cache_shard_t* shard = _ccv_shared_cache_shard(cache, sign);
+	pthread_mutex_lock(&shard->mutex);
+	const size_t old_size = shard->cache.size;
+	void* result = ccv_cache_out(&shard->cache, sign, type);
+	if (result)
+		_ccv_shared_cache_resize(cache, old_size, shard->cache.size);
+	pthread_mutex_unlock(&shard->mutex);
+	return result;
+}
+
+int ccv_shared_cache_put(ccv_shared_cache_t* cache, uint64_t sign, void* x, uint32_t size, uint8_t type)
+{
+	if (size > cache->up)
+		return -1;
+	ccv_shared_cache_shard_t* shard = _ccv_shared_cache_shard(cache, sign);
+	pthread_mutex_lock(&shard->mutex);
+	const size_t old_size = shard->cache.size;
+	const int result = ccv_cache_put(&shard->cache, sign, x, size, type);
+	const int over = _ccv_shared_cache_resize(cache, old_size, shard->cache.size);
+	pthread_mutex_unlock(&shard->mutex);
+	if (over)
+		_ccv_shared_cache_depleted(cache);
+	return result;
+}
+
+int ccv_shared_cache_delete(ccv_shared_cache_t* cache, uint64_t sign)
+{
+	ccv_shared_cache_shard_t* shard = _ccv_shared_cache_shard(cache, sign);
+	pthread_mutex_lock(&shard->mutex);
+	const size_t old_size = shard->cache.size;
+	const int result = ccv_cache_delete(&shard->cache, sign);
+	_ccv_shared_cache_resize(cache, old_size, shard->cache.size);
+	pthread_mutex_unlock(&shard->mutex);
+	return result;
+}
+
+void ccv_shared_cache_cleanup(ccv_shared_cache_t* cache)
+{
+	int i;
+	for (i = 0; i < CCV_SHARED_CACHE_SHARD_SIZE; i++)
+	{
+		ccv_shared_cache_shard_t* shard = cache->shards + i;
+		pthread_mutex_lock(&shard->mutex);
+		const size_t old_size = shard->cache.size;
+		ccv_cache_cleanup(&shard->cache);
+		_ccv_shared_cache_resize(cache, old_size, shard->cache.size);
+		pthread_mutex_unlock(&shard->mutex);
+	}
+}
+
+void ccv_shared_cache_stats(ccv_shared_cache_t* cache, ccv_cache_stats_t* stats)
+{
+	memset(stats, 0, sizeof(ccv_cache_stats_t));
+	int i;
+	for (i = 0; i < CCV_SHARED_CACHE_SHARD_SIZE; i++)
+	{
+		ccv_shared_cache_shard_t* shard = cache->shards + i;
+		pthread_mutex_lock(&shard->mutex);
+		stats->hit += shard->cache.hit;
+		stats->miss += shard->cache.miss;
+		stats->evict += shard->cache.evict;
+		stats->rnum += shard->cache.rnum;
+		pthread_mutex_unlock(&shard->mutex);
+	}
+	pthread_mutex_lock(&cache->mutex);
+	stats->size = cache->size;
+	stats->up = cache->up;
+	pthread_mutex_unlock(&cache->mutex);
+}
+
+void ccv_shared_cache_free(ccv_shared_cache_t* cache)
+{
+	int i;
+	for (i = 0; i < CCV_SHARED_CACHE_SHARD_SIZE; i++)
+	{
+		ccv_cache_close(&cache->shards[i].cache);
+		pthread_mutex_destroy(&cache->shards[i].mutex);
+	}
+	pthread_mutex_destroy(&cache->mutex);
+	ccfree(cache);
+}
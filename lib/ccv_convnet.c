@@ -20,19 +20,30 @@
 #endif
 #include "3rdparty/sqlite3/sqlite3.h"
 #include "inc/ccv_convnet_internal.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #ifndef CASE_TESTS
 
-ccv_convnet_t* ccv_convnet_new(int use_cwc_accel, ccv_size_t input, ccv_convnet_layer_param_t params[], int count)
+// if alloc is 0, the weights and the mean activity are left for the caller to set
+static ccv_convnet_t* _ccv_convnet_new(int use_cwc_accel, ccv_size_t input, ccv_convnet_layer_param_t params[], int count, int alloc)
 {
 	ccv_convnet_t* convnet = (ccv_convnet_t*)ccmalloc(sizeof(ccv_convnet_t) + sizeof(ccv_convnet_layer_t) * count + sizeof(ccv_dense_matrix_t*) * count * 2);
 	convnet->use_cwc_accel = use_cwc_accel;
 #ifdef HAVE_GSL
-	gsl_rng_env_setup();
-	gsl_rng* rng = gsl_rng_alloc(gsl_rng_default);
-	gsl_rng_set(rng, (unsigned long int)convnet);
+	gsl_rng* rng = 0;
+	if (alloc)
+	{
+		gsl_rng_env_setup();
+		rng = gsl_rng_alloc(gsl_rng_default);
+		gsl_rng_set(rng, (unsigned long int)convnet);
+	}
 #endif
 	convnet->reserved = 0;
+	convnet->mapped = 0;
+	convnet->mapped_size = 0;
 	convnet->layers = (ccv_convnet_layer_t*)(convnet + 1);
 	convnet->acts = (ccv_dense_matrix_t**)(convnet->layers + count);
 	memset(convnet->acts, 0, sizeof(ccv_dense_matrix_t*) * count);
@@ -43,8 +54,12 @@ ccv_convnet_t* ccv_convnet_new(int use_cwc_accel, ccv_size_t input, ccv_convnet_
 	convnet->rows = params[0].input.matrix.rows;
 	convnet->cols = params[0].input.matrix.cols;
 	convnet->channels = params[0].input.matrix.channels;
-	convnet->mean_activity = ccv_dense_matrix_new(convnet->input.height, convnet->input.width, convnet->channels | CCV_32F, 0, 0);
-	ccv_zero(convnet->mean_activity);
+	convnet->mean_activity = 0;
+	if (alloc)
+	{
+		convnet->mean_activity = ccv_dense_matrix_new(convnet->input.height, convnet->input.width, convnet->channels | CCV_32F, 0, 0);
+		ccv_zero(convnet->mean_activity);
+	}
 	ccv_convnet_layer_t* layers = convnet->layers;
 	int i, j;
 	for (i = 0; i < count; i++)
@@ -61,6 +76,11 @@ ccv_convnet_t* ccv_convnet_new(int use_cwc_accel, ccv_size_t input, ccv_convnet_
 				assert(params[i].output.convolutional.partition % params[i].input.matrix.partition == 0);
 				assert(params[i].output.convolutional.partition >= params[i].input.matrix.partition);
 				layers[i].wnum = params[i].output.convolutional.rows * params[i].output.convolutional.cols * params[i].output.convolutional.channels / params[i].input.matrix.partition * params[i].output.convolutional.count;
+				if (!alloc)
+				{
+					layers[i].w = layers[i].bias = 0;
+					break;
+				}
 				layers[i].w = (float*)ccmalloc(sizeof(float) * (layers[i].wnum + params[i].output.convolutional.count));
 				layers[i].bias = layers[i].w + layers[i].wnum;
 #ifdef HAVE_GSL
@@ -75,6 +95,11 @@ ccv_convnet_t* ccv_convnet_new(int use_cwc_accel, ccv_size_t input, ccv_convnet_
 				break;
 			case CCV_CONVNET_FULL_CONNECT:
 				layers[i].wnum = params[i].input.node.count * params[i].output.full_connect.count;
+				if (!alloc)
+				{
+					layers[i].w = layers[i].bias = 0;
+					break;
+				}
 				layers[i].w = (float*)ccmalloc(sizeof(float) * (layers[i].wnum + params[i].output.full_connect.count));
 				layers[i].bias = layers[i].w + layers[i].wnum;
 #ifdef HAVE_GSL
@@ -95,11 +120,17 @@ ccv_convnet_t* ccv_convnet_new(int use_cwc_accel, ccv_size_t input, ccv_convnet_
 		}
 	}
 #ifdef HAVE_GSL
-	gsl_rng_free(rng);
+	if (rng)
+		gsl_rng_free(rng);
 #endif
 	return convnet;
 }
 
+ccv_convnet_t* ccv_convnet_new(int use_cwc_accel, ccv_size_t input, ccv_convnet_layer_param_t params[], int count)
+{
+	return _ccv_convnet_new(use_cwc_accel, input, params, count, 1);
+}
+
 int ccv_convnet_verify(ccv_convnet_t* convnet, int output)
 {
 	int i, out_rows, out_cols, out_partition, out_channels;
@@ -1234,6 +1265,8 @@ static ccv_convnet_t* _ccv_convnet_update_new(ccv_convnet_t* convnet)
 	update_params->count = convnet->count;
 	update_params->channels = convnet->channels;
 	update_params->mean_activity = 0;
+	update_params->mapped = 0;
+	update_params->mapped_size = 0;
 	int i;
 	for (i = 0; i < convnet->count; i++)
 	{
@@ -1682,6 +1715,184 @@ ccv_convnet_t* ccv_convnet_read(int use_cwc_accel, const char* filename)
 	return 0;
 }
 
+// the flat format: a header, followed by the layers, and then the weights / bias / mean activity, each one
+// aligned to CCV_CONVNET_FLAT_ALIGN so that they can be used directly from the memory mapping
+#define CCV_CONVNET_FLAT_MAGIC "CCVCNNF\0"
+#define CCV_CONVNET_FLAT_VERSION (1)
+#define CCV_CONVNET_FLAT_ALIGN (64)
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t count;
+	int32_t input_height;
+	int32_t input_width;
+	uint64_t mean_activity_offset;
+	uint64_t size; // the size of the whole file
+} ccv_convnet_flat_header_t;
+
+typedef struct {
+	int32_t type;
+	int32_t reserved;
+	ccv_convnet_input_t input;
+	ccv_convnet_type_t net;
+	uint64_t wnum;
+	uint64_t w_offset; // 0 if the layer has no weights
+	uint64_t bias_offset;
+} ccv_convnet_flat_layer_t;
+
+static inline uint64_t _ccv_convnet_flat_align(uint64_t offset)
+{
+	return (offset + CCV_CONVNET_FLAT_ALIGN - 1) & -(uint64_t)CCV_CONVNET_FLAT_ALIGN;
+}
+
+static inline int _ccv_convnet_layer_bias_count(const ccv_convnet_layer_t* layer)
+{
+	switch (layer->type)
+	{
+		case CCV_CONVNET_CONVOLUTIONAL:
+			return layer->net.convolutional.count;
+		case CCV_CONVNET_FULL_CONNECT:
+			return layer->net.full_connect.count;
+	}
+	return 0;
+}
+
+static int _ccv_convnet_flat_write_at(FILE* w, uint64_t* offset, uint64_t at, const void* data, size_t size)
+{
+	static const char zeros[CCV_CONVNET_FLAT_ALIGN] = {0};
+	assert(at >= *offset && at - *offset < CCV_CONVNET_FLAT_ALIGN);
+	if (at > *offset && fwrite(zeros, 1, at - *offset, w) != at - *offset)
+		return -1;
+	if (size > 0 && fwrite(data, 1, size, w) != size)
+		return -1;
+	*offset = at + size;
+	return 0;
+}
+
+int ccv_convnet_write_flat(ccv_convnet_t* convnet, const char* filename)
+{
+	assert(convnet->mean_activity->rows == convnet->input.height);
+	assert(convnet->mean_activity->cols == convnet->input.width);
+	assert(CCV_GET_CHANNEL(convnet->mean_activity->type) == convnet->channels);
+	assert(CCV_GET_DATA_TYPE(convnet->mean_activity->type) == CCV_32F);
+	ccv_convnet_flat_layer_t* flat_layers = (ccv_convnet_flat_layer_t*)cccalloc(convnet->count, sizeof(ccv_convnet_flat_layer_t));
+	ccv_convnet_flat_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CCV_CONVNET_FLAT_MAGIC, sizeof(header.magic));
+	header.version = CCV_CONVNET_FLAT_VERSION;
+	header.count = convnet->count;
+	header.input_height = convnet->input.height;
+	header.input_width = convnet->input.width;
+	// lay out the data first
+	uint64_t offset = sizeof(ccv_convnet_flat_header_t) + sizeof(ccv_convnet_flat_layer_t) * convnet->count;
+	int i;
+	for (i = 0; i < convnet->count; i++)
+	{
+		ccv_convnet_layer_t* layer = convnet->layers + i;
+		flat_layers[i].type = layer->type;
+		flat_layers[i].input = layer->input;
+		flat_layers[i].net = layer->net;
+		flat_layers[i].wnum = layer->wnum;
+		if (layer->type == CCV_CONVNET_CONVOLUTIONAL || layer->type == CCV_CONVNET_FULL_CONNECT)
+		{
+			flat_layers[i].w_offset = _ccv_convnet_flat_align(offset);
+			flat_layers[i].bias_offset = _ccv_convnet_flat_align(flat_layers[i].w_offset + sizeof(float) * layer->wnum);
+			offset = flat_layers[i].bias_offset + sizeof(float) * _ccv_convnet_layer_bias_count(layer);
+		}
+	}
+	const size_t mean_activity_size = sizeof(float) * convnet->input.height * convnet->input.width * convnet->channels;
+	header.mean_activity_offset = _ccv_convnet_flat_align(offset);
+	header.size = header.mean_activity_offset + mean_activity_size;
+	FILE* w = fopen(filename, "wb");
+	if (!w)
+	{
+		ccfree(flat_layers);
+		return -1;
+	}
+	offset = 0;
+	int status = _ccv_convnet_flat_write_at(w, &offset, 0, &header, sizeof(header));
+	if (!status)
+		status = _ccv_convnet_flat_write_at(w, &offset, offset, flat_layers, sizeof(ccv_convnet_flat_layer_t) * convnet->count);
+	for (i = 0; !status && i < convnet->count; i++)
+		if (flat_layers[i].w_offset)
+		{
+			ccv_convnet_layer_t* layer = convnet->layers + i;
+			status = _ccv_convnet_flat_write_at(w, &offset, flat_layers[i].w_offset, layer->w, sizeof(float) * layer->wnum);
+			if (!status)
+				status = _ccv_convnet_flat_write_at(w, &offset, flat_layers[i].bias_offset, layer->bias, sizeof(float) * _ccv_convnet_layer_bias_count(layer));
+		}
+	if (!status)
+		status = _ccv_convnet_flat_write_at(w, &offset, header.mean_activity_offset, convnet->mean_activity->data.f32, mean_activity_size);
+	ccfree(flat_layers);
+	if (fclose(w) != 0)
+		status = -1;
+	return status;
+}
+
+ccv_convnet_t* ccv_convnet_read_flat(int use_cwc_accel, const char* filename)
+{
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return 0;
+	struct stat st;
+	if (fstat(fd, &st) < 0 || st.st_size < sizeof(ccv_convnet_flat_header_t))
+	{
+		close(fd);
+		return 0;
+	}
+	const size_t size = st.st_size;
+	// private mapping so that writes to the weights (for example, fine-tuning) don't go back to the file,
+	// the pages are still shared through the page cache until written
+	void* mapped = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping holds the reference to the file
+	if (mapped == MAP_FAILED)
+		return 0;
+	const ccv_convnet_flat_header_t* header = (const ccv_convnet_flat_header_t*)mapped;
+	const ccv_convnet_flat_layer_t* flat_layers = (const ccv_convnet_flat_layer_t*)(header + 1);
+	if (memcmp(header->magic, CCV_CONVNET_FLAT_MAGIC, sizeof(header->magic)) != 0 ||
+		header->version != CCV_CONVNET_FLAT_VERSION || header->size != size || header->count == 0 ||
+		sizeof(ccv_convnet_flat_header_t) + sizeof(ccv_convnet_flat_layer_t) * header->count > size)
+	{
+		munmap(mapped, size);
+		return 0;
+	}
+	ccv_convnet_layer_param_t* params = (ccv_convnet_layer_param_t*)ccmalloc(sizeof(ccv_convnet_layer_param_t) * header->count);
+	int i;
+	for (i = 0; i < header->count; i++)
+	{
+		params[i].type = flat_layers[i].type;
+		params[i].bias = params[i].glorot = 0; // this is irrelevant to read convnet
+		params[i].input = flat_layers[i].input;
+		params[i].output = flat_layers[i].net;
+	}
+	ccv_convnet_t* convnet = _ccv_convnet_new(use_cwc_accel, ccv_size(header->input_width, header->input_height), params, header->count, 0);
+	ccfree(params);
+	convnet->mapped = mapped;
+	convnet->mapped_size = size;
+	int valid = 1;
+	for (i = 0; valid && i < convnet->count; i++)
+	{
+		ccv_convnet_layer_t* layer = convnet->layers + i;
+		if (layer->type == CCV_CONVNET_CONVOLUTIONAL || layer->type == CCV_CONVNET_FULL_CONNECT)
+		{
+			valid = (flat_layers[i].wnum == layer->wnum &&
+				flat_layers[i].w_offset % CCV_CONVNET_FLAT_ALIGN == 0 && flat_layers[i].w_offset + sizeof(float) * layer->wnum <= size &&
+				flat_layers[i].bias_offset % CCV_CONVNET_FLAT_ALIGN == 0 && flat_layers[i].bias_offset + sizeof(float) * _ccv_convnet_layer_bias_count(layer) <= size);
+			layer->w = (float*)((char*)mapped + flat_layers[i].w_offset);
+			layer->bias = (float*)((char*)mapped + flat_layers[i].bias_offset);
+		}
+	}
+	const size_t mean_activity_size = sizeof(float) * convnet->input.height * convnet->input.width * convnet->channels;
+	if (!valid || header->mean_activity_offset % CCV_CONVNET_FLAT_ALIGN != 0 || header->mean_activity_offset + mean_activity_size > size)
+	{
+		ccv_convnet_free(convnet);
+		return 0;
+	}
+	convnet->mean_activity = ccv_dense_matrix_new(convnet->input.height, convnet->input.width, convnet->channels | CCV_32F | CCV_NO_DATA_ALLOC, (char*)mapped + header->mean_activity_offset, 0);
+	return convnet;
+}
+
 void ccv_convnet_input_formation(ccv_size_t input, ccv_dense_matrix_t* a, ccv_dense_matrix_t** b)
 {
 	if (a->rows > input.height && a->cols > input.width)
@@ -1696,11 +1907,14 @@ void ccv_convnet_free(ccv_convnet_t* convnet)
 {
 	ccv_convnet_compact(convnet);
 	int i;
-	for (i = 0; i < convnet->count; i++)
-		if (convnet->layers[i].w)
-			ccfree(convnet->layers[i].w);
+	if (!convnet->mapped)
+		for (i = 0; i < convnet->count; i++)
+			if (convnet->layers[i].w)
+				ccfree(convnet->layers[i].w);
 	if (convnet->mean_activity)
 		ccv_matrix_free(convnet->mean_activity);
+	if (convnet->mapped)
+		munmap(convnet->mapped, convnet->mapped_size);
 	ccfree(convnet);
 }
 
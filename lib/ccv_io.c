@@ -1,5 +1,11 @@
 #include "ccv.h"
 #include "ccv_internal.h"
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
 #ifdef HAVE_LIBPNG
 #ifdef __APPLE__
 #include "TargetConditionals.h"
@@ -30,41 +36,67 @@
 #include "io/_ccv_io_binary.inc"
 #include "io/_ccv_io_raw.inc"
 
-static int _ccv_read_and_close_fd(FILE* fd, ccv_dense_matrix_t** x, int type)
+static int _ccv_read_sniff(const unsigned char* sig, size_t size)
+{
+	if (size >= 8 && memcmp(sig, "\x89\x50\x4e\x47\xd\xa\x1a\xa", 8) == 0)
+		return CCV_IO_PNG_FILE;
+	else if (size >= 3 && memcmp(sig, "\xff\xd8\xff", 3) == 0)
+		return CCV_IO_JPEG_FILE;
+	else if (size >= 2 && memcmp(sig, "BM", 2) == 0)
+		return CCV_IO_BMP_FILE;
+	else if (size >= 8 && memcmp(sig, "CCVBINDM", 8) == 0)
+		return CCV_IO_BINARY_FILE;
+	return 0;
+}
+
+// only the JPEG decoder can crop and scale while decoding, other formats decode in full and get cropped afterwards
+static void _ccv_read_slice(ccv_dense_matrix_t* im, ccv_dense_matrix_t** x, const ccv_read_param_t* const params)
+{
+	if (im == 0)
+		return;
+	const int roi_x = ccv_max(params->x, 0);
+	const int roi_y = ccv_max(params->y, 0);
+	const int roi_width = ccv_min(params->x + params->width, im->cols) - roi_x;
+	const int roi_height = ccv_min(params->y + params->height, im->rows) - roi_y;
+	if (roi_width > 0 && roi_height > 0)
+		ccv_slice(im, (ccv_matrix_t**)x, 0, roi_y, roi_x, roi_height, roi_width);
+	ccv_matrix_free(im);
+}
+
+static int _ccv_read_and_close_fd(FILE* fd, ccv_dense_matrix_t** x, int type, const ccv_read_param_t* const params)
 {
 	int ctype = (type & 0xF00) ? CCV_8U | ((type & 0xF00) >> 8) : 0;
 	if ((type & 0XFF) == CCV_IO_ANY_FILE)
 	{
 		unsigned char sig[8];
-		(void) fread(sig, 1, 8, fd);
-		if (memcmp(sig, "\x89\x50\x4e\x47\xd\xa\x1a\xa", 8) == 0)
-			type = CCV_IO_PNG_FILE;
-		else if (memcmp(sig, "\xff\xd8\xff", 3) == 0)
-			type = CCV_IO_JPEG_FILE;
-		else if (memcmp(sig, "BM", 2) == 0)
-			type = CCV_IO_BMP_FILE;
-		else if (memcmp(sig, "CCVBINDM", 8) == 0)
-			type = CCV_IO_BINARY_FILE;
+		const size_t size = fread(sig, 1, 8, fd);
+		const int format = _ccv_read_sniff(sig, size);
+		if (format)
+			type = format;
 		fseek(fd, 0, SEEK_SET);
 	}
+	ccv_dense_matrix_t* im = 0;
+	ccv_dense_matrix_t** const dx = (params && params->width > 0 && params->height > 0 && (type & 0xFF) != CCV_IO_JPEG_FILE) ? &im : x;
 	switch (type & 0XFF)
 	{
 #ifdef HAVE_LIBJPEG
 		case CCV_IO_JPEG_FILE:
-			_ccv_read_jpeg_fd(fd, x, ctype);
+			_ccv_read_jpeg_fd(fd, dx, ctype, params);
 			break;
 #endif
 #ifdef HAVE_LIBPNG
 		case CCV_IO_PNG_FILE:
-			_ccv_read_png_fd(fd, x, ctype);
+			_ccv_read_png_fd(fd, dx, ctype);
 			break;
 #endif
 		case CCV_IO_BMP_FILE:
-			_ccv_read_bmp_fd(fd, x, ctype);
+			_ccv_read_bmp_fd(fd, dx, ctype);
 			break;
 		case CCV_IO_BINARY_FILE:
-			_ccv_read_binary_fd(fd, x, ctype);
+			_ccv_read_binary_fd(fd, dx, ctype);
 	}
+	if (dx != x)
+		_ccv_read_slice(im, x, params);
 	if (*x != 0)
 		ccv_make_matrix_immutable(*x);
 	if (type & CCV_IO_ANY_FILE)
@@ -172,7 +204,122 @@ static fpos_t seekfn(void* context, fpos_t off, int whence)
 }
 #endif
 
-int ccv_read_impl(const void* in, ccv_dense_matrix_t** x, int type, int rows, int cols, int scanline)
+// go through stdio for the decoders that only read from a file
+static int _ccv_read_mem_fd(const void* in, size_t size, ccv_dense_matrix_t** x, int type, const ccv_read_param_t* const params)
+{
+#if _XOPEN_SOURCE >= 700 || _POSIX_C_SOURCE >= 200809L || defined(__APPLE__) || defined(BSD)
+	FILE* fd = 0;
+	// this is only supported by glibc
+#if _XOPEN_SOURCE >= 700 || _POSIX_C_SOURCE >= 200809L
+	fd = fmemopen((void*)in, size, "rb");
+#else
+	ccv_io_mem_t mem = {
+		.size = size,
+		.pos = 0,
+		.buffer = (char*)in,
+	};
+	fd = funopen(&mem, readfn, 0, seekfn, 0);
+#endif
+	if (!fd)
+		return CCV_IO_ERROR;
+	// mimicking itself as a "file"
+	type = (type & ~0x10) | 0x20;
+	return _ccv_read_and_close_fd(fd, x, type, params);
+#else
+	return CCV_IO_UNKNOWN;
+#endif
+}
+
+#ifdef HAVE_LIBPNG
+// a deflate stream that inflates beyond this is rejected rather than exhausting the memory
+#define CCV_IO_INFLATE_MAX_SIZE ((size_t)1 << 30)
+
+// zlib comes with libpng
+static unsigned char* _ccv_inflate(const void* in, size_t size, size_t* len)
+{
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	// 15 + 32 takes either zlib or gzip header
+	if (inflateInit2(&stream, 15 + 32) != Z_OK)
+		return 0;
+	size_t buf_size = ccv_min(ccv_max(size * 4, 4096), CCV_IO_INFLATE_MAX_SIZE);
+	unsigned char* buf = (unsigned char*)ccmalloc(buf_size);
+	stream.next_in = (Bytef*)in;
+	stream.avail_in = (uInt)size;
+	int status;
+	do {
+		if (stream.total_out == buf_size)
+		{
+			if (buf_size >= CCV_IO_INFLATE_MAX_SIZE)
+			{
+				status = Z_BUF_ERROR;
+				break;
+			}
+			buf_size = ccv_min(buf_size * 2, CCV_IO_INFLATE_MAX_SIZE);
+			buf = (unsigned char*)ccrealloc(buf, buf_size);
+		}
+		stream.next_out = buf + stream.total_out;
+		stream.avail_out = (uInt)(buf_size - stream.total_out);
+		status = inflate(&stream, Z_NO_FLUSH);
+	} while (status == Z_OK);
+	*len = stream.total_out;
+	inflateEnd(&stream);
+	if (status != Z_STREAM_END)
+	{
+		ccfree(buf);
+		return 0;
+	}
+	return buf;
+}
+#endif
+
+// decode straight from the memory region, without stdio buffering or a copy
+static int _ccv_read_mem(const void* in, size_t size, ccv_dense_matrix_t** x, int type, const ccv_read_param_t* const params)
+{
+	int ctype = (type & 0xF00) ? CCV_8U | ((type & 0xF00) >> 8) : 0;
+	// the stream formats are the file formats with 0x10 instead of 0x20
+	int format = (type & 0xFF) == CCV_IO_DEFLATE_STREAM ? CCV_IO_DEFLATE_STREAM : ((type & 0xFF & ~0x10) | 0x20);
+	if ((type & 0xFF) == CCV_IO_ANY_STREAM)
+		format = _ccv_read_sniff((const unsigned char*)in, size);
+	ccv_dense_matrix_t* im = 0;
+	ccv_dense_matrix_t** const dx = (params && params->width > 0 && params->height > 0 && format != CCV_IO_JPEG_FILE) ? &im : x;
+	switch (format)
+	{
+#ifdef HAVE_LIBJPEG
+		case CCV_IO_JPEG_FILE:
+			_ccv_read_jpeg_mem(in, size, dx, ctype, params);
+			break;
+#endif
+#ifdef HAVE_LIBPNG
+		case CCV_IO_PNG_FILE:
+			_ccv_read_png_mem(in, size, dx, ctype);
+			break;
+		case CCV_IO_DEFLATE_STREAM:
+		{
+			size_t len = 0;
+			unsigned char* data = _ccv_inflate(in, size, &len);
+			if (!data)
+				return CCV_IO_ERROR;
+			// the inflated data is decoded as any stream, which never inflates again, thus, only one level of deflate
+			const int result = _ccv_read_mem(data, len, x, (type & ~0xFF) | CCV_IO_ANY_STREAM, params);
+			ccfree(data);
+			return result;
+		}
+#endif
+		case CCV_IO_BINARY_FILE:
+			_ccv_read_binary_mem(in, size, dx, ctype);
+			break;
+		case CCV_IO_BMP_FILE:
+			return _ccv_read_mem_fd(in, size, x, (type & ~0xFF) | CCV_IO_BMP_STREAM, params);
+	}
+	if (dx != x)
+		_ccv_read_slice(im, x, params);
+	if (*x != 0)
+		ccv_make_matrix_immutable(*x);
+	return CCV_IO_FINAL;
+}
+
+static int _ccv_read_impl(const void* in, ccv_dense_matrix_t** x, int type, int rows, int cols, int scanline, const ccv_read_param_t* const params)
 {
 	FILE* fd = 0;
 	if (type & CCV_IO_ANY_FILE)
@@ -181,34 +328,63 @@ int ccv_read_impl(const void* in, ccv_dense_matrix_t** x, int type, int rows, in
 		fd = fopen((const char*)in, "rb");
 		if (!fd)
 			return CCV_IO_ERROR;
-		return _ccv_read_and_close_fd(fd, x, type);
+		return _ccv_read_and_close_fd(fd, x, type, params);
 	} else if (type & CCV_IO_ANY_STREAM) {
 		assert(rows > 8 && cols == 0 && scanline == 0);
-		assert((type & 0xFF) != CCV_IO_DEFLATE_STREAM); // deflate stream (compressed stream) is not supported yet
-#if _XOPEN_SOURCE >= 700 || _POSIX_C_SOURCE >= 200809L || defined(__APPLE__) || defined(BSD)
-		// this is only supported by glibc
-#if _XOPEN_SOURCE >= 700 || _POSIX_C_SOURCE >= 200809L
-		fd = fmemopen((void*)in, (size_t)rows, "rb");
-#else
-		ccv_io_mem_t mem = {
-			.size = rows,
-			.pos = 0,
-			.buffer = (char*)in,
-		};
-		fd = funopen(&mem, readfn, 0, seekfn, 0);
-#endif
-		if (!fd)
-			return CCV_IO_ERROR;
-		// mimicking itself as a "file"
-		type = (type & ~0x10) | 0x20;
-		return _ccv_read_and_close_fd(fd, x, type);
-#endif
+		return _ccv_read_mem(in, (size_t)rows, x, type, params);
 	} else if (type & CCV_IO_ANY_RAW) {
 		return _ccv_read_raw(x, (void*)in /* it can be modifiable if it is NO_COPY mode */, type, rows, cols, scanline);
 	}
 	return CCV_IO_UNKNOWN;
 }
 
+int ccv_read_impl(const void* in, ccv_dense_matrix_t** x, int type, int rows, int cols, int scanline)
+{
+	return _ccv_read_impl(in, x, type, rows, cols, scanline, 0);
+}
+
+int ccv_read_scaled(const void* in, ccv_dense_matrix_t** x, int type, int size, ccv_read_param_t params)
+{
+	assert(!(type & CCV_IO_ANY_RAW)); // raw data is not encoded, use ccv_slice / ccv_resample on it instead
+	return _ccv_read_impl(in, x, type, size, 0, 0, &params);
+}
+
+int ccv_read_batch(const void* const* in, const int* sizes, ccv_dense_matrix_t** x, int count, int type, int rows, int cols)
+{
+	assert(!(type & CCV_IO_ANY_RAW)); // raw data is not encoded, there is nothing to decode in parallel
+	assert((rows > 0 && cols > 0) || (rows == 0 && cols == 0));
+	parallel_for(i, count) {
+		const int size = sizes ? sizes[i] : 0;
+		if (rows > 0 && cols > 0)
+		{
+			// decode at the smallest scale that is still larger than the output and resample from there
+			ccv_read_param_t params = {
+				.rows = rows,
+				.cols = cols,
+			};
+			ccv_dense_matrix_t* image = 0;
+			ccv_read_scaled(in[i], &image, type, size, params);
+			if (image)
+			{
+				if (image->rows == rows && image->cols == cols)
+					x[i] = image;
+				else {
+					ccv_resample(image, &x[i], 0, rows, cols, CCV_INTER_AREA | CCV_INTER_CUBIC);
+					ccv_matrix_free(image);
+				}
+			}
+		} else if (type & CCV_IO_ANY_FILE)
+			ccv_read(in[i], &x[i], type);
+		else
+			ccv_read(in[i], &x[i], type, size);
+	} parallel_endfor
+	int i, decoded = 0;
+	for (i = 0; i < count; i++)
+		if (x[i])
+			++decoded;
+	return decoded;
+}
+
 int ccv_write(ccv_dense_matrix_t* mat, char* out, int* len, int type, void* conf)
 {
 	FILE* fd = 0;
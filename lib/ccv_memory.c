@@ -13,13 +13,35 @@ static __thread ccv_cache_t ccv_cache;
 /* option to enable/disable cache */
 static __thread int ccv_cache_opt = 0;
 
+/* process-wide cache shared by all threads, takes precedence over the thread-local one when enabled */
+static ccv_shared_cache_t* ccv_shared_cache = 0;
+
+static inline int _ccv_cache_enabled(void)
+{
+	return ccv_shared_cache || ccv_cache_opt;
+}
+
+static inline void* _ccv_cache_out(uint64_t sig, uint8_t* type)
+{
+	if (ccv_shared_cache)
+		return ccv_shared_cache_out(ccv_shared_cache, sig, type);
+	return ccv_cache_out(&ccv_cache, sig, type);
+}
+
+static inline int _ccv_cache_put(uint64_t sig, void* x, uint32_t size, uint8_t type)
+{
+	if (ccv_shared_cache)
+		return ccv_shared_cache_put(ccv_shared_cache, sig, x, size, type);
+	return ccv_cache_put(&ccv_cache, sig, x, size, type);
+}
+
 ccv_dense_matrix_t* ccv_dense_matrix_new(int rows, int cols, int type, void* data, uint64_t sig)
 {
 	ccv_dense_matrix_t* mat;
-	if (ccv_cache_opt && sig != 0 && !data && !(type & CCV_NO_DATA_ALLOC))
+	if (_ccv_cache_enabled() && sig != 0 && !data && !(type & CCV_NO_DATA_ALLOC))
 	{
 		uint8_t type;
-		mat = (ccv_dense_matrix_t*)ccv_cache_out(&ccv_cache, sig, &type);
+		mat = (ccv_dense_matrix_t*)_ccv_cache_out(sig, &type);
 		if (mat)
 		{
 			assert(type == 0);
@@ -169,7 +191,7 @@ void ccv_matrix_free(ccv_matrix_t* mat)
 	{
 		ccv_dense_matrix_t* dmt = (ccv_dense_matrix_t*)mat;
 		dmt->refcount = 0;
-		if (!ccv_cache_opt || // e don't enable cache
+		if (!_ccv_cache_enabled() || // e don't enable cache
 			!(dmt->type & CCV_REUSABLE) || // or this is not a reusable piece
 			dmt->sig == 0 || // or this doesn't have valid signature
 			(dmt->type & CCV_NO_DATA_ALLOC)) // or this matrix is allocated as header-only, therefore we cannot cache it
@@ -181,7 +203,8 @@ void ccv_matrix_free(ccv_matrix_t* mat)
 				   CCV_GET_DATA_TYPE(dmt->type) == CCV_64S ||
 				   CCV_GET_DATA_TYPE(dmt->type) == CCV_64F);
 			size_t size = ccv_compute_dense_matrix_size(dmt->rows, dmt->cols, dmt->type);
-			ccv_cache_put(&ccv_cache, dmt->sig, dmt, size, 0 /* type 0 */);
+			if (_ccv_cache_put(dmt->sig, dmt, size, 0 /* type 0 */) < 0) // cannot cache it (too large), free it now
+				ccfree(dmt);
 		}
 	} else if (type & CCV_MATRIX_SPARSE) {
 		ccv_sparse_matrix_t* smt = (ccv_sparse_matrix_t*)mat;
@@ -204,10 +227,10 @@ void ccv_matrix_free(ccv_matrix_t* mat)
 ccv_array_t* ccv_array_new(int rsize, int rnum, uint64_t sig)
 {
 	ccv_array_t* array;
-	if (ccv_cache_opt && sig != 0)
+	if (_ccv_cache_enabled() && sig != 0)
 	{
 		uint8_t type;
-		array = (ccv_array_t*)ccv_cache_out(&ccv_cache, sig, &type);
+		array = (ccv_array_t*)_ccv_cache_out(sig, &type);
 		if (array)
 		{
 			assert(type == 1);
@@ -249,25 +272,33 @@ void ccv_array_free_immediately(ccv_array_t* array)
 
 void ccv_array_free(ccv_array_t* array)
 {
-	if (!ccv_cache_opt || !(array->type & CCV_REUSABLE) || array->sig == 0)
+	if (!_ccv_cache_enabled() || !(array->type & CCV_REUSABLE) || array->sig == 0)
 	{
 		array->refcount = 0;
 		ccfree(array->data);
 		ccfree(array);
 	} else {
 		size_t size = sizeof(ccv_array_t) + array->size * array->rsize;
-		ccv_cache_put(&ccv_cache, array->sig, array, size, 1 /* type 1 */);
+		if (_ccv_cache_put(array->sig, array, size, 1 /* type 1 */) < 0)
+			ccv_array_free_immediately(array);
 	}
 }
 
 void ccv_drain_cache(void)
 {
+	if (ccv_shared_cache)
+		ccv_shared_cache_cleanup(ccv_shared_cache);
 	if (ccv_cache.rnum > 0)
 		ccv_cache_cleanup(&ccv_cache);
 }
 
 void ccv_disable_cache(void)
 {
+	if (ccv_shared_cache)
+	{
+		ccv_shared_cache_free(ccv_shared_cache);
+		ccv_shared_cache = 0;
+	}
 	ccv_cache_opt = 0;
 	ccv_cache_close(&ccv_cache);
 }
@@ -283,6 +314,28 @@ void ccv_enable_default_cache(void)
 	ccv_enable_cache(CCV_DEFAULT_CACHE_SIZE);
 }
 
+void ccv_enable_shared_cache(size_t size)
+{
+	if (ccv_shared_cache)
+		ccv_shared_cache_free(ccv_shared_cache);
+	ccv_shared_cache = ccv_shared_cache_new(size, 2, ccv_matrix_free_immediately, ccv_array_free_immediately);
+}
+
+void ccv_get_cache_stats(ccv_cache_stats_t* stats)
+{
+	if (ccv_shared_cache)
+	{
+		ccv_shared_cache_stats(ccv_shared_cache, stats);
+		return;
+	}
+	stats->hit = ccv_cache.hit;
+	stats->miss = ccv_cache.miss;
+	stats->evict = ccv_cache.evict;
+	stats->rnum = ccv_cache.rnum;
+	stats->size = ccv_cache.size;
+	stats->up = ccv_cache.up;
+}
+
 static uint8_t key_siphash[16] = "libccvky4siphash";
 
 uint64_t ccv_cache_generate_signature(const char* msg, int len, uint64_t sig_start, ...)
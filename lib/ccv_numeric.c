@@ -582,6 +582,103 @@ static int _ccv_get_optimal_fft_size(int size)
 
 static pthread_mutex_t fftw_plan_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* FFTW planner is not thread-safe, but executing a plan with the new-array functions is. Thus, plans are
+ * created once per (rows, cols, channels, precision) under fftw_plan_mutex and shared by all threads.
+ * A plan is held (refcount) while a filter executes it, a drained plan that is still held is destroyed
+ * by whoever releases it last */
+typedef struct ccv_fftw_plan_s {
+	int rows;
+	int cols;
+	int ch;
+	int fft_type;
+	int refcount;
+	int drained;
+	fftw_plan p, pinv;
+	fftwf_plan pf, pinvf;
+	struct ccv_fftw_plan_s* next;
+} ccv_fftw_plan_t;
+
+static ccv_fftw_plan_t* fftw_plan_cache = 0;
+static unsigned fftw_plan_flags = FFTW_ESTIMATE;
+
+/* this has to be called with fftw_plan_mutex held */
+static void _ccv_fftw_plan_destroy(ccv_fftw_plan_t* plan)
+{
+	if (plan->fft_type == CCV_32F)
+	{
+		fftwf_destroy_plan(plan->pf);
+		fftwf_destroy_plan(plan->pinvf);
+	} else {
+		fftw_destroy_plan(plan->p);
+		fftw_destroy_plan(plan->pinv);
+	}
+	ccfree(plan);
+}
+
+static ccv_fftw_plan_t* _ccv_fftw_plan_get(int rows, int cols, int ch, int fft_type)
+{
+	pthread_mutex_lock(&fftw_plan_mutex);
+	ccv_fftw_plan_t* plan;
+	for (plan = fftw_plan_cache; plan; plan = plan->next)
+		if (plan->rows == rows && plan->cols == cols && plan->ch == ch && plan->fft_type == fft_type)
+			break;
+	if (plan == 0)
+	{
+		plan = (ccv_fftw_plan_t*)ccmalloc(sizeof(ccv_fftw_plan_t));
+		plan->rows = rows;
+		plan->cols = cols;
+		plan->ch = ch;
+		plan->fft_type = fft_type;
+		plan->refcount = 0;
+		plan->drained = 0;
+		plan->p = plan->pinv = 0;
+		plan->pf = plan->pinvf = 0;
+		int cols_2c = 2 * (cols / 2 + 1);
+		int ndim[] = {rows, cols};
+		if (fft_type == CCV_32F)
+		{
+			/* FFTW_MEASURE runs the transforms on the arrays, plan in-place on a scratch one that is
+			 * aligned the same way as the arrays from fftwf_malloc the plan will execute on */
+			float* buf = (fftw_plan_flags & FFTW_ESTIMATE) ? 0 : (float*)fftwf_malloc(rows * cols_2c * ch * sizeof(float));
+			if (ch == 1)
+			{
+				plan->pf = fftwf_plan_dft_r2c_2d(rows, cols, buf, (fftwf_complex*)buf, fftw_plan_flags);
+				plan->pinvf = fftwf_plan_dft_c2r_2d(rows, cols, (fftwf_complex*)buf, buf, fftw_plan_flags);
+			} else {
+				plan->pf = fftwf_plan_many_dft_r2c(2, ndim, ch, buf, 0, ch, 1, (fftwf_complex*)buf, 0, ch, 1, fftw_plan_flags);
+				plan->pinvf = fftwf_plan_many_dft_c2r(2, ndim, ch, (fftwf_complex*)buf, 0, ch, 1, buf, 0, ch, 1, fftw_plan_flags);
+			}
+			if (buf)
+				fftwf_free(buf);
+		} else {
+			double* buf = (fftw_plan_flags & FFTW_ESTIMATE) ? 0 : (double*)fftw_malloc(rows * cols_2c * ch * sizeof(double));
+			if (ch == 1)
+			{
+				plan->p = fftw_plan_dft_r2c_2d(rows, cols, buf, (fftw_complex*)buf, fftw_plan_flags);
+				plan->pinv = fftw_plan_dft_c2r_2d(rows, cols, (fftw_complex*)buf, buf, fftw_plan_flags);
+			} else {
+				plan->p = fftw_plan_many_dft_r2c(2, ndim, ch, buf, 0, ch, 1, (fftw_complex*)buf, 0, ch, 1, fftw_plan_flags);
+				plan->pinv = fftw_plan_many_dft_c2r(2, ndim, ch, (fftw_complex*)buf, 0, ch, 1, buf, 0, ch, 1, fftw_plan_flags);
+			}
+			if (buf)
+				fftw_free(buf);
+		}
+		plan->next = fftw_plan_cache;
+		fftw_plan_cache = plan;
+	}
+	++plan->refcount;
+	pthread_mutex_unlock(&fftw_plan_mutex);
+	return plan;
+}
+
+static void _ccv_fftw_plan_put(ccv_fftw_plan_t* plan)
+{
+	pthread_mutex_lock(&fftw_plan_mutex);
+	if (--plan->refcount == 0 && plan->drained)
+		_ccv_fftw_plan_destroy(plan);
+	pthread_mutex_unlock(&fftw_plan_mutex);
+}
+
 static void _ccv_filter_fftw(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_dense_matrix_t* d, int padding_pattern)
 {
 	int ch = CCV_GET_CHANNEL(a->type);
@@ -592,39 +689,18 @@ static void _ccv_filter_fftw(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_d
 	void* fftw_a;
 	void* fftw_b;
 	void* fftw_d;
-	fftw_plan p, pinv;
-	fftwf_plan pf, pinvf;
+	ccv_fftw_plan_t* plan = _ccv_fftw_plan_get(rows, cols, ch, fft_type);
+	fftw_plan p = plan->p, pinv = plan->pinv;
+	fftwf_plan pf = plan->pf, pinvf = plan->pinvf;
 	if (fft_type == CCV_32F)
 	{
 		fftw_a = fftwf_malloc(rows * cols_2c * ch * sizeof(float));
 		fftw_b = fftwf_malloc(rows * cols_2c * ch * sizeof(float));
 		fftw_d = fftwf_malloc(rows * cols_2c * ch * sizeof(float));
-		pthread_mutex_lock(&fftw_plan_mutex);
-		if (ch == 1)
-		{
-			pf = fftwf_plan_dft_r2c_2d(rows, cols, 0, 0, FFTW_ESTIMATE);
-			pinvf = fftwf_plan_dft_c2r_2d(rows, cols, 0, 0, FFTW_ESTIMATE);
-		} else {
-			int ndim[] = {rows, cols};
-			pf = fftwf_plan_many_dft_r2c(2, ndim, ch, 0, 0, ch, 1, 0, 0, ch, 1, FFTW_ESTIMATE);
-			pinvf = fftwf_plan_many_dft_c2r(2, ndim, ch, 0, 0, ch, 1, 0, 0, ch, 1, FFTW_ESTIMATE);
-		}
-		pthread_mutex_unlock(&fftw_plan_mutex);
 	} else {
 		fftw_a = fftw_malloc(rows * cols_2c * ch * sizeof(double));
 		fftw_b = fftw_malloc(rows * cols_2c * ch * sizeof(double));
 		fftw_d = fftw_malloc(rows * cols_2c * ch * sizeof(double));
-		pthread_mutex_lock(&fftw_plan_mutex);
-		if (ch == 1)
-		{
-			p = fftw_plan_dft_r2c_2d(rows, cols, 0, 0, FFTW_ESTIMATE);
-			pinv = fftw_plan_dft_c2r_2d(rows, cols, 0, 0, FFTW_ESTIMATE);
-		} else {
-			int ndim[] = {rows, cols};
-			p = fftw_plan_many_dft_r2c(2, ndim, ch, 0, 0, ch, 1, 0, 0, ch, 1, FFTW_ESTIMATE);
-			pinv = fftw_plan_many_dft_c2r(2, ndim, ch, 0, 0, ch, 1, 0, 0, ch, 1, FFTW_ESTIMATE);
-		}
-		pthread_mutex_unlock(&fftw_plan_mutex);
 	}
 	memset(fftw_b, 0, rows * cols_2c * ch * CCV_GET_DATA_TYPE_SIZE(fft_type));
 
@@ -744,10 +820,6 @@ static void _ccv_filter_fftw(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_d
 		ccv_matrix_setter(d->type, ccv_matrix_getter, a->type, for_block, float, fftwf_complex);
 #undef fft_execute_dft_r2c
 #undef fft_execute_dft_c2r
-		pthread_mutex_lock(&fftw_plan_mutex);
-		fftwf_destroy_plan(pf);
-		fftwf_destroy_plan(pinvf);
-		pthread_mutex_unlock(&fftw_plan_mutex);
 		fftwf_free(fftw_a);
 		fftwf_free(fftw_b);
 		fftwf_free(fftw_d);
@@ -757,15 +829,12 @@ static void _ccv_filter_fftw(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_d
 		ccv_matrix_setter(d->type, ccv_matrix_getter, a->type, for_block, double, fftw_complex);
 #undef fft_execute_dft_r2c
 #undef fft_execute_dft_c2r
-		pthread_mutex_lock(&fftw_plan_mutex);
-		fftw_destroy_plan(p);
-		fftw_destroy_plan(pinv);
-		pthread_mutex_unlock(&fftw_plan_mutex);
 		fftw_free(fftw_a);
 		fftw_free(fftw_b);
 		fftw_free(fftw_d);
 	}
 #undef for_block
+	_ccv_fftw_plan_put(plan);
 }
 #else
 static void _ccv_filter_kissfft(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_dense_matrix_t* d, int padding_pattern)
@@ -1060,6 +1129,88 @@ void ccv_filter(ccv_dense_matrix_t* a, ccv_dense_matrix_t* b, ccv_dense_matrix_t
 	}
 }
 
+void ccv_filter_plan_mode(int mode)
+{
+#ifdef HAVE_FFTW3
+	pthread_mutex_lock(&fftw_plan_mutex);
+	fftw_plan_flags = (mode == CCV_FILTER_PLAN_MEASURE) ? FFTW_MEASURE : FFTW_ESTIMATE;
+	pthread_mutex_unlock(&fftw_plan_mutex);
+#endif
+}
+
+void ccv_filter_plan_drain(void)
+{
+#ifdef HAVE_FFTW3
+	pthread_mutex_lock(&fftw_plan_mutex);
+	ccv_fftw_plan_t* plan = fftw_plan_cache;
+	while (plan)
+	{
+		ccv_fftw_plan_t* next = plan->next;
+		// a plan that is still executing elsewhere is destroyed when that filter finishes with it
+		if (plan->refcount > 0)
+			plan->drained = 1;
+		else
+			_ccv_fftw_plan_destroy(plan);
+		plan = next;
+	}
+	fftw_plan_cache = 0;
+	pthread_mutex_unlock(&fftw_plan_mutex);
+#endif
+}
+
+#ifdef HAVE_FFTW3
+/* like FFTW's own system wisdom (/etc/fftw/wisdom and /etc/fftw/wisdomf), the double precision wisdom is in
+ * filename and the single precision one is in filename with "f" appended, both in the standard FFTW format */
+static char* _ccv_fftw_wisdomf_filename(const char* filename)
+{
+	size_t len = strlen(filename);
+	char* filenamef = (char*)ccmalloc(len + 2);
+	memcpy(filenamef, filename, len);
+	filenamef[len] = 'f';
+	filenamef[len + 1] = 0;
+	return filenamef;
+}
+#endif
+
+int ccv_filter_plan_import(const char* filename)
+{
+#ifdef HAVE_FFTW3
+	char* filenamef = _ccv_fftw_wisdomf_filename(filename);
+	// skip the precision without a wisdom file, but the ones exist have to be loaded
+	FILE* r = fopen(filename, "rb");
+	FILE* rf = fopen(filenamef, "rb");
+	int status = (r || rf);
+	if (r)
+		fclose(r);
+	if (rf)
+		fclose(rf);
+	pthread_mutex_lock(&fftw_plan_mutex);
+	if (status && r)
+		status = fftw_import_wisdom_from_filename(filename);
+	if (status && rf)
+		status = fftwf_import_wisdom_from_filename(filenamef);
+	pthread_mutex_unlock(&fftw_plan_mutex);
+	ccfree(filenamef);
+	return status ? 0 : -1;
+#else
+	return -1;
+#endif
+}
+
+int ccv_filter_plan_export(const char* filename)
+{
+#ifdef HAVE_FFTW3
+	char* filenamef = _ccv_fftw_wisdomf_filename(filename);
+	pthread_mutex_lock(&fftw_plan_mutex);
+	int status = fftw_export_wisdom_to_filename(filename) && fftwf_export_wisdom_to_filename(filenamef);
+	pthread_mutex_unlock(&fftw_plan_mutex);
+	ccfree(filenamef);
+	return status ? 0 : -1;
+#else
+	return -1;
+#endif
+}
+
 void ccv_filter_kernel(ccv_dense_matrix_t* x, ccv_filter_kernel_f func, void* data)
 {
 	int i, j, k, ch = CCV_GET_CHANNEL(x->type);
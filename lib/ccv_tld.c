@@ -937,7 +937,7 @@ ccv_comp_t ccv_tld_track_object(ccv_tld_t* tld, ccv_dense_matrix_t* a, ccv_dense
 	{
 		ccv_array_t* idx_dd = 0;
 		// group retrieved rectangles in order to filter out noise
-		int ncomp = ccv_array_group(dd, &idx_dd, _ccv_is_equal, 0);
+		int ncomp = ccv_array_group_rect(dd, &idx_dd, _ccv_is_equal, 0);
 		ccv_comp_t* comps = (ccv_comp_t*)ccmalloc(ncomp * sizeof(ccv_comp_t));
 		memset(comps, 0, ncomp * sizeof(ccv_comp_t));
 		for (i = 0; i < dd->rnum; i++)
@@ -1,5 +1,8 @@
 #include "ccv.h"
 #include "ccv_internal.h"
+#if defined(HAVE_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#endif
 
 ccv_dense_matrix_t* ccv_get_dense_matrix(ccv_matrix_t* mat)
 {
@@ -1639,11 +1642,46 @@ static uint16_t _ccv_offset_table[64] = {
 	0x400, 0x400, 0x400, 0x400, 0x400, 0x400, 0x400, 0x400,
 };
 
+#if defined(HAVE_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_F16C_DISPATCH
+// F16C is not part of the baseline we compile for, only use it when the CPU reports it.
+// It quiets signaling NaNs, blocks that have NaNs go through the tables to keep their payloads.
+__attribute__((target("avx,f16c"))) static size_t _ccv_half_precision_to_float_f16c(uint16_t* h, float* f, size_t len)
+{
+	const __m128i abs_mask = _mm_set1_epi16(0x7fff);
+	const __m128i inf = _mm_set1_epi16(0x7c00);
+	uint32_t* u = (uint32_t*)f;
+	size_t i, j;
+	for (i = 0; i + 8 <= len; i += 8)
+	{
+		const __m128i x = _mm_loadu_si128((__m128i*)(h + i));
+		if (_mm_movemask_epi8(_mm_cmpgt_epi16(_mm_and_si128(x, abs_mask), inf)))
+			for (j = i; j < i + 8; j++)
+				u[j] = _ccv_mantissa_table[_ccv_offset_table[h[j] >> 10] + (h[j] & 0x3ff)] + _ccv_exponent_table[h[j] >> 10];
+		else
+			_mm256_storeu_ps(f + i, _mm256_cvtph_ps(x));
+	}
+	return i;
+}
+
+static int _ccv_f16c = 0;
+
+// Settle the check before any thread can call in, so the dispatch below only ever reads it.
+__attribute__((constructor)) static void _ccv_f16c_init(void)
+{
+	_ccv_f16c = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+}
+#endif
+
 void ccv_half_precision_to_float(uint16_t* h, float* f, size_t len)
 {
-	int i;
+	size_t i = 0;
+#ifdef HAVE_F16C_DISPATCH
+	if (_ccv_f16c)
+		i = _ccv_half_precision_to_float_f16c(h, f, len);
+#endif
 	uint32_t* u = (uint32_t*)f;
-	for (i = 0; i < len; i++)
+	for (; i < len; i++)
 		u[i] = _ccv_mantissa_table[_ccv_offset_table[h[i] >> 10] + (h[i] & 0x3ff)] + _ccv_exponent_table[h[i] >> 10];
 }
 
@@ -1770,6 +1808,136 @@ int ccv_array_group(ccv_array_t* array, ccv_array_t** index, ccv_array_group_f g
 	return class_idx;
 }
 
+static inline int _ccv_array_group_find(int* parent, int i)
+{
+	int root = i;
+	while (parent[root] != root)
+		root = parent[root];
+	/* compress path from i to the root: */
+	while (parent[i] != root)
+	{
+		int next = parent[i];
+		parent[i] = root;
+		i = next;
+	}
+	return root;
+}
+
+int ccv_array_group_rect(ccv_array_t* array, ccv_array_t** index, ccv_array_group_f gfunc, void* data)
+{
+	int i, j, k, x, y;
+	int* parent = (int*)ccmalloc(sizeof(int) * array->rnum * 2);
+	int* rank = parent + array->rnum;
+	int min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+	double mean_width = 0, mean_height = 0;
+	for (i = 0; i < array->rnum; i++)
+	{
+		parent[i] = i;
+		rank[i] = 0;
+		ccv_rect_t rect = ((ccv_comp_t*)ccv_array_get(array, i))->rect;
+		if (i == 0)
+		{
+			min_x = max_x = rect.x;
+			min_y = max_y = rect.y;
+		}
+		min_x = ccv_min(min_x, rect.x);
+		min_y = ccv_min(min_y, rect.y);
+		max_x = ccv_max(max_x, rect.x + rect.width);
+		max_y = ccv_max(max_y, rect.y + rect.height);
+		mean_width += rect.width;
+		mean_height += rect.height;
+	}
+	if (array->rnum > 0)
+	{
+		/* the cell size follows the mean rectangle size, thus, a typical rectangle covers up to 4 cells,
+		 * and the grid itself is capped to a few cells per rectangle */
+		int cell_width = ccv_max(1, (int)(mean_width / array->rnum + 0.5));
+		int cell_height = ccv_max(1, (int)(mean_height / array->rnum + 0.5));
+		int grid_cols = (max_x - min_x) / cell_width + 1;
+		int grid_rows = (max_y - min_y) / cell_height + 1;
+		while ((double)grid_cols * grid_rows > 4.0 * array->rnum + 16)
+		{
+			cell_width *= 2;
+			cell_height *= 2;
+			grid_cols = (max_x - min_x) / cell_width + 1;
+			grid_rows = (max_y - min_y) / cell_height + 1;
+		}
+		/* bucket every rectangle into all the cells it touches, in compressed row form */
+		int* cell_start = (int*)cccalloc(grid_cols * grid_rows + 1, sizeof(int));
+		for (i = 0; i < array->rnum; i++)
+		{
+			ccv_rect_t rect = ((ccv_comp_t*)ccv_array_get(array, i))->rect;
+			int x0 = (rect.x - min_x) / cell_width, x1 = (rect.x + rect.width - min_x) / cell_width;
+			int y0 = (rect.y - min_y) / cell_height, y1 = (rect.y + rect.height - min_y) / cell_height;
+			for (y = y0; y <= y1; y++)
+				for (x = x0; x <= x1; x++)
+					++cell_start[y * grid_cols + x + 1];
+		}
+		for (i = 0; i < grid_cols * grid_rows; i++)
+			cell_start[i + 1] += cell_start[i];
+		int* cell = (int*)ccmalloc(sizeof(int) * (cell_start[grid_cols * grid_rows] + grid_cols * grid_rows));
+		int* cell_fill = cell + cell_start[grid_cols * grid_rows];
+		memcpy(cell_fill, cell_start, sizeof(int) * grid_cols * grid_rows);
+		for (i = 0; i < array->rnum; i++)
+		{
+			ccv_rect_t rect = ((ccv_comp_t*)ccv_array_get(array, i))->rect;
+			int x0 = (rect.x - min_x) / cell_width, x1 = (rect.x + rect.width - min_x) / cell_width;
+			int y0 = (rect.y - min_y) / cell_height, y1 = (rect.y + rect.height - min_y) / cell_height;
+			for (y = y0; y <= y1; y++)
+				for (x = x0; x <= x1; x++)
+					cell[cell_fill[y * grid_cols + x]++] = i;
+		}
+		for (y = 0; y < grid_rows; y++)
+			for (x = 0; x < grid_cols; x++)
+			{
+				int* bucket = cell + cell_start[y * grid_cols + x];
+				int bucket_size = cell_start[y * grid_cols + x + 1] - cell_start[y * grid_cols + x];
+				for (j = 0; j < bucket_size; j++)
+				{
+					void* a = ccv_array_get(array, bucket[j]);
+					ccv_rect_t ra = ((ccv_comp_t*)a)->rect;
+					for (k = j + 1; k < bucket_size; k++)
+					{
+						void* b = ccv_array_get(array, bucket[k]);
+						ccv_rect_t rb = ((ccv_comp_t*)b)->rect;
+						/* a pair shares a run of cells, only test it in the cell that holds the top-left corner of the intersection */
+						if ((ccv_max(ra.x, rb.x) - min_x) / cell_width != x || (ccv_max(ra.y, rb.y) - min_y) / cell_height != y)
+							continue;
+						int root = _ccv_array_group_find(parent, bucket[j]);
+						int root2 = _ccv_array_group_find(parent, bucket[k]);
+						if (root == root2 || !(gfunc(a, b, data) || gfunc(b, a, data)))
+							continue;
+						if (rank[root] > rank[root2])
+							parent[root2] = root;
+						else {
+							parent[root] = root2;
+							rank[root2] += rank[root] == rank[root2];
+						}
+					}
+				}
+			}
+		ccfree(cell);
+		ccfree(cell_start);
+	}
+	if (*index == 0)
+		*index = ccv_array_new(sizeof(int), array->rnum, 0);
+	else
+		ccv_array_clear(*index);
+	ccv_array_t* idx = *index;
+
+	int class_idx = 0;
+	for (i = 0; i < array->rnum; i++)
+	{
+		int root = _ccv_array_group_find(parent, i);
+		if (rank[root] >= 0)
+			rank[root] = ~class_idx++;
+		j = ~rank[root];
+		ccv_array_push(idx, &j);
+	}
+	ccfree(parent);
+	return class_idx;
+}
+
 ccv_contour_t* ccv_contour_new(int set)
 {
 	ccv_contour_t* contour = (ccv_contour_t*)ccmalloc(sizeof(ccv_contour_t));
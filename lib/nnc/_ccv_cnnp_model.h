@@ -1,11 +1,17 @@
 #include "ccv_nnc.h"
 
+// Initialize the state (the tensor of a trainable symbol for example) by running a command to output to it.
+typedef void (*ccv_cnnp_state_initializer_f)(void* const context, const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, const ccv_nnc_tensor_symbol_t symbol);
+
 typedef struct {
 	void (*deinit)(ccv_cnnp_model_t* const self); // It can be nil.
 	void (*build)(ccv_cnnp_model_t* const self, ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_symbol_t* const inputs, const int input_size, ccv_nnc_tensor_symbol_t* const outputs, const int output_size); // Call this graph to build computation. No need to specify input size or output size, as it is defined along in the model already.
 	void (*add_to_trainable)(ccv_cnnp_model_t* const self, ccv_array_t* const trainables); // This is called to add ccv_nnc_tensor_symbol_t to as list of trainables.
+	void (*init_states)(ccv_cnnp_model_t* const self, ccv_nnc_symbolic_graph_t* const graph, const ccv_cnnp_state_initializer_f initializer, void* const context); // This is called to initialize the trainables with the initializer, it can be nil.
 } ccv_cnnp_model_vtab_t;
 
+typedef struct ccv_cnnp_compiled_data_s ccv_cnnp_compiled_data_t; // The data for fit, only available after the model is compiled.
+
 struct ccv_cnnp_model_s {
 	const ccv_cnnp_model_vtab_t* isa;
 	int input_size;
@@ -14,6 +20,8 @@ struct ccv_cnnp_model_s {
 	ccv_nnc_symbolic_graph_t* graph;
 	ccv_nnc_tensor_symbol_t* inputs; // Unlike outputs, which is not dynamically allocated, inputs is dynamically allocated, and may be 0.
 	ccv_nnc_tensor_symbol_t* outputs;
+	int parallel; // How many pieces a minibatch is split into, 0 to decide it on compile.
+	ccv_cnnp_compiled_data_t* compiled_data;
 };
 
 static inline void ccv_cnnp_model_build(ccv_cnnp_model_t* const self, ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_symbol_t* const inputs, const int input_size, ccv_nnc_tensor_symbol_t* const outputs, const int output_size)
@@ -32,3 +40,9 @@ static inline void ccv_cnnp_model_add_to_trainable(ccv_cnnp_model_t* const self,
 	if (self->isa->add_to_trainable)
 		self->isa->add_to_trainable(self, trainables);
 }
+
+static inline void ccv_cnnp_model_init_states(ccv_cnnp_model_t* const self, ccv_nnc_symbolic_graph_t* const graph, const ccv_cnnp_state_initializer_f initializer, void* const context)
+{
+	if (self->isa->init_states)
+		self->isa->init_states(self, graph, initializer, context);
+}
@@ -70,6 +70,9 @@ typedef struct {
 	ccv_nnc_graph_tensor_wrap_t* from;
 } ccv_nnc_graph_tensor_carry_over_t;
 
+// The worker pool for CCV_NNC_GRAPH_RUN_PARALLEL, lazily created on the first parallel run.
+typedef struct ccv_nnc_graph_scheduler_s ccv_nnc_graph_scheduler_t;
+
 struct ccv_nnc_graph_s {
 	int p_idx; // Reference to the index in its parent graph's sub-graph array, Starts at 1.
 	int exec_idx; // Reference to the index in its parent graph's exec (the graph exec), Starts at 1.
@@ -94,6 +97,13 @@ struct ccv_nnc_graph_s {
 	// End of while loop handling.
 	// Extra metadata, useful when we don't want extra memory allocation.
 	ccv_array_t* carry_overs; // The array of tensor carry_overs.
+	// Parallel run.
+	int worker_size; // Number of threads (including the caller) to run the graph with, 0 means number of CPUs.
+	ccv_nnc_graph_scheduler_t* scheduler;
+	// Profile, only collected on the root graph.
+	ccv_array_t* profile; // The array of ccv_nnc_graph_profile_entry_t, appended when run with CCV_NNC_GRAPH_RUN_PROFILE.
 };
 
+void ccv_nnc_graph_scheduler_free(ccv_nnc_graph_scheduler_t* const scheduler);
+
 #endif
@@ -92,6 +92,7 @@ struct ccv_nnc_symbolic_graph_s {
 		int tensor;
 		int exec;
 	} reuse; // The reuse slot for tensor or graph exec symbols.
+	int compile_flags; // How the memory is planned when compiled (CCV_NNC_SYMBOLIC_GRAPH_COMPILE_*).
 	// Start for backward (automatic differentiation) handling
 	int backward_tensor_symbol_size;
 	int* backward_tensor_symbols;
@@ -133,6 +134,11 @@ struct ccv_nnc_tensor_arena_s {
 	// ccv_tensor_multiview_t, thus, it is aligned to a 16-byte boundary).
 	ccv_array_t* tensor_metadata;
 	ccv_array_t* m_tensor_idx; // The index into multi-view tensors in tensor_metadata.
+	// The layout of the blocks in the buffers (for ccv_nnc_tensor_arena_report).
+	int exec_size;
+	int block_size;
+	uint64_t peak_size;
+	ccv_nnc_tensor_arena_block_t* blocks;
 };
 
 struct ccv_nnc_graph_exec_arena_s {
@@ -160,6 +166,26 @@ inline static void ccv_array_replace_int(ccv_array_t* ints, const int idx, const
 	ccv_array_push(ints, &outgoing);
 }
 
+// Whether the exec gives the same outputs from the same inputs whenever it runs. Random commands don't, and there is
+// no telling for custom commands or sub-graphs. Passes that run an exec ahead of time (constant folding) or a second
+// time (checkpointing) only take these.
+inline static int ccv_nnc_graph_exec_symbol_is_deterministic(const ccv_nnc_graph_exec_symbol_info_t* const exec_info)
+{
+	if (exec_info->graph_ref_size)
+		return 0;
+	switch (exec_info->cmd.cmd)
+	{
+		case CCV_NNC_CUSTOM_FORWARD:
+		case CCV_NNC_CUSTOM_BACKWARD:
+		case CCV_NNC_GRAPH_FORWARD:
+		case CCV_NNC_GRAPH_BACKWARD:
+		case CCV_NNC_RANDOM_UNIFORM_FORWARD:
+		case CCV_NNC_DROPOUT_FORWARD:
+			return 0;
+	}
+	return 1;
+}
+
 void ccv_nnc_symbolic_graph_symbol_infer(const ccv_nnc_symbolic_graph_t* const symbolic_graph, const ccv_nnc_graph_visit_t* const visit, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size, const ccv_nnc_tensor_symbol_info_t* const p_tensor_symbol_info, const int p_tensor_symbol_info_size, ccv_nnc_tensor_symbol_info_t* const tensor_symbol_info, ccv_nnc_graph_exec_symbol_info_t* const exec_symbol_info);
 
 void ccv_nnc_symbolic_graph_add_source(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t source);
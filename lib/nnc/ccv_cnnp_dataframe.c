@@ -2,3 +2,491 @@
 #include "ccv_nnc_easy.h"
 #include "ccv_nnc_internal.h"
 #include "ccv_internal.h"
+#include "3rdparty/dsfmt/dSFMT.h"
+#include <pthread.h>
+
+typedef struct {
+	ccv_cnnp_column_data_enum_f data_enum; // If 0, this is a derived column.
+	ccv_cnnp_column_data_map_f map;
+	ccv_cnnp_column_data_deinit_f data_deinit;
+	void* context;
+	ccv_cnnp_column_data_context_deinit_f context_deinit;
+	int column_idx_size; // The columns this one derived from.
+	int* column_idxs;
+} ccv_cnnp_dataframe_column_t;
+
+struct ccv_cnnp_dataframe_s {
+	int row_count;
+	int* shuffled_idx; // 0 if never shuffled.
+	dsfmt_t dsfmt;
+	ccv_array_t* columns;
+};
+
+// A slot holds the data of one row for every column. Once computed, a column of the slot is not computed again
+// until the slot moves to another row, and the data is given back to the callbacks to reuse when it does.
+typedef struct {
+	int epoch; // Increment every time the slot moves to another row.
+	int row_idx;
+	int column_size;
+	int* computed; // The epoch when the column computed.
+	void** data;
+} ccv_cnnp_dataframe_slot_t;
+
+static void _ccv_cnnp_dataframe_slot_init(ccv_cnnp_dataframe_slot_t* const slot, const int column_size)
+{
+	slot->epoch = 0;
+	slot->row_idx = -1;
+	slot->column_size = column_size;
+	slot->computed = (int*)cccalloc(column_size, sizeof(int) + sizeof(void*));
+	slot->data = (void**)(slot->computed + column_size);
+}
+
+static void _ccv_cnnp_dataframe_slot_deinit(ccv_cnnp_dataframe_t* const dataframe, ccv_cnnp_dataframe_slot_t* const slot)
+{
+	int i;
+	for (i = 0; i < slot->column_size; i++)
+		if (slot->data[i])
+		{
+			const ccv_cnnp_dataframe_column_t* const column = (ccv_cnnp_dataframe_column_t*)ccv_array_get(dataframe->columns, i);
+			if (column->data_deinit)
+				column->data_deinit(slot->data[i], column->context);
+		}
+	ccfree(slot->computed);
+}
+
+static void* _ccv_cnnp_dataframe_slot_column(ccv_cnnp_dataframe_t* const dataframe, ccv_cnnp_dataframe_slot_t* const slot, const int column_idx)
+{
+	assert(column_idx < slot->column_size);
+	if (slot->computed[column_idx] == slot->epoch)
+		return slot->data[column_idx];
+	const ccv_cnnp_dataframe_column_t* const column = (ccv_cnnp_dataframe_column_t*)ccv_array_get(dataframe->columns, column_idx);
+	if (column->data_enum)
+		column->data_enum(column_idx, &slot->row_idx, 1, slot->data + column_idx, column->context);
+	else {
+		int i;
+		void* input_data[ccv_max(1, column->column_idx_size)];
+		void** column_data[ccv_max(1, column->column_idx_size)];
+		for (i = 0; i < column->column_idx_size; i++)
+		{
+			input_data[i] = _ccv_cnnp_dataframe_slot_column(dataframe, slot, column->column_idxs[i]);
+			column_data[i] = input_data + i;
+		}
+		column->map(column_data, column->column_idx_size, 1, slot->data + column_idx, column->context);
+	}
+	slot->computed[column_idx] = slot->epoch;
+	return slot->data[column_idx];
+}
+
+static void _ccv_cnnp_dataframe_slot_move(ccv_cnnp_dataframe_slot_t* const slot, const int row_idx)
+{
+	slot->row_idx = row_idx;
+	++slot->epoch;
+}
+
+ccv_cnnp_dataframe_t* ccv_cnnp_dataframe_new(const ccv_cnnp_column_data_t* const column_data, const int column_size, const int row_count)
+{
+	assert(row_count >= 0);
+	ccv_cnnp_dataframe_t* const dataframe = (ccv_cnnp_dataframe_t*)ccmalloc(sizeof(ccv_cnnp_dataframe_t));
+	dataframe->row_count = row_count;
+	dataframe->shuffled_idx = 0;
+	dsfmt_init_gen_rand(&dataframe->dsfmt, 0);
+	dataframe->columns = ccv_array_new(sizeof(ccv_cnnp_dataframe_column_t), ccv_max(column_size, 1), 0);
+	int i;
+	for (i = 0; i < column_size; i++)
+		ccv_cnnp_dataframe_add(dataframe, column_data[i].data_enum, column_data[i].data_deinit, column_data[i].context, column_data[i].context_deinit);
+	return dataframe;
+}
+
+static void _ccv_cnnp_array_enum(const int column_idx, const int* const row_idxs, const int row_size, void** const data, void* const context)
+{
+	ccv_array_t* const array = (ccv_array_t*)context;
+	int i;
+	for (i = 0; i < row_size; i++)
+		data[i] = ccv_array_get(array, row_idxs[i]);
+}
+
+ccv_cnnp_dataframe_t* ccv_cnnp_dataframe_from_array_new(ccv_array_t* const array)
+{
+	const ccv_cnnp_column_data_t array_column_data = {
+		.data_enum = _ccv_cnnp_array_enum,
+		.context = array,
+	};
+	return ccv_cnnp_dataframe_new(&array_column_data, 1, array->rnum);
+}
+
+int ccv_cnnp_dataframe_add(ccv_cnnp_dataframe_t* const dataframe, const ccv_cnnp_column_data_enum_f data_enum, const ccv_cnnp_column_data_deinit_f data_deinit, void* const context, const ccv_cnnp_column_data_context_deinit_f context_deinit)
+{
+	assert(data_enum);
+	const ccv_cnnp_dataframe_column_t column = {
+		.data_enum = data_enum,
+		.data_deinit = data_deinit,
+		.context = context,
+		.context_deinit = context_deinit,
+	};
+	ccv_array_push(dataframe->columns, &column);
+	return dataframe->columns->rnum - 1;
+}
+
+int ccv_cnnp_dataframe_map(ccv_cnnp_dataframe_t* const dataframe, const ccv_cnnp_column_data_map_f map, const ccv_cnnp_column_data_deinit_f data_deinit, const int* const column_idxs, const int column_idx_size, void* const context, const ccv_cnnp_column_data_context_deinit_f context_deinit)
+{
+	assert(map);
+	assert(column_idx_size > 0);
+	int i;
+	for (i = 0; i < column_idx_size; i++)
+		{ assert(column_idxs[i] >= 0 && column_idxs[i] < dataframe->columns->rnum); }
+	ccv_cnnp_dataframe_column_t column = {
+		.map = map,
+		.data_deinit = data_deinit,
+		.context = context,
+		.context_deinit = context_deinit,
+		.column_idx_size = column_idx_size,
+	};
+	column.column_idxs = (int*)ccmalloc(sizeof(int) * column_idx_size);
+	memcpy(column.column_idxs, column_idxs, sizeof(int) * column_idx_size);
+	ccv_array_push(dataframe->columns, &column);
+	return dataframe->columns->rnum - 1;
+}
+
+void ccv_cnnp_dataframe_shuffle(ccv_cnnp_dataframe_t* const dataframe)
+{
+	const int row_count = dataframe->row_count;
+	int i;
+	if (!dataframe->shuffled_idx)
+	{
+		dataframe->shuffled_idx = (int*)ccmalloc(sizeof(int) * row_count);
+		for (i = 0; i < row_count; i++)
+			dataframe->shuffled_idx[i] = i;
+	}
+	// Fisher-Yates.
+	for (i = row_count - 1; i > 0; i--)
+	{
+		const int j = ccv_min((int)(dsfmt_genrand_close_open(&dataframe->dsfmt) * (i + 1)), i);
+		int t;
+		CCV_SWAP(dataframe->shuffled_idx[i], dataframe->shuffled_idx[j], t);
+	}
+}
+
+int ccv_cnnp_dataframe_row_count(ccv_cnnp_dataframe_t* const dataframe)
+{
+	return dataframe->row_count;
+}
+
+void ccv_cnnp_dataframe_free(ccv_cnnp_dataframe_t* const dataframe)
+{
+	int i;
+	for (i = 0; i < dataframe->columns->rnum; i++)
+	{
+		ccv_cnnp_dataframe_column_t* const column = (ccv_cnnp_dataframe_column_t*)ccv_array_get(dataframe->columns, i);
+		if (column->context_deinit)
+			column->context_deinit(column->context);
+		if (column->column_idxs)
+			ccfree(column->column_idxs);
+	}
+	ccv_array_free(dataframe->columns);
+	if (dataframe->shuffled_idx)
+		ccfree(dataframe->shuffled_idx);
+	ccfree(dataframe);
+}
+
+// Batching
+
+typedef struct {
+	ccv_cnnp_dataframe_t* dataframe;
+	int batch_count;
+	int column_idx_size;
+	int* column_idxs;
+	// Slots to compute rows of the underlying dataframe, one is taken for each batch being computed.
+	pthread_mutex_t mutex;
+	ccv_array_t* slots;
+} ccv_cnnp_dataframe_batching_t;
+
+static void _ccv_cnnp_batching_enum(const int column_idx, const int* const row_idxs, const int row_size, void** const data, void* const context)
+{
+	ccv_cnnp_dataframe_batching_t* const batching = (ccv_cnnp_dataframe_batching_t*)context;
+	ccv_cnnp_dataframe_t* const dataframe = batching->dataframe;
+	const int batch_count = batching->batch_count;
+	const int column_idx_size = batching->column_idx_size;
+	ccv_cnnp_dataframe_slot_t* slot;
+	pthread_mutex_lock(&batching->mutex);
+	if (batching->slots->rnum > 0)
+	{
+		slot = *(ccv_cnnp_dataframe_slot_t**)ccv_array_get(batching->slots, batching->slots->rnum - 1);
+		--batching->slots->rnum;
+	} else {
+		slot = (ccv_cnnp_dataframe_slot_t*)ccmalloc(sizeof(ccv_cnnp_dataframe_slot_t));
+		_ccv_cnnp_dataframe_slot_init(slot, dataframe->columns->rnum);
+	}
+	pthread_mutex_unlock(&batching->mutex);
+	int i, j, k;
+	for (i = 0; i < row_size; i++)
+	{
+		ccv_nnc_tensor_t** tensors = (ccv_nnc_tensor_t**)data[i];
+		if (!tensors)
+			tensors = (ccv_nnc_tensor_t**)(data[i] = cccalloc(column_idx_size, sizeof(ccv_nnc_tensor_t*)));
+		for (j = 0; j < batch_count; j++)
+		{
+			const int row_idx = row_idxs[i] * batch_count + j;
+			_ccv_cnnp_dataframe_slot_move(slot, dataframe->shuffled_idx ? dataframe->shuffled_idx[row_idx] : row_idx);
+			for (k = 0; k < column_idx_size; k++)
+			{
+				ccv_nnc_tensor_t* const tensor = (ccv_nnc_tensor_t*)_ccv_cnnp_dataframe_slot_column(dataframe, slot, batching->column_idxs[k]);
+				assert(CCV_TENSOR_GET_MEMORY(tensor->info.type) == CCV_TENSOR_CPU_MEMORY);
+				assert(!CCV_IS_TENSOR_VIEW(tensor));
+				const int nd = ccv_nnc_tensor_nd(tensor->info.dim);
+				assert(nd < CCV_NNC_MAX_DIM_ALLOC);
+				if (!tensors[k])
+				{
+					ccv_nnc_tensor_param_t params = tensor->info;
+					memset(params.dim, 0, sizeof(params.dim));
+					params.dim[0] = batch_count;
+					memcpy(params.dim + 1, tensor->info.dim, sizeof(int) * nd);
+					tensors[k] = ccv_nnc_tensor_new(0, params, 0);
+				}
+				assert(tensors[k]->info.datatype == tensor->info.datatype);
+				assert(memcmp(tensors[k]->info.dim + 1, tensor->info.dim, sizeof(int) * nd) == 0);
+				const size_t data_size = CCV_GET_DATA_TYPE_SIZE(tensor->info.datatype) * ccv_nnc_tensor_count(tensor->info);
+				memcpy(tensors[k]->data.u8 + data_size * j, tensor->data.u8, data_size);
+			}
+		}
+	}
+	pthread_mutex_lock(&batching->mutex);
+	ccv_array_push(batching->slots, &slot);
+	pthread_mutex_unlock(&batching->mutex);
+}
+
+static void _ccv_cnnp_batching_data_deinit(void* const data, void* const context)
+{
+	ccv_cnnp_dataframe_batching_t* const batching = (ccv_cnnp_dataframe_batching_t*)context;
+	ccv_nnc_tensor_t** const tensors = (ccv_nnc_tensor_t**)data;
+	int i;
+	for (i = 0; i < batching->column_idx_size; i++)
+		if (tensors[i])
+			ccv_nnc_tensor_free(tensors[i]);
+	ccfree(tensors);
+}
+
+static void _ccv_cnnp_batching_context_deinit(void* const context)
+{
+	ccv_cnnp_dataframe_batching_t* const batching = (ccv_cnnp_dataframe_batching_t*)context;
+	int i;
+	for (i = 0; i < batching->slots->rnum; i++)
+	{
+		ccv_cnnp_dataframe_slot_t* const slot = *(ccv_cnnp_dataframe_slot_t**)ccv_array_get(batching->slots, i);
+		_ccv_cnnp_dataframe_slot_deinit(batching->dataframe, slot);
+		ccfree(slot);
+	}
+	ccv_array_free(batching->slots);
+	pthread_mutex_destroy(&batching->mutex);
+	ccfree(batching);
+}
+
+ccv_cnnp_dataframe_t* ccv_cnnp_dataframe_batching_new(ccv_cnnp_dataframe_t* const dataframe, const int* const column_idxs, const int column_idx_size, const int batch_count)
+{
+	assert(batch_count > 0);
+	assert(column_idx_size > 0);
+	int i;
+	for (i = 0; i < column_idx_size; i++)
+		{ assert(column_idxs[i] >= 0 && column_idxs[i] < dataframe->columns->rnum); }
+	ccv_cnnp_dataframe_batching_t* const batching = (ccv_cnnp_dataframe_batching_t*)ccmalloc(sizeof(ccv_cnnp_dataframe_batching_t) + sizeof(int) * column_idx_size);
+	batching->dataframe = dataframe;
+	batching->batch_count = batch_count;
+	batching->column_idx_size = column_idx_size;
+	batching->column_idxs = (int*)(batching + 1);
+	memcpy(batching->column_idxs, column_idxs, sizeof(int) * column_idx_size);
+	pthread_mutex_init(&batching->mutex, 0);
+	batching->slots = ccv_array_new(sizeof(ccv_cnnp_dataframe_slot_t*), 1, 0);
+	const ccv_cnnp_column_data_t batching_column_data = {
+		.data_enum = _ccv_cnnp_batching_enum,
+		.data_deinit = _ccv_cnnp_batching_data_deinit,
+		.context = batching,
+		.context_deinit = _ccv_cnnp_batching_context_deinit,
+	};
+	return ccv_cnnp_dataframe_new(&batching_column_data, 1, dataframe->row_count / batch_count);
+}
+
+// Iterator
+
+struct ccv_cnnp_dataframe_iter_s {
+	ccv_cnnp_dataframe_t* dataframe;
+	int idx; // The next row to return.
+	int row_count;
+	int* row_idxs; // The order of rows when the cursor set.
+	int column_idx_size;
+	int* column_idxs;
+	int slot_size; // prefetch_count + 1, because the consumer holds one.
+	ccv_cnnp_dataframe_slot_t* slots;
+	// Prefetch.
+	int worker_size;
+	pthread_t* threads;
+	pthread_mutex_t mutex;
+	pthread_cond_t notify; // Signaled when the workers can move on.
+	pthread_cond_t ready; // Signaled when a row is ready.
+	int destroying;
+	int fetch; // The next row to be prefetched.
+	int busy; // Number of rows being prefetched.
+	int* slot_rows; // Which row the slot has ready, -1 if none.
+};
+
+static void _ccv_cnnp_dataframe_iter_fill(ccv_cnnp_dataframe_iter_t* const iter, ccv_cnnp_dataframe_slot_t* const slot, const int row_idx)
+{
+	_ccv_cnnp_dataframe_slot_move(slot, row_idx);
+	int i;
+	for (i = 0; i < iter->column_idx_size; i++)
+		_ccv_cnnp_dataframe_slot_column(iter->dataframe, slot, iter->column_idxs[i]);
+}
+
+static void* _ccv_cnnp_dataframe_iter_worker(void* const context)
+{
+	ccv_cnnp_dataframe_iter_t* const iter = (ccv_cnnp_dataframe_iter_t*)context;
+	pthread_mutex_lock(&iter->mutex);
+	for (;;)
+	{
+		// Only fill the slots the consumer doesn't hold.
+		while (!iter->destroying && (iter->fetch >= iter->row_count || iter->fetch >= iter->idx + iter->slot_size - 1))
+			pthread_cond_wait(&iter->notify, &iter->mutex);
+		if (iter->destroying)
+			break;
+		const int row = iter->fetch++;
+		const int slot_idx = row % iter->slot_size;
+		iter->slot_rows[slot_idx] = -1;
+		const int row_idx = iter->row_idxs[row];
+		++iter->busy;
+		pthread_mutex_unlock(&iter->mutex);
+		_ccv_cnnp_dataframe_iter_fill(iter, iter->slots + slot_idx, row_idx);
+		pthread_mutex_lock(&iter->mutex);
+		iter->slot_rows[slot_idx] = row;
+		--iter->busy;
+		pthread_cond_broadcast(&iter->ready);
+	}
+	pthread_mutex_unlock(&iter->mutex);
+	return 0;
+}
+
+static void _ccv_cnnp_dataframe_iter_reset_rows(ccv_cnnp_dataframe_iter_t* const iter)
+{
+	ccv_cnnp_dataframe_t* const dataframe = iter->dataframe;
+	int i;
+	if (dataframe->shuffled_idx)
+		memcpy(iter->row_idxs, dataframe->shuffled_idx, sizeof(int) * iter->row_count);
+	else
+		for (i = 0; i < iter->row_count; i++)
+			iter->row_idxs[i] = i;
+}
+
+ccv_cnnp_dataframe_iter_t* ccv_cnnp_dataframe_iter_new(ccv_cnnp_dataframe_t* const dataframe, const int* const column_idxs, const int column_idx_size)
+{
+	assert(column_idx_size > 0);
+	int i;
+	for (i = 0; i < column_idx_size; i++)
+		{ assert(column_idxs[i] >= 0 && column_idxs[i] < dataframe->columns->rnum); }
+	ccv_cnnp_dataframe_iter_t* const iter = (ccv_cnnp_dataframe_iter_t*)cccalloc(1, sizeof(ccv_cnnp_dataframe_iter_t) + sizeof(int) * (column_idx_size + dataframe->row_count));
+	iter->dataframe = dataframe;
+	iter->row_count = dataframe->row_count;
+	iter->column_idx_size = column_idx_size;
+	iter->column_idxs = (int*)(iter + 1);
+	memcpy(iter->column_idxs, column_idxs, sizeof(int) * column_idx_size);
+	iter->row_idxs = iter->column_idxs + column_idx_size;
+	_ccv_cnnp_dataframe_iter_reset_rows(iter);
+	iter->slot_size = 1;
+	iter->slots = (ccv_cnnp_dataframe_slot_t*)ccmalloc(sizeof(ccv_cnnp_dataframe_slot_t));
+	_ccv_cnnp_dataframe_slot_init(iter->slots, dataframe->columns->rnum);
+	return iter;
+}
+
+void ccv_cnnp_dataframe_iter_prefetch(ccv_cnnp_dataframe_iter_t* const iter, const int prefetch_count, const int worker_size)
+{
+	assert(!iter->worker_size); // Can only be called once.
+	assert(prefetch_count > 0);
+	assert(worker_size > 0);
+	int i;
+	iter->slots = (ccv_cnnp_dataframe_slot_t*)ccrealloc(iter->slots, sizeof(ccv_cnnp_dataframe_slot_t) * (prefetch_count + 1));
+	for (i = 1; i < prefetch_count + 1; i++)
+		_ccv_cnnp_dataframe_slot_init(iter->slots + i, iter->slots[0].column_size);
+	iter->slot_size = prefetch_count + 1;
+	iter->slot_rows = (int*)ccmalloc(sizeof(int) * iter->slot_size);
+	for (i = 0; i < iter->slot_size; i++)
+		iter->slot_rows[i] = -1;
+	iter->fetch = iter->idx;
+	iter->busy = 0;
+	iter->destroying = 0;
+	pthread_mutex_init(&iter->mutex, 0);
+	pthread_cond_init(&iter->notify, 0);
+	pthread_cond_init(&iter->ready, 0);
+	iter->worker_size = worker_size;
+	iter->threads = (pthread_t*)ccmalloc(sizeof(pthread_t) * worker_size);
+	for (i = 0; i < worker_size; i++)
+		pthread_create(iter->threads + i, 0, _ccv_cnnp_dataframe_iter_worker, iter);
+}
+
+int ccv_cnnp_dataframe_iter_next(ccv_cnnp_dataframe_iter_t* const iter, void** const data_ref, const int column_idx_size)
+{
+	assert(column_idx_size <= iter->column_idx_size);
+	if (iter->idx >= iter->row_count)
+		return -1;
+	const int row = iter->idx;
+	ccv_cnnp_dataframe_slot_t* const slot = iter->slots + (row % iter->slot_size);
+	if (iter->worker_size)
+	{
+		pthread_mutex_lock(&iter->mutex);
+		// Release the slot held from last time, thus, the workers can move on.
+		iter->idx = row + 1;
+		pthread_cond_broadcast(&iter->notify);
+		while (iter->slot_rows[row % iter->slot_size] != row)
+			pthread_cond_wait(&iter->ready, &iter->mutex);
+		pthread_mutex_unlock(&iter->mutex);
+	} else {
+		_ccv_cnnp_dataframe_iter_fill(iter, slot, iter->row_idxs[row]);
+		iter->idx = row + 1;
+	}
+	int i;
+	for (i = 0; i < column_idx_size; i++)
+		data_ref[i] = slot->data[iter->column_idxs[i]];
+	return 0;
+}
+
+void ccv_cnnp_dataframe_iter_set_cursor(ccv_cnnp_dataframe_iter_t* const iter, const int idx)
+{
+	assert(idx >= 0 && idx <= iter->row_count);
+	if (!iter->worker_size)
+	{
+		iter->idx = idx;
+		_ccv_cnnp_dataframe_iter_reset_rows(iter);
+		return;
+	}
+	int i;
+	pthread_mutex_lock(&iter->mutex);
+	// Stop the workers from fetching more, and wait for the rows in flight, the prefetched rows are discarded.
+	iter->fetch = iter->row_count;
+	while (iter->busy > 0)
+		pthread_cond_wait(&iter->ready, &iter->mutex);
+	for (i = 0; i < iter->slot_size; i++)
+		iter->slot_rows[i] = -1;
+	_ccv_cnnp_dataframe_iter_reset_rows(iter);
+	iter->idx = idx;
+	iter->fetch = idx;
+	pthread_cond_broadcast(&iter->notify);
+	pthread_mutex_unlock(&iter->mutex);
+}
+
+void ccv_cnnp_dataframe_iter_free(ccv_cnnp_dataframe_iter_t* const iter)
+{
+	int i;
+	if (iter->worker_size)
+	{
+		pthread_mutex_lock(&iter->mutex);
+		iter->destroying = 1;
+		pthread_cond_broadcast(&iter->notify);
+		pthread_mutex_unlock(&iter->mutex);
+		for (i = 0; i < iter->worker_size; i++)
+			pthread_join(iter->threads[i], 0);
+		ccfree(iter->threads);
+		ccfree(iter->slot_rows);
+		pthread_cond_destroy(&iter->ready);
+		pthread_cond_destroy(&iter->notify);
+		pthread_mutex_destroy(&iter->mutex);
+	}
+	for (i = 0; i < iter->slot_size; i++)
+		_ccv_cnnp_dataframe_slot_deinit(iter->dataframe, iter->slots + i);
+	ccfree(iter->slots);
+	ccfree(iter);
+}
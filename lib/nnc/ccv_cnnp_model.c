@@ -3,6 +3,8 @@
 #include "ccv_nnc_internal.h"
 #include "ccv_internal.h"
 #include "_ccv_cnnp_model.h"
+#include <pthread.h>
+#include <unistd.h>
 
 static const ccv_cnnp_model_vtab_t ccv_cnnp_input_isa;
 
@@ -52,10 +54,19 @@ static void _ccv_cnnp_sequential_model_add_to_trainable(ccv_cnnp_model_t* const
 		ccv_cnnp_model_add_to_trainable(self->sequence[i], trainables);
 }
 
+static void _ccv_cnnp_sequential_model_init_states(ccv_cnnp_model_t* const super, ccv_nnc_symbolic_graph_t* const graph, const ccv_cnnp_state_initializer_f initializer, void* const context)
+{
+	ccv_cnnp_sequential_model_t* const self = (ccv_cnnp_sequential_model_t*)super;
+	int i;
+	for (i = 0; i < self->sequence_size; i++)
+		ccv_cnnp_model_init_states(self->sequence[i], graph, initializer, context);
+}
+
 static const ccv_cnnp_model_vtab_t ccv_cnnp_sequential_model_isa = {
 	.deinit = _ccv_cnnp_sequential_model_deinit,
 	.build = _ccv_cnnp_sequential_model_build,
 	.add_to_trainable = _ccv_cnnp_sequential_model_add_to_trainable,
+	.init_states = _ccv_cnnp_sequential_model_init_states,
 };
 
 ccv_cnnp_model_t* ccv_cnnp_sequential_new(ccv_cnnp_model_t* const* const models, const int model_size)
@@ -129,10 +140,19 @@ static void _ccv_cnnp_functional_model_add_to_trainable(ccv_cnnp_model_t* const
 		ccv_cnnp_model_add_to_trainable(self->sequence[i]->model, trainables);
 }
 
+static void _ccv_cnnp_functional_model_init_states(ccv_cnnp_model_t* const super, ccv_nnc_symbolic_graph_t* const graph, const ccv_cnnp_state_initializer_f initializer, void* const context)
+{
+	ccv_cnnp_functional_model_t* const self = (ccv_cnnp_functional_model_t*)super;
+	int i;
+	for (i = self->super.input_size; i < self->sequence_size; i++)
+		ccv_cnnp_model_init_states(self->sequence[i]->model, graph, initializer, context);
+}
+
 static const ccv_cnnp_model_vtab_t ccv_cnnp_functional_model_isa = {
 	.deinit = _ccv_cnnp_functional_model_deinit,
 	.build = _ccv_cnnp_functional_model_build,
 	.add_to_trainable = _ccv_cnnp_functional_model_add_to_trainable,
+	.init_states = _ccv_cnnp_functional_model_init_states,
 };
 
 #define CCV_CNNP_IS_MODEL_INPUT(x) ((x)->isa == &ccv_cnnp_input_isa)
@@ -211,29 +231,448 @@ ccv_cnnp_model_io_t ccv_cnnp_model_apply(ccv_cnnp_model_t* const model, const cc
 	return model->io;
 }
 
-void ccv_cnnp_model_compile(ccv_cnnp_model_t* const model, const ccv_nnc_tensor_param_t* const inputs, const int input_size)
+typedef struct {
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+} ccv_cnnp_model_replica_t;
+
+typedef struct {
+	ccv_cnnp_model_t* model;
+	int idx; // Which replica this worker runs.
+} ccv_cnnp_model_worker_t;
+
+typedef void (*ccv_cnnp_model_task_f)(ccv_cnnp_model_t* const model, const int idx);
+
+struct ccv_cnnp_compiled_data_s {
+	int parallel_count; // How many replicas the minibatch is split into.
+	int trainable_size;
+	int saved_aux_size; // The number of saved aux per trainable.
+	int backward_exec_size;
+	ccv_nnc_cmd_t minimizer;
+	ccv_nnc_cmd_t loss;
+	ccv_nnc_tensor_symbol_t* trainables;
+	ccv_nnc_tensor_symbol_t* updated_trainables;
+	ccv_nnc_tensor_symbol_map_t* saved_aux;
+	ccv_nnc_graph_exec_symbol_t* update_execs;
+	ccv_nnc_graph_exec_symbol_t* backward_execs; // The execs that compute the gradients of the trainables.
+	// Below are available after the first fit.
+	ccv_nnc_tensor_t** trainable_tensors; // Shared by all replicas, updated in place by the minimizer.
+	ccv_nnc_tensor_t** saved_aux_tensors;
+	ccv_nnc_tensor_t** gradients; // The gradients of the trainables, parallel_count x trainable_size.
+	ccv_nnc_graph_exec_t* backward_exec; // The backward execs of the first replica.
+	ccv_nnc_graph_exec_t* update_exec; // The minimizer execs of the first replica.
+	ccv_cnnp_model_replica_t* replicas;
+	// The first replica runs on the caller thread, the others run on these workers.
+	pthread_t* threads;
+	ccv_cnnp_model_worker_t* workers;
+	pthread_mutex_t mutex;
+	pthread_cond_t notify; // Signaled when there is a new task or the workers should exit.
+	pthread_cond_t done; // Signaled when all workers finished the task.
+	ccv_cnnp_model_task_f task;
+	int generation; // Bumped for each new task.
+	int pending;
+	int exit;
+	ccv_nnc_tensor_symbol_t* losses;
+	ccv_nnc_tensor_symbol_t fits[1];
+};
+
+static int _ccv_cnnp_model_parallel_count(const ccv_cnnp_model_t* const model, const ccv_nnc_tensor_param_t* const inputs, const int input_size)
+{
+	// Only split the minibatch if all inputs are CPU tensors batched along the first dimension with the same batch size.
+	int i;
+	int batch_size = 0;
+	for (i = 0; i < input_size; i++)
+	{
+		const int nd = ccv_nnc_tensor_nd(inputs[i].dim);
+		if (CCV_TENSOR_GET_MEMORY(inputs[i].type) != CCV_TENSOR_CPU_MEMORY || inputs[i].format == CCV_TENSOR_FORMAT_CHWN || nd < 2 || nd == CCV_NNC_MAX_DIM + 1)
+			return 1;
+		const int n = ccv_nnc_tensor_get_n(inputs[i]);
+		if (batch_size > 0 && n != batch_size)
+			return 1;
+		batch_size = n;
+	}
+	if (batch_size <= 1)
+		return 1;
+	int parallel = model->parallel > 0 ? model->parallel : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	parallel = ccv_min(ccv_max(parallel, 1), batch_size);
+	while (batch_size % parallel != 0)
+		--parallel;
+	return parallel;
+}
+
+static int _ccv_cnnp_minimizer_saved_aux_size(const ccv_nnc_cmd_t minimizer)
+{
+	// Probe the same way as ccv_nnc_symbolic_graph_minimize does.
+	int i;
+	uint64_t input_bitmask = 0x1;
+	uint64_t output_bitmask = 0x0;
+	for (i = 0; i < 62; i++)
+	{
+		input_bitmask |= ((uint64_t)1 << (i + 1));
+		output_bitmask |= ((uint64_t)1 << i);
+		if (ccv_nnc_cmd_bitmask(minimizer, i + 2, i + 1, &input_bitmask, 1, &output_bitmask, 1))
+			return i;
+	}
+	assert(0 && "the minimizer doesn't accept (gradient, x, aux...) as inputs");
+	return 0;
+}
+
+void ccv_cnnp_model_set_parallel(ccv_cnnp_model_t* const model, const int parallel)
+{
+	assert(!model->graph); // The graph is built for the pieces of the minibatch, it cannot be changed after compile.
+	model->parallel = parallel;
+}
+
+void ccv_cnnp_model_compile(ccv_cnnp_model_t* const model, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_cmd_t minimizer, const ccv_nnc_cmd_t loss)
 {
 	assert(input_size == model->input_size);
 	if (!model->graph) // The graph is not compiled yet.
 	{
+		const int parallel_count = _ccv_cnnp_model_parallel_count(model, inputs, input_size);
 		model->graph = ccv_nnc_symbolic_graph_new();
 		model->inputs = ccmalloc(sizeof(ccv_nnc_tensor_symbol_t) * input_size);
-		int i;
+		int i, j;
 		for (i = 0; i < input_size; i++)
-			model->inputs[i] = ccv_nnc_tensor_symbol_new(model->graph, inputs[i], 0);
+		{
+			// The graph is built for one replica, which works on its own piece of the minibatch.
+			ccv_nnc_tensor_param_t params = inputs[i];
+			if (parallel_count > 1)
+				ccv_nnc_tensor_set_n(&params, ccv_nnc_tensor_get_n(params) / parallel_count);
+			model->inputs[i] = ccv_nnc_tensor_symbol_new(model->graph, params, 0);
+		}
 		ccv_cnnp_model_build(model, model->graph, model->inputs, input_size, 0, 0);
+		const int output_size = model->output_size;
+		ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data = cccalloc(1, sizeof(ccv_cnnp_compiled_data_t) + sizeof(ccv_nnc_tensor_symbol_t) * (output_size * 2 - 1));
+		compiled_data->parallel_count = parallel_count;
+		compiled_data->minimizer = minimizer;
+		compiled_data->loss = loss;
+		compiled_data->losses = compiled_data->fits + output_size;
+		for (i = 0; i < output_size; i++)
+		{
+			const ccv_nnc_tensor_param_t output_params = ccv_nnc_tensor_symbol_params(model->graph, model->outputs[i]);
+			compiled_data->fits[i] = ccv_nnc_tensor_symbol_new(model->graph, output_params, 0);
+			ccv_nnc_tensor_param_t loss_params;
+			ccv_nnc_hint_tensor_auto(loss, (ccv_nnc_tensor_param_t []){
+					output_params,
+					output_params,
+				}, 2, ccv_nnc_no_hint, &loss_params, 1);
+			compiled_data->losses[i] = ccv_nnc_tensor_symbol_new(model->graph, loss_params, 0);
+			ccv_nnc_graph_exec_symbol_new(model->graph, loss, TENSOR_SYMBOL_LIST(model->outputs[i], compiled_data->fits[i]), TENSOR_SYMBOL_LIST(compiled_data->losses[i]), 0);
+		}
 		ccv_nnc_graph_exec_symbol_autogen(model->graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+		ccv_nnc_tensor_symbol_t simplify_outputs[output_size * 2];
+		memcpy(simplify_outputs, model->outputs, sizeof(ccv_nnc_tensor_symbol_t) * output_size);
+		memcpy(simplify_outputs + output_size, compiled_data->losses, sizeof(ccv_nnc_tensor_symbol_t) * output_size);
 		ccv_nnc_symbolic_graph_simplify(model->graph,
 			SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_COMMON_SUBEXPRESSION_ELIMINATION,
 				CCV_NNC_SIMPLIFY_DATA_TRANSFER_OPT,
 				CCV_NNC_SIMPLIFY_GRAPH_PRUNING),
-			model->outputs, model->output_size,
+			simplify_outputs, output_size * 2,
 			SYMBOLIC_GRAPH_SOURCES(model->graph), SYMBOLIC_GRAPH_DESTINATIONS(model->graph));
+		ccv_array_t* const trainables = ccv_array_new(sizeof(ccv_nnc_tensor_symbol_t), 0, 0);
+		ccv_cnnp_model_add_to_trainable(model, trainables);
+		const int trainable_size = compiled_data->trainable_size = trainables->rnum;
+		if (trainable_size > 0)
+		{
+			const int saved_aux_size = compiled_data->saved_aux_size = _ccv_cnnp_minimizer_saved_aux_size(minimizer);
+			compiled_data->trainables = (ccv_nnc_tensor_symbol_t*)ccmalloc((sizeof(ccv_nnc_tensor_symbol_t) * 2 + sizeof(ccv_nnc_tensor_symbol_map_t) * saved_aux_size + sizeof(ccv_nnc_graph_exec_symbol_t) * 2) * trainable_size);
+			compiled_data->updated_trainables = compiled_data->trainables + trainable_size;
+			compiled_data->saved_aux = (ccv_nnc_tensor_symbol_map_t*)(compiled_data->updated_trainables + trainable_size);
+			compiled_data->update_execs = (ccv_nnc_graph_exec_symbol_t*)(compiled_data->saved_aux + saved_aux_size * trainable_size);
+			compiled_data->backward_execs = compiled_data->update_execs + trainable_size;
+			memcpy(compiled_data->trainables, ccv_array_get(trainables, 0), sizeof(ccv_nnc_tensor_symbol_t) * trainable_size);
+			ccv_nnc_symbolic_graph_minimize(model->graph, minimizer, compiled_data->losses, output_size, compiled_data->trainables, trainable_size, SYMBOLIC_GRAPH_SOURCES(model->graph), SYMBOLIC_GRAPH_DESTINATIONS(model->graph), compiled_data->updated_trainables, compiled_data->saved_aux, compiled_data->update_execs);
+			// One exec can compute the gradients of several trainables (the weights and the bias), only keep one of it.
+			for (i = 0; i < trainable_size; i++)
+			{
+				const ccv_nnc_graph_exec_symbol_t backward_exec = ccv_nnc_graph_exec_symbol_for_backward(model->graph, ccv_nnc_tensor_symbol_for_backward(model->graph, compiled_data->trainables[i]));
+				for (j = 0; j < compiled_data->backward_exec_size; j++)
+					if (compiled_data->backward_execs[j].d == backward_exec.d)
+						break;
+				if (j == compiled_data->backward_exec_size)
+					compiled_data->backward_execs[compiled_data->backward_exec_size++] = backward_exec;
+			}
+			ccv_nnc_graph_exec_symbol_autogen(model->graph, 0, 0, CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+		}
+		ccv_array_free(trainables);
 	}
 }
 
-void ccv_cnnp_model_fit(ccv_cnnp_model_t* const model, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size)
+static void _ccv_cnnp_model_init_state(void* const context, const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, const ccv_nnc_tensor_symbol_t symbol)
 {
+	ccv_cnnp_compiled_data_t* const compiled_data = (ccv_cnnp_compiled_data_t*)context;
+	int i;
+	for (i = 0; i < compiled_data->trainable_size; i++)
+		if (compiled_data->trainables[i].d == symbol.d)
+		{
+			ccv_nnc_cmd_exec(cmd, hint, flags, 0, 0, compiled_data->trainable_tensors + i, 1, 0);
+			break;
+		}
+}
+
+static void* _ccv_cnnp_model_worker_main(void* const userdata)
+{
+	ccv_cnnp_model_worker_t* const worker = (ccv_cnnp_model_worker_t*)userdata;
+	ccv_cnnp_compiled_data_t* const compiled_data = worker->model->compiled_data;
+	int generation = 0;
+	pthread_mutex_lock(&compiled_data->mutex);
+	for (;;)
+	{
+		while (!compiled_data->exit && compiled_data->generation == generation)
+			pthread_cond_wait(&compiled_data->notify, &compiled_data->mutex);
+		if (compiled_data->exit)
+			break;
+		generation = compiled_data->generation;
+		const ccv_cnnp_model_task_f task = compiled_data->task;
+		pthread_mutex_unlock(&compiled_data->mutex);
+		task(worker->model, worker->idx);
+		pthread_mutex_lock(&compiled_data->mutex);
+		if (--compiled_data->pending == 0)
+			pthread_cond_signal(&compiled_data->done);
+	}
+	pthread_mutex_unlock(&compiled_data->mutex);
+	return 0;
+}
+
+// Run the task for each replica, the first one on the caller thread, and wait for all of them.
+static void _ccv_cnnp_model_parallel_run(ccv_cnnp_model_t* const model, const ccv_cnnp_model_task_f task)
+{
+	ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	if (compiled_data->parallel_count > 1)
+	{
+		pthread_mutex_lock(&compiled_data->mutex);
+		compiled_data->task = task;
+		compiled_data->pending = compiled_data->parallel_count - 1;
+		++compiled_data->generation;
+		pthread_cond_broadcast(&compiled_data->notify);
+		pthread_mutex_unlock(&compiled_data->mutex);
+	}
+	task(model, 0);
+	if (compiled_data->parallel_count > 1)
+	{
+		pthread_mutex_lock(&compiled_data->mutex);
+		while (compiled_data->pending > 0)
+			pthread_cond_wait(&compiled_data->done, &compiled_data->mutex);
+		pthread_mutex_unlock(&compiled_data->mutex);
+	}
+}
+
+static void _ccv_cnnp_model_jit(ccv_cnnp_model_t* const model)
+{
+	ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	const int parallel_count = compiled_data->parallel_count;
+	const int trainable_size = compiled_data->trainable_size;
+	const int saved_aux_size = trainable_size * compiled_data->saved_aux_size;
+	const int output_size = model->output_size;
+	int i, j;
+	compiled_data->trainable_tensors = (ccv_nnc_tensor_t**)ccmalloc(sizeof(ccv_nnc_tensor_t*) * (trainable_size + saved_aux_size + trainable_size * parallel_count));
+	compiled_data->saved_aux_tensors = compiled_data->trainable_tensors + trainable_size;
+	compiled_data->gradients = compiled_data->saved_aux_tensors + saved_aux_size;
+	for (i = 0; i < trainable_size; i++)
+		compiled_data->trainable_tensors[i] = ccv_nnc_tensor_new(0, ccv_nnc_tensor_symbol_params(model->graph, compiled_data->trainables[i]), 0);
+	for (i = 0; i < saved_aux_size; i++)
+	{
+		compiled_data->saved_aux_tensors[i] = ccv_nnc_tensor_new(0, ccv_nnc_tensor_symbol_params(model->graph, compiled_data->saved_aux[i].source), 0);
+		ccv_nnc_cmd_exec(CMD_SET_FORWARD(0), ccv_nnc_no_hint, 0, 0, 0, compiled_data->saved_aux_tensors + i, 1, 0);
+	}
+	ccv_cnnp_model_init_states(model, model->graph, _ccv_cnnp_model_init_state, compiled_data);
+	// The trainables and the saved aux are bound to the shared tensors. The updated trainables and the saved aux
+	// destinations are bound to the same tensors, thus, the minimizer updates them in place.
+	const int tensor_bind_size = trainable_size * 2 + saved_aux_size * 2;
+	ccv_nnc_tensor_bind_t tensor_binds[ccv_max(1, tensor_bind_size)];
+	for (i = 0; i < trainable_size; i++)
+	{
+		tensor_binds[i].symbol = compiled_data->trainables[i];
+		tensor_binds[i].tensor = compiled_data->trainable_tensors[i];
+		tensor_binds[trainable_size + i].symbol = compiled_data->updated_trainables[i];
+		tensor_binds[trainable_size + i].tensor = compiled_data->trainable_tensors[i];
+	}
+	for (i = 0; i < saved_aux_size; i++)
+	{
+		tensor_binds[trainable_size * 2 + i * 2].symbol = compiled_data->saved_aux[i].source;
+		tensor_binds[trainable_size * 2 + i * 2].tensor = compiled_data->saved_aux_tensors[i];
+		tensor_binds[trainable_size * 2 + i * 2 + 1].symbol = compiled_data->saved_aux[i].destination;
+		tensor_binds[trainable_size * 2 + i * 2 + 1].tensor = compiled_data->saved_aux_tensors[i];
+	}
+	// Keep the outputs, the losses and the gradients after the run.
+	ccv_nnc_tensor_symbol_t outputs[output_size * 2 + trainable_size];
+	memcpy(outputs, model->outputs, sizeof(ccv_nnc_tensor_symbol_t) * output_size);
+	memcpy(outputs + output_size, compiled_data->losses, sizeof(ccv_nnc_tensor_symbol_t) * output_size);
+	for (i = 0; i < trainable_size; i++)
+		outputs[output_size * 2 + i] = ccv_nnc_tensor_symbol_for_backward(model->graph, compiled_data->trainables[i]);
+	compiled_data->replicas = (ccv_cnnp_model_replica_t*)ccmalloc(sizeof(ccv_cnnp_model_replica_t) * parallel_count);
+	for (i = 0; i < parallel_count; i++)
+	{
+		ccv_cnnp_model_replica_t* const replica = compiled_data->replicas + i;
+		// Only the first replica runs the minimizer, the others stop at the gradients.
+		if (i == 0 || trainable_size == 0)
+			ccv_nnc_symbolic_graph_compile(model->graph, tensor_binds, tensor_bind_size, outputs, output_size * 2 + trainable_size, SYMBOLIC_GRAPH_SOURCES(model->graph), SYMBOLIC_GRAPH_DESTINATIONS(model->graph), &replica->graph, &replica->tensor_arena, &replica->graph_exec_arena);
+		else
+			ccv_nnc_symbolic_graph_compile(model->graph, tensor_binds, trainable_size, outputs, output_size * 2 + trainable_size, SYMBOLIC_GRAPH_SOURCES(model->graph), compiled_data->backward_execs, compiled_data->backward_exec_size, &replica->graph, &replica->tensor_arena, &replica->graph_exec_arena);
+		for (j = 0; j < trainable_size; j++)
+			compiled_data->gradients[i * trainable_size + j] = ccv_nnc_tensor_from_symbol(replica->tensor_arena, outputs[output_size * 2 + j]);
+	}
+	if (trainable_size > 0)
+	{
+		compiled_data->backward_exec = (ccv_nnc_graph_exec_t*)ccmalloc(sizeof(ccv_nnc_graph_exec_t) * (compiled_data->backward_exec_size + trainable_size));
+		compiled_data->update_exec = compiled_data->backward_exec + compiled_data->backward_exec_size;
+		for (i = 0; i < compiled_data->backward_exec_size; i++)
+			compiled_data->backward_exec[i] = ccv_nnc_graph_exec_from_symbol(compiled_data->replicas[0].graph_exec_arena, compiled_data->backward_execs[i]);
+		for (i = 0; i < trainable_size; i++)
+			compiled_data->update_exec[i] = ccv_nnc_graph_exec_from_symbol(compiled_data->replicas[0].graph_exec_arena, compiled_data->update_execs[i]);
+	}
+	if (parallel_count > 1)
+	{
+		pthread_mutex_init(&compiled_data->mutex, 0);
+		pthread_cond_init(&compiled_data->notify, 0);
+		pthread_cond_init(&compiled_data->done, 0);
+		compiled_data->threads = (pthread_t*)ccmalloc((sizeof(pthread_t) + sizeof(ccv_cnnp_model_worker_t)) * (parallel_count - 1));
+		compiled_data->workers = (ccv_cnnp_model_worker_t*)(compiled_data->threads + parallel_count - 1);
+		for (i = 0; i < parallel_count - 1; i++)
+		{
+			compiled_data->workers[i].model = model;
+			compiled_data->workers[i].idx = i + 1;
+			pthread_create(compiled_data->threads + i, 0, _ccv_cnnp_model_worker_main, compiled_data->workers + i);
+		}
+	}
+}
+
+static void _ccv_cnnp_compiled_data_free(ccv_cnnp_compiled_data_t* const compiled_data)
+{
+	int i;
+	if (compiled_data->threads)
+	{
+		pthread_mutex_lock(&compiled_data->mutex);
+		compiled_data->exit = 1;
+		pthread_cond_broadcast(&compiled_data->notify);
+		pthread_mutex_unlock(&compiled_data->mutex);
+		for (i = 0; i < compiled_data->parallel_count - 1; i++)
+			pthread_join(compiled_data->threads[i], 0);
+		pthread_cond_destroy(&compiled_data->done);
+		pthread_cond_destroy(&compiled_data->notify);
+		pthread_mutex_destroy(&compiled_data->mutex);
+		ccfree(compiled_data->threads);
+	}
+	if (compiled_data->replicas)
+	{
+		for (i = 0; i < compiled_data->parallel_count; i++)
+		{
+			ccv_nnc_graph_free(compiled_data->replicas[i].graph);
+			ccv_nnc_tensor_arena_free(compiled_data->replicas[i].tensor_arena);
+			ccv_nnc_graph_exec_arena_free(compiled_data->replicas[i].graph_exec_arena);
+		}
+		ccfree(compiled_data->replicas);
+	}
+	if (compiled_data->trainable_tensors)
+	{
+		for (i = 0; i < compiled_data->trainable_size * (1 + compiled_data->saved_aux_size); i++)
+			ccv_nnc_tensor_free(compiled_data->trainable_tensors[i]);
+		ccfree(compiled_data->trainable_tensors);
+	}
+	if (compiled_data->backward_exec)
+		ccfree(compiled_data->backward_exec);
+	if (compiled_data->trainables)
+		ccfree(compiled_data->trainables);
+	ccfree(compiled_data);
+}
+
+// Copy the idx-th piece of the minibatch between the tensor of the whole minibatch and the tensor of one replica.
+static void _ccv_cnnp_model_copy_piece(ccv_nnc_tensor_t* const batch, ccv_nnc_tensor_t* const piece, const int idx, const int to_piece)
+{
+	assert(!CCV_IS_TENSOR_VIEW(batch) && !CCV_IS_TENSOR_VIEW(piece));
+	assert(CCV_TENSOR_GET_MEMORY(batch->info.type) == CCV_TENSOR_CPU_MEMORY);
+	assert(batch->info.datatype == piece->info.datatype);
+	const size_t size = (size_t)ccv_nnc_tensor_count(piece->info) * CCV_GET_DATA_TYPE_SIZE(piece->info.datatype);
+	assert((size_t)ccv_nnc_tensor_count(batch->info) * CCV_GET_DATA_TYPE_SIZE(batch->info.datatype) >= size * (idx + 1));
+	if (to_piece)
+		memcpy(piece->data.u8, batch->data.u8 + size * idx, size);
+	else
+		memcpy(batch->data.u8 + size * idx, piece->data.u8, size);
+}
+
+static void _ccv_cnnp_model_replica_backward(ccv_cnnp_model_t* const model, const int idx)
+{
+	ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	ccv_cnnp_model_replica_t* const replica = compiled_data->replicas + idx;
+	int i;
+	if (compiled_data->trainable_size == 0)
+	{
+		ccv_nnc_graph_run(replica->graph, 0, 0, TRAVERSE_FULL);
+		return;
+	}
+	for (i = 0; i < model->output_size; i++)
+	{
+		// Average the loss over the whole minibatch, thus, the gradients from the replicas can simply be summed.
+		ccv_nnc_tensor_t* const df = ccv_nnc_tensor_from_symbol(replica->tensor_arena, ccv_nnc_tensor_symbol_for_backward(model->graph, compiled_data->losses[i]));
+		ccv_nnc_cmd_exec(CMD_SET_FORWARD(1.0 / (ccv_nnc_tensor_count(df->info) * compiled_data->parallel_count)), ccv_nnc_no_hint, 0, 0, 0, &df, 1, 0);
+	}
+	if (idx == 0) // Stop before the minimizer, it runs after the gradients are summed.
+		ccv_nnc_graph_run(replica->graph, 0, 0, 0, 0, compiled_data->backward_exec, compiled_data->backward_exec_size);
+	else
+		ccv_nnc_graph_run(replica->graph, 0, 0, TRAVERSE_FULL);
+}
+
+static void _ccv_cnnp_model_reduce_gradients(ccv_cnnp_model_t* const model, const int idx)
+{
+	ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	const int parallel_count = compiled_data->parallel_count;
+	const int trainable_size = compiled_data->trainable_size;
+	ccv_nnc_tensor_t* gradients[parallel_count];
+	int i, j;
+	// Each thread sums the gradients of a different set of trainables into the first replica.
+	for (i = idx; i < trainable_size; i += parallel_count)
+	{
+		for (j = 0; j < parallel_count; j++)
+			gradients[j] = compiled_data->gradients[j * trainable_size + i];
+		ccv_nnc_cmd_exec(CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, 0, gradients, parallel_count, gradients, 1, 0);
+	}
+}
+
+void ccv_cnnp_model_fit(ccv_cnnp_model_t* const model, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const fits, const int fit_size, ccv_nnc_tensor_t* const* const outputs, const int output_size)
+{
+	ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	assert(compiled_data); // The model has to be compiled first.
+	assert(input_size == model->input_size);
+	assert(fit_size == model->output_size);
+	assert(output_size == 0 || output_size == model->output_size);
+	if (!compiled_data->replicas)
+		_ccv_cnnp_model_jit(model);
+	const int parallel_count = compiled_data->parallel_count;
+	int i, j;
+	for (i = 0; i < parallel_count; i++)
+	{
+		ccv_nnc_tensor_arena_t* const tensor_arena = compiled_data->replicas[i].tensor_arena;
+		for (j = 0; j < input_size; j++)
+			_ccv_cnnp_model_copy_piece(inputs[j], ccv_nnc_tensor_from_symbol(tensor_arena, model->inputs[j]), i, 1);
+		for (j = 0; j < fit_size; j++)
+			_ccv_cnnp_model_copy_piece(fits[j], ccv_nnc_tensor_from_symbol(tensor_arena, compiled_data->fits[j]), i, 1);
+	}
+	_ccv_cnnp_model_parallel_run(model, _ccv_cnnp_model_replica_backward);
+	const int trainable_size = compiled_data->trainable_size;
+	if (trainable_size > 0)
+	{
+		if (parallel_count > 1)
+			_ccv_cnnp_model_parallel_run(model, _ccv_cnnp_model_reduce_gradients);
+		ccv_nnc_graph_run(compiled_data->replicas[0].graph, 0, 0, compiled_data->update_exec, trainable_size, compiled_data->update_exec, trainable_size);
+	}
+	for (i = 0; i < parallel_count; i++)
+		for (j = 0; j < output_size; j++)
+			_ccv_cnnp_model_copy_piece(outputs[j], ccv_nnc_tensor_from_symbol(compiled_data->replicas[i].tensor_arena, model->outputs[j]), i, 0);
+}
+
+void ccv_cnnp_model_set_minimizer(ccv_cnnp_model_t* const model, const ccv_nnc_cmd_t minimizer)
+{
+	ccv_cnnp_compiled_data_t* const compiled_data = model->compiled_data;
+	assert(compiled_data);
+	assert(minimizer.cmd == compiled_data->minimizer.cmd);
+	compiled_data->minimizer = minimizer;
+	int i;
+	for (i = 0; i < compiled_data->trainable_size; i++)
+		if (compiled_data->update_exec) // The graph is compiled already.
+			ccv_nnc_graph_exec_set(compiled_data->replicas[0].graph, compiled_data->update_exec[i], minimizer);
+		else
+			ccv_nnc_graph_exec_symbol_set(model->graph, compiled_data->update_execs[i], minimizer);
 }
 
 void ccv_cnnp_model_dot(const ccv_cnnp_model_t* const model, const int flags, FILE* out)
@@ -270,6 +709,8 @@ void ccv_cnnp_model_free(ccv_cnnp_model_t* const model)
 			ccv_array_free(model->io->incomings);
 		ccfree(model->io);
 	}
+	if (model->compiled_data)
+		_ccv_cnnp_compiled_data_free(model->compiled_data);
 	if (model->inputs)
 		ccfree(model->inputs);
 	if (model->graph)
@@ -180,8 +180,30 @@ static void _ccv_cnnp_convolution_build(ccv_cnnp_model_t* const super, ccv_nnc_s
 		outputs[0] = convolution_output;
 }
 
+static void _ccv_cnnp_convolution_init_states(ccv_cnnp_model_t* const super, ccv_nnc_symbolic_graph_t* const graph, const ccv_cnnp_state_initializer_f initializer, void* const context)
+{
+	ccv_cnnp_model_convolution_t* const self = (ccv_cnnp_model_convolution_t*)super;
+	const ccv_nnc_tensor_param_t weights_params = ccv_nnc_tensor_symbol_params(graph, self->weights);
+	const int n = ccv_max(ccv_nnc_tensor_get_n(weights_params), 1);
+	const int count = ccv_nnc_tensor_count(weights_params);
+	// He initialization, with the fan-in being the size of one filter.
+	const float std = sqrtf(2) / sqrtf(count / n);
+	const float bound = sqrtf(3) * std;
+	initializer(context, CMD_RANDOM_UNIFORM_FORWARD(-bound, bound), ccv_nnc_no_hint, 0, self->weights);
+	initializer(context, CMD_SET_FORWARD(0), ccv_nnc_no_hint, 0, self->bias);
+}
+
+static void _ccv_cnnp_convolution_add_to_trainable(ccv_cnnp_model_t* const super, ccv_array_t* const trainables)
+{
+	ccv_cnnp_model_convolution_t* const self = (ccv_cnnp_model_convolution_t*)super;
+	ccv_array_push(trainables, &self->weights);
+	ccv_array_push(trainables, &self->bias);
+}
+
 static const ccv_cnnp_model_vtab_t ccv_cnnp_convolution_isa = {
 	.build = _ccv_cnnp_convolution_build,
+	.init_states = _ccv_cnnp_convolution_init_states,
+	.add_to_trainable = _ccv_cnnp_convolution_add_to_trainable,
 };
 
 ccv_cnnp_model_t* ccv_cnnp_convolution(const int groups, const int filters, const int kdim[CCV_NNC_MAX_DIM_ALLOC], const ccv_cnnp_param_t params)
@@ -253,8 +275,28 @@ static void _ccv_cnnp_dense_build(ccv_cnnp_model_t* const super, ccv_nnc_symboli
 		outputs[0] = dense_output;
 }
 
+static void _ccv_cnnp_dense_init_states(ccv_cnnp_model_t* const super, ccv_nnc_symbolic_graph_t* const graph, const ccv_cnnp_state_initializer_f initializer, void* const context)
+{
+	ccv_cnnp_model_dense_t* const self = (ccv_cnnp_model_dense_t*)super;
+	const ccv_nnc_tensor_param_t weights_params = ccv_nnc_tensor_symbol_params(graph, self->weights);
+	// He initialization, with the fan-in being the input channels.
+	const float std = sqrtf(2) / sqrtf(weights_params.dim[1]);
+	const float bound = sqrtf(3) * std;
+	initializer(context, CMD_RANDOM_UNIFORM_FORWARD(-bound, bound), ccv_nnc_no_hint, 0, self->weights);
+	initializer(context, CMD_SET_FORWARD(0), ccv_nnc_no_hint, 0, self->bias);
+}
+
+static void _ccv_cnnp_dense_add_to_trainable(ccv_cnnp_model_t* const super, ccv_array_t* const trainables)
+{
+	ccv_cnnp_model_dense_t* const self = (ccv_cnnp_model_dense_t*)super;
+	ccv_array_push(trainables, &self->weights);
+	ccv_array_push(trainables, &self->bias);
+}
+
 static const ccv_cnnp_model_vtab_t ccv_cnnp_dense_isa = {
 	.build = _ccv_cnnp_dense_build,
+	.init_states = _ccv_cnnp_dense_init_states,
+	.add_to_trainable = _ccv_cnnp_dense_add_to_trainable,
 };
 
 ccv_cnnp_model_t* ccv_cnnp_dense(const int count, const ccv_cnnp_param_t params)
@@ -44,6 +44,7 @@ typedef struct {
 		struct {
 			int count; /**< [convolution.count] The number of filters for convolutional layer. */
 			int groups; /**< [convolution.groups] The number of groups for convolutional layer. */
+			int relu; /**< [convolution.relu] Whether to apply ReLU to the output, set by CCV_NNC_SIMPLIFY_OPS_FUSION and only honored by the CPU backends. */
 		} convolution;
 		struct {
 			int reserved;
@@ -69,6 +70,7 @@ typedef struct {
 		struct {
 			float a[3]; /**< [blas.a[3]] BLAS scalars. */
 			int count; /**< [blas.count] The number of outputs for blas layer. */
+			int relu; /**< [blas.relu] Whether to apply ReLU to the output of GEMM, set by CCV_NNC_SIMPLIFY_OPS_FUSION and only honored by the CPU backends. */
 		} blas;
 		struct {
 			int axis[CCV_NNC_MAX_DIM_ALLOC]; /**< [reduce.axis[]] The axis selected to reduce. */
@@ -77,6 +79,14 @@ typedef struct {
 		struct {
 			float p; /**< [dropout.p] Dropout probability. */
 		} dropout;
+		struct {
+			int count; /**< [ewchain.count] The number of element-wise commands in the chain. */
+			uint32_t cmds[CCV_NNC_MAX_DIM_ALLOC]; /**< [ewchain.cmds[]] The element-wise commands to apply in order, each takes the result so far, and the next input if it is binary. */
+			float a[CCV_NNC_MAX_DIM_ALLOC]; /**< [ewchain.a[]] The scalar for CCV_NNC_SCALAR_MUL_FORWARD in the chain. */
+		} ewchain;
+		struct {
+			int per_channel; /**< [quantize.per_channel] Whether to compute a symmetric scale for each slice along the first dimension (weights) rather than an asymmetric scale / zero point for the whole tensor (activations). */
+		} quantize;
 		void* userdata;
 	};
 } ccv_nnc_cmd_param_t;
@@ -143,6 +153,9 @@ void ccv_nnc_tensor_view_free(ccv_nnc_tensor_view_t* const tensor_view);
 // All these functions afterwards should be compatible with both tensor and tensor view unless assertion.
 void ccv_nnc_tensor_zero(void* const tensor);
 CCV_WARN_UNUSED(int) ccv_nnc_tensor_eq(const ccv_nnc_tensor_t* const a, const ccv_nnc_tensor_t* const b);
+// Drop what kernels cached from tensors flagged CCV_TENSOR_CONSTANT (for example, the transformed convolution weights).
+// Call it after changing the content of such a tensor. Freeing a constant tensor calls it as well.
+void ccv_nnc_tensor_constant_invalidate(void);
 
 // For computation node
 // Return high precision time unit.
@@ -161,7 +174,16 @@ CCV_WARN_UNUSED(uint32_t) ccv_nnc_cmd_find_backend(const ccv_nnc_cmd_t cmd, cons
 // Run autotune to find the best kernel and configuration for the given input, returned is the modified
 // cmd that contains the updated configuration.
 CCV_WARN_UNUSED(ccv_nnc_cmd_t) ccv_nnc_cmd_autotune(const ccv_nnc_cmd_t cmd, const size_t max_workspace_size, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context);
+// Persist autotune results in a sqlite3 database at the given path. While it is open, ccv_nnc_cmd_autotune (thus,
+// ccv_nnc_graph_autotune) looks up the command, its parameters, tensor shapes / formats / datatypes and the host CPU
+// in the cache first, and only measures (then stores the result) on a miss. Returns 0 on success.
+CCV_WARN_UNUSED(int) ccv_nnc_cmd_autotune_cache_open(const char* const fn);
+// Stop consulting the autotune cache and close the database.
+void ccv_nnc_cmd_autotune_cache_close(void);
 CCV_WARN_UNUSED(int) ccv_nnc_cmd_bitmask(const ccv_nnc_cmd_t cmd, const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size);
+// Execute the command. If stream_context is a CPU stream, the command is queued onto the stream and returns immediately,
+// the tensors need to stay alive until ccv_nnc_stream_context_wait returns. The return value then only tells whether the
+// command can be queued, what the kernel returns is reported by ccv_nnc_stream_context_wait.
 int ccv_nnc_cmd_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context);
 CCV_WARN_UNUSED(int) ccv_nnc_cmd_is_forward(const ccv_nnc_cmd_t cmd);
 CCV_WARN_UNUSED(int) ccv_nnc_cmd_is_backward(const ccv_nnc_cmd_t cmd);
@@ -182,13 +204,20 @@ enum {
 #define CCV_STREAM_GET_DEVICE(type) ((type) & 0xff00)
 #define CCV_STREAM_GET_DEVICE_ID(type) (CCV_STREAM_GET_DEVICE(type) >> 8)
 // Flag is a combination of CPU / GPU and DEVICE_ID
+// A CPU stream context has its own worker thread, commands on it execute in order, asynchronous to the caller.
 CCV_WARN_UNUSED(ccv_nnc_stream_context_t*) ccv_nnc_stream_context_new(const int type);
-void ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream);
+// Block until everything queued on the stream is done. Returns the first failure from the commands executed on the
+// stream since the last wait, or CCV_NNC_EXEC_SUCCESS.
+int ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream);
+// Finish the pending commands and then free the stream context.
 void ccv_nnc_stream_context_free(ccv_nnc_stream_context_t* const stream_context);
 
 typedef struct ccv_nnc_stream_signal_s ccv_nnc_stream_signal_t;
 
+// Signal to synchronize between streams, only CPU signals are supported for now.
 CCV_WARN_UNUSED(ccv_nnc_stream_signal_t*) ccv_nnc_stream_signal_new(const int type);
+// Signal is fired after everything queued on the stream before this call is done.
+// Commands queued on a stream after wait_signal won't start until the last emission of the signal fires.
 void ccv_nnc_stream_context_emit_signal(const ccv_nnc_stream_context_t* const stream, const ccv_nnc_stream_signal_t* const signal);
 void ccv_nnc_stream_context_wait_signal(const ccv_nnc_stream_context_t* const stream, const ccv_nnc_stream_signal_t* const signal);
 void ccv_nnc_stream_signal_free(ccv_nnc_stream_signal_t* const signal);
@@ -251,6 +280,8 @@ ccv_nnc_graph_exec_t* ccv_nnc_graph_destinations(const ccv_nnc_graph_t* const gr
 int ccv_nnc_graph_destination_size(const ccv_nnc_graph_t* const graph);
 // add tensor pair that can be used to "carry over". (carry over: passing a tensor from current loop to the next loop).
 void ccv_nnc_graph_add_carry_over(ccv_nnc_graph_t* const graph, const ccv_nnc_tensor_t* const from, const ccv_nnc_tensor_t* const to);
+// Set how many threads (including the calling thread) to use when run with CCV_NNC_GRAPH_RUN_PARALLEL, 0 means number of CPUs.
+void ccv_nnc_graph_set_worker_size(ccv_nnc_graph_t* const graph, const int worker_size);
 // This graph, and its relevant auxiliary objects (opaque to user) are deallocated.
 void ccv_nnc_graph_free(ccv_nnc_graph_t* const graph);
 
@@ -279,6 +310,7 @@ typedef struct {
 enum {
 	CCV_NNC_TENSOR_SYMBOL_INIT_ZEROS = 0x01, // Initialize underlying tensor for the symbol with zeros
 	CCV_NNC_TENSOR_SYMBOL_TAPE_VAR = 0x02, // Mark this as a tape variable (it cannot be folded, will contain flag CCV_TAPE_ALLOC)
+	CCV_NNC_TENSOR_SYMBOL_CONSTANT = 0x04, // Mark the tensor bound to this symbol as unchanged between runs, see ccv_nnc_symbolic_graph_constant_fold
 	// The one below is special.
 	CCV_NNC_TENSOR_SYMBOL_DEAD = 0x80000000, // Mark this tensor symbol as dead, any future usage will cause assertion
 };
@@ -404,6 +436,15 @@ typedef struct {
 // tensor_binds provide custom binding for these tensors. You still responsible to manage the life-time of these tensors.
 // outputs marks the tensor symbols that need to be kept til the end of the graph.
 void ccv_nnc_symbolic_graph_compile(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size, ccv_nnc_graph_t** const graph_ref, ccv_nnc_tensor_arena_t** const tensor_arena_ref, ccv_nnc_graph_exec_arena_t** const graph_exec_arena_ref);
+enum {
+	// Besides the default placement (driven by how many tensors each one overlaps with), also place the tensors from the
+	// largest to the smallest at the tightest gap, and keep whichever needs less memory. It puts all tensors of a type in
+	// one buffer. Graphs that share tensors with their parent or sub-graphs always use the default placement.
+	CCV_NNC_SYMBOLIC_GRAPH_COMPILE_BEST_FIT = 0x1,
+};
+// Set how ccv_nnc_symbolic_graph_compile plans the memory of this graph.
+void ccv_nnc_symbolic_graph_set_compile_flags(ccv_nnc_symbolic_graph_t* const graph, const int flags);
+CCV_WARN_UNUSED(int) ccv_nnc_symbolic_graph_compile_flags(const ccv_nnc_symbolic_graph_t* const graph);
 // Free the symbolic graph and its associated memory. Note that if you compiled a graph / tensor arena out of this symbolic graph, these won't be free'd.
 void ccv_nnc_symbolic_graph_free(ccv_nnc_symbolic_graph_t* const graph);
 // Find corresponding tensor by a symbol from the tensor arena.
@@ -412,6 +453,28 @@ CCV_WARN_UNUSED(ccv_nnc_tensor_t*) ccv_nnc_tensor_from_symbol(const ccv_nnc_tens
 int ccv_nnc_tensor_bind_symbol(const ccv_nnc_tensor_arena_t* const tensor_arena, const ccv_nnc_tensor_symbol_t symbol, const ccv_nnc_tensor_t* const tensor);
 // Free the opaque tensor arena structure.
 void ccv_nnc_tensor_arena_free(ccv_nnc_tensor_arena_t* const tensor_arena);
+typedef struct {
+	ccv_nnc_tensor_symbol_t symbol; // The tensor symbol this block is allocated for (d is -1 for blocks the compiler made up when unrolling while loops).
+	int buffer; // The buffer this block lives in.
+	uint64_t offset; // Offset of the block in that buffer, in bytes.
+	uint64_t size; // Size of the block, in bytes.
+	int head; // The first exec that uses the block (the position in topological order, starts at 0).
+	int tail; // The last exec that uses the block (inclusive).
+} ccv_nnc_tensor_arena_block_t;
+typedef struct {
+	int buffer_size; // How many dis-continuous buffers the arena allocated.
+	int block_size; // How many tensor blocks are placed in these buffers.
+	int exec_size; // How many execs the head / tail of the blocks are counted against.
+	uint64_t total_size; // The size of all buffers, this is the memory the arena actually holds.
+	uint64_t peak_size; // The most bytes alive at any exec, no placement can do better than this for the given graph.
+	uint64_t unshared_size; // The size if every block had its own memory.
+	double fragmentation; // 1 - peak_size / total_size, the portion of the arena the placement cannot put to use.
+	const ccv_nnc_tensor_arena_block_t* blocks; // The blocks, owned by the tensor arena.
+} ccv_nnc_tensor_arena_report_t;
+// Report how the tensors are laid out in the tensor arena. Only the buffers of this arena are reported, the sub-graphs
+// (while loops, case..of) reuse these buffers. Tensors bound through tensor_binds are not counted. To trade computation
+// for memory, see ccv_nnc_symbolic_graph_checkpoint.
+CCV_WARN_UNUSED(ccv_nnc_tensor_arena_report_t) ccv_nnc_tensor_arena_report(const ccv_nnc_tensor_arena_t* const tensor_arena);
 // Find corresponding graph exec by a exec symbol from graph exec arena.
 CCV_WARN_UNUSED(ccv_nnc_graph_exec_t) ccv_nnc_graph_exec_from_symbol(const ccv_nnc_graph_exec_arena_t* const graph_exec_arena, const ccv_nnc_graph_exec_symbol_t symbol);
 // Return the node that can drive all the source nodes from the compilation.
@@ -584,7 +647,33 @@ void ccv_nnc_graph_set_while_expr(ccv_nnc_graph_t* const while_graph, const ccv_
 CCV_WARN_UNUSED(ccv_nnc_tensor_t) ccv_nnc_tensor_for_while_count(const ccv_nnc_graph_t* const while_graph);
 // In that case, the computation graph still has no loops or cycles, but you can run it multiple times against different
 // versions of the tensors until the condition not met (thus, the tensor is versioned, so you can "backpropagate through time").
+enum {
+	// Run nodes on a thread pool as soon as all their incoming nodes finished, rather than one by one in topological order.
+	// Sub-graph nodes (while, case_of) run as a whole, and their sub-graphs are executed serially.
+	CCV_NNC_GRAPH_RUN_PARALLEL = 0x10000,
+	// Record the wall time, backend, bytes read / written and thread of every exec (including the ones
+	// in sub-graphs) into the profile of the graph, see ccv_nnc_graph_profile_entries.
+	CCV_NNC_GRAPH_RUN_PROFILE = 0x20000,
+};
 int ccv_nnc_graph_run(ccv_nnc_graph_t* const graph, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags, const ccv_nnc_graph_exec_t* const sources, const int source_size, const ccv_nnc_graph_exec_t* const destinations, const int destination_size);
+typedef struct {
+	ccv_nnc_graph_exec_t exec; // The exec, its graph can be a sub-graph of the profiled graph.
+	uint32_t cmd;
+	uint32_t backend;
+	uint64_t thread; // The thread that executed it.
+	uint64_t start; // In nanoseconds, from ccv_nnc_cmd_mono_time.
+	uint64_t elapsed; // In nanoseconds.
+	uint64_t bytes_read; // Sum of the sizes of the input tensors.
+	uint64_t bytes_written; // Sum of the sizes of the output tensors.
+} ccv_nnc_graph_profile_entry_t;
+// The profile entries collected so far, in the order execs finished. Entries accumulate over runs until cleared.
+CCV_WARN_UNUSED(int) ccv_nnc_graph_profile_entry_size(const ccv_nnc_graph_t* const graph);
+CCV_WARN_UNUSED(const ccv_nnc_graph_profile_entry_t*) ccv_nnc_graph_profile_entries(const ccv_nnc_graph_t* const graph);
+void ccv_nnc_graph_profile_clear(ccv_nnc_graph_t* const graph);
+// Write the profile in Chrome trace event format (JSON), can be loaded in chrome://tracing or Perfetto.
+void ccv_nnc_graph_profile_trace(const ccv_nnc_graph_t* const graph, FILE* out);
+// Write a table of the profile aggregated by command and backend, the most expensive first.
+void ccv_nnc_graph_profile_summary(const ccv_nnc_graph_t* const graph, FILE* out);
 
 // The API to operate on the symbolic graph is more involved than the concrete graph for while loops.
 // The reason is because symbolic graph operates in SSA form (static single assignment), therefore, the while
@@ -675,11 +764,59 @@ enum {
 	// Similarly, if it is on the same device, but alias of some, for some cases we can skip as well (if neither
 	// are carry overs, bypasses etc.)
 	CCV_NNC_SIMPLIFY_DATA_TRANSFER_OPT,
-	// CCV_NNC_SIMPLIFY_CONSTANT_FOLDING, // This currently is not supported, because we don't have efficient way to express constant in symbolic graph.
+	// For CCV_NNC_FORMAT_TRANSFORM, if a transform is undone by the next one (NHWC -> NCHW -> NHWC), or only an
+	// element-wise command sits in between two transforms that cancel out, the transforms are removed and the
+	// element-wise command works on the original layout directly.
+	CCV_NNC_SIMPLIFY_FORMAT_TRANSFORM_OPT,
+	// Fuse commands to save passes over memory: batch norm in test mode and bias add are folded into the preceding
+	// convolution / GEMM, ReLU is applied by the convolution / GEMM before writing its output, and chains of
+	// element-wise commands run in one loop as CCV_NNC_EWCHAIN_FORWARD. The fused commands have no gradient,
+	// thus, this pass should run after ccv_nnc_symbolic_graph_backward if there is one.
+	CCV_NNC_SIMPLIFY_OPS_FUSION,
+	// Constant folding needs the tensors bound to the constant symbols, thus, it is not a simplification pass but
+	// ccv_nnc_symbolic_graph_constant_fold below.
 };
 // When a graph is simplified, its sources / destinations are changed as well.
 void ccv_nnc_symbolic_graph_simplify(ccv_nnc_symbolic_graph_t* const graph, const int* const passes, const int pass_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size);
 
+// Symbolic graph quantization.
+//
+// Rewrite the float CCV_NNC_CONVOLUTION_FORWARD and CCV_NNC_GEMM_FORWARD execs between sources and destinations
+// to run on 8-bit inputs. A CCV_NNC_QUANTIZE_FORWARD is inserted in front of each of them, the activation is
+// quantized per tensor and the weight per output channel, and the exec then takes (a, w, bias, a quantization
+// parameters, w quantization parameters) and picks the quantized backend (CCV_NNC_BACKEND_CPU_INT8). The output
+// remains a float tensor, thus, the rest of the graph is not affected. A tensor used by several execs is quantized
+// only once. Weights that no exec in the graph writes to are flagged with CCV_NNC_TENSOR_SYMBOL_CONSTANT, run
+// ccv_nnc_symbolic_graph_constant_fold afterwards with the weights bound to quantize them once rather than every time
+// the graph runs. The quantize commands that don't wait on other execs become sources of the graph in place of the
+// rewritten execs, the destinations are unchanged.
+void ccv_nnc_symbolic_graph_quantize(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size);
+
+// Symbolic graph constant folding.
+//
+// Tensor symbols flagged with CCV_NNC_TENSOR_SYMBOL_CONSTANT and bound to a CPU tensor in tensor_binds are constants.
+// Execs between sources and destinations that only read constants (weight transforms, quantization of weights,
+// shape-independent sub-graphs etc.) are run once here with ccv_nnc_cmd_exec, their outputs become constants as well,
+// and the execs are removed from the graph. The computed tensors the rest of the graph reads (or in outputs) are
+// returned in folded_binds_ref, pass these along with tensor_binds to ccv_nnc_symbolic_graph_compile. You are
+// responsible to free these tensors (ccv_nnc_tensor_free) and the array (ccfree). Commands without inputs, execs with
+// sub-graphs and outputs that are aliases, carry overs or bypasses are not folded. Like simplification, the sources /
+// destinations of the graph are regenerated.
+void ccv_nnc_symbolic_graph_constant_fold(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size, ccv_nnc_tensor_bind_t** const folded_binds_ref, int* const folded_bind_size_ref);
+
+// Symbolic graph checkpointing.
+//
+// Trade computation for memory in training: the forward pass (the execs between sources and destinations, the same
+// ones given to ccv_nnc_symbolic_graph_backward) is cut into segments of segment_size execs in topological order
+// (0 picks the square root of the number of forward execs). Only the tensors a later segment reads are kept alive
+// until the backward pass. The execs that run after the forward pass and read the other activations get them from a
+// copy of the segment's forward execs instead, which runs after the backward execs of the next segment. Thus, the
+// peak memory is roughly one segment of activations plus the kept ones. The last segment, aliases, in-place execs
+// and outputs of random commands (dropout, random uniform) or execs with sub-graphs are not recomputed. Call this
+// after ccv_nnc_symbolic_graph_backward (or ccv_nnc_symbolic_graph_minimize) and before compile. Like
+// simplification, the sources / destinations of the graph are regenerated.
+void ccv_nnc_symbolic_graph_checkpoint(ccv_nnc_symbolic_graph_t* const graph, const int segment_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size);
+
 /**
  * Level-4 API
  */
@@ -757,10 +894,58 @@ void ccv_nnc_dynamic_graph_dot(const ccv_nnc_dynamic_graph_t* const graph, const
 // 4. Columns can be aligned, with some given indexes.
 // 5. All these can be done efficiently, on a scale of hundreds of Gigabytes data.
 //
+// The current implementation covers 1, 2 and the data loading side of 5: a dataframe is a set of columns over a
+// number of rows. A column is either enumerated (data provided by a callback for given rows) or derived (mapped from
+// other columns). Nothing is computed until iterated, and only the columns asked (and what they derive from) are
+// computed. Rows can be shuffled, batched into tensors, and prefetched in the background while the consumer is busy.
+//
 typedef struct ccv_cnnp_dataframe_s ccv_cnnp_dataframe_t;
-CCV_WARN_UNUSED(ccv_cnnp_dataframe_t*) ccv_cnnp_dataframe_new(void);
+// Fill data for the given rows. data[i] contains what was filled last time for this slot (or 0), thus, can be reused.
+// This can be called from multiple threads at the same time when prefetching.
+typedef void (*ccv_cnnp_column_data_enum_f)(const int column_idx, const int* const row_idxs, const int row_size, void** const data, void* const context);
+// Derive data from other columns. column_data[i][j] is the data of the i-th input column for the j-th row.
+// The same reuse and thread-safety rules apply as ccv_cnnp_column_data_enum_f.
+typedef void (*ccv_cnnp_column_data_map_f)(void*** const column_data, const int column_size, const int batch_size, void** const data, void* const context);
+// Free the data filled by enum or map.
+typedef void (*ccv_cnnp_column_data_deinit_f)(void* const data, void* const context);
+// Free the context when the dataframe is freed.
+typedef void (*ccv_cnnp_column_data_context_deinit_f)(void* const context);
+typedef struct {
+	ccv_cnnp_column_data_enum_f data_enum;
+	ccv_cnnp_column_data_deinit_f data_deinit;
+	void* context;
+	ccv_cnnp_column_data_context_deinit_f context_deinit;
+} ccv_cnnp_column_data_t;
+// Create a dataframe with enumerated columns.
+CCV_WARN_UNUSED(ccv_cnnp_dataframe_t*) ccv_cnnp_dataframe_new(const ccv_cnnp_column_data_t* const column_data, const int column_size, const int row_count);
+// Create a dataframe of 1 column, the data of each row is the pointer to the element of the array (not copied,
+// the array needs to outlive the dataframe).
+CCV_WARN_UNUSED(ccv_cnnp_dataframe_t*) ccv_cnnp_dataframe_from_array_new(ccv_array_t* const array);
+// Add an enumerated column, returns the column index.
+int ccv_cnnp_dataframe_add(ccv_cnnp_dataframe_t* const dataframe, const ccv_cnnp_column_data_enum_f data_enum, const ccv_cnnp_column_data_deinit_f data_deinit, void* const context, const ccv_cnnp_column_data_context_deinit_f context_deinit);
+// Add a column derived from the given columns, returns the column index. It is computed lazily.
+int ccv_cnnp_dataframe_map(ccv_cnnp_dataframe_t* const dataframe, const ccv_cnnp_column_data_map_f map, const ccv_cnnp_column_data_deinit_f data_deinit, const int* const column_idxs, const int column_idx_size, void* const context, const ccv_cnnp_column_data_context_deinit_f context_deinit);
+// Shuffle the order of rows. Existing iterators pick up the new order on ccv_cnnp_dataframe_iter_set_cursor.
+void ccv_cnnp_dataframe_shuffle(ccv_cnnp_dataframe_t* const dataframe);
+CCV_WARN_UNUSED(int) ccv_cnnp_dataframe_row_count(ccv_cnnp_dataframe_t* const dataframe);
+// Create a dataframe of 1 column, each row is a batch_count rows of the given columns. The given columns have to be
+// CPU tensors (ccv_nnc_tensor_t*) of the same shape for all rows. The data of the new column is an array of
+// column_idx_size tensors (ccv_nnc_tensor_t**), each one with an extra dimension at the beginning for the batch.
+// The rows that cannot fill a whole batch at the end are dropped. The given dataframe needs to outlive this one.
+CCV_WARN_UNUSED(ccv_cnnp_dataframe_t*) ccv_cnnp_dataframe_batching_new(ccv_cnnp_dataframe_t* const dataframe, const int* const column_idxs, const int column_idx_size, const int batch_count);
 void ccv_cnnp_dataframe_free(ccv_cnnp_dataframe_t* const dataframe);
 
+typedef struct ccv_cnnp_dataframe_iter_s ccv_cnnp_dataframe_iter_t;
+// Iterate over the given columns row by row.
+CCV_WARN_UNUSED(ccv_cnnp_dataframe_iter_t*) ccv_cnnp_dataframe_iter_new(ccv_cnnp_dataframe_t* const dataframe, const int* const column_idxs, const int column_idx_size);
+// Get the data of the next row for the columns, these are valid until the next call. Returns -1 if no more rows.
+int ccv_cnnp_dataframe_iter_next(ccv_cnnp_dataframe_iter_t* const iter, void** const data_ref, const int column_idx_size);
+// Compute up to prefetch_count rows ahead with worker_size background threads. Can only be called once per iterator.
+void ccv_cnnp_dataframe_iter_prefetch(ccv_cnnp_dataframe_iter_t* const iter, const int prefetch_count, const int worker_size);
+// Move the iterator to the given row (0 to start over).
+void ccv_cnnp_dataframe_iter_set_cursor(ccv_cnnp_dataframe_iter_t* const iter, const int idx);
+void ccv_cnnp_dataframe_iter_free(ccv_cnnp_dataframe_iter_t* const iter);
+
 // Model
 //
 // With Keras API in mind, this model implementation essentially is a light-weight way to group neural network layers
@@ -802,13 +987,26 @@ CCV_WARN_UNUSED(ccv_cnnp_model_io_t) ccv_cnnp_model_apply(ccv_cnnp_model_t* cons
 CCV_WARN_UNUSED(ccv_cnnp_model_t*) ccv_cnnp_model_new(const ccv_cnnp_model_io_t* const inputs, const int input_size, const ccv_cnnp_model_io_t* const outputs, const int output_size);
 // This method returns a sequential model, which composed from a sequence of models.
 CCV_WARN_UNUSED(ccv_cnnp_model_t*) ccv_cnnp_sequential_new(ccv_cnnp_model_t* const* const models, const int model_size);
+// Split each minibatch into parallel pieces, and fit them on as many CPU threads. The gradients from each piece are
+// summed before the parameters are updated once. This has to be called before ccv_cnnp_model_compile. By default
+// (or with 0), it uses as many threads as there are CPU cores, reduced until the batch size can be evenly split.
+void ccv_cnnp_model_set_parallel(ccv_cnnp_model_t* const model, const int parallel);
 // Prepare the model to be trained, the input specifies the batch size etc.
 // Input size technically is not needed, here is a safety check.
-void ccv_cnnp_model_compile(ccv_cnnp_model_t* const model, const ccv_nnc_tensor_param_t* const inputs, const int input_size);
+// The loss command takes an output of the model and its fit (the expected output), and computes a loss per sample,
+// such as CMD_CATEGORICAL_CROSSENTROPY_FORWARD(). The minimizer command updates the parameters from the gradients
+// of the loss averaged over the minibatch, such as CMD_SGD_FORWARD(...).
+void ccv_cnnp_model_compile(ccv_cnnp_model_t* const model, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_cmd_t minimizer, const ccv_nnc_cmd_t loss);
 // Draw the model out as a graph.
 void ccv_cnnp_model_dot(const ccv_cnnp_model_t* const model, const int flags, FILE* out);
-// Fit a model to a given input / output.
-void ccv_cnnp_model_fit(ccv_cnnp_model_t* const model, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size);
+// Fit a model to a given input / output, this runs one step of the minimizer on the minibatch. The first call
+// initializes the parameters and compiles the graph, the later ones reuse it thus there is no allocation per step.
+// The inputs and fits are CPU tensors with the whole minibatch. The outputs are optional, if provided, these will be
+// filled with the model outputs from this step.
+void ccv_cnnp_model_fit(ccv_cnnp_model_t* const model, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const fits, const int fit_size, ccv_nnc_tensor_t* const* const outputs, const int output_size);
+// Change the minimizer (the learning rate for example) after the model is compiled. The new minimizer has to be the
+// same command with different parameters.
+void ccv_cnnp_model_set_minimizer(ccv_cnnp_model_t* const model, const ccv_nnc_cmd_t minimizer);
 // Free a given model.
 void ccv_cnnp_model_free(ccv_cnnp_model_t* const model);
 
@@ -1,11 +1,18 @@
 #include "ccv_nnc.h"
 #include "ccv_nnc_internal.h"
 #include "ccv_nnc_easy.h"
+#include "3rdparty/sqlite3/sqlite3.h"
 #ifdef HAVE_CUDA
 #include "gpu/ccv_nnc_compat.h"
 #endif
 #include <time.h>
 #include <sys/time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
 
 #ifdef __MACH__
 #include <mach/mach.h>
@@ -287,6 +294,8 @@ uint32_t ccv_nnc_cmd_find_backend(const ccv_nnc_cmd_t cmd, const int tensor_memo
 	const int cmd_idx = _ccv_nnc_cmd_ph(cmd.cmd);
 	assert(cmd_idx >= 0 && cmd_idx < sizeof(init_map) / sizeof(init_map[0]));
 	int i;
+	uint32_t backend = cmd.backend;
+	int backend_extra_datatypes = -1;
 	for (i = 0; i < CCV_NNC_BACKEND_COUNT; i++)
 	{
 		const ccv_nnc_cmd_backend_registry_t api_registry = init_map[cmd_idx].backends[i];
@@ -295,13 +304,205 @@ uint32_t ccv_nnc_cmd_find_backend(const ccv_nnc_cmd_t cmd, const int tensor_memo
 			(api_registry.tensor_memory & tensor_memory) == tensor_memory &&
 			(api_registry.tensor_formats & tensor_formats) == tensor_formats &&
 			(api_registry.tensor_datatypes & tensor_datatypes) == tensor_datatypes)
-			return backend_init_map[i].backend;
+		{
+			// Prefer the backend that supports the fewest datatypes we don't use, thus, a float tensor won't be
+			// dispatched to a quantized backend just because it also accepts float (for its scales).
+			int extra_datatypes = 0;
+			int datatypes = api_registry.tensor_datatypes & ~tensor_datatypes;
+			for (; datatypes; datatypes &= datatypes - 1)
+				++extra_datatypes;
+			if (extra_datatypes == 0)
+				return backend_init_map[i].backend;
+			if (backend_extra_datatypes < 0 || extra_datatypes < backend_extra_datatypes)
+				backend = backend_init_map[i].backend, backend_extra_datatypes = extra_datatypes;
+		}
 	}
-	return cmd.backend;
+	return backend;
 }
 
 #define AUTO_TUNE_TRIAL_SIZE (3)
 
+// The autotune cache. Results are keyed by the host signature, the command and a blob of everything else that
+// can change the measurement (parameters, hint, flags, workspace limit and tensor parameters), thus, a warm
+// start can pick the same backend / algorithm without running any of them.
+static pthread_mutex_t autotune_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static sqlite3* autotune_cache_conn = 0;
+static sqlite3_stmt* autotune_cache_select_stmt = 0;
+static sqlite3_stmt* autotune_cache_insert_stmt = 0;
+static char autotune_cache_host[128];
+
+static void _ccv_nnc_cmd_autotune_host(char* const host, const size_t size)
+{
+	// Timings only carry over to the same CPU model with the same number of cores to run on.
+	char model[49] = "unknown";
+#if defined(__x86_64__) || defined(__i386__)
+	unsigned int brand[12];
+	if (__get_cpuid(0x80000000, brand, brand + 1, brand + 2, brand + 3) && brand[0] >= 0x80000004)
+	{
+		int i;
+		for (i = 0; i < 3; i++)
+			__get_cpuid(0x80000002 + i, brand + i * 4, brand + i * 4 + 1, brand + i * 4 + 2, brand + i * 4 + 3);
+		memcpy(model, brand, 48);
+		model[48] = 0;
+	}
+#endif
+	struct utsname name;
+	if (uname(&name) != 0)
+		strncpy(name.machine, "unknown", sizeof(name.machine));
+	snprintf(host, size, "%s %s %ld", name.machine, model, sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+static void _ccv_nnc_cmd_autotune_cache_free(void)
+{
+	if (autotune_cache_select_stmt)
+		sqlite3_finalize(autotune_cache_select_stmt);
+	if (autotune_cache_insert_stmt)
+		sqlite3_finalize(autotune_cache_insert_stmt);
+	if (autotune_cache_conn)
+		sqlite3_close(autotune_cache_conn);
+	autotune_cache_select_stmt = 0;
+	autotune_cache_insert_stmt = 0;
+	autotune_cache_conn = 0;
+}
+
+int ccv_nnc_cmd_autotune_cache_open(const char* const fn)
+{
+	pthread_mutex_lock(&autotune_cache_mutex);
+	_ccv_nnc_cmd_autotune_cache_free();
+	if (SQLITE_OK != sqlite3_open(fn, &autotune_cache_conn))
+	{
+		_ccv_nnc_cmd_autotune_cache_free();
+		pthread_mutex_unlock(&autotune_cache_mutex);
+		return -1;
+	}
+	const char autotune_create_table_qs[] = "CREATE TABLE IF NOT EXISTS autotune "
+		"(host TEXT, cmd INTEGER, key BLOB, backend INTEGER, algorithm INTEGER, PRIMARY KEY (host, cmd, key))";
+	const char autotune_select_qs[] = "SELECT backend, algorithm FROM autotune WHERE host=$host AND cmd=$cmd AND key=$key";
+	const char autotune_insert_qs[] = "REPLACE INTO autotune (host, cmd, key, backend, algorithm) VALUES ($host, $cmd, $key, $backend, $algorithm)";
+	if (SQLITE_OK != sqlite3_exec(autotune_cache_conn, autotune_create_table_qs, 0, 0, 0) ||
+		SQLITE_OK != sqlite3_prepare_v2(autotune_cache_conn, autotune_select_qs, sizeof(autotune_select_qs), &autotune_cache_select_stmt, 0) ||
+		SQLITE_OK != sqlite3_prepare_v2(autotune_cache_conn, autotune_insert_qs, sizeof(autotune_insert_qs), &autotune_cache_insert_stmt, 0))
+	{
+		_ccv_nnc_cmd_autotune_cache_free();
+		pthread_mutex_unlock(&autotune_cache_mutex);
+		return -1;
+	}
+	_ccv_nnc_cmd_autotune_host(autotune_cache_host, sizeof(autotune_cache_host));
+	pthread_mutex_unlock(&autotune_cache_mutex);
+	return 0;
+}
+
+void ccv_nnc_cmd_autotune_cache_close(void)
+{
+	pthread_mutex_lock(&autotune_cache_mutex);
+	_ccv_nnc_cmd_autotune_cache_free();
+	pthread_mutex_unlock(&autotune_cache_mutex);
+}
+
+typedef struct {
+	int flags;
+	int input_size;
+	int output_size;
+	uint64_t max_workspace_size;
+	ccv_nnc_cmd_param_t info;
+	ccv_nnc_hint_t hint;
+} ccv_nnc_cmd_autotune_key_t;
+
+typedef struct {
+	int view;
+	ccv_nnc_tensor_param_t info;
+	int inc[CCV_NNC_MAX_DIM_ALLOC];
+} ccv_nnc_cmd_autotune_tensor_key_t;
+
+static void _ccv_nnc_cmd_autotune_tensor_key(ccv_nnc_cmd_autotune_tensor_key_t* const key, const ccv_nnc_tensor_t* const tensor)
+{
+	memset(key, 0, sizeof(ccv_nnc_cmd_autotune_tensor_key_t));
+	if (!tensor)
+		return;
+	memcpy(&key->info, &tensor->info, sizeof(ccv_nnc_tensor_param_t));
+	// Strided views run at a different pace than the dense tensor of the same shape.
+	if (CCV_IS_TENSOR_VIEW(tensor))
+	{
+		key->view = 1;
+		memcpy(key->inc, ((ccv_nnc_tensor_view_t*)tensor)->inc, sizeof(key->inc));
+	}
+}
+
+static size_t _ccv_nnc_cmd_autotune_key_size(const int input_size, const int output_size)
+{
+	return sizeof(ccv_nnc_cmd_autotune_key_t) + sizeof(ccv_nnc_cmd_autotune_tensor_key_t) * (input_size + output_size);
+}
+
+static void _ccv_nnc_cmd_autotune_key(void* const key, const ccv_nnc_cmd_t cmd, const size_t max_workspace_size, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size)
+{
+	// Zero out first so the padding doesn't leak into the blob.
+	ccv_nnc_cmd_autotune_key_t* const cmd_key = (ccv_nnc_cmd_autotune_key_t*)key;
+	memset(cmd_key, 0, sizeof(ccv_nnc_cmd_autotune_key_t));
+	cmd_key->flags = flags;
+	cmd_key->input_size = input_size;
+	cmd_key->output_size = output_size;
+	cmd_key->max_workspace_size = max_workspace_size;
+	memcpy(&cmd_key->info, &cmd.info, sizeof(ccv_nnc_cmd_param_t));
+	memcpy(&cmd_key->hint, &hint, sizeof(ccv_nnc_hint_t));
+	ccv_nnc_cmd_autotune_tensor_key_t* const tensor_keys = (ccv_nnc_cmd_autotune_tensor_key_t*)(cmd_key + 1);
+	int i;
+	for (i = 0; i < input_size; i++)
+		_ccv_nnc_cmd_autotune_tensor_key(tensor_keys + i, inputs[i]);
+	for (i = 0; i < output_size; i++)
+		_ccv_nnc_cmd_autotune_tensor_key(tensor_keys + input_size + i, outputs[i]);
+}
+
+static int _ccv_nnc_cmd_autotune_cache_get(const ccv_nnc_cmd_t cmd, const void* const key, const size_t key_size, ccv_nnc_cmd_t* const tuned_cmd)
+{
+	int found = 0;
+	pthread_mutex_lock(&autotune_cache_mutex);
+	if (autotune_cache_select_stmt)
+	{
+		sqlite3_bind_text(autotune_cache_select_stmt, 1, autotune_cache_host, -1, SQLITE_STATIC);
+		sqlite3_bind_int64(autotune_cache_select_stmt, 2, cmd.cmd);
+		sqlite3_bind_blob(autotune_cache_select_stmt, 3, key, key_size, SQLITE_STATIC);
+		if (SQLITE_ROW == sqlite3_step(autotune_cache_select_stmt))
+		{
+			const uint32_t backend = (uint32_t)sqlite3_column_int64(autotune_cache_select_stmt, 0);
+			const int algorithm = sqlite3_column_int(autotune_cache_select_stmt, 1);
+			// The cache may come from a build with a different set of backends, only trust what we can run.
+			const int backend_idx = _ccv_nnc_cmd_backend_ph(backend);
+			if (backend_idx >= 0 && backend_idx < CCV_NNC_BACKEND_COUNT && backend_init_map[backend_idx].backend == backend)
+			{
+				const ccv_nnc_cmd_backend_registry_t api_registry = init_map[_ccv_nnc_cmd_ph(cmd.cmd)].backends[backend_idx];
+				if (api_registry.exec && (api_registry.autotune || algorithm < api_registry.algorithms))
+				{
+					*tuned_cmd = cmd;
+					tuned_cmd->backend = backend;
+					tuned_cmd->algorithm = algorithm;
+					found = 1;
+				}
+			}
+		}
+		sqlite3_reset(autotune_cache_select_stmt);
+		sqlite3_clear_bindings(autotune_cache_select_stmt);
+	}
+	pthread_mutex_unlock(&autotune_cache_mutex);
+	return found;
+}
+
+static void _ccv_nnc_cmd_autotune_cache_set(const ccv_nnc_cmd_t tuned_cmd, const void* const key, const size_t key_size)
+{
+	pthread_mutex_lock(&autotune_cache_mutex);
+	if (autotune_cache_insert_stmt)
+	{
+		sqlite3_bind_text(autotune_cache_insert_stmt, 1, autotune_cache_host, -1, SQLITE_STATIC);
+		sqlite3_bind_int64(autotune_cache_insert_stmt, 2, tuned_cmd.cmd);
+		sqlite3_bind_blob(autotune_cache_insert_stmt, 3, key, key_size, SQLITE_STATIC);
+		sqlite3_bind_int64(autotune_cache_insert_stmt, 4, tuned_cmd.backend);
+		sqlite3_bind_int(autotune_cache_insert_stmt, 5, tuned_cmd.algorithm);
+		sqlite3_step(autotune_cache_insert_stmt);
+		sqlite3_reset(autotune_cache_insert_stmt);
+		sqlite3_clear_bindings(autotune_cache_insert_stmt);
+	}
+	pthread_mutex_unlock(&autotune_cache_mutex);
+}
+
 ccv_nnc_cmd_t ccv_nnc_cmd_autotune(const ccv_nnc_cmd_t cmd, const size_t max_workspace_size, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
 {
 	// This is a custom cmd kernel, no need to autotune.
@@ -326,6 +527,22 @@ ccv_nnc_cmd_t ccv_nnc_cmd_autotune(const ccv_nnc_cmd_t cmd, const size_t max_wor
 	int64_t best_measured = -1;
 	const int cmd_idx = _ccv_nnc_cmd_ph(cmd.cmd);
 	assert(cmd_idx >= 0 && cmd_idx < sizeof(init_map) / sizeof(init_map[0]));
+	// Check the autotune cache before measuring anything.
+	const size_t key_size = _ccv_nnc_cmd_autotune_key_size(input_size, output_size);
+	void* key = 0;
+	pthread_mutex_lock(&autotune_cache_mutex);
+	const int has_autotune_cache = !!autotune_cache_conn;
+	pthread_mutex_unlock(&autotune_cache_mutex);
+	if (has_autotune_cache)
+	{
+		key = ccmalloc(key_size);
+		_ccv_nnc_cmd_autotune_key(key, cmd, max_workspace_size, hint, flags, inputs, input_size, outputs, output_size);
+		if (_ccv_nnc_cmd_autotune_cache_get(cmd, key, key_size, &tuned_cmd))
+		{
+			ccfree(key);
+			return tuned_cmd;
+		}
+	}
 	// We need to have trial loop through all the data.
 	for (k = 0; k < AUTO_TUNE_TRIAL_SIZE; k++)
 	{
@@ -350,8 +567,11 @@ ccv_nnc_cmd_t ccv_nnc_cmd_autotune(const ccv_nnc_cmd_t cmd, const size_t max_wor
 					uint64_t elapsed = ccv_nnc_cmd_mono_time();
 					// Ready to run.
 					int status = ccv_nnc_cmd_exec(candid_cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
-					ccv_nnc_stream_context_wait(stream_context);
+					// On a CPU stream, the command only finishes (and reports how it went) after the wait.
+					const int wait_status = ccv_nnc_stream_context_wait(stream_context);
 					elapsed = ccv_nnc_cmd_mono_time() - elapsed;
+					if (status == CCV_NNC_EXEC_SUCCESS)
+						status = wait_status;
 					if (status == CCV_NNC_EXEC_SUCCESS &&
 						(best_measured == -1 || elapsed < best_measured))
 					{
@@ -366,7 +586,10 @@ ccv_nnc_cmd_t ccv_nnc_cmd_autotune(const ccv_nnc_cmd_t cmd, const size_t max_wor
 						uint64_t elapsed = ccv_nnc_cmd_mono_time();
 						// Ready to run.
 						int status = ccv_nnc_cmd_exec(candid_cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
+						const int wait_status = ccv_nnc_stream_context_wait(stream_context);
 						elapsed = ccv_nnc_cmd_mono_time() - elapsed;
+						if (status == CCV_NNC_EXEC_SUCCESS)
+							status = wait_status;
 						if (status == CCV_NNC_EXEC_SUCCESS &&
 							(best_measured == -1 || elapsed < best_measured))
 						{
@@ -378,6 +601,13 @@ ccv_nnc_cmd_t ccv_nnc_cmd_autotune(const ccv_nnc_cmd_t cmd, const size_t max_wor
 			}
 		}
 	}
+	// Only remember the result if some backend actually ran.
+	if (key)
+	{
+		if (best_measured >= 0)
+			_ccv_nnc_cmd_autotune_cache_set(tuned_cmd, key, key_size);
+		ccfree(key);
+	}
 	return tuned_cmd;
 }
 
@@ -397,6 +627,9 @@ int ccv_nnc_cmd_bitmask(const ccv_nnc_cmd_t cmd, const int input_size, const int
 	return 0;
 }
 
+static int _ccv_nnc_stream_context_is_async(const ccv_nnc_stream_context_t* const stream_context);
+static int _ccv_nnc_stream_context_exec_async(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context);
+
 int ccv_nnc_cmd_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
 {
 	// If it is no-op, return as if succeed already.
@@ -404,7 +637,11 @@ int ccv_nnc_cmd_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const i
 		return 0;
 	// If it is a custom command, just apply it directly.
 	if (cmd.cmd == CCV_NNC_CUSTOM_FORWARD || cmd.cmd == CCV_NNC_CUSTOM_BACKWARD)
+	{
+		if (_ccv_nnc_stream_context_is_async(stream_context))
+			return _ccv_nnc_stream_context_exec_async(cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
 		return cmd.exec(cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
+	}
 	assert(cmd.cmd != CCV_NNC_GRAPH_FORWARD && cmd.cmd != CCV_NNC_GRAPH_BACKWARD);
 	const int cmd_idx = _ccv_nnc_cmd_ph(cmd.cmd);
 	assert(cmd_idx >= 0 && cmd_idx < sizeof(init_map) / sizeof(init_map[0]));
@@ -464,6 +701,14 @@ int ccv_nnc_cmd_exec(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const i
 		ccfree(input_bitmasks);
 	if (output_size > 64 * CCV_NNC_STACK_BITMASK_ALLOC)
 		ccfree(output_bitmasks);
+	// On a CPU stream, queue it up with the backend resolved and return right away, the stream's worker thread will
+	// execute it. Whatever the kernel returns there is reported by ccv_nnc_stream_context_wait.
+	if (_ccv_nnc_stream_context_is_async(stream_context))
+	{
+		ccv_nnc_cmd_t queued_cmd = cmd;
+		queued_cmd.backend = backend;
+		return _ccv_nnc_stream_context_exec_async(queued_cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
+	}
 	// Everything is out, call the underlying implementation.
 	return api_registry.exec(cmd, hint, flags, inputs, input_size, outputs, output_size, stream_context);
 }
@@ -483,15 +728,154 @@ int ccv_nnc_cmd_attr(const ccv_nnc_cmd_t cmd, const int flags)
 	return !!(cmd_registry.flags & flags);
 }
 
+typedef struct ccv_nnc_stream_task_s ccv_nnc_stream_task_t;
+
 struct ccv_nnc_stream_context_s {
 	int type;
-	// Left for implementation yet, the CPU support for stream context.
+	// The CPU stream context is a worker thread that drains a FIFO of tasks.
+	pthread_t thread;
+	pthread_mutex_t mutex;
+	pthread_cond_t notify; // Signaled when there is new task or the stream is destroying.
+	pthread_cond_t drain; // Signaled when the queue is drained.
+	int busy;
+	int destroying;
+	int status; // The first failure from the commands executed since the last wait.
+	ccv_nnc_stream_task_t* head;
+	ccv_nnc_stream_task_t* tail;
+};
+
+struct ccv_nnc_stream_signal_s {
+	int type;
+	pthread_mutex_t mutex;
+	pthread_cond_t notify;
+	uint64_t emit_count; // How many times this signal is emitted onto a stream.
+	uint64_t fire_count; // How many of these emissions are reached by the stream.
+};
+
+enum {
+	CCV_NNC_STREAM_TASK_EXEC,
+	CCV_NNC_STREAM_TASK_EMIT_SIGNAL,
+	CCV_NNC_STREAM_TASK_WAIT_SIGNAL,
 };
 
+struct ccv_nnc_stream_task_s {
+	int type;
+	ccv_nnc_cmd_t cmd;
+	ccv_nnc_hint_t hint;
+	int flags;
+	int input_size;
+	int output_size;
+	ccv_nnc_tensor_t** inputs;
+	ccv_nnc_tensor_t** outputs;
+	ccv_nnc_stream_signal_t* signal;
+	uint64_t count; // For wait signal, the emission to wait for.
+	ccv_nnc_stream_task_t* next;
+};
+
+static int _ccv_nnc_stream_context_is_async(const ccv_nnc_stream_context_t* const stream_context)
+{
+	// The worker thread executes the task synchronously.
+	return stream_context && CCV_STREAM_GET_CONTEXT(stream_context->type) == CCV_STREAM_CONTEXT_CPU && !pthread_equal(pthread_self(), stream_context->thread);
+}
+
+static void _ccv_nnc_stream_task_push(ccv_nnc_stream_context_t* const stream_context, ccv_nnc_stream_task_t* const task)
+{
+	task->next = 0;
+	pthread_mutex_lock(&stream_context->mutex);
+	if (stream_context->tail)
+		stream_context->tail->next = task;
+	else
+		stream_context->head = task;
+	stream_context->tail = task;
+	pthread_cond_signal(&stream_context->notify);
+	pthread_mutex_unlock(&stream_context->mutex);
+}
+
+static void* _ccv_nnc_stream_context_worker(void* const context)
+{
+	ccv_nnc_stream_context_t* const stream_context = (ccv_nnc_stream_context_t*)context;
+	pthread_mutex_lock(&stream_context->mutex);
+	for (;;)
+	{
+		while (!stream_context->head && !stream_context->destroying)
+			pthread_cond_wait(&stream_context->notify, &stream_context->mutex);
+		ccv_nnc_stream_task_t* const task = stream_context->head;
+		if (!task) // Destroying, and nothing left.
+			break;
+		stream_context->head = task->next;
+		if (!stream_context->head)
+			stream_context->tail = 0;
+		stream_context->busy = 1;
+		pthread_mutex_unlock(&stream_context->mutex);
+		ccv_nnc_stream_signal_t* const signal = task->signal;
+		int status = CCV_NNC_EXEC_SUCCESS;
+		switch (task->type)
+		{
+			case CCV_NNC_STREAM_TASK_EXEC:
+				status = ccv_nnc_cmd_exec(task->cmd, task->hint, task->flags, task->inputs, task->input_size, task->outputs, task->output_size, stream_context);
+				break;
+			case CCV_NNC_STREAM_TASK_EMIT_SIGNAL:
+				pthread_mutex_lock(&signal->mutex);
+				++signal->fire_count;
+				pthread_cond_broadcast(&signal->notify);
+				pthread_mutex_unlock(&signal->mutex);
+				break;
+			case CCV_NNC_STREAM_TASK_WAIT_SIGNAL:
+				pthread_mutex_lock(&signal->mutex);
+				while (signal->fire_count < task->count)
+					pthread_cond_wait(&signal->notify, &signal->mutex);
+				pthread_mutex_unlock(&signal->mutex);
+				break;
+		}
+		ccfree(task);
+		pthread_mutex_lock(&stream_context->mutex);
+		if (status != CCV_NNC_EXEC_SUCCESS && stream_context->status == CCV_NNC_EXEC_SUCCESS)
+			stream_context->status = status;
+		stream_context->busy = 0;
+		if (!stream_context->head)
+			pthread_cond_broadcast(&stream_context->drain);
+	}
+	pthread_mutex_unlock(&stream_context->mutex);
+	return 0;
+}
+
+static int _ccv_nnc_stream_context_exec_async(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	// The tensor lists are usually on the caller's stack, copy them along with the task.
+	ccv_nnc_stream_task_t* const task = (ccv_nnc_stream_task_t*)ccmalloc(sizeof(ccv_nnc_stream_task_t) + sizeof(ccv_nnc_tensor_t*) * (input_size + output_size));
+	task->type = CCV_NNC_STREAM_TASK_EXEC;
+	task->cmd = cmd;
+	task->hint = hint;
+	task->flags = flags;
+	task->input_size = input_size;
+	task->output_size = output_size;
+	task->inputs = (ccv_nnc_tensor_t**)(task + 1);
+	task->outputs = task->inputs + input_size;
+	if (input_size)
+		memcpy(task->inputs, inputs, sizeof(ccv_nnc_tensor_t*) * input_size);
+	if (output_size)
+		memcpy(task->outputs, outputs, sizeof(ccv_nnc_tensor_t*) * output_size);
+	task->signal = 0;
+	task->count = 0;
+	_ccv_nnc_stream_task_push((ccv_nnc_stream_context_t*)stream_context, task);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
 ccv_nnc_stream_context_t* ccv_nnc_stream_context_new(const int type)
 {
 	ccv_nnc_stream_context_t* stream_context = (ccv_nnc_stream_context_t*)ccmalloc(sizeof(ccv_nnc_stream_context_t));
 	stream_context->type = type;
+	if (CCV_STREAM_GET_CONTEXT(type) == CCV_STREAM_CONTEXT_CPU)
+	{
+		pthread_mutex_init(&stream_context->mutex, 0);
+		pthread_cond_init(&stream_context->notify, 0);
+		pthread_cond_init(&stream_context->drain, 0);
+		stream_context->busy = 0;
+		stream_context->destroying = 0;
+		stream_context->status = CCV_NNC_EXEC_SUCCESS;
+		stream_context->head = stream_context->tail = 0;
+		pthread_create(&stream_context->thread, 0, _ccv_nnc_stream_context_worker, stream_context);
+	}
 #ifdef HAVE_CUDA
 	if (CCV_STREAM_GET_CONTEXT(type) == CCV_STREAM_CONTEXT_GPU)
 		stream_context = ccv_nnc_init_stream_context(stream_context);
@@ -499,21 +883,106 @@ ccv_nnc_stream_context_t* ccv_nnc_stream_context_new(const int type)
 	return stream_context;
 }
 
-void ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream_context)
+int ccv_nnc_stream_context_wait(const ccv_nnc_stream_context_t* const stream_context)
 {
 	if (!stream_context)
-		return;
+		return CCV_NNC_EXEC_SUCCESS;
+	int status = CCV_NNC_EXEC_SUCCESS;
+	if (_ccv_nnc_stream_context_is_async(stream_context))
+	{
+		ccv_nnc_stream_context_t* const stream_cpu = (ccv_nnc_stream_context_t*)stream_context;
+		pthread_mutex_lock(&stream_cpu->mutex);
+		while (stream_cpu->head || stream_cpu->busy)
+			pthread_cond_wait(&stream_cpu->drain, &stream_cpu->mutex);
+		status = stream_cpu->status;
+		stream_cpu->status = CCV_NNC_EXEC_SUCCESS;
+		pthread_mutex_unlock(&stream_cpu->mutex);
+	}
 #ifdef HAVE_CUDA
 	if (CCV_STREAM_GET_CONTEXT(stream_context->type) == CCV_STREAM_CONTEXT_GPU)
 		ccv_nnc_synchronize_stream_context(stream_context);
 #endif
+	return status;
 }
 
 void ccv_nnc_stream_context_free(ccv_nnc_stream_context_t* const stream_context)
 {
+	if (CCV_STREAM_GET_CONTEXT(stream_context->type) == CCV_STREAM_CONTEXT_CPU)
+	{
+		// Finish all the pending tasks first.
+		pthread_mutex_lock(&stream_context->mutex);
+		stream_context->destroying = 1;
+		pthread_cond_signal(&stream_context->notify);
+		pthread_mutex_unlock(&stream_context->mutex);
+		pthread_join(stream_context->thread, 0);
+		pthread_cond_destroy(&stream_context->drain);
+		pthread_cond_destroy(&stream_context->notify);
+		pthread_mutex_destroy(&stream_context->mutex);
+	}
 #ifdef HAVE_CUDA
 	if (CCV_STREAM_GET_CONTEXT(stream_context->type) == CCV_STREAM_CONTEXT_GPU)
 		ccv_nnc_deinit_stream_context(stream_context);
 #endif
 	ccfree(stream_context);
 }
+
+ccv_nnc_stream_signal_t* ccv_nnc_stream_signal_new(const int type)
+{
+	// Only CPU streams support signals for now.
+	assert(CCV_STREAM_GET_CONTEXT(type) == CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_signal_t* const signal = (ccv_nnc_stream_signal_t*)ccmalloc(sizeof(ccv_nnc_stream_signal_t));
+	signal->type = type;
+	pthread_mutex_init(&signal->mutex, 0);
+	pthread_cond_init(&signal->notify, 0);
+	signal->emit_count = 0;
+	signal->fire_count = 0;
+	return signal;
+}
+
+void ccv_nnc_stream_context_emit_signal(const ccv_nnc_stream_context_t* const stream_context, const ccv_nnc_stream_signal_t* const signal)
+{
+	ccv_nnc_stream_signal_t* const stream_signal = (ccv_nnc_stream_signal_t*)signal;
+	pthread_mutex_lock(&stream_signal->mutex);
+	++stream_signal->emit_count;
+	if (!_ccv_nnc_stream_context_is_async(stream_context))
+	{
+		// No stream (or from within the stream), everything before this point is done already.
+		++stream_signal->fire_count;
+		pthread_cond_broadcast(&stream_signal->notify);
+		pthread_mutex_unlock(&stream_signal->mutex);
+		return;
+	}
+	pthread_mutex_unlock(&stream_signal->mutex);
+	ccv_nnc_stream_task_t* const task = (ccv_nnc_stream_task_t*)cccalloc(1, sizeof(ccv_nnc_stream_task_t));
+	task->type = CCV_NNC_STREAM_TASK_EMIT_SIGNAL;
+	task->signal = stream_signal;
+	_ccv_nnc_stream_task_push((ccv_nnc_stream_context_t*)stream_context, task);
+}
+
+void ccv_nnc_stream_context_wait_signal(const ccv_nnc_stream_context_t* const stream_context, const ccv_nnc_stream_signal_t* const signal)
+{
+	ccv_nnc_stream_signal_t* const stream_signal = (ccv_nnc_stream_signal_t*)signal;
+	pthread_mutex_lock(&stream_signal->mutex);
+	// Wait for the latest emission at the time of the call, the same as cudaStreamWaitEvent.
+	const uint64_t count = stream_signal->emit_count;
+	if (!_ccv_nnc_stream_context_is_async(stream_context))
+	{
+		while (stream_signal->fire_count < count)
+			pthread_cond_wait(&stream_signal->notify, &stream_signal->mutex);
+		pthread_mutex_unlock(&stream_signal->mutex);
+		return;
+	}
+	pthread_mutex_unlock(&stream_signal->mutex);
+	ccv_nnc_stream_task_t* const task = (ccv_nnc_stream_task_t*)cccalloc(1, sizeof(ccv_nnc_stream_task_t));
+	task->type = CCV_NNC_STREAM_TASK_WAIT_SIGNAL;
+	task->signal = stream_signal;
+	task->count = count;
+	_ccv_nnc_stream_task_push((ccv_nnc_stream_context_t*)stream_context, task);
+}
+
+void ccv_nnc_stream_signal_free(ccv_nnc_stream_signal_t* const signal)
+{
+	pthread_cond_destroy(&signal->notify);
+	pthread_mutex_destroy(&signal->mutex);
+	ccfree(signal);
+}
@@ -55,6 +55,9 @@
 #define GRAPH_EXEC_SYMBOL_LIST_X(...) (ccv_nnc_graph_exec_symbol_t []){__VA_ARGS__}
 #define GRAPH_EXEC_SYMBOL_LIST(...) GRAPH_EXEC_SYMBOL_LIST_X(__VA_ARGS__), LIST_COUNT(__VA_ARGS__)
 
+#define COLUMN_ID_LIST_X(...) (int []){__VA_ARGS__}
+#define COLUMN_ID_LIST(...) COLUMN_ID_LIST_X(__VA_ARGS__), LIST_COUNT(__VA_ARGS__)
+
 #define SYMBOLIC_GRAPH_SOURCES(x) ccv_nnc_symbolic_graph_sources(x), ccv_nnc_symbolic_graph_source_size(x)
 #define SYMBOLIC_GRAPH_DESTINATIONS(x) ccv_nnc_symbolic_graph_destinations(x), ccv_nnc_symbolic_graph_destination_size(x)
 
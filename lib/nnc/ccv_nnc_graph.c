@@ -1186,6 +1186,10 @@ void ccv_nnc_graph_free(ccv_nnc_graph_t* const graph)
 			ccv_nnc_graph_free(*(ccv_nnc_graph_t**)ccv_array_get(graph->sub_graphs, i));
 		ccv_array_free(graph->sub_graphs);
 	}
+	if (graph->scheduler)
+		ccv_nnc_graph_scheduler_free(graph->scheduler);
+	if (graph->profile)
+		ccv_array_free(graph->profile);
 	ccv_array_free(graph->exec_info);
 	ccfree(graph);
 }
@@ -3,6 +3,8 @@
 #include "ccv_nnc_internal.h"
 #include "ccv_internal.h"
 #include "_ccv_nnc_graph.h"
+#include <pthread.h>
+#include <unistd.h>
 
 static void _ccv_nnc_unwrap_tensor_wrap(const ccv_nnc_graph_t* const graph, const int64_t count, const int64_t reverse_count, ccv_nnc_graph_tensor_wrap_t* const tensor_wrap)
 {
@@ -222,17 +224,74 @@ static void _ccv_nnc_print_tensor_verbose(const ccv_nnc_tensor_t* const tensor)
 
 static int _ccv_nnc_graph_run(ccv_nnc_graph_t* const graph, const int exec_idx, const ccv_nnc_graph_exec_info_t* const exec, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags, const ccv_nnc_graph_exec_t* const sources, const int source_size, const ccv_nnc_graph_exec_t* const destinations, const int destination_size);
 
-static inline void _ccv_nnc_graph_exec_run(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const node, const int idx, const int depth, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags)
+// Execs can run on the scheduler's workers concurrently, the profile is appended under this lock.
+static pthread_mutex_t profile_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t _ccv_nnc_tensor_profile_size(const ccv_nnc_tensor_t* const tensor)
+{
+	return (uint64_t)ccv_nnc_tensor_count(tensor->info) * CCV_GET_DATA_TYPE_SIZE(tensor->info.datatype);
+}
+
+static void _ccv_nnc_graph_exec_profile(ccv_nnc_graph_t* const graph, const ccv_nnc_graph_exec_info_t* const node, const int idx, const uint64_t start, const uint64_t elapsed)
 {
+	ccv_nnc_graph_profile_entry_t entry = {
+		.exec = {
+			.d = idx,
+			.graph = graph,
+		},
+		.cmd = node->cmd.cmd,
+		.backend = node->cmd.backend,
+		.thread = (uint64_t)(uintptr_t)pthread_self(),
+		.start = start,
+		.elapsed = elapsed,
+	};
+	ccv_nnc_tensor_t* const* const inputs = node->inputs;
+	ccv_nnc_tensor_t* const* const outputs = inputs + node->input_size;
 	int i;
+	int tensor_memory = 0, tensor_formats = 0, tensor_datatypes = 0;
+	for (i = 0; i < node->input_size; i++)
+		if (inputs[i] && !CCV_IS_TENSOR_MULTIVIEW(inputs[i]))
+		{
+			entry.bytes_read += _ccv_nnc_tensor_profile_size(inputs[i]);
+			tensor_memory |= CCV_TENSOR_GET_MEMORY(inputs[i]->info.type), tensor_formats |= inputs[i]->info.format, tensor_datatypes |= inputs[i]->info.datatype;
+		}
+	for (i = 0; i < node->output_size; i++)
+		if (outputs[i] && !CCV_IS_TENSOR_MULTIVIEW(outputs[i]))
+		{
+			entry.bytes_written += _ccv_nnc_tensor_profile_size(outputs[i]);
+			tensor_memory |= CCV_TENSOR_GET_MEMORY(outputs[i]->info.type), tensor_formats |= outputs[i]->info.format, tensor_datatypes |= outputs[i]->info.datatype;
+		}
+	// Record the backend ccv_nnc_cmd_exec picked if the cmd doesn't carry one.
+	if (entry.backend == CCV_NNC_NO_BACKEND && tensor_memory &&
+		entry.cmd != CCV_NNC_NOOP && entry.cmd != CCV_NNC_CUSTOM_FORWARD && entry.cmd != CCV_NNC_CUSTOM_BACKWARD)
+		entry.backend = ccv_nnc_cmd_find_backend(node->cmd, tensor_memory, tensor_formats, tensor_datatypes);
+	// Collect on the root graph.
+	ccv_nnc_graph_t* root = graph;
+	while (root->p)
+		root = root->p;
+	pthread_mutex_lock(&profile_mutex);
+	if (!root->profile)
+		root->profile = ccv_array_new(sizeof(ccv_nnc_graph_profile_entry_t), root->exec_info->rnum, 0);
+	ccv_array_push(root->profile, &entry);
+	pthread_mutex_unlock(&profile_mutex);
+}
+
+static inline void _ccv_nnc_graph_exec_prepare(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const node, ccv_nnc_tensor_tape_t* const tensor_tape)
+{
 	_ccv_nnc_graph_exec_unwrap_io(graph, node);
-	ccv_nnc_tensor_t** inputs = node->inputs;
-	ccv_nnc_tensor_t** outputs = inputs + node->input_size;
 	if (tensor_tape)
-		ccv_nnc_tensor_tape_io(tensor_tape, graph, node->input_flags, inputs, node->input_size, node->output_flags, outputs, node->output_size);
+		ccv_nnc_tensor_tape_io(tensor_tape, graph, node->input_flags, node->inputs, node->input_size, node->output_flags, node->inputs + node->input_size, node->output_size);
 	/* Broadcast the updates to all subscribed references for input / output, even though at th
 	 * time output is not written yet, propagate pointer change is still valid. */
 	_ccv_nnc_graph_exec_begin_synchronize_multiviews(graph, node);
+}
+
+// Execute the node after _ccv_nnc_graph_exec_prepare.
+static inline void _ccv_nnc_graph_exec_run_prepared(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const node, const int idx, const int depth, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags)
+{
+	int i;
+	ccv_nnc_tensor_t** inputs = node->inputs;
+	ccv_nnc_tensor_t** outputs = inputs + node->input_size;
 	if (node->cmd.cmd == CCV_NNC_GRAPH_FORWARD || node->cmd.cmd == CCV_NNC_GRAPH_BACKWARD)
 	{
 		if (node->flags & CCV_NNC_GRAPH_EXEC_CASE_OF)
@@ -274,7 +333,10 @@ static inline void _ccv_nnc_graph_exec_run(ccv_nnc_graph_t* const graph, ccv_nnc
 				_ccv_nnc_print_tensor_verbose(inputs[i]);
 			PRINT(CCV_CLI_VERBOSE, "\n");
 		}
-		ccv_nnc_cmd_exec(node->cmd, node->hint, flags, inputs, node->input_size, outputs, node->output_size, 0);
+		const uint64_t start = (flags & CCV_NNC_GRAPH_RUN_PROFILE) ? ccv_nnc_cmd_mono_time() : 0;
+		ccv_nnc_cmd_exec(node->cmd, node->hint, flags & ~CCV_NNC_GRAPH_RUN_PROFILE, inputs, node->input_size, outputs, node->output_size, 0);
+		if (flags & CCV_NNC_GRAPH_RUN_PROFILE)
+			_ccv_nnc_graph_exec_profile(graph, node, idx, start, ccv_nnc_cmd_mono_time() - start);
 		for (i = 0; i < node->output_size; i++)
 		{
 			PRINT(CCV_CLI_VERBOSE, "|<- %d. %p (%p)", i + 1, outputs[i], (outputs[i] ? outputs[i]->data.u8 : 0));
@@ -285,6 +347,12 @@ static inline void _ccv_nnc_graph_exec_run(ccv_nnc_graph_t* const graph, ccv_nnc
 	}
 }
 
+static inline void _ccv_nnc_graph_exec_run(ccv_nnc_graph_t* const graph, ccv_nnc_graph_exec_info_t* const node, const int idx, const int depth, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags)
+{
+	_ccv_nnc_graph_exec_prepare(graph, node, tensor_tape);
+	_ccv_nnc_graph_exec_run_prepared(graph, node, idx, depth, tensor_tape, flags);
+}
+
 static int _ccv_nnc_graph_run(ccv_nnc_graph_t* const graph, const int exec_idx, const ccv_nnc_graph_exec_info_t* const exec, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags, const ccv_nnc_graph_exec_t* const sources, const int source_size, const ccv_nnc_graph_exec_t* const destinations, const int destination_size)
 {
 	assert((sources == 0 && source_size == 0) || (sources && source_size));
@@ -433,7 +501,362 @@ static int _ccv_nnc_graph_run(ccv_nnc_graph_t* const graph, const int exec_idx,
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
+// Parallel run, nodes are scheduled once all their incoming nodes are done.
+
+typedef struct {
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_tape_t* tensor_tape;
+	int flags;
+	int* incomings; // Number of unfinished incoming nodes, -1 if the node is not part of this run.
+	int remain; // Number of nodes not finished yet.
+	int ready; // Number of nodes in the queues.
+	int* queues; // One queue per worker, each one is large enough to hold every node of the graph.
+	int* heads;
+	int* tails;
+	// Tensor tape, multi-view tensors and sub-graphs are not thread-safe, these are guarded with this lock.
+	pthread_mutex_t exclusive;
+} ccv_nnc_graph_parallel_run_t;
+
+typedef struct {
+	ccv_nnc_graph_scheduler_t* scheduler;
+	int idx;
+} ccv_nnc_graph_worker_t;
+
+struct ccv_nnc_graph_scheduler_s {
+	int worker_size; // The caller of ccv_nnc_graph_run is the worker 0.
+	pthread_t* threads;
+	ccv_nnc_graph_worker_t* workers;
+	pthread_mutex_t mutex;
+	pthread_cond_t notify; // Signaled when a run starts, a node is ready or a run finishes.
+	pthread_cond_t done; // Signaled when a worker leaves a run.
+	int destroying;
+	int active; // Number of helper workers inside the current run.
+	uint64_t generation; // Increment for every run.
+	ccv_nnc_graph_parallel_run_t* run;
+};
+
+static void _ccv_nnc_graph_parallel_exec(ccv_nnc_graph_parallel_run_t* const run, ccv_nnc_graph_exec_info_t* const node, const int idx)
+{
+	ccv_nnc_graph_t* const graph = run->graph;
+	ccv_nnc_tensor_tape_t* const tensor_tape = run->tensor_tape;
+	if (node->cmd.cmd == CCV_NNC_GRAPH_FORWARD || node->cmd.cmd == CCV_NNC_GRAPH_BACKWARD)
+	{
+		// The sub-graph runs serially, as a whole.
+		pthread_mutex_lock(&run->exclusive);
+		_ccv_nnc_graph_exec_run(graph, node, idx, 0, tensor_tape, run->flags);
+		pthread_mutex_unlock(&run->exclusive);
+	} else if (tensor_tape || node->tensor_wrap_size) {
+		pthread_mutex_lock(&run->exclusive);
+		_ccv_nnc_graph_exec_prepare(graph, node, tensor_tape);
+		pthread_mutex_unlock(&run->exclusive);
+		_ccv_nnc_graph_exec_run_prepared(graph, node, idx, 0, tensor_tape, run->flags);
+	} else
+		_ccv_nnc_graph_exec_run(graph, node, idx, 0, tensor_tape, run->flags);
+}
+
+// Must be called with scheduler->mutex locked. Returns when every node of the run is finished.
+static void _ccv_nnc_graph_parallel_work(ccv_nnc_graph_scheduler_t* const scheduler, ccv_nnc_graph_parallel_run_t* const run, const int worker)
+{
+	const int worker_size = scheduler->worker_size;
+	const int exec_info_size = run->graph->exec_info->rnum;
+	int* const queue = run->queues + worker * exec_info_size;
+	int i;
+	while (run->remain > 0)
+	{
+		if (!run->ready)
+		{
+			pthread_cond_wait(&scheduler->notify, &scheduler->mutex);
+			continue;
+		}
+		int idx = -1;
+		if (run->tails[worker] > run->heads[worker])
+			idx = queue[--run->tails[worker]]; // Take the latest from its own queue, it is the most likely to have inputs in cache.
+		else
+			for (i = 1; i < worker_size && idx < 0; i++)
+			{
+				// Steal the oldest from others.
+				const int victim = (worker + i) % worker_size;
+				if (run->tails[victim] > run->heads[victim])
+					idx = run->queues[victim * exec_info_size + run->heads[victim]++];
+			}
+		assert(idx >= 0);
+		--run->ready;
+		pthread_mutex_unlock(&scheduler->mutex);
+		ccv_nnc_graph_exec_info_t* const node = (ccv_nnc_graph_exec_info_t*)ccv_array_get(run->graph->exec_info, idx);
+		_ccv_nnc_graph_parallel_exec(run, node, idx);
+		pthread_mutex_lock(&scheduler->mutex);
+		if (node->outgoings)
+			for (i = 0; i < node->outgoings->rnum; i++)
+			{
+				const int d = *(int*)ccv_array_get(node->outgoings, i);
+				if (run->incomings[d] > 0 && --run->incomings[d] == 0)
+				{
+					queue[run->tails[worker]++] = d;
+					++run->ready;
+					pthread_cond_signal(&scheduler->notify);
+				}
+			}
+		if (--run->remain == 0)
+			pthread_cond_broadcast(&scheduler->notify);
+	}
+}
+
+static void* _ccv_nnc_graph_scheduler_main(void* const context)
+{
+	ccv_nnc_graph_worker_t* const worker = (ccv_nnc_graph_worker_t*)context;
+	ccv_nnc_graph_scheduler_t* const scheduler = worker->scheduler;
+	uint64_t generation = 0;
+	pthread_mutex_lock(&scheduler->mutex);
+	for (;;)
+	{
+		while (!scheduler->destroying && (!scheduler->run || scheduler->generation == generation))
+			pthread_cond_wait(&scheduler->notify, &scheduler->mutex);
+		if (scheduler->destroying)
+			break;
+		generation = scheduler->generation;
+		++scheduler->active;
+		_ccv_nnc_graph_parallel_work(scheduler, scheduler->run, worker->idx);
+		if (--scheduler->active == 0)
+			pthread_cond_signal(&scheduler->done);
+	}
+	pthread_mutex_unlock(&scheduler->mutex);
+	return 0;
+}
+
+static ccv_nnc_graph_scheduler_t* _ccv_nnc_graph_scheduler_new(const int worker_size)
+{
+	ccv_nnc_graph_scheduler_t* const scheduler = (ccv_nnc_graph_scheduler_t*)cccalloc(1, sizeof(ccv_nnc_graph_scheduler_t) + (sizeof(pthread_t) + sizeof(ccv_nnc_graph_worker_t)) * (worker_size - 1));
+	scheduler->worker_size = worker_size;
+	scheduler->threads = (pthread_t*)(scheduler + 1);
+	scheduler->workers = (ccv_nnc_graph_worker_t*)(scheduler->threads + worker_size - 1);
+	pthread_mutex_init(&scheduler->mutex, 0);
+	pthread_cond_init(&scheduler->notify, 0);
+	pthread_cond_init(&scheduler->done, 0);
+	int i;
+	for (i = 0; i < worker_size - 1; i++)
+	{
+		scheduler->workers[i].scheduler = scheduler;
+		scheduler->workers[i].idx = i + 1;
+		pthread_create(scheduler->threads + i, 0, _ccv_nnc_graph_scheduler_main, scheduler->workers + i);
+	}
+	return scheduler;
+}
+
+void ccv_nnc_graph_scheduler_free(ccv_nnc_graph_scheduler_t* const scheduler)
+{
+	pthread_mutex_lock(&scheduler->mutex);
+	scheduler->destroying = 1;
+	pthread_cond_broadcast(&scheduler->notify);
+	pthread_mutex_unlock(&scheduler->mutex);
+	int i;
+	for (i = 0; i < scheduler->worker_size - 1; i++)
+		pthread_join(scheduler->threads[i], 0);
+	pthread_cond_destroy(&scheduler->done);
+	pthread_cond_destroy(&scheduler->notify);
+	pthread_mutex_destroy(&scheduler->mutex);
+	ccfree(scheduler);
+}
+
+void ccv_nnc_graph_set_worker_size(ccv_nnc_graph_t* const graph, const int worker_size)
+{
+	assert(worker_size >= 0);
+	graph->worker_size = worker_size;
+	if (graph->scheduler && graph->scheduler->worker_size != worker_size)
+	{
+		ccv_nnc_graph_scheduler_free(graph->scheduler);
+		graph->scheduler = 0;
+	}
+}
+
+static int _ccv_nnc_graph_run_parallel(ccv_nnc_graph_t* const graph, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags, const ccv_nnc_graph_exec_t* const sources, const int source_size, const ccv_nnc_graph_exec_t* const destinations, const int destination_size)
+{
+	const int worker_size = graph->worker_size > 0 ? graph->worker_size : (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (worker_size <= 1)
+		return _ccv_nnc_graph_run(graph, -1, 0, 0, 0, 0, 0, tensor_tape, flags, sources, source_size, destinations, destination_size);
+	assert((sources == 0 && source_size == 0) || (sources && source_size));
+	assert((destinations == 0 && destination_size == 0) || (destinations && destination_size));
+	const ccv_nnc_graph_exec_t* const graph_sources = sources ? sources : (ccv_nnc_graph_exec_t*)ccv_array_get(graph->sources, 0);
+	const int graph_source_size = source_size ? source_size : graph->sources->rnum;
+	const ccv_nnc_graph_exec_t* const graph_destinations = destinations ? destinations : (ccv_nnc_graph_exec_t*)ccv_array_get(graph->destinations, 0);
+	const int graph_destination_size = destination_size ? destination_size : graph->destinations->rnum;
+	int i, j;
+	for (i = 0; i < graph_source_size; i++)
+		if (graph_sources[i].graph != graph)
+			return CCV_NNC_EXEC_INVALID;
+	for (i = 0; i < graph_destination_size; i++)
+		if (graph_destinations[i].graph != graph)
+			return CCV_NNC_EXEC_INVALID;
+	const int exec_info_size = graph->exec_info->rnum;
+	ccv_nnc_graph_exec_info_t* const exec_info = (ccv_nnc_graph_exec_info_t*)ccv_array_get(graph->exec_info, 0);
+	ccv_nnc_graph_visit_t* const visit = ccv_nnc_graph_visit_new(graph, exec_info, exec_info_size, graph_sources, graph_source_size, graph_destinations, graph_destination_size, 0);
+	ccv_nnc_graph_parallel_run_t run = {
+		.graph = graph,
+		.tensor_tape = tensor_tape,
+		.flags = flags,
+		.remain = visit->size,
+	};
+	run.incomings = (int*)ccmalloc(sizeof(int) * (exec_info_size * (worker_size + 1) + worker_size * 2));
+	run.queues = run.incomings + exec_info_size;
+	run.heads = run.queues + exec_info_size * worker_size;
+	run.tails = run.heads + worker_size;
+	for (i = 0; i < exec_info_size; i++)
+		run.incomings[i] = -1;
+	ccv_nnc_graph_visit_for(visit, exec_info, node, idx) {
+		run.incomings[idx] = 0;
+	} ccv_nnc_graph_visit_endfor
+	ccv_nnc_graph_visit_for(visit, exec_info, node) {
+		if (node->outgoings)
+			for (i = 0; i < node->outgoings->rnum; i++)
+			{
+				const int d = *(int*)ccv_array_get(node->outgoings, i);
+				if (run.incomings[d] >= 0)
+					++run.incomings[d];
+			}
+	} ccv_nnc_graph_visit_endfor
+	for (i = 0; i < worker_size; i++)
+		run.heads[i] = run.tails[i] = 0;
+	// Distribute the nodes without incoming nodes to the workers.
+	j = 0;
+	ccv_nnc_graph_visit_for(visit, exec_info, node, idx) {
+		if (run.incomings[idx] == 0)
+		{
+			run.queues[j * exec_info_size + run.tails[j]++] = idx;
+			++run.ready;
+			j = (j + 1) % worker_size;
+		}
+	} ccv_nnc_graph_visit_endfor
+	ccv_nnc_graph_visit_free(visit);
+	pthread_mutex_init(&run.exclusive, 0);
+	if (graph->scheduler && graph->scheduler->worker_size != worker_size)
+	{
+		ccv_nnc_graph_scheduler_free(graph->scheduler);
+		graph->scheduler = 0;
+	}
+	if (!graph->scheduler)
+		graph->scheduler = _ccv_nnc_graph_scheduler_new(worker_size);
+	ccv_nnc_graph_scheduler_t* const scheduler = graph->scheduler;
+	graph->while_count = 0;
+	pthread_mutex_lock(&scheduler->mutex);
+	scheduler->run = &run;
+	++scheduler->generation;
+	pthread_cond_broadcast(&scheduler->notify);
+	_ccv_nnc_graph_parallel_work(scheduler, &run, 0);
+	// Wait for all helpers to leave before tear down the run.
+	while (scheduler->active > 0)
+		pthread_cond_wait(&scheduler->done, &scheduler->mutex);
+	scheduler->run = 0;
+	pthread_mutex_unlock(&scheduler->mutex);
+	pthread_mutex_destroy(&run.exclusive);
+	ccfree(run.incomings);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
 int ccv_nnc_graph_run(ccv_nnc_graph_t* const graph, ccv_nnc_tensor_tape_t* const tensor_tape, const int flags, const ccv_nnc_graph_exec_t* const sources, const int source_size, const ccv_nnc_graph_exec_t* const destinations, const int destination_size)
 {
+	if (flags & CCV_NNC_GRAPH_RUN_PARALLEL)
+		return _ccv_nnc_graph_run_parallel(graph, tensor_tape, flags & ~CCV_NNC_GRAPH_RUN_PARALLEL, sources, source_size, destinations, destination_size);
 	return _ccv_nnc_graph_run(graph, -1, 0, 0, 0, 0, 0, tensor_tape, flags, sources, source_size, destinations, destination_size);
 }
+
+int ccv_nnc_graph_profile_entry_size(const ccv_nnc_graph_t* const graph)
+{
+	return graph->profile ? graph->profile->rnum : 0;
+}
+
+const ccv_nnc_graph_profile_entry_t* ccv_nnc_graph_profile_entries(const ccv_nnc_graph_t* const graph)
+{
+	return graph->profile && graph->profile->rnum ? (ccv_nnc_graph_profile_entry_t*)ccv_array_get(graph->profile, 0) : 0;
+}
+
+void ccv_nnc_graph_profile_clear(ccv_nnc_graph_t* const graph)
+{
+	if (graph->profile)
+		ccv_array_clear(graph->profile);
+}
+
+void ccv_nnc_graph_profile_trace(const ccv_nnc_graph_t* const graph, FILE* out)
+{
+	const int entry_size = ccv_nnc_graph_profile_entry_size(graph);
+	const ccv_nnc_graph_profile_entry_t* const entries = ccv_nnc_graph_profile_entries(graph);
+	int i, j;
+	uint64_t origin = 0;
+	for (i = 0; i < entry_size; i++)
+		if (i == 0 || entries[i].start < origin)
+			origin = entries[i].start;
+	// Chrome tracing expects small thread ids, number threads in the order they show up.
+	uint64_t* const threads = entry_size > 0 ? (uint64_t*)ccmalloc(sizeof(uint64_t) * entry_size) : 0;
+	int thread_size = 0;
+	fputs("{\"traceEvents\":[", out);
+	for (i = 0; i < entry_size; i++)
+	{
+		for (j = 0; j < thread_size && threads[j] != entries[i].thread; j++);
+		if (j == thread_size)
+			threads[thread_size++] = entries[i].thread;
+		fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3lf,\"dur\":%.3lf,"
+			"\"args\":{\"exec\":%d,\"graph\":\"%p\",\"bytes_read\":%llu,\"bytes_written\":%llu}}",
+			i > 0 ? "," : "", ccv_nnc_cmd_name(entries[i].cmd), ccv_nnc_cmd_backend_name(entries[i].backend), j,
+			(entries[i].start - origin) * 1e-3, entries[i].elapsed * 1e-3, entries[i].exec.d, entries[i].exec.graph,
+			(unsigned long long)entries[i].bytes_read, (unsigned long long)entries[i].bytes_written);
+	}
+	fputs("\n],\"displayTimeUnit\":\"ms\"}\n", out);
+	if (threads)
+		ccfree(threads);
+}
+
+typedef struct {
+	uint32_t cmd;
+	uint32_t backend;
+	int count;
+	uint64_t elapsed;
+	uint64_t bytes_read;
+	uint64_t bytes_written;
+} ccv_nnc_graph_profile_summary_t;
+
+#define more_than(i1, i2, aux) ((i1).elapsed > (i2).elapsed)
+static CCV_IMPLEMENT_QSORT(_ccv_nnc_graph_profile_summary_sort_by_elapsed, ccv_nnc_graph_profile_summary_t, more_than)
+#undef more_than
+
+void ccv_nnc_graph_profile_summary(const ccv_nnc_graph_t* const graph, FILE* out)
+{
+	const int entry_size = ccv_nnc_graph_profile_entry_size(graph);
+	const ccv_nnc_graph_profile_entry_t* const entries = ccv_nnc_graph_profile_entries(graph);
+	ccv_array_t* const summaries = ccv_array_new(sizeof(ccv_nnc_graph_profile_summary_t), 0, 0);
+	int i, j;
+	uint64_t total = 0;
+	for (i = 0; i < entry_size; i++)
+	{
+		ccv_nnc_graph_profile_summary_t* summary = 0;
+		for (j = 0; !summary && j < summaries->rnum; j++)
+		{
+			ccv_nnc_graph_profile_summary_t* const other = (ccv_nnc_graph_profile_summary_t*)ccv_array_get(summaries, j);
+			if (other->cmd == entries[i].cmd && other->backend == entries[i].backend)
+				summary = other;
+		}
+		if (!summary)
+		{
+			const ccv_nnc_graph_profile_summary_t new_summary = {
+				.cmd = entries[i].cmd,
+				.backend = entries[i].backend,
+			};
+			ccv_array_push(summaries, &new_summary);
+			summary = (ccv_nnc_graph_profile_summary_t*)ccv_array_get(summaries, summaries->rnum - 1);
+		}
+		++summary->count;
+		summary->elapsed += entries[i].elapsed;
+		summary->bytes_read += entries[i].bytes_read;
+		summary->bytes_written += entries[i].bytes_written;
+		total += entries[i].elapsed;
+	}
+	if (summaries->rnum > 1)
+		_ccv_nnc_graph_profile_summary_sort_by_elapsed((ccv_nnc_graph_profile_summary_t*)ccv_array_get(summaries, 0), summaries->rnum, 0);
+	fprintf(out, "%-40s %-24s %8s %12s %12s %7s %12s %12s\n", "command", "backend", "count", "total (ms)", "mean (us)", "%", "read (MiB)", "write (MiB)");
+	for (i = 0; i < summaries->rnum; i++)
+	{
+		const ccv_nnc_graph_profile_summary_t* const summary = (ccv_nnc_graph_profile_summary_t*)ccv_array_get(summaries, i);
+		fprintf(out, "%-40s %-24s %8d %12.3lf %12.3lf %6.2lf%% %12.3lf %12.3lf\n", ccv_nnc_cmd_name(summary->cmd), ccv_nnc_cmd_backend_name(summary->backend), summary->count,
+			summary->elapsed * 1e-6, summary->elapsed * 1e-3 / summary->count, total ? summary->elapsed * 100.0 / total : 0,
+			summary->bytes_read / (1024.0 * 1024.0), summary->bytes_written / (1024.0 * 1024.0));
+	}
+	fprintf(out, "%-40s %-24s %8d %12.3lf\n", "total", "", entry_size, total * 1e-6);
+	ccv_array_free(summaries);
+}
@@ -1295,6 +1295,16 @@ int ccv_nnc_symbolic_graph_destination_size(const ccv_nnc_symbolic_graph_t* cons
 	return graph->destinations ? graph->destinations->rnum : 0;
 }
 
+void ccv_nnc_symbolic_graph_set_compile_flags(ccv_nnc_symbolic_graph_t* const graph, const int flags)
+{
+	graph->compile_flags = flags;
+}
+
+int ccv_nnc_symbolic_graph_compile_flags(const ccv_nnc_symbolic_graph_t* const graph)
+{
+	return graph->compile_flags;
+}
+
 static void _ccv_nnc_symbolic_graph_dot_exec_symbol(const int index, const ccv_nnc_graph_exec_symbol_info_t* const symbol_info, const int flags, FILE* out)
 {
 	if (flags == CCV_NNC_LONG_DOT_GRAPH)
@@ -0,0 +1,281 @@
+#include "ccv_nnc.h"
+#include "ccv_nnc_easy.h"
+#include "ccv_nnc_internal.h"
+#include "ccv_internal.h"
+#include "_ccv_nnc_symbolic_graph.h"
+
+/**
+ * Level-3.5 API
+ */
+
+// Whether the exec can run a second time and produce the same outputs.
+static int _ccv_nnc_symbolic_graph_checkpoint_exec_is_recomputable(const ccv_nnc_graph_exec_symbol_info_t* const exec_info)
+{
+	if (exec_info->output_size <= 0 || exec_info->cmd.cmd == CCV_NNC_NOOP || !ccv_nnc_graph_exec_symbol_is_deterministic(exec_info))
+		return 0;
+	int i, j;
+	// In-place execs overwrite their inputs, there is nothing left to recompute from.
+	for (i = 0; i < exec_info->output_size; i++)
+		if (exec_info->outputs[i] >= 0)
+			for (j = 0; j < exec_info->input_size; j++)
+				if (exec_info->inputs[j] == exec_info->outputs[i])
+					return 0;
+	return 1;
+}
+
+void ccv_nnc_symbolic_graph_checkpoint(ccv_nnc_symbolic_graph_t* const graph, const int segment_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size)
+{
+	// New symbols are appended (or take the dead slots) as we go, everything below is about the graph as it is now.
+	const int exec_symbol_info_size = graph->exec_symbol_info->rnum;
+	const int tensor_symbol_info_size = graph->tensor_symbol_info->rnum;
+	int i, j, k;
+	ccv_array_t* const forward_execs = ccv_array_new(sizeof(int), 0, 0);
+	ccv_nnc_graph_visit_t* const visit = ccv_nnc_graph_visit_new(graph, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), exec_symbol_info_size, sources, source_size, destinations, destination_size, 0);
+	ccv_nnc_graph_visit_for(visit, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), node, idx) {
+		ccv_array_push(forward_execs, &idx);
+	} ccv_nnc_graph_visit_endfor
+	ccv_nnc_graph_visit_free(visit);
+	const int segment_exec_size = segment_size > 0 ? segment_size : ccv_max(1, (int)ceil(sqrt(forward_execs->rnum)));
+	const int segment_count = (forward_execs->rnum + segment_exec_size - 1) / segment_exec_size;
+	if (segment_count <= 1)
+	{
+		ccv_array_free(forward_execs);
+		return;
+	}
+	// The segment of each forward exec, -1 for the rest.
+	int* const exec_segment = (int*)ccmalloc(sizeof(int) * (exec_symbol_info_size + tensor_symbol_info_size * 4));
+	// The segment of the forward exec that writes the tensor, the forward exec itself, whether it can be recomputed,
+	// and the tensor that is recomputed in its place.
+	int* const tensor_segment = exec_segment + exec_symbol_info_size;
+	int* const tensor_exec = tensor_segment + tensor_symbol_info_size;
+	int* const recomputable = tensor_exec + tensor_symbol_info_size;
+	int* const recomputed = recomputable + tensor_symbol_info_size;
+	for (i = 0; i < exec_symbol_info_size; i++)
+		exec_segment[i] = -1;
+	for (i = 0; i < tensor_symbol_info_size; i++)
+		tensor_segment[i] = tensor_exec[i] = recomputed[i] = -1, recomputable[i] = 0;
+	for (i = 0; i < forward_execs->rnum; i++)
+	{
+		const int idx = *(int*)ccv_array_get(forward_execs, i);
+		const int segment = exec_segment[idx] = i / segment_exec_size;
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		const int exec_is_recomputable = _ccv_nnc_symbolic_graph_checkpoint_exec_is_recomputable(exec_info);
+		for (j = 0; j < exec_info->output_size; j++)
+		{
+			const int d = exec_info->outputs[j];
+			if (d < 0)
+				continue;
+			// Written twice in the forward pass, keep it.
+			recomputable[d] = (tensor_exec[d] < 0 && exec_is_recomputable && segment < segment_count - 1);
+			tensor_segment[d] = segment;
+			tensor_exec[d] = idx;
+		}
+	}
+	for (i = 0; i < tensor_symbol_info_size; i++)
+	{
+		const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, i);
+		// Aliases and the tensors they point to, carry overs (for while), bypasses (for case..of), tape variables and
+		// tensors shared with sub-graphs are kept.
+		if (symbol_info->alias_ref)
+			recomputable[i] = recomputable[symbol_info->alias_ref - 1] = 0;
+		if (symbol_info->assign_ref || symbol_info->r_assign_ref || symbol_info->bypass_ref || symbol_info->r_bypass_ref ||
+			symbol_info->p_ref || (symbol_info->s_ref && symbol_info->s_ref->rnum) || (symbol_info->flags & CCV_NNC_TENSOR_SYMBOL_TAPE_VAR))
+			recomputable[i] = 0;
+	}
+	// The tensors read by a later segment are the checkpoints, and the ones written outside of the forward pass are kept.
+	for (i = 0; i < exec_symbol_info_size; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(exec_info->flags))
+			continue;
+		if (exec_segment[i] >= 0)
+		{
+			for (j = 0; j < exec_info->input_size; j++)
+				if (exec_info->inputs[j] >= 0 && tensor_segment[exec_info->inputs[j]] < exec_segment[i])
+					recomputable[exec_info->inputs[j]] = 0;
+		} else {
+			for (j = 0; j < exec_info->output_size; j++)
+				if (exec_info->outputs[j] >= 0)
+					recomputable[exec_info->outputs[j]] = 0;
+		}
+	}
+	// The execs after the forward pass (backward execs, minimizers etc.), and the latest segment of the activations they read.
+	int* const after_segment = (int*)ccmalloc(sizeof(int) * exec_symbol_info_size);
+	for (i = 0; i < exec_symbol_info_size; i++)
+		after_segment[i] = -2;
+	// The backward execs are concatenated right after their forward execs, walk down from all of them.
+	ccv_array_t* const stack = ccv_array_new(sizeof(int), forward_execs->rnum, 0);
+	for (i = 0; i < forward_execs->rnum; i++)
+		ccv_array_push(stack, ccv_array_get(forward_execs, i));
+	while (stack->rnum > 0)
+	{
+		const int idx = *(int*)ccv_array_get(stack, stack->rnum - 1);
+		--stack->rnum;
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		for (i = 0; exec_info->outgoings && i < exec_info->outgoings->rnum; i++)
+		{
+			const int outgoing = *(int*)ccv_array_get(exec_info->outgoings, i);
+			if (exec_segment[outgoing] >= 0 || after_segment[outgoing] > -2)
+				continue;
+			const ccv_nnc_graph_exec_symbol_info_t* const outgoing_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, outgoing);
+			int segment = -1;
+			for (j = 0; j < outgoing_info->input_size; j++)
+				if (outgoing_info->inputs[j] >= 0)
+				{
+					const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, outgoing_info->inputs[j]);
+					const int d = symbol_info->alias_ref ? symbol_info->alias_ref - 1 : outgoing_info->inputs[j];
+					segment = ccv_max(segment, tensor_segment[d]);
+				}
+			after_segment[outgoing] = segment;
+			ccv_array_push(stack, &outgoing);
+		}
+	}
+	ccv_array_free(stack);
+	// Mark the activations to recompute: the ones these execs read from their latest segment, and going up the segment,
+	// the inputs needed to compute them.
+	uint8_t* const exec_recompute = (uint8_t*)cccalloc(exec_symbol_info_size + tensor_symbol_info_size, sizeof(uint8_t));
+	uint8_t* const tensor_recompute = exec_recompute + exec_symbol_info_size;
+	for (i = 0; i < exec_symbol_info_size; i++)
+		if (after_segment[i] >= 0)
+		{
+			const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+			for (j = 0; j < exec_info->input_size; j++)
+			{
+				const int d = exec_info->inputs[j];
+				if (d >= 0 && recomputable[d] && tensor_segment[d] == after_segment[i])
+					tensor_recompute[d] = 1;
+			}
+		}
+	for (i = forward_execs->rnum - 1; i >= 0; i--)
+	{
+		const int idx = *(int*)ccv_array_get(forward_execs, i);
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		for (j = 0; !exec_recompute[idx] && j < exec_info->output_size; j++)
+			if (exec_info->outputs[j] >= 0 && tensor_recompute[exec_info->outputs[j]])
+				exec_recompute[idx] = 1;
+		if (!exec_recompute[idx])
+			continue;
+		for (j = 0; j < exec_info->input_size; j++)
+		{
+			const int d = exec_info->inputs[j];
+			if (d >= 0 && recomputable[d] && tensor_segment[d] == exec_segment[idx])
+				tensor_recompute[d] = 1;
+		}
+	}
+	// Copy the execs over in topological order, with their outputs on new tensors.
+	ccv_array_t* const recompute_execs = ccv_array_new(sizeof(ccv_nnc_graph_exec_symbol_t), 0, 0);
+	int* const recompute_exec = (int*)ccmalloc(sizeof(int) * exec_symbol_info_size);
+	ccv_nnc_tensor_symbol_t inputs[CCV_NNC_MAX_DIM_ALLOC * 2];
+	ccv_nnc_tensor_symbol_t outputs[CCV_NNC_MAX_DIM_ALLOC * 2];
+	for (i = 0; i < exec_symbol_info_size; i++)
+		recompute_exec[i] = -1;
+	for (i = 0; i < forward_execs->rnum; i++)
+	{
+		const int idx = *(int*)ccv_array_get(forward_execs, i);
+		if (!exec_recompute[idx])
+			continue;
+		ccv_nnc_graph_exec_symbol_info_t exec_info = *(ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		if (exec_info.input_size > CCV_NNC_MAX_DIM_ALLOC * 2 || exec_info.output_size > CCV_NNC_MAX_DIM_ALLOC * 2)
+		{
+			// Cannot copy it over, the ones read afterwards are not recomputed then.
+			for (j = 0; j < exec_info.output_size; j++)
+				if (exec_info.outputs[j] >= 0)
+					tensor_recompute[exec_info.outputs[j]] = 0;
+			continue;
+		}
+		// Only the activations of this segment are read from the copies, the checkpoints are read as is.
+		for (j = 0; j < exec_info.input_size; j++)
+		{
+			const int d = exec_info.inputs[j];
+			inputs[j].d = d >= 0 && tensor_recompute[d] && recomputed[d] >= 0 ? recomputed[d] : d;
+			inputs[j].graph = graph;
+		}
+		for (j = 0; j < exec_info.output_size; j++)
+		{
+			const int d = exec_info.outputs[j];
+			if (d >= 0)
+			{
+				const ccv_nnc_tensor_param_t info = ((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, d))->info;
+				outputs[j] = ccv_nnc_tensor_symbol_new(graph, info, 0);
+				recomputed[d] = outputs[j].d;
+			} else
+				outputs[j] = NO_TENSOR_SYMBOL;
+		}
+		const ccv_nnc_graph_exec_symbol_t symbol = ccv_nnc_graph_exec_symbol_new(graph, exec_info.cmd, inputs, exec_info.input_size, outputs, exec_info.output_size, 0);
+		recompute_exec[idx] = symbol.d;
+		ccv_array_push(recompute_execs, &idx);
+		// Keep the backend / algorithm picked for the original exec.
+		ccv_nnc_graph_exec_symbol_info_t* const symbol_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, symbol.d);
+		symbol_info->cmd = exec_info.cmd;
+		symbol_info->hint = exec_info.hint;
+		for (j = 0; j < exec_info.input_size; j++)
+		{
+			const int d = exec_info.inputs[j];
+			if (d < 0 || tensor_exec[d] < 0)
+				continue;
+			const ccv_nnc_graph_exec_symbol_t from = {
+				.d = tensor_recompute[d] && recomputed[d] >= 0 ? recompute_exec[tensor_exec[d]] : tensor_exec[d],
+				.graph = graph,
+			};
+			ccv_nnc_graph_exec_symbol_concat(graph, from, symbol);
+		}
+	}
+	// Now the execs after the forward pass read the recomputed tensors.
+	for (i = 0; i < exec_symbol_info_size; i++)
+		if (after_segment[i] >= 0)
+		{
+			ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+			const ccv_nnc_graph_exec_symbol_t symbol = {
+				.d = i,
+				.graph = graph,
+			};
+			for (j = 0; j < exec_info->input_size; j++)
+			{
+				const int d = exec_info->inputs[j];
+				if (d < 0 || tensor_segment[d] != after_segment[i] || !tensor_recompute[d] || recomputed[d] < 0)
+					continue;
+				exec_info->inputs[j] = recomputed[d];
+				const ccv_nnc_graph_exec_symbol_t from = {
+					.d = recompute_exec[tensor_exec[d]],
+					.graph = graph,
+				};
+				ccv_nnc_graph_exec_symbol_concat(graph, from, symbol);
+			}
+		}
+	// Hold the recomputation of a segment til the execs reading the next segment are done, otherwise it
+	// runs right after the forward pass and saves nothing. The execs reading segment s only depend on the
+	// ones reading later segments, thus, there is no cycle.
+	for (i = 0; i < segment_count - 1; i++)
+	{
+		int next = -1;
+		for (j = i + 1; next < 0 && j < segment_count; j++)
+			for (k = 0; next < 0 && k < exec_symbol_info_size; k++)
+				if (after_segment[k] == j)
+					next = j;
+		if (next < 0)
+			break;
+		for (j = 0; j < recompute_execs->rnum; j++)
+		{
+			const int idx = *(int*)ccv_array_get(recompute_execs, j);
+			if (exec_segment[idx] != i)
+				continue;
+			const ccv_nnc_graph_exec_symbol_t symbol = {
+				.d = recompute_exec[idx],
+				.graph = graph,
+			};
+			for (k = 0; k < exec_symbol_info_size; k++)
+				if (after_segment[k] == next)
+					ccv_nnc_graph_exec_symbol_concat(graph, (ccv_nnc_graph_exec_symbol_t){
+						.d = k,
+						.graph = graph,
+					}, symbol);
+		}
+	}
+	ccv_array_free(recompute_execs);
+	ccfree(recompute_exec);
+	ccfree(exec_recompute);
+	ccfree(after_segment);
+	ccfree(exec_segment);
+	ccv_array_free(forward_execs);
+	ccv_nnc_graph_exec_symbol_autogen(graph, 0, 0, CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+}
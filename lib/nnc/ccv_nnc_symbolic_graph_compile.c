@@ -129,6 +129,165 @@ static int _ccv_nnc_tensor_block_head_after_tail(const ccv_sparse_matrix_t* cons
 	return _ccv_nnc_tensor_block_a_after_b_exclusively(exec_dep, a.head, b.tail);
 }
 
+typedef struct {
+	uint64_t offset;
+	uint64_t size;
+} ccv_nnc_tensor_range_t;
+
+#define less_than(r1, r2, aux) ((r1).offset < (r2).offset)
+static CCV_IMPLEMENT_QSORT(_ccv_nnc_tensor_range_sort_by_offset, ccv_nnc_tensor_range_t, less_than)
+#undef less_than
+
+typedef struct {
+	int type;
+	int unit;
+	uint64_t offset;
+} ccv_nnc_tensor_placed_t;
+
+#define less_than(p1, p2, aux) ((p1).type < (p2).type || ((p1).type == (p2).type && (p1).offset < (p2).offset))
+static CCV_IMPLEMENT_QSORT(_ccv_nnc_tensor_placed_sort_by_type_and_offset, ccv_nnc_tensor_placed_t, less_than)
+#undef less_than
+
+// Block a uses the memory of block b after b is done with it.
+static void _ccv_nnc_tensor_alloc_dep_add(const ccv_sparse_matrix_t* const exec_dep, const ccv_nnc_tensor_block_t* const tensor_blocks, const uint64_t* const allocated_offset, const int a, const int b, ccv_array_t** const alloc_dep)
+{
+	if (allocated_offset[b] < allocated_offset[a] + tensor_blocks[a].size && allocated_offset[a] < allocated_offset[b] + tensor_blocks[b].size &&
+		_ccv_nnc_tensor_block_head_after_tail(exec_dep, tensor_blocks[a], tensor_blocks[b]))
+	{
+		if (!alloc_dep[a])
+			alloc_dep[a] = ccv_array_new(sizeof(int), 1, 0);
+		ccv_array_add_unique_int(alloc_dep[a], b);
+	}
+}
+
+static int _ccv_nnc_tensor_blocks_interfere(const ccv_sparse_matrix_t* const tensor_itf, const int a, const int b)
+{
+	ccv_numeric_data_t cell = ccv_get_sparse_matrix_cell(tensor_itf, ccv_min(a, b), ccv_max(a, b));
+	return cell.u8 && cell.u8[0] == 1;
+}
+
+// Place the blocks from the largest to the smallest, each at the tightest gap left by the blocks it interferes with.
+// There is one buffer per type. Return 1 and replace the assignment if this needs less memory than the given one. Only
+// used with CCV_NNC_SYMBOLIC_GRAPH_COMPILE_BEST_FIT.
+static int _ccv_nnc_tensor_alloc_by_size(const ccv_sparse_matrix_t* const exec_dep, const ccv_nnc_tensor_block_t* const tensor_blocks, const int tensor_block_size, const ccv_sparse_matrix_t* const tensor_itf, int* const assigned, uint64_t* const allocated_offset, uint64_t* const allocated_size, int* const num_assigned_ref, ccv_array_t** const alloc_dep)
+{
+	int i, j;
+	// Blocks shared with the parent graph or the sub-graphs need the buffer structure the overlap based placement gives.
+	for (i = 0; i < tensor_block_size; i++)
+		if (TENSOR_EXPECT_COMPUTABLE(tensor_blocks[i]) && (tensor_blocks[i].p_refs[0] || tensor_blocks[i].dup_p_refs))
+			return 0;
+	ccv_nnc_tensor_opt_t* const units = (ccv_nnc_tensor_opt_t*)ccmalloc(sizeof(ccv_nnc_tensor_opt_t) * tensor_block_size);
+	int unit_size = 0;
+	for (i = 0; i < tensor_block_size; i++)
+		if (TENSOR_EXPECT_COMPUTABLE(tensor_blocks[i]) && IS_PRIMARY_COMPANION(i, tensor_blocks[i]))
+		{
+			ccv_nnc_tensor_opt_t a = {
+				.index = i,
+				.companion = tensor_blocks[i].companion_ref - 1, // The designated companion shares the same memory region.
+				.oc = tensor_block_size - i, // Break the tie by the order of the blocks.
+				.type = tensor_blocks[i].type,
+				.size = tensor_blocks[i].size,
+			};
+			if (a.companion >= 0)
+				a.size = ccv_max(a.size, tensor_blocks[a.companion].size);
+			units[unit_size++] = a;
+		}
+	_ccv_nnc_tensor_opt_sort_by_size_and_oc(units, unit_size, 0);
+	uint64_t* const offsets = (uint64_t*)ccmalloc((sizeof(uint64_t) * 2 + sizeof(ccv_nnc_tensor_range_t) + sizeof(int) * 2) * ccv_max(unit_size, 1));
+	uint64_t* const type_size = offsets + unit_size;
+	ccv_nnc_tensor_range_t* const ranges = (ccv_nnc_tensor_range_t*)(type_size + unit_size);
+	int* const types = (int*)(ranges + unit_size);
+	int* const unit_type = types + unit_size;
+	int type_count = 0;
+	for (i = 0; i < unit_size; i++)
+	{
+		for (j = 0; j < type_count && types[j] != units[i].type; j++);
+		if (j == type_count)
+			types[type_count] = units[i].type, type_size[type_count] = 0, ++type_count;
+		unit_type[i] = j;
+		int range_size = 0;
+		for (j = 0; j < i; j++)
+			if (unit_type[j] == unit_type[i] &&
+				(_ccv_nnc_tensor_blocks_interfere(tensor_itf, units[i].index, units[j].index) ||
+				 (units[i].companion >= 0 && _ccv_nnc_tensor_blocks_interfere(tensor_itf, units[i].companion, units[j].index)) ||
+				 (units[j].companion >= 0 && _ccv_nnc_tensor_blocks_interfere(tensor_itf, units[i].index, units[j].companion)) ||
+				 (units[i].companion >= 0 && units[j].companion >= 0 && _ccv_nnc_tensor_blocks_interfere(tensor_itf, units[i].companion, units[j].companion))))
+			{
+				ranges[range_size].offset = offsets[j];
+				ranges[range_size].size = units[j].size;
+				++range_size;
+			}
+		_ccv_nnc_tensor_range_sort_by_offset(ranges, range_size, 0);
+		uint64_t cursor = 0, best_offset = 0, best_gap = 0;
+		int found = 0;
+		for (j = 0; j < range_size; j++)
+		{
+			if (ranges[j].offset > cursor)
+			{
+				const uint64_t gap = ranges[j].offset - cursor;
+				if (gap >= units[i].size && (!found || gap < best_gap))
+					best_offset = cursor, best_gap = gap, found = 1;
+			}
+			cursor = ccv_max(cursor, ranges[j].offset + ranges[j].size);
+		}
+		offsets[i] = found ? best_offset : cursor;
+		type_size[unit_type[i]] = ccv_max(type_size[unit_type[i]], offsets[i] + units[i].size);
+	}
+	uint64_t total_size = 0, by_size_total_size = 0;
+	for (i = 0; i < *num_assigned_ref; i++)
+		total_size += allocated_size[i];
+	for (i = 0; i < type_count; i++)
+		by_size_total_size += type_size[i];
+	if (by_size_total_size >= total_size)
+	{
+		ccfree(offsets);
+		ccfree(units);
+		return 0;
+	}
+	*num_assigned_ref = type_count;
+	for (i = 0; i < type_count; i++)
+		allocated_size[i] = type_size[i];
+	// The ranges are not needed any more, reuse them.
+	assert(sizeof(ccv_nnc_tensor_placed_t) <= sizeof(ccv_nnc_tensor_range_t));
+	ccv_nnc_tensor_placed_t* const placed = (ccv_nnc_tensor_placed_t*)ranges;
+	for (i = 0; i < unit_size; i++)
+	{
+		assigned[units[i].index] = unit_type[i] + 1;
+		allocated_offset[units[i].index] = offsets[i];
+		if (units[i].companion >= 0)
+		{
+			assigned[units[i].companion] = unit_type[i] + 1;
+			allocated_offset[units[i].companion] = offsets[i];
+		}
+		placed[i].type = unit_type[i];
+		placed[i].unit = i;
+		placed[i].offset = offsets[i];
+	}
+	// A block depends on the earlier blocks that used the same memory. Sweep through the blocks in each buffer by offset,
+	// thus, only the ones overlapping in memory are compared.
+	_ccv_nnc_tensor_placed_sort_by_type_and_offset(placed, unit_size, 0);
+	int k, l;
+	for (i = 0; i < unit_size; i++)
+	{
+		const ccv_nnc_tensor_opt_t* const a = units + placed[i].unit;
+		for (j = i + 1; j < unit_size && placed[j].type == placed[i].type && placed[j].offset < placed[i].offset + a->size; j++)
+		{
+			const ccv_nnc_tensor_opt_t* const b = units + placed[j].unit;
+			const int a_blocks[2] = { a->index, a->companion };
+			const int b_blocks[2] = { b->index, b->companion };
+			for (k = 0; k < 2 && a_blocks[k] >= 0; k++)
+				for (l = 0; l < 2 && b_blocks[l] >= 0; l++)
+				{
+					_ccv_nnc_tensor_alloc_dep_add(exec_dep, tensor_blocks, allocated_offset, a_blocks[k], b_blocks[l], alloc_dep);
+					_ccv_nnc_tensor_alloc_dep_add(exec_dep, tensor_blocks, allocated_offset, b_blocks[l], a_blocks[k], alloc_dep);
+				}
+		}
+	}
+	ccfree(offsets);
+	ccfree(units);
+	return 1;
+}
+
 typedef struct {
 	ccv_array_t** alloc_dep;
 	int vt_block_size;
@@ -175,7 +334,7 @@ typedef struct ccv_nnc_symbolic_graph_prep_s {
 	ccv_array_t* dup_breakpoints; // The noop breakpoints, used to extend the inputs life-cycle for while expr.
 } ccv_nnc_symbolic_graph_prep_t;
 
-static ccv_nnc_tensor_alloc_prep_t* _ccv_nnc_tensor_alloc_prep_new(const ccv_sparse_matrix_t* const exec_dep, const ccv_nnc_tensor_block_t* const tensor_blocks, const int tensor_block_size)
+static ccv_nnc_tensor_alloc_prep_t* _ccv_nnc_tensor_alloc_prep_new(const ccv_sparse_matrix_t* const exec_dep, const ccv_nnc_tensor_block_t* const tensor_blocks, const int tensor_block_size, const int compile_flags)
 {
 	// Compute how many dis-continuous buffers are needed.
 	// We prefer to have several dis-continuous buffers instead of one big buffer because
@@ -494,6 +653,8 @@ static ccv_nnc_tensor_alloc_prep_t* _ccv_nnc_tensor_alloc_prep_new(const ccv_spa
 		j += string_size;
 	}
 	ccv_array_free(opt);
+	// The placement above goes by the overlap count and can leave gaps between the blocks. If asked, keep whichever needs less memory.
+	const int alloc_by_size = (compile_flags & CCV_NNC_SYMBOLIC_GRAPH_COMPILE_BEST_FIT) ? _ccv_nnc_tensor_alloc_by_size(exec_dep, tensor_blocks, tensor_block_size, tensor_itf, assigned, allocated_offset, allocated_size, &num_assigned, alloc_dep) : 0;
 	ccv_matrix_free(tensor_itf);
 #define for_block(y, x, val) do { \
 		if (((uint64_t*)val)[0] > 0 && y > 0 && x < tensor_block_size + 1) \
@@ -503,7 +664,10 @@ static ccv_nnc_tensor_alloc_prep_t* _ccv_nnc_tensor_alloc_prep_new(const ccv_spa
 			ccv_array_add_unique_int(alloc_dep[x - 1], y - 1); \
 		} \
 	} while (0)
-	CCV_SPARSE_FOREACH(alloc, for_block);
+	if (!alloc_by_size)
+	{
+		CCV_SPARSE_FOREACH(alloc, for_block);
+	}
 #undef for_block
 	ccv_matrix_free(alloc);
 	ccfree(oc);
@@ -965,6 +1129,74 @@ static int _ccv_nnc_tensor_flat_if_multiview(ccv_array_t* const tensor_metadata,
 	return new_pos;
 }
 
+static void _ccv_nnc_tensor_arena_layout(const ccv_nnc_symbolic_graph_prep_t* const graph_prep, ccv_nnc_tensor_arena_t* const tensor_arena)
+{
+	const ccv_nnc_tensor_alloc_prep_t* const alloc_prep = graph_prep->alloc_prep;
+	const ccv_nnc_tensor_block_t* const tensor_blocks = graph_prep->tensor_blocks;
+	const int exec_symbol_info_size = graph_prep->exec_symbol_info_size;
+	int i, j;
+	// The position of each exec in topological order, the duplicated execs from unrolling are not in the visit.
+	int* const exec_pos = (int*)ccmalloc(sizeof(int) * exec_symbol_info_size);
+	for (i = 0; i < exec_symbol_info_size; i++)
+		exec_pos[i] = -1;
+	int exec_size = 0;
+	ccv_nnc_graph_visit_for(graph_prep->visit, graph_prep->exec_symbol_info, node, idx) {
+		exec_pos[idx] = exec_size++;
+	} ccv_nnc_graph_visit_endfor
+	int block_size = 0;
+	for (i = 0; i < alloc_prep->block_size; i++)
+		if (alloc_prep->blocks[i].buffer_ref >= 0)
+			++block_size;
+	ccv_nnc_tensor_arena_block_t* const blocks = block_size > 0 ? (ccv_nnc_tensor_arena_block_t*)ccmalloc(sizeof(ccv_nnc_tensor_arena_block_t) * block_size) : 0;
+	// Bytes that become alive at an exec minus the bytes that are dead after the previous one.
+	int64_t* const delta = (int64_t*)cccalloc(exec_size + 1, sizeof(int64_t));
+	for (i = 0, j = 0; i < alloc_prep->block_size; i++)
+	{
+		if (alloc_prep->blocks[i].buffer_ref < 0)
+			continue;
+		const int block_ref = alloc_prep->blocks[i].block_ref;
+		ccv_nnc_tensor_arena_block_t* const block = blocks + j++;
+		block->symbol.d = block_ref < graph_prep->tensor_symbol_info_size ? block_ref : -1;
+		block->symbol.graph = graph_prep->symbolic_graph;
+		block->buffer = alloc_prep->blocks[i].buffer_ref;
+		block->offset = alloc_prep->blocks[i].offset;
+		block->size = tensor_blocks[block_ref].size;
+		// Without head, the block is an input and alive from the start. Without tail, it is alive til the end.
+		int k, head = -1, tail = -1;
+		for (k = 0; tensor_blocks[block_ref].head && k < tensor_blocks[block_ref].head->rnum; k++)
+		{
+			const int d = *(int*)ccv_array_get(tensor_blocks[block_ref].head, k);
+			if (d < exec_symbol_info_size && exec_pos[d] >= 0 && (head < 0 || exec_pos[d] < head))
+				head = exec_pos[d];
+		}
+		for (k = 0; tensor_blocks[block_ref].tail && k < tensor_blocks[block_ref].tail->rnum; k++)
+		{
+			const int d = *(int*)ccv_array_get(tensor_blocks[block_ref].tail, k);
+			if (d < exec_symbol_info_size && exec_pos[d] >= 0 && exec_pos[d] > tail)
+				tail = exec_pos[d];
+		}
+		block->head = head >= 0 ? head : 0;
+		block->tail = tail >= 0 ? tail : ccv_max(exec_size - 1, 0);
+		if (block->tail < block->head)
+			block->tail = block->head;
+		delta[block->head] += block->size;
+		delta[block->tail + 1] -= block->size;
+	}
+	int64_t alive = 0;
+	uint64_t peak_size = 0;
+	for (i = 0; i < exec_size; i++)
+	{
+		alive += delta[i];
+		peak_size = ccv_max(peak_size, (uint64_t)alive);
+	}
+	ccfree(delta);
+	ccfree(exec_pos);
+	tensor_arena->exec_size = exec_size;
+	tensor_arena->block_size = block_size;
+	tensor_arena->blocks = blocks;
+	tensor_arena->peak_size = peak_size;
+}
+
 static ccv_nnc_tensor_arena_t* _ccv_nnc_tensor_arena_new(ccv_nnc_symbolic_graph_prep_t* const graph_prep, const ccv_nnc_tensor_arena_t* const p_arena, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size)
 {
 	// All tensors assigned out, now, the num_assigned is the number of dis-continuous buffers,
@@ -998,6 +1230,7 @@ static ccv_nnc_tensor_arena_t* _ccv_nnc_tensor_arena_new(ccv_nnc_symbolic_graph_
 	tensor_arena->m_tensor_idx = ccv_array_new(sizeof(int), 0, 0);
 	for (i = 0; i < alloc_prep->buffer_size; i++)
 		tensor_arena->buffers[i].type = alloc_prep->buffers[i].type, tensor_arena->buffers[i].size = alloc_prep->buffers[i].size;
+	_ccv_nnc_tensor_arena_layout(graph_prep, tensor_arena);
 	if (graph_prep->while_count_tensor)
 	{
 		// If we need to have a while count tensor, allocate that first, set its pointer to point the while_count variable.
@@ -3237,7 +3470,7 @@ static ccv_nnc_symbolic_graph_prep_t* _ccv_nnc_symbolic_graph_prep_new(const ccv
 	ccfree(tensor_fold);
 	// It is time to guess what's the best tensor placement and create the opaque tensor arena. The alloc_dep will return
 	// the allocation dependencies, thus, which tensor is reused to the existing tensor.
-	ccv_nnc_tensor_alloc_prep_t* alloc_prep = _ccv_nnc_tensor_alloc_prep_new(exec_dep, tensor_blocks, tensor_block_size);
+	ccv_nnc_tensor_alloc_prep_t* alloc_prep = _ccv_nnc_tensor_alloc_prep_new(exec_dep, tensor_blocks, tensor_block_size, symbolic_graph->compile_flags);
 	ccv_matrix_free(exec_dep);
 	prep->while_count_tensor = 0;
 	prep->dup_breakpoints = 0;
@@ -3689,6 +3922,8 @@ static void _ccv_nnc_tensor_arena_free(ccv_nnc_tensor_arena_t* const tensor_aren
 	}
 	ccv_array_free(tensor_arena->tensor_metadata);
 	ccv_array_free(tensor_arena->m_tensor_idx);
+	if (tensor_arena->blocks)
+		ccfree(tensor_arena->blocks);
 	ccfree(tensor_arena);
 }
 
@@ -3700,6 +3935,24 @@ int ccv_nnc_tensor_bind_symbol(const ccv_nnc_tensor_arena_t* const tensor_arena,
 	return 0;
 }
 
+ccv_nnc_tensor_arena_report_t ccv_nnc_tensor_arena_report(const ccv_nnc_tensor_arena_t* const tensor_arena)
+{
+	ccv_nnc_tensor_arena_report_t report = {
+		.buffer_size = tensor_arena->buffer_size,
+		.block_size = tensor_arena->block_size,
+		.exec_size = tensor_arena->exec_size,
+		.peak_size = tensor_arena->peak_size,
+		.blocks = tensor_arena->blocks,
+	};
+	int i;
+	for (i = 0; i < tensor_arena->buffer_size; i++)
+		report.total_size += tensor_arena->buffers[i].size;
+	for (i = 0; i < tensor_arena->block_size; i++)
+		report.unshared_size += tensor_arena->blocks[i].size;
+	report.fragmentation = report.total_size > 0 ? 1 - (double)report.peak_size / report.total_size : 0;
+	return report;
+}
+
 void ccv_nnc_tensor_arena_free(ccv_nnc_tensor_arena_t* const tensor_arena)
 {
 	int i;
@@ -0,0 +1,175 @@
+#include "ccv_nnc.h"
+#include "ccv_nnc_easy.h"
+#include "ccv_nnc_internal.h"
+#include "ccv_internal.h"
+#include "_ccv_nnc_symbolic_graph.h"
+
+/**
+ * Level-3.5 API
+ */
+
+// A tensor can hold a folded result only if it is a plain CPU tensor that only this exec writes.
+static int _ccv_nnc_symbolic_graph_constant_fold_output_is_foldable(const ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_t* const* const constants, const int exec_idx, const int d)
+{
+	const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, d);
+	// Aliases, carry overs (for while), bypasses (for case..of), tape variables and tensors shared with sub-graphs are left as is.
+	if (constants[d] || symbol_info->alias_ref || symbol_info->assign_ref || symbol_info->r_assign_ref ||
+		symbol_info->bypass_ref || symbol_info->r_bypass_ref || symbol_info->p_ref || (symbol_info->s_ref && symbol_info->s_ref->rnum) ||
+		(symbol_info->flags & CCV_NNC_TENSOR_SYMBOL_TAPE_VAR))
+		return 0;
+	if (CCV_TENSOR_GET_MEMORY(symbol_info->info.type) != CCV_TENSOR_CPU_MEMORY || ccv_nnc_tensor_count(symbol_info->info) <= 0)
+		return 0;
+	int i, j;
+	for (i = 0; i < graph->exec_symbol_info->rnum; i++)
+	{
+		if (i == exec_idx)
+			continue;
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(exec_info->flags))
+			continue;
+		for (j = 0; j < exec_info->output_size; j++)
+			if (exec_info->outputs[j] == d)
+				return 0;
+	}
+	return 1;
+}
+
+// Whether any exec left in the graph reads or writes tensor d, directly or through an alias.
+static int _ccv_nnc_symbolic_graph_constant_fold_is_used(const ccv_nnc_symbolic_graph_t* const graph, const int d)
+{
+	int i, j;
+	for (i = 0; i < graph->exec_symbol_info->rnum; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(exec_info->flags))
+			continue;
+		for (j = 0; j < exec_info->input_size + exec_info->output_size; j++)
+		{
+			const int idx = j < exec_info->input_size ? exec_info->inputs[j] : exec_info->outputs[j - exec_info->input_size];
+			if (idx < 0)
+				continue;
+			if (idx == d)
+				return 1;
+			const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, idx);
+			if (symbol_info->alias_ref == d + 1)
+				return 1;
+		}
+	}
+	return 0;
+}
+
+void ccv_nnc_symbolic_graph_constant_fold(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_tensor_bind_t* const tensor_binds, const int tensor_bind_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size, ccv_nnc_tensor_bind_t** const folded_binds_ref, int* const folded_bind_size_ref)
+{
+	const int tensor_symbol_size = graph->tensor_symbol_info->rnum;
+	// The tensor of each constant symbol, whether it is bound by the caller or computed here.
+	ccv_nnc_tensor_t** const constants = (ccv_nnc_tensor_t**)cccalloc(tensor_symbol_size, sizeof(ccv_nnc_tensor_t*));
+	int i, j;
+	for (i = 0; i < tensor_bind_size; i++)
+	{
+		assert(tensor_binds[i].symbol.graph == graph);
+		const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, tensor_binds[i].symbol.d);
+		if (!(symbol_info->flags & CCV_NNC_TENSOR_SYMBOL_CONSTANT) || symbol_info->alias_ref || !tensor_binds[i].tensor ||
+			CCV_IS_TENSOR_MULTIVIEW(tensor_binds[i].tensor) || CCV_TENSOR_GET_MEMORY(tensor_binds[i].tensor->info.type) != CCV_TENSOR_CPU_MEMORY)
+			continue;
+		constants[tensor_binds[i].symbol.d] = (ccv_nnc_tensor_t*)tensor_binds[i].tensor;
+	}
+	// A symbol marked as constant but written by some exec is not a constant.
+	for (i = 0; i < graph->exec_symbol_info->rnum; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(exec_info->flags))
+			continue;
+		for (j = 0; j < exec_info->output_size; j++)
+			if (exec_info->outputs[j] >= 0)
+				constants[exec_info->outputs[j]] = 0;
+	}
+	// Run the execs that only read constants in topological order, thus, their outputs can feed the next ones.
+	ccv_array_t* const folded_execs = ccv_array_new(sizeof(int), 0, 0);
+	ccv_array_t* const folded_tensors = ccv_array_new(sizeof(int), 0, 0);
+	ccv_nnc_tensor_t* input_tensors[CCV_NNC_MAX_DIM_ALLOC * 2];
+	ccv_nnc_tensor_t* output_tensors[CCV_NNC_MAX_DIM_ALLOC * 2];
+	ccv_nnc_graph_visit_t* const visit = ccv_nnc_graph_visit_new(graph, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), graph->exec_symbol_info->rnum, sources, source_size, destinations, destination_size, 0);
+	ccv_nnc_graph_visit_for(visit, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), node, idx) {
+		// Commands without inputs are not necessarily the same from run to run, random ones (dropout) even with inputs.
+		if (node->input_size <= 0 || node->output_size <= 0 ||
+			node->input_size > CCV_NNC_MAX_DIM_ALLOC * 2 || node->output_size > CCV_NNC_MAX_DIM_ALLOC * 2 ||
+			node->cmd.cmd == CCV_NNC_NOOP || !ccv_nnc_graph_exec_symbol_is_deterministic(node))
+			continue;
+		int foldable = 0;
+		for (i = 0; i < node->input_size; i++)
+			if (node->inputs[i] >= 0)
+			{
+				if (!constants[node->inputs[i]])
+					break;
+				foldable = 1;
+			}
+		if (!foldable || i < node->input_size)
+			continue;
+		for (i = 0; i < node->output_size; i++)
+			if (node->outputs[i] >= 0 && !_ccv_nnc_symbolic_graph_constant_fold_output_is_foldable(graph, (const ccv_nnc_tensor_t* const*)constants, idx, node->outputs[i]))
+				break;
+		if (i < node->output_size)
+			continue;
+		for (i = 0; i < node->input_size; i++)
+			input_tensors[i] = node->inputs[i] >= 0 ? constants[node->inputs[i]] : 0;
+		for (i = 0; i < node->output_size; i++)
+			output_tensors[i] = node->outputs[i] >= 0 ? ccv_nnc_tensor_new(0, ((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->outputs[i]))->info, 0) : 0;
+		if (ccv_nnc_cmd_exec(node->cmd, node->hint, 0, input_tensors, node->input_size, output_tensors, node->output_size, 0) != CCV_NNC_EXEC_SUCCESS)
+		{
+			// Leave it to the graph if we cannot run it now.
+			for (i = 0; i < node->output_size; i++)
+				if (output_tensors[i])
+					ccv_nnc_tensor_free(output_tensors[i]);
+			continue;
+		}
+		for (i = 0; i < node->output_size; i++)
+			if (node->outputs[i] >= 0)
+			{
+				constants[node->outputs[i]] = output_tensors[i];
+				ccv_array_push(folded_tensors, node->outputs + i);
+			}
+		ccv_array_push(folded_execs, &idx);
+	} ccv_nnc_graph_visit_endfor
+	ccv_nnc_graph_visit_free(visit);
+	for (i = 0; i < folded_execs->rnum; i++)
+		ccv_nnc_graph_exec_symbol_free(graph, (ccv_nnc_graph_exec_symbol_t){
+			.d = *(int*)ccv_array_get(folded_execs, i),
+			.graph = graph,
+		});
+	ccv_array_free(folded_execs);
+	// Only hand back the tensors the rest of the graph reads, or the ones asked for.
+	ccv_nnc_tensor_bind_t* folded_binds = folded_tensors->rnum > 0 ? (ccv_nnc_tensor_bind_t*)ccmalloc(sizeof(ccv_nnc_tensor_bind_t) * folded_tensors->rnum) : 0;
+	int folded_bind_size = 0;
+	for (i = 0; i < folded_tensors->rnum; i++)
+	{
+		const int d = *(int*)ccv_array_get(folded_tensors, i);
+		int is_output = 0;
+		for (j = 0; !is_output && j < output_size; j++)
+			is_output = (outputs[j].d == d);
+		if (!is_output && !_ccv_nnc_symbolic_graph_constant_fold_is_used(graph, d))
+		{
+			ccv_nnc_tensor_free(constants[d]);
+			continue;
+		}
+		const ccv_nnc_tensor_symbol_t symbol = {
+			.d = d,
+			.graph = graph,
+		};
+		// The folded tensor won't change either, this can be folded further in later passes.
+		ccv_nnc_tensor_symbol_set_flags(graph, symbol, ccv_nnc_tensor_symbol_flags(graph, symbol) | CCV_NNC_TENSOR_SYMBOL_CONSTANT);
+		folded_binds[folded_bind_size].symbol = symbol;
+		folded_binds[folded_bind_size].tensor = constants[d];
+		++folded_bind_size;
+	}
+	ccv_array_free(folded_tensors);
+	ccfree(constants);
+	if (folded_bind_size == 0 && folded_binds)
+	{
+		ccfree(folded_binds);
+		folded_binds = 0;
+	}
+	*folded_binds_ref = folded_binds;
+	*folded_bind_size_ref = folded_bind_size;
+	// The execs reading the folded tensors can be new sources.
+	ccv_nnc_graph_exec_symbol_autogen(graph, 0, 0, CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+}
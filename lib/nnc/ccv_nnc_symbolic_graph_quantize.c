@@ -0,0 +1,169 @@
+#include "ccv_nnc.h"
+#include "ccv_nnc_easy.h"
+#include "ccv_nnc_internal.h"
+#include "ccv_internal.h"
+#include "_ccv_nnc_symbolic_graph.h"
+
+/**
+ * Level-3.5 API
+ */
+
+typedef struct {
+	ccv_nnc_graph_exec_symbol_t exec; // The quantize command, graph is 0 if the tensor is not quantized yet.
+	ccv_nnc_tensor_symbol_t y; // The quantized tensor.
+	ccv_nnc_tensor_symbol_t q; // The quantization parameters.
+	int is_source; // Nothing in the graph writes to the tensor, thus, the quantize command is a new source.
+} ccv_nnc_symbolic_graph_quantized_t;
+
+static int _ccv_nnc_symbolic_graph_quantize_tensor_is_float(const ccv_nnc_symbolic_graph_t* const graph, const int d)
+{
+	const ccv_nnc_tensor_symbol_info_t* const tensor_symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, d);
+	// Alias and tensors carried between sub-graphs are left as is.
+	return !tensor_symbol_info->alias_ref && !tensor_symbol_info->assign_ref && !tensor_symbol_info->r_assign_ref &&
+		CCV_TENSOR_GET_MEMORY(tensor_symbol_info->info.type) == CCV_TENSOR_CPU_MEMORY &&
+		tensor_symbol_info->info.datatype == CCV_32F && ccv_nnc_tensor_count(tensor_symbol_info->info) > 0;
+}
+
+static ccv_nnc_symbolic_graph_quantized_t* _ccv_nnc_symbolic_graph_quantize_tensor(ccv_nnc_symbolic_graph_t* const graph, ccv_nnc_symbolic_graph_quantized_t* const quantized, const int exec_symbol_size, const int d, const int per_channel)
+{
+	ccv_nnc_symbolic_graph_quantized_t* const tensor_quantized = quantized + d * 2 + per_channel;
+	if (tensor_quantized->exec.graph)
+		return tensor_quantized;
+	const ccv_nnc_tensor_symbol_t x = {
+		.d = d,
+		.graph = graph,
+	};
+	const ccv_nnc_tensor_param_t info = ccv_nnc_tensor_symbol_params(graph, x);
+	ccv_nnc_tensor_param_t y_info = info;
+	y_info.datatype = CCV_8U;
+	tensor_quantized->y = ccv_nnc_tensor_symbol_new(graph, y_info, 0);
+	ccv_nnc_tensor_param_t q_info = {
+		.type = info.type,
+		.format = info.format,
+		.datatype = CCV_32F,
+		.dim = {
+			per_channel ? info.dim[0] : 1, 2
+		},
+	};
+	tensor_quantized->q = ccv_nnc_tensor_symbol_new(graph, q_info, 0);
+	ccv_nnc_tensor_symbol_t outputs[] = {
+		tensor_quantized->y, tensor_quantized->q
+	};
+	tensor_quantized->exec = ccv_nnc_graph_exec_symbol_new(graph, CMD_QUANTIZE_FORWARD(per_channel), &x, 1, outputs, 2, 0);
+	// Whoever writes to x has to finish before we quantize it.
+	tensor_quantized->is_source = 1;
+	int i, j;
+	for (i = 0; i < exec_symbol_size; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_symbol_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(exec_symbol_info->flags))
+			continue;
+		for (j = 0; j < exec_symbol_info->output_size; j++)
+			if (exec_symbol_info->outputs[j] == d)
+			{
+				ccv_nnc_graph_exec_symbol_concat(graph, (ccv_nnc_graph_exec_symbol_t){
+					.d = i,
+					.graph = graph,
+				}, tensor_quantized->exec);
+				tensor_quantized->is_source = 0;
+				break;
+			}
+	}
+	return tensor_quantized;
+}
+
+void ccv_nnc_symbolic_graph_quantize(ccv_nnc_symbolic_graph_t* const graph, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size)
+{
+	// Collect the execs first, we will add exec symbols later, which can move the exec symbol info around.
+	ccv_array_t* const candidates = ccv_array_new(sizeof(int), 0, 0);
+	ccv_nnc_graph_visit_t* const visit = ccv_nnc_graph_visit_new(graph, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), graph->exec_symbol_info->rnum, sources, source_size, destinations, destination_size, 0);
+	ccv_nnc_graph_visit_for(visit, (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, 0), node, idx) {
+		if (node->cmd.cmd != CCV_NNC_CONVOLUTION_FORWARD && node->cmd.cmd != CCV_NNC_GEMM_FORWARD)
+			continue;
+		if (node->graph_ref_size || (node->input_size != 2 && node->input_size != 3) || node->output_size != 1)
+			continue;
+		if (node->inputs[0] < 0 || node->inputs[1] < 0 ||
+			!_ccv_nnc_symbolic_graph_quantize_tensor_is_float(graph, node->inputs[0]) ||
+			!_ccv_nnc_symbolic_graph_quantize_tensor_is_float(graph, node->inputs[1]))
+			continue;
+		// The quantized kernels only cover the layout the reference implementation has.
+		const ccv_nnc_tensor_symbol_info_t* const a_symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->inputs[0]);
+		if (a_symbol_info->info.format != CCV_TENSOR_FORMAT_NHWC)
+			continue;
+		ccv_array_push(candidates, &idx);
+	} ccv_nnc_graph_visit_endfor
+	ccv_nnc_graph_visit_free(visit);
+	const int exec_symbol_size = graph->exec_symbol_info->rnum;
+	ccv_array_t* const new_sources = ccv_array_new(sizeof(ccv_nnc_graph_exec_symbol_t), 0, 0);
+	ccv_nnc_symbolic_graph_quantized_t* const quantized = (ccv_nnc_symbolic_graph_quantized_t*)cccalloc(graph->tensor_symbol_info->rnum * 2, sizeof(ccv_nnc_symbolic_graph_quantized_t));
+	int i;
+	for (i = 0; i < candidates->rnum; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_t exec = {
+			.d = *(int*)ccv_array_get(candidates, i),
+			.graph = graph,
+		};
+		const ccv_nnc_graph_exec_symbol_info_t* exec_symbol_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, exec.d);
+		const int a = exec_symbol_info->inputs[0];
+		const int w = exec_symbol_info->inputs[1];
+		const int bias = exec_symbol_info->input_size > 2 ? exec_symbol_info->inputs[2] : CCV_NNC_NO_TENSOR_SYMBOL;
+		const int b = exec_symbol_info->outputs[0];
+		// Activations are quantized per tensor, weights per output channel.
+		const int a_quantized_before = !!quantized[a * 2].exec.graph;
+		const ccv_nnc_symbolic_graph_quantized_t* const a_quantized = _ccv_nnc_symbolic_graph_quantize_tensor(graph, quantized, exec_symbol_size, a, 0);
+		if (!a_quantized_before && a_quantized->is_source)
+			ccv_array_push(new_sources, &a_quantized->exec);
+		const int w_quantized_before = !!quantized[w * 2 + 1].exec.graph;
+		const ccv_nnc_symbolic_graph_quantized_t* const w_quantized = _ccv_nnc_symbolic_graph_quantize_tensor(graph, quantized, exec_symbol_size, w, 1);
+		if (!w_quantized_before && w_quantized->is_source)
+		{
+			ccv_array_push(new_sources, &w_quantized->exec);
+			// Nothing in the graph writes to the weights, quantizing them can be folded once they are bound.
+			const ccv_nnc_tensor_symbol_t w_symbol = {
+				.d = w,
+				.graph = graph,
+			};
+			ccv_nnc_tensor_symbol_set_flags(graph, w_symbol, ccv_nnc_tensor_symbol_flags(graph, w_symbol) | CCV_NNC_TENSOR_SYMBOL_CONSTANT);
+		}
+		const ccv_nnc_tensor_symbol_t inputs[] = {
+			a_quantized->y,
+			w_quantized->y,
+			{
+				.d = bias,
+				.graph = bias >= 0 ? graph : 0,
+			},
+			a_quantized->q,
+			w_quantized->q,
+		};
+		const ccv_nnc_tensor_symbol_t output = {
+			.d = b,
+			.graph = graph,
+		};
+		// This picks the quantized backend, because the inputs are 8U now.
+		ccv_nnc_graph_exec_symbol_set_io(graph, exec, inputs, 5, &output, 1);
+		ccv_nnc_graph_exec_symbol_concat(graph, a_quantized->exec, exec);
+		ccv_nnc_graph_exec_symbol_concat(graph, w_quantized->exec, exec);
+	}
+	ccfree(quantized);
+	// The rewritten execs now run after their quantize commands, they are not sources any more. The quantize
+	// commands that don't wait on anything take their place. The destinations are not changed, every quantize
+	// command runs before a rewritten exec.
+	ccv_array_t* const graph_sources = ccv_array_new(sizeof(ccv_nnc_graph_exec_symbol_t), 0, 0);
+	const int graph_source_size = ccv_nnc_symbolic_graph_source_size(graph);
+	const ccv_nnc_graph_exec_symbol_t* const old_sources = ccv_nnc_symbolic_graph_sources(graph);
+	int j;
+	for (i = 0; i < graph_source_size; i++)
+	{
+		for (j = 0; j < candidates->rnum; j++)
+			if (*(int*)ccv_array_get(candidates, j) == old_sources[i].d)
+				break;
+		if (j == candidates->rnum)
+			ccv_array_push(graph_sources, old_sources + i);
+	}
+	for (i = 0; i < new_sources->rnum; i++)
+		ccv_array_push(graph_sources, ccv_array_get(new_sources, i));
+	ccv_nnc_symbolic_graph_set_sources(graph, (ccv_nnc_graph_exec_symbol_t*)ccv_array_get(graph_sources, 0), graph_sources->rnum);
+	ccv_array_free(graph_sources);
+	ccv_array_free(new_sources);
+	ccv_array_free(candidates);
+}
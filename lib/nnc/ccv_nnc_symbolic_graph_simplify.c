@@ -529,6 +529,158 @@ static void _ccv_nnc_symbolic_graph_data_transfer_opt(ccv_nnc_symbolic_graph_sim
 	} ccv_nnc_graph_visit_endfor
 }
 
+static int _ccv_nnc_format_transform_is_local(const ccv_nnc_symbolic_graph_simplify_t* const simplify, const uint32_t* const has_alias, const int d)
+{
+	const ccv_nnc_tensor_symbol_info_t* const symbol_info = simplify->tensor_symbol_info + d;
+	// Aliases, carry overs (for while), bypasses (for case..of) and tensors shared with sub-graphs are left as is.
+	return !symbol_info->alias_ref && !(has_alias[d >> 5] & (1u << (d & 0x1f))) &&
+		!symbol_info->assign_ref && !symbol_info->r_assign_ref &&
+		!symbol_info->bypass_ref && !symbol_info->r_bypass_ref &&
+		!symbol_info->p_ref && !(symbol_info->s_ref && symbol_info->s_ref->rnum);
+}
+
+static int _ccv_nnc_format_transform_same_params(const ccv_nnc_tensor_param_t a, const ccv_nnc_tensor_param_t b)
+{
+	return a.type == b.type && a.format == b.format && a.datatype == b.datatype && memcmp(a.dim, b.dim, sizeof(a.dim)) == 0;
+}
+
+static int _ccv_nnc_format_transform_is_elementwise(const uint32_t cmd)
+{
+	// These commands only look at one element at a time, thus, they are indifferent to the layout.
+	return cmd == CCV_NNC_RELU_FORWARD || cmd == CCV_NNC_EWEXP_FORWARD || cmd == CCV_NNC_EWLOG_FORWARD ||
+		cmd == CCV_NNC_EWSQRT_FORWARD || cmd == CCV_NNC_SCALAR_MUL_FORWARD;
+}
+
+// Format transforms are inserted around commands that only support one layout. When the layouts of
+// consecutive commands line up, these transforms cancel each other out and can be removed.
+static void _ccv_nnc_symbolic_graph_format_transform_opt(ccv_nnc_symbolic_graph_simplify_t* const simplify, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size)
+{
+	uint32_t* const exec_dead = simplify->exec_dead;
+	uint32_t* const tensor_dead = simplify->tensor_dead;
+	const ccv_nnc_tensor_symbol_info_t* const tensor_symbol_info = simplify->tensor_symbol_info;
+	int i;
+	uint32_t* const has_alias = ccmalloc(sizeof(uint32_t) * ((simplify->tensor_symbol_info_size + 31) >> 5));
+	uint32_t* const is_output = cccalloc((simplify->tensor_symbol_info_size + 31) >> 5, sizeof(uint32_t));
+	for (i = 0; i < output_size; i++)
+		is_output[outputs[i].d >> 5] |= (1u << (outputs[i].d & 0x1f));
+	int* const refs = (int*)ccmalloc(sizeof(int) * simplify->tensor_symbol_info_size);
+	int* const consumers = (int*)ccmalloc(sizeof(int) * simplify->tensor_symbol_info_size);
+	int updated_refs, updated_execs;
+	do {
+		_ccv_nnc_symbolic_graph_simplify_update_output_execs(simplify);
+		memset(has_alias, 0, sizeof(uint32_t) * ((simplify->tensor_symbol_info_size + 31) >> 5));
+		for (i = 0; i < simplify->tensor_symbol_info_size; i++)
+		{
+			refs[i] = -1;
+			consumers[i] = 0;
+			if (tensor_symbol_info[i].alias_ref)
+			{
+				const int alias_ref = tensor_symbol_info[i].alias_ref - 1;
+				has_alias[alias_ref >> 5] |= (1u << (alias_ref & 0x1f));
+			}
+		}
+		ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+			if (exec_dead[idx >> 5] & (1u << (idx & 0x1f)))
+				continue;
+			for (i = 0; i < node->input_size; i++)
+				if (node->inputs[i] >= 0)
+					++consumers[node->inputs[i]];
+		} ccv_nnc_graph_visit_endfor
+		updated_execs = 0;
+		ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+			if (exec_dead[idx >> 5] & (1u << (idx & 0x1f)))
+				continue;
+			if (node->cmd.cmd != CCV_NNC_FORMAT_TRANSFORM_FORWARD || node->input_size != 1 || node->output_size != 1 || node->graph_ref_size)
+				continue;
+			const int x = node->inputs[0];
+			const int y = node->outputs[0];
+			// Skip if the input is already going away from an earlier match in this round.
+			if (x < 0 || y < 0 || refs[x] >= 0 || refs[y] >= 0 || (tensor_dead[x >> 5] & (1u << (x & 0x1f))) || !_ccv_nnc_format_transform_is_local(simplify, has_alias, x) || !_ccv_nnc_format_transform_is_local(simplify, has_alias, y))
+				continue;
+			// An identity transform, replace the output with the input.
+			if (_ccv_nnc_format_transform_same_params(tensor_symbol_info[x].info, tensor_symbol_info[y].info))
+			{
+				if (!(is_output[y >> 5] & (1u << (y & 0x1f))))
+					refs[y] = x;
+				continue;
+			}
+			// Otherwise, the output has to be a temporary only read by the next command.
+			if ((is_output[y >> 5] & (1u << (y & 0x1f))) || consumers[y] != 1)
+				continue;
+			int next_idx = -1;
+			int j, k;
+			const int* const outgoings = node->outgoings ? (int*)ccv_array_get(node->outgoings, 0) : 0;
+			for (j = 0; next_idx < 0 && node->outgoings && j < node->outgoings->rnum; j++)
+			{
+				const int outgoing = outgoings[j];
+				if (exec_dead[outgoing >> 5] & (1u << (outgoing & 0x1f)))
+					continue;
+				const ccv_nnc_graph_exec_symbol_info_t* const outgoing_node = simplify->exec_symbol_info + outgoing;
+				for (k = 0; next_idx < 0 && k < outgoing_node->input_size; k++)
+					if (outgoing_node->inputs[k] == y)
+						next_idx = outgoing;
+			}
+			if (next_idx < 0)
+				continue;
+			ccv_nnc_graph_exec_symbol_info_t* const next_node = simplify->exec_symbol_info + next_idx;
+			if (next_node->input_size != 1 || next_node->output_size != 1 || next_node->graph_ref_size || next_node->outputs[0] < 0)
+				continue;
+			if (next_node->cmd.cmd == CCV_NNC_FORMAT_TRANSFORM_FORWARD)
+			{
+				// x -> y -> z where z is the same as x, z can be replaced with x, and both transforms go away.
+				const int z = next_node->outputs[0];
+				if (refs[z] < 0 && !(is_output[z >> 5] & (1u << (z & 0x1f))) &&
+					_ccv_nnc_format_transform_is_local(simplify, has_alias, z) &&
+					_ccv_nnc_format_transform_same_params(tensor_symbol_info[x].info, tensor_symbol_info[z].info))
+				{
+					refs[z] = x;
+					exec_dead[idx >> 5] |= (1u << (idx & 0x1f));
+					tensor_dead[y >> 5] |= (1u << (y & 0x1f));
+				}
+				continue;
+			}
+			if (!_ccv_nnc_format_transform_is_elementwise(next_node->cmd.cmd))
+				continue;
+			// x -> y -> element-wise -> u -> v where v is the same as x, the element-wise command can take x and write v directly.
+			const int u = next_node->outputs[0];
+			if ((is_output[u >> 5] & (1u << (u & 0x1f))) || consumers[u] != 1 || !_ccv_nnc_format_transform_is_local(simplify, has_alias, u))
+				continue;
+			int last_idx = -1;
+			const int* const next_outgoings = next_node->outgoings ? (int*)ccv_array_get(next_node->outgoings, 0) : 0;
+			for (j = 0; last_idx < 0 && next_node->outgoings && j < next_node->outgoings->rnum; j++)
+			{
+				const int outgoing = next_outgoings[j];
+				if (exec_dead[outgoing >> 5] & (1u << (outgoing & 0x1f)))
+					continue;
+				const ccv_nnc_graph_exec_symbol_info_t* const outgoing_node = simplify->exec_symbol_info + outgoing;
+				if (outgoing_node->cmd.cmd == CCV_NNC_FORMAT_TRANSFORM_FORWARD && outgoing_node->input_size == 1 && outgoing_node->output_size == 1 &&
+					!outgoing_node->graph_ref_size && outgoing_node->inputs[0] == u)
+					last_idx = outgoing;
+			}
+			if (last_idx < 0)
+				continue;
+			const int v = simplify->exec_symbol_info[last_idx].outputs[0];
+			if (v < 0 || !_ccv_nnc_format_transform_is_local(simplify, has_alias, v) ||
+				!_ccv_nnc_format_transform_same_params(tensor_symbol_info[x].info, tensor_symbol_info[v].info))
+				continue;
+			// The inputs / outputs are shared with the graph, thus, this updates the graph as well.
+			next_node->inputs[0] = x;
+			next_node->outputs[0] = v;
+			exec_dead[idx >> 5] |= (1u << (idx & 0x1f));
+			exec_dead[last_idx >> 5] |= (1u << (last_idx & 0x1f));
+			tensor_dead[y >> 5] |= (1u << (y & 0x1f));
+			tensor_dead[u >> 5] |= (1u << (u & 0x1f));
+			updated_execs = 1;
+		} ccv_nnc_graph_visit_endfor
+		// The exec that generates the replaced tensor is a format transform, it is dead now.
+		updated_refs = _ccv_nnc_symbolic_graph_update_refs(simplify, outputs, output_size, refs, 1);
+	} while (updated_refs || updated_execs);
+	ccfree(consumers);
+	ccfree(refs);
+	ccfree(is_output);
+	ccfree(has_alias);
+}
+
 static void _ccv_nnc_symbolic_graph_pruning_undead_exec(ccv_nnc_symbolic_graph_simplify_t* const simplify, const int exec_idx, uint32_t* const tensor_visited, ccv_array_t* const next)
 {
 	assert(exec_idx >= 0);
@@ -766,9 +918,497 @@ static void _ccv_nnc_symbolic_graph_pruning(ccv_nnc_symbolic_graph_simplify_t* c
 	ccfree(r_alias_refs);
 }
 
+typedef struct {
+	ccv_nnc_symbolic_graph_t* graph;
+	int tensor_symbol_info_size;
+	int exec_symbol_info_size;
+	int* consumers; // The only exec that reads the tensor, -1 if there is none, -2 if more than one (or a while loop reads it).
+	uint32_t* aliased; // Mark a tensor has a live alias, each bit represent a tensor.
+	uint32_t* written; // Mark a tensor is written by an exec, each bit represent a tensor.
+	int* exec_remap; // The exec that took over a removed exec, or itself.
+	uint32_t* exec_visited; // Mark an exec is in the range simplify visited, each bit represent an exec.
+	ccv_array_t* fold_execs; // The batch norm fold execs, they only read constants, thus, are new sources.
+} ccv_nnc_ops_fusion_t;
+
+// Index who reads and writes each tensor once, rather than going through the graph for every query. Tensors created
+// afterwards (the folded weights and bias) are not indexed, they are never the output of a candidate.
+static void _ccv_nnc_ops_fusion_index(ccv_nnc_ops_fusion_t* const fusion)
+{
+	ccv_nnc_symbolic_graph_t* const graph = fusion->graph;
+	const int tensor_symbol_info_size = graph->tensor_symbol_info->rnum;
+	fusion->tensor_symbol_info_size = tensor_symbol_info_size;
+	fusion->consumers = (int*)ccrealloc(fusion->consumers, sizeof(int) * tensor_symbol_info_size + sizeof(uint32_t) * ((tensor_symbol_info_size + 31) >> 5) * 2);
+	fusion->aliased = (uint32_t*)(fusion->consumers + tensor_symbol_info_size);
+	fusion->written = fusion->aliased + ((tensor_symbol_info_size + 31) >> 5);
+	memset(fusion->aliased, 0, sizeof(uint32_t) * ((tensor_symbol_info_size + 31) >> 5) * 2);
+	int i, j;
+	for (i = 0; i < tensor_symbol_info_size; i++)
+	{
+		fusion->consumers[i] = -1;
+		const ccv_nnc_tensor_symbol_info_t* const alias_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, i);
+		if (!CCV_NNC_TENSOR_SYMBOL_IS_DEAD(alias_info->flags) && alias_info->alias_ref)
+		{
+			const int d = alias_info->alias_ref - 1;
+			fusion->aliased[d >> 5] |= (1u << (d & 0x1f));
+		}
+	}
+	for (i = 0; i < graph->exec_symbol_info->rnum; i++)
+	{
+		const ccv_nnc_graph_exec_symbol_info_t* const exec_info = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, i);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(exec_info->flags))
+			continue;
+		for (j = 0; j < exec_info->input_size; j++)
+		{
+			const int d = exec_info->inputs[j];
+			if (d >= 0)
+				fusion->consumers[d] = (fusion->consumers[d] == -1 || fusion->consumers[d] == i) ? i : -2;
+		}
+		for (j = 0; j < exec_info->output_size; j++)
+		{
+			const int d = exec_info->outputs[j];
+			if (d >= 0)
+				fusion->written[d >> 5] |= (1u << (d & 0x1f));
+		}
+		if ((exec_info->flags & CCV_NNC_GRAPH_EXEC_P_WHILE) && exec_info->p_while.inputs)
+			for (j = 0; j < exec_info->p_while.input_size; j++)
+				if (exec_info->p_while.inputs[j] >= 0)
+					fusion->consumers[exec_info->p_while.inputs[j]] = -2;
+	}
+}
+
+// The exec that reads tensor d is now a different one.
+static void _ccv_nnc_ops_fusion_consumer_move(ccv_nnc_ops_fusion_t* const fusion, const int d, const int from, const int to)
+{
+	if (d >= 0 && d < fusion->tensor_symbol_info_size && fusion->consumers[d] == from)
+		fusion->consumers[d] = to;
+}
+
+// Remove the exec, the range refers to the one took over afterwards.
+static void _ccv_nnc_ops_fusion_exec_free(ccv_nnc_ops_fusion_t* const fusion, const int d, const int to)
+{
+	fusion->exec_remap[d] = to;
+	ccv_nnc_graph_exec_symbol_free(fusion->graph, (ccv_nnc_graph_exec_symbol_t){
+		.d = d,
+		.graph = fusion->graph,
+	});
+}
+
+static int _ccv_nnc_ops_fusion_tensor_is_local(const ccv_nnc_ops_fusion_t* const fusion, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const int d)
+{
+	if (d >= fusion->tensor_symbol_info_size)
+		return 0;
+	const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(fusion->graph->tensor_symbol_info, d);
+	// Aliases, carry overs (for while), bypasses (for case..of) and tensors shared with sub-graphs are left as is.
+	if (symbol_info->alias_ref || symbol_info->assign_ref || symbol_info->r_assign_ref ||
+		symbol_info->bypass_ref || symbol_info->r_bypass_ref || symbol_info->p_ref || (symbol_info->s_ref && symbol_info->s_ref->rnum))
+		return 0;
+	if (CCV_TENSOR_GET_MEMORY(symbol_info->info.type) != CCV_TENSOR_CPU_MEMORY || symbol_info->info.datatype != CCV_32F)
+		return 0;
+	int i;
+	for (i = 0; i < output_size; i++)
+		if (outputs[i].d == d)
+			return 0;
+	return !(fusion->aliased[d >> 5] & (1u << (d & 0x1f)));
+}
+
+// Find the only command that reads tensor d, -1 if there is none, more than one, or it is out of the range.
+static int _ccv_nnc_ops_fusion_unique_consumer(const ccv_nnc_ops_fusion_t* const fusion, const int d)
+{
+	if (d < 0 || d >= fusion->tensor_symbol_info_size)
+		return -1;
+	const int consumer = fusion->consumers[d];
+	if (consumer < 0 || consumer >= fusion->exec_symbol_info_size || !(fusion->exec_visited[consumer >> 5] & (1u << (consumer & 0x1f))))
+		return -1;
+	return consumer;
+}
+
+// Parameters folded into the convolution / GEMM have to be ready before the graph runs.
+static int _ccv_nnc_ops_fusion_is_constant(const ccv_nnc_ops_fusion_t* const fusion, const int d)
+{
+	if (d < 0 || d >= fusion->tensor_symbol_info_size)
+		return 0;
+	const ccv_nnc_tensor_symbol_info_t* const symbol_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(fusion->graph->tensor_symbol_info, d);
+	if (symbol_info->alias_ref || symbol_info->assign_ref || symbol_info->p_ref ||
+		CCV_TENSOR_GET_MEMORY(symbol_info->info.type) != CCV_TENSOR_CPU_MEMORY || symbol_info->info.datatype != CCV_32F)
+		return 0;
+	return !(fusion->written[d >> 5] & (1u << (d & 0x1f)));
+}
+
+static int _ccv_nnc_ops_fusion_channel_axis(const ccv_nnc_cmd_t cmd, const ccv_nnc_tensor_param_t info)
+{
+	const int nd = ccv_nnc_tensor_nd(info.dim);
+	if (cmd.cmd == CCV_NNC_GEMM_FORWARD)
+		return nd - 1;
+	if (info.format == CCV_TENSOR_FORMAT_NHWC)
+		return nd - 1;
+	if (info.format == CCV_TENSOR_FORMAT_NCHW)
+		return nd - 3;
+	return -1;
+}
+
+// Batch norm in test mode normalizes over every axis but the channel axis of the convolution / GEMM output.
+static int _ccv_nnc_ops_fusion_bnorm_is_per_channel(const ccv_nnc_cmd_param_t bnorm, const int nd, const int channel_axis)
+{
+	if (bnorm.bnorm.count != nd - 1)
+		return 0;
+	int i, axis_mask = 0;
+	for (i = 0; i < bnorm.bnorm.count; i++)
+		axis_mask |= (1 << bnorm.bnorm.axis[i]);
+	return axis_mask == (((1 << nd) - 1) & ~(1 << channel_axis));
+}
+
+// A bias can be folded if it only spans the channel axis when broadcast to the output (trailing dimensions are aligned).
+static int _ccv_nnc_ops_fusion_bias_is_per_channel(const ccv_nnc_tensor_param_t bias, const int nd, const int channel_axis, const int count)
+{
+	const int bias_nd = ccv_nnc_tensor_nd(bias.dim);
+	if (bias_nd != nd - channel_axis || bias.dim[0] != count)
+		return 0;
+	int i;
+	for (i = 1; i < bias_nd; i++)
+		if (bias.dim[i] != 1)
+			return 0;
+	return 1;
+}
+
+static void _ccv_nnc_ops_fusion_epilogue(ccv_nnc_ops_fusion_t* const fusion, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const int idx)
+{
+	ccv_nnc_symbolic_graph_t* const graph = fusion->graph;
+	for (;;)
+	{
+		ccv_nnc_graph_exec_symbol_info_t* node = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		const int y = node->outputs[0];
+		const int x = node->inputs[0];
+		const int w = node->inputs[1];
+		const int bias = node->input_size > 2 ? node->inputs[2] : CCV_NNC_NO_TENSOR_SYMBOL;
+		if (!_ccv_nnc_ops_fusion_tensor_is_local(fusion, outputs, output_size, y))
+			return;
+		const int consumer_idx = _ccv_nnc_ops_fusion_unique_consumer(fusion, y);
+		if (consumer_idx < 0)
+			return;
+		const ccv_nnc_graph_exec_symbol_info_t* const consumer = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, consumer_idx);
+		if (consumer->graph_ref_size || consumer->output_size < 1 || consumer->outputs[0] < 0)
+			return;
+		int i;
+		for (i = 1; i < consumer->output_size; i++)
+			if (consumer->outputs[i] >= 0)
+				return;
+		const int z = consumer->outputs[0];
+		const ccv_nnc_tensor_param_t y_params = ((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, y))->info;
+		const ccv_nnc_tensor_param_t z_params = ((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, z))->info;
+		if (z_params.type != y_params.type || z_params.format != y_params.format || z_params.datatype != y_params.datatype || memcmp(z_params.dim, y_params.dim, sizeof(y_params.dim)) != 0)
+			return;
+		const int nd = ccv_nnc_tensor_nd(y_params.dim);
+		const int channel_axis = _ccv_nnc_ops_fusion_channel_axis(node->cmd, y_params);
+		if (channel_axis < 0)
+			return;
+		const int count = y_params.dim[channel_axis];
+		const ccv_nnc_graph_exec_symbol_t exec = {
+			.d = idx,
+			.graph = graph,
+		};
+		const uint32_t consumer_cmd = consumer->cmd.cmd;
+		if (consumer_cmd == CCV_NNC_ADD_FORWARD && consumer->cmd.info.blas.a[0] == 1 && consumer->cmd.info.blas.a[1] == 1 &&
+			consumer->input_size == 2 && bias < 0)
+		{
+			// y + bias, where bias is per channel, becomes the bias of the convolution / GEMM.
+			const int new_bias = consumer->inputs[0] == y ? consumer->inputs[1] : consumer->inputs[0];
+			if (new_bias == y || !_ccv_nnc_ops_fusion_is_constant(fusion, new_bias) ||
+				!_ccv_nnc_ops_fusion_bias_is_per_channel(((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, new_bias))->info, nd, channel_axis, count))
+				return;
+			const ccv_nnc_tensor_symbol_t inputs[] = {
+				{ .d = x, .graph = graph },
+				{ .d = w, .graph = graph },
+				{ .d = new_bias, .graph = graph },
+			};
+			const ccv_nnc_tensor_symbol_t output = { .d = z, .graph = graph };
+			_ccv_nnc_ops_fusion_exec_free(fusion, consumer_idx, idx);
+			ccv_nnc_graph_exec_symbol_set_io(graph, exec, inputs, 3, &output, 1);
+			_ccv_nnc_ops_fusion_consumer_move(fusion, new_bias, consumer_idx, idx);
+		} else if (consumer_cmd == CCV_NNC_BATCH_NORM_FORWARD && consumer->cmd.info.bnorm.is_test && consumer->input_size == 5 &&
+			consumer->inputs[0] == y && _ccv_nnc_ops_fusion_bnorm_is_per_channel(consumer->cmd.info, nd, channel_axis)) {
+			// Batch norm in test mode is an affine transform per channel, fold it into the weights and the bias.
+			for (i = 1; i < 5; i++)
+				if (!_ccv_nnc_ops_fusion_is_constant(fusion, consumer->inputs[i]) ||
+					ccv_nnc_tensor_count(((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, consumer->inputs[i]))->info) != count)
+					return;
+			if (!_ccv_nnc_ops_fusion_is_constant(fusion, w) || (bias >= 0 && !_ccv_nnc_ops_fusion_is_constant(fusion, bias)))
+				return;
+			const ccv_nnc_tensor_param_t w_params = ((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, w))->info;
+			if (w_params.dim[0] != count)
+				return;
+			const ccv_nnc_tensor_symbol_t fold_inputs[] = {
+				{ .d = w, .graph = graph },
+				{ .d = bias, .graph = bias >= 0 ? graph : 0 },
+				{ .d = consumer->inputs[1], .graph = graph },
+				{ .d = consumer->inputs[2], .graph = graph },
+				{ .d = consumer->inputs[3], .graph = graph },
+				{ .d = consumer->inputs[4], .graph = graph },
+			};
+			const ccv_nnc_cmd_t fold = CMD_BATCH_NORM_FOLD_FORWARD(consumer->cmd.info.bnorm.epsilon);
+			const ccv_nnc_tensor_param_t bias_params = {
+				.type = w_params.type,
+				.format = w_params.format,
+				.datatype = CCV_32F,
+				.dim = {
+					count
+				},
+			};
+			// This can move the exec symbol info around, consumer is not valid afterwards.
+			const ccv_nnc_tensor_symbol_t fold_outputs[] = {
+				ccv_nnc_tensor_symbol_new(graph, w_params, 0),
+				ccv_nnc_tensor_symbol_new(graph, bias_params, 0),
+			};
+			const ccv_nnc_graph_exec_symbol_t fold_exec = ccv_nnc_graph_exec_symbol_new(graph, fold, fold_inputs, 6, fold_outputs, 2, 0);
+			const ccv_nnc_tensor_symbol_t inputs[] = {
+				{ .d = x, .graph = graph },
+				fold_outputs[0],
+				fold_outputs[1],
+			};
+			const ccv_nnc_tensor_symbol_t output = { .d = z, .graph = graph };
+			_ccv_nnc_ops_fusion_exec_free(fusion, consumer_idx, idx);
+			ccv_nnc_graph_exec_symbol_set_io(graph, exec, inputs, 3, &output, 1);
+			ccv_nnc_graph_exec_symbol_concat(graph, fold_exec, exec);
+			ccv_array_push(fusion->fold_execs, &fold_exec);
+			for (i = 0; i < 6; i++)
+				_ccv_nnc_ops_fusion_consumer_move(fusion, fold_inputs[i].d, i < 2 ? idx : consumer_idx, fold_exec.d);
+		} else if (consumer_cmd == CCV_NNC_RELU_FORWARD && consumer->input_size == 1) {
+			// ReLU is applied before the convolution / GEMM writes out, nothing can be fused after that.
+			ccv_nnc_cmd_t cmd = node->cmd;
+			if (cmd.cmd == CCV_NNC_GEMM_FORWARD)
+				cmd.info.blas.relu = 1;
+			else
+				cmd.info.convolution.relu = 1;
+			const ccv_nnc_tensor_symbol_t output = { .d = z, .graph = graph };
+			_ccv_nnc_ops_fusion_exec_free(fusion, consumer_idx, idx);
+			ccv_nnc_graph_exec_symbol_set(graph, exec, cmd);
+			node = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+			const ccv_nnc_tensor_symbol_t inputs[] = {
+				{ .d = node->inputs[0], .graph = graph },
+				{ .d = node->inputs[1], .graph = graph },
+				{ .d = node->input_size > 2 ? node->inputs[2] : CCV_NNC_NO_TENSOR_SYMBOL, .graph = node->input_size > 2 && node->inputs[2] >= 0 ? graph : 0 },
+			};
+			ccv_nnc_graph_exec_symbol_set_io(graph, exec, inputs, node->input_size > 2 ? 3 : 2, &output, 1);
+			ccv_nnc_tensor_symbol_free(graph, (ccv_nnc_tensor_symbol_t){
+				.d = y,
+				.graph = graph,
+			});
+			return;
+		} else
+			return;
+		ccv_nnc_tensor_symbol_free(graph, (ccv_nnc_tensor_symbol_t){
+			.d = y,
+			.graph = graph,
+		});
+	}
+}
+
+static int _ccv_nnc_ops_fusion_is_elementwise(const ccv_nnc_graph_exec_symbol_info_t* const node)
+{
+	if (node->graph_ref_size || node->output_size != 1 || node->outputs[0] < 0)
+		return 0;
+	switch (node->cmd.cmd)
+	{
+		case CCV_NNC_EWEXP_FORWARD:
+		case CCV_NNC_EWLOG_FORWARD:
+		case CCV_NNC_EWSQRT_FORWARD:
+		case CCV_NNC_RELU_FORWARD:
+		case CCV_NNC_SCALAR_MUL_FORWARD:
+			return node->input_size == 1 && node->inputs[0] >= 0;
+		case CCV_NNC_EWSUM_FORWARD:
+		case CCV_NNC_EWPROD_FORWARD:
+		case CCV_NNC_EWDIV_FORWARD:
+			return node->input_size == 2 && node->inputs[0] >= 0 && node->inputs[1] >= 0 && node->inputs[0] != node->inputs[1];
+	}
+	return 0;
+}
+
+static int _ccv_nnc_ops_fusion_same_params(const ccv_nnc_symbolic_graph_t* const graph, const int a, const int b)
+{
+	const ccv_nnc_tensor_symbol_info_t* const a_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, a);
+	const ccv_nnc_tensor_symbol_info_t* const b_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, b);
+	// The chain runs on the contiguous memory directly, thus, no aliases.
+	return !a_info->alias_ref && !b_info->alias_ref &&
+		a_info->info.type == b_info->info.type && a_info->info.format == b_info->info.format && a_info->info.datatype == b_info->info.datatype &&
+		memcmp(a_info->info.dim, b_info->info.dim, sizeof(a_info->info.dim)) == 0;
+}
+
+static void _ccv_nnc_ops_fusion_elementwise_chains(ccv_nnc_ops_fusion_t* const fusion, const ccv_array_t* const execs, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size)
+{
+	ccv_nnc_symbolic_graph_t* const graph = fusion->graph;
+	int chain[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_symbol_t inputs[CCV_NNC_MAX_DIM_ALLOC + 1];
+	int i, j;
+	for (j = 0; j < execs->rnum; j++)
+	{
+		const int idx = *(int*)ccv_array_get(execs, j);
+		const ccv_nnc_graph_exec_symbol_info_t* const node = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(node->flags) || !_ccv_nnc_ops_fusion_is_elementwise(node))
+			continue;
+		const int x = node->inputs[0];
+		if (CCV_TENSOR_GET_MEMORY(((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, x))->info.type) != CCV_TENSOR_CPU_MEMORY ||
+			((ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, x))->info.datatype != CCV_32F ||
+			!_ccv_nnc_ops_fusion_same_params(graph, x, node->outputs[0]) ||
+			(node->input_size > 1 && !_ccv_nnc_ops_fusion_same_params(graph, x, node->inputs[1])))
+			continue;
+		// Extend the chain as long as the intermediate result is only read by the next element-wise command.
+		int chain_size = 1;
+		chain[0] = idx;
+		for (;;)
+		{
+			const ccv_nnc_graph_exec_symbol_info_t* const tail = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, chain[chain_size - 1]);
+			const int t = tail->outputs[0];
+			if (chain_size >= CCV_NNC_MAX_DIM_ALLOC || !_ccv_nnc_ops_fusion_tensor_is_local(fusion, outputs, output_size, t))
+				break;
+			const int next_idx = _ccv_nnc_ops_fusion_unique_consumer(fusion, t);
+			if (next_idx < 0)
+				break;
+			const ccv_nnc_graph_exec_symbol_info_t* const next = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, next_idx);
+			if (!_ccv_nnc_ops_fusion_is_elementwise(next) || !_ccv_nnc_ops_fusion_same_params(graph, x, next->outputs[0]))
+				break;
+			if (next->input_size > 1)
+			{
+				// The result so far has to be the numerator for division.
+				if (next->inputs[0] != t && (next->cmd.cmd == CCV_NNC_EWDIV_FORWARD || next->inputs[1] != t))
+					break;
+				if (!_ccv_nnc_ops_fusion_same_params(graph, x, next->inputs[0] == t ? next->inputs[1] : next->inputs[0]))
+					break;
+			}
+			chain[chain_size++] = next_idx;
+		}
+		if (chain_size < 2)
+			continue;
+		ccv_nnc_cmd_param_t params = {
+			.ewchain = {
+				.count = chain_size,
+			},
+		};
+		int input_size = 0;
+		inputs[input_size++] = (ccv_nnc_tensor_symbol_t){
+			.d = x,
+			.graph = graph,
+		};
+		int t = x;
+		for (i = 0; i < chain_size; i++)
+		{
+			const ccv_nnc_graph_exec_symbol_info_t* const link = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, chain[i]);
+			params.ewchain.cmds[i] = link->cmd.cmd;
+			params.ewchain.a[i] = link->cmd.cmd == CCV_NNC_SCALAR_MUL_FORWARD ? link->cmd.info.blas.a[0] : 0;
+			if (link->input_size > 1)
+				inputs[input_size++] = (ccv_nnc_tensor_symbol_t){
+					.d = link->inputs[0] == t ? link->inputs[1] : link->inputs[0],
+					.graph = graph,
+				};
+			t = link->outputs[0];
+		}
+		// The last command in the chain becomes the chain, the rest and their results are removed.
+		const ccv_nnc_graph_exec_symbol_t exec = {
+			.d = chain[chain_size - 1],
+			.graph = graph,
+		};
+		const ccv_nnc_tensor_symbol_t output = {
+			.d = t,
+			.graph = graph,
+		};
+		for (i = 0; i < chain_size - 1; i++)
+		{
+			const int d = ((ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, chain[i]))->outputs[0];
+			_ccv_nnc_ops_fusion_exec_free(fusion, chain[i], exec.d);
+			ccv_nnc_tensor_symbol_free(graph, (ccv_nnc_tensor_symbol_t){
+				.d = d,
+				.graph = graph,
+			});
+		}
+		ccv_nnc_graph_exec_symbol_set(graph, exec, ccv_nnc_cmd(CCV_NNC_EWCHAIN_FORWARD, 0, params, 0));
+		ccv_nnc_graph_exec_symbol_set_io(graph, exec, inputs, input_size, &output, 1);
+		// The inputs read by any link are read by the chain now.
+		for (i = 0; i < input_size; i++)
+			if (inputs[i].d < fusion->tensor_symbol_info_size && fusion->consumers[inputs[i].d] >= 0)
+				fusion->consumers[inputs[i].d] = exec.d;
+	}
+}
+
+// Map the execs in the range to the ones took over, drop the ones removed by the previous passes, and add the new sources.
+static void _ccv_nnc_ops_fusion_range_remap(const ccv_nnc_ops_fusion_t* const fusion, ccv_array_t* const range, const ccv_array_t* const new_execs)
+{
+	int i, j, k = 0;
+	for (i = 0; i < range->rnum; i++)
+	{
+		ccv_nnc_graph_exec_symbol_t symbol = *(ccv_nnc_graph_exec_symbol_t*)ccv_array_get(range, i);
+		if (symbol.d < 0 || symbol.d >= fusion->exec_symbol_info_size)
+			continue;
+		while (fusion->exec_remap[symbol.d] != symbol.d)
+			symbol.d = fusion->exec_remap[symbol.d];
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(((ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(fusion->graph->exec_symbol_info, symbol.d))->flags))
+			continue;
+		for (j = 0; j < k; j++)
+			if (((ccv_nnc_graph_exec_symbol_t*)ccv_array_get(range, j))->d == symbol.d)
+				break;
+		if (j == k)
+			*(ccv_nnc_graph_exec_symbol_t*)ccv_array_get(range, k++) = symbol;
+	}
+	range->rnum = k;
+	if (new_execs)
+		for (i = 0; i < new_execs->rnum; i++)
+			ccv_array_push(range, ccv_array_get(new_execs, i));
+}
+
+// Unlike the other passes, this one creates new symbols (for batch norm folding), thus, it works on the graph directly
+// as ccv_nnc_symbolic_graph_quantize does. The execs are the ones simplify visited, in topological order, and the range
+// is updated to the execs after fusion.
+static void _ccv_nnc_symbolic_graph_ops_fusion(ccv_nnc_symbolic_graph_t* const graph, const ccv_array_t* const execs, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, ccv_array_t* const sources, ccv_array_t* const destinations)
+{
+	ccv_nnc_ops_fusion_t fusion = {
+		.graph = graph,
+		.exec_symbol_info_size = graph->exec_symbol_info->rnum,
+		.exec_remap = (int*)ccmalloc(sizeof(int) * graph->exec_symbol_info->rnum + sizeof(uint32_t) * ((graph->exec_symbol_info->rnum + 31) >> 5)),
+		.fold_execs = ccv_array_new(sizeof(ccv_nnc_graph_exec_symbol_t), 0, 0),
+	};
+	fusion.exec_visited = (uint32_t*)(fusion.exec_remap + fusion.exec_symbol_info_size);
+	memset(fusion.exec_visited, 0, sizeof(uint32_t) * ((fusion.exec_symbol_info_size + 31) >> 5));
+	int i;
+	for (i = 0; i < fusion.exec_symbol_info_size; i++)
+		fusion.exec_remap[i] = i;
+	for (i = 0; i < execs->rnum; i++)
+	{
+		const int idx = *(int*)ccv_array_get(execs, i);
+		fusion.exec_visited[idx >> 5] |= (1u << (idx & 0x1f));
+	}
+	_ccv_nnc_ops_fusion_index(&fusion);
+	for (i = 0; i < execs->rnum; i++)
+	{
+		const int idx = *(int*)ccv_array_get(execs, i);
+		const ccv_nnc_graph_exec_symbol_info_t* const node = (ccv_nnc_graph_exec_symbol_info_t*)ccv_array_get(graph->exec_symbol_info, idx);
+		if (CCV_NNC_GRAPH_EXEC_IS_DEAD(node->flags) || (node->cmd.cmd != CCV_NNC_CONVOLUTION_FORWARD && node->cmd.cmd != CCV_NNC_GEMM_FORWARD))
+			continue;
+		if (node->graph_ref_size || (node->input_size != 2 && node->input_size != 3) || node->output_size != 1 ||
+			node->inputs[0] < 0 || node->inputs[1] < 0 || node->outputs[0] < 0)
+			continue;
+		// Grouped convolution doesn't have the fused kernels, and the int8 kernels only do ReLU.
+		if (node->cmd.cmd == CCV_NNC_CONVOLUTION_FORWARD && node->cmd.info.convolution.groups != 1)
+			continue;
+		const ccv_nnc_tensor_symbol_info_t* const w_info = (ccv_nnc_tensor_symbol_info_t*)ccv_array_get(graph->tensor_symbol_info, node->inputs[1]);
+		if (CCV_TENSOR_GET_MEMORY(w_info->info.type) != CCV_TENSOR_CPU_MEMORY || w_info->info.datatype != CCV_32F)
+			continue;
+		_ccv_nnc_ops_fusion_epilogue(&fusion, outputs, output_size, idx);
+	}
+	// The epilogues freed tensors and added a few, index again for the chains.
+	_ccv_nnc_ops_fusion_index(&fusion);
+	_ccv_nnc_ops_fusion_elementwise_chains(&fusion, execs, outputs, output_size);
+	// The fold commands only read constants, thus, they are new sources. The graph level sources / destinations are
+	// autogen'ed when simplify applies at the end.
+	_ccv_nnc_ops_fusion_range_remap(&fusion, sources, fusion.fold_execs);
+	_ccv_nnc_ops_fusion_range_remap(&fusion, destinations, 0);
+	ccv_array_free(fusion.fold_execs);
+	ccfree(fusion.consumers);
+	ccfree(fusion.exec_remap);
+}
+
 void ccv_nnc_symbolic_graph_simplify(ccv_nnc_symbolic_graph_t* const graph, const int* const passes, const int pass_size, const ccv_nnc_tensor_symbol_t* const outputs, const int output_size, const ccv_nnc_graph_exec_symbol_t* const sources, const int source_size, const ccv_nnc_graph_exec_symbol_t* const destinations, const int destination_size)
 {
-	ccv_nnc_symbolic_graph_simplify_t* const simplify = _ccv_nnc_symbolic_graph_simplify_new(graph, sources, source_size, destinations, destination_size);
+	ccv_nnc_symbolic_graph_simplify_t* simplify = _ccv_nnc_symbolic_graph_simplify_new(graph, sources, source_size, destinations, destination_size);
+	// Ops fusion adds and removes execs, the range it leaves behind is kept here.
+	ccv_array_t* range_sources = 0;
+	ccv_array_t* range_destinations = 0;
 	int i;
 	for (i = 0; i < pass_size; i++)
 		switch (passes[i])
@@ -779,10 +1419,43 @@ void ccv_nnc_symbolic_graph_simplify(ccv_nnc_symbolic_graph_t* const graph, cons
 			case CCV_NNC_SIMPLIFY_DATA_TRANSFER_OPT:
 				_ccv_nnc_symbolic_graph_data_transfer_opt(simplify, outputs, output_size);
 				break;
+			case CCV_NNC_SIMPLIFY_FORMAT_TRANSFORM_OPT:
+				_ccv_nnc_symbolic_graph_format_transform_opt(simplify, outputs, output_size);
+				break;
+			case CCV_NNC_SIMPLIFY_OPS_FUSION:
+			{
+				if (!range_sources)
+				{
+					range_sources = ccv_array_new(sizeof(ccv_nnc_graph_exec_symbol_t), source_size, 0);
+					int j;
+					for (j = 0; j < source_size; j++)
+						ccv_array_push(range_sources, sources + j);
+					range_destinations = ccv_array_new(sizeof(ccv_nnc_graph_exec_symbol_t), destination_size, 0);
+					for (j = 0; j < destination_size; j++)
+						ccv_array_push(range_destinations, destinations + j);
+				}
+				// Take the execs in the range before settling what the previous passes did, fuse on the graph, and pick up
+				// from the updated graph within the same range.
+				ccv_array_t* const execs = ccv_array_new(sizeof(int), simplify->visit->size, 0);
+				ccv_nnc_graph_visit_for(simplify->visit, simplify->exec_symbol_info, node, idx) {
+					if (!(simplify->exec_dead[idx >> 5] & (1u << (idx & 0x1f))))
+						ccv_array_push(execs, &idx);
+				} ccv_nnc_graph_visit_endfor
+				_ccv_nnc_symbolic_graph_simplify_apply(simplify);
+				_ccv_nnc_symbolic_graph_simplify_free(simplify);
+				_ccv_nnc_symbolic_graph_ops_fusion(graph, execs, outputs, output_size, range_sources, range_destinations);
+				ccv_array_free(execs);
+				simplify = _ccv_nnc_symbolic_graph_simplify_new(graph, (ccv_nnc_graph_exec_symbol_t*)ccv_array_get(range_sources, 0), range_sources->rnum, (ccv_nnc_graph_exec_symbol_t*)ccv_array_get(range_destinations, 0), range_destinations->rnum);
+				break;
+			}
 			case CCV_NNC_SIMPLIFY_GRAPH_PRUNING:
 				_ccv_nnc_symbolic_graph_pruning(simplify, outputs, output_size);
 				break;
 		}
 	_ccv_nnc_symbolic_graph_simplify_apply(simplify);
 	_ccv_nnc_symbolic_graph_simplify_free(simplify);
+	if (range_sources)
+		ccv_array_free(range_sources);
+	if (range_destinations)
+		ccv_array_free(range_destinations);
 }
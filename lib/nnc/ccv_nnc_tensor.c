@@ -92,8 +92,24 @@ ccv_nnc_tensor_t ccv_nnc_tensor(const void* const ptr, const ccv_nnc_tensor_para
 	return tensor;
 }
 
+// What kernels cached from constant tensors is only valid within the same epoch.
+static uint64_t tensor_constant_epoch = 0;
+
+void ccv_nnc_tensor_constant_invalidate(void)
+{
+	__sync_add_and_fetch(&tensor_constant_epoch, 1);
+}
+
+uint64_t ccv_nnc_tensor_constant_epoch(void)
+{
+	return __sync_add_and_fetch(&tensor_constant_epoch, 0);
+}
+
 void ccv_nnc_tensor_free(ccv_nnc_tensor_t* const tensor)
 {
+	// The memory can be reused by another constant tensor.
+	if (CCV_IS_TENSOR_CONSTANT(tensor))
+		ccv_nnc_tensor_constant_invalidate();
 #ifdef HAVE_CUDA
 	if (CCV_TENSOR_GET_MEMORY(tensor->info.type) == CCV_TENSOR_GPU_MEMORY)
 		cufree(CCV_TENSOR_GET_DEVICE_ID(tensor->info.type), tensor->data.u8);
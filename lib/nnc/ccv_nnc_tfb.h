@@ -53,6 +53,7 @@ enum {
 enum {
 	CCV_TENSOR_VIEW      = 0x01000000,
 	CCV_TENSOR_MULTIVIEW = 0x02000000,
+	CCV_TENSOR_CONSTANT  = 0x04000000, // The content won't change while flagged, thus, kernels may cache what they derived from it.
 };
 
 typedef union ccv_numeric_data_u {
@@ -61,6 +62,7 @@ typedef union ccv_numeric_data_u {
 	float* f32;
 	int64_t* i64;
 	double* f64;
+	uint16_t* f16; // Half precision float point, stored as raw bits.
 	void* ptr; // Raw pointer
 } ccv_numeric_data_t;
 
@@ -97,6 +99,7 @@ typedef struct {
 
 #define CCV_IS_TENSOR_VIEW(x) ((*(int*)(x)) & CCV_TENSOR_VIEW)
 #define CCV_IS_TENSOR_MULTIVIEW(x) ((*(int*)(x)) & CCV_TENSOR_MULTIVIEW)
+#define CCV_IS_TENSOR_CONSTANT(x) ((*(int*)(x)) & CCV_TENSOR_CONSTANT)
 
 #if CCV_NNC_TENSOR_TFB
 #define CCV_TENSOR_IS_DENSE_MATRIX(x) (((x) & 0xFFF) > 0) // has channel components
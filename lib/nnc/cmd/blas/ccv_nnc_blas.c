@@ -14,6 +14,12 @@ static int _ccv_nnc_gemm_forw_bitmask(const int input_size, const int output_siz
 	// No bias is OK.
 	if (input_size == 2 && (input_bitmasks[0] & 3u) == ((1u << 0) | (1u << 1)) && output_bitmasks[0] == 1u)
 		return 1;
+	// Quantized, with the quantization parameters for a and w.
+	if (input_size == 5 && (input_bitmasks[0] & 31u) == ((1u << 0) | (1u << 1) | (1u << 2) | (1u << 3) | (1u << 4)) && output_bitmasks[0] == 1u)
+		return 1;
+	// Quantized, no bias.
+	if (input_size == 5 && (input_bitmasks[0] & 31u) == ((1u << 0) | (1u << 1) | (0u << 2) | (1u << 3) | (1u << 4)) && output_bitmasks[0] == 1u)
+		return 1;
 	return 0;
 }
 
@@ -39,14 +45,15 @@ static void _ccv_nnc_gemm_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const
 	assert(output_size == 1);
 	outputs[0].type = inputs[0].type;
 	outputs[0].format = inputs[0].format;
-	outputs[0].datatype = inputs[0].datatype;
+	// The quantized GEMM takes 8U inputs but always outputs 32F.
+	outputs[0].datatype = inputs[0].datatype == CCV_8U ? CCV_32F : inputs[0].datatype;
 	outputs[0].dim[0] = inputs[0].dim[0]; // batch size.
 	outputs[0].dim[1] = inputs[1].dim[0]; // from the weight matrix.
 	assert(inputs[1].dim[0] == cmd.blas.count);
 }
 
 REGISTER_COMMAND(CCV_NNC_GEMM_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_gemm_cpu_ref.c, ccv_nnc_gemm_cpu_opt.c, gpu/ccv_nnc_gemm_gpu_cublas.cu)
+	FIND_BACKEND(ccv_nnc_gemm_cpu_ref.c, ccv_nnc_gemm_cpu_opt.c, ccv_nnc_gemm_cpu_int8.c, gpu/ccv_nnc_gemm_gpu_cublas.cu)
 {
 	registry->bitmask = _ccv_nnc_gemm_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_gemm_tensor_auto_forw;
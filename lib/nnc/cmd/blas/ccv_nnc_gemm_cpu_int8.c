@@ -0,0 +1,89 @@
+#include <ccv.h>
+#include <ccv_internal.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
+
+static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	// inputs: a (8U), w (8U), [bias (32F)], a quantization parameters, w quantization parameters (see CCV_NNC_QUANTIZE_FORWARD).
+	if (input_size != 5 || inputs[0]->info.datatype != CCV_8U || inputs[1]->info.datatype != CCV_8U)
+		return CCV_NNC_EXEC_INVALID;
+	const ccv_nnc_tensor_view_t* a = (const ccv_nnc_tensor_view_t*)inputs[0];
+	const ccv_nnc_tensor_view_t* w = (const ccv_nnc_tensor_view_t*)inputs[1];
+	const ccv_nnc_tensor_view_t* bias = (const ccv_nnc_tensor_view_t*)inputs[2];
+	const ccv_nnc_tensor_t* aq = inputs[3];
+	const ccv_nnc_tensor_t* wq = inputs[4];
+	// Copy the most of parameters, but reshape the dimension of a to a vector.
+	assert(a->info.dim[2] == 0); // It is a 2-d array.
+	assert(output_size == 1);
+	ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[0];
+	assert(b->info.datatype == CCV_32F);
+	assert(b->info.dim[2] == 0); // It is a 2-d array.
+	assert(w->info.dim[2] == 0); // It is a 2-d array
+	assert(!bias || bias->info.dim[1] == 0); // It is a 1-d array
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == 1 || a_nd == 2);
+	const int* adim = (a_nd == 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == 1 || b_nd == 2);
+	const int* bdim = (b_nd == 1) ? b->info.dim : b->info.dim + 1;
+	const int batch_size = a_nd == 1 ? 1 : ccv_max(1, a->info.dim[0]);
+	assert(batch_size == (b_nd == 1) ? 1 : ccv_max(1, b->info.dim[0]));
+	assert(!bias || bdim[0] == bias->info.dim[0]);
+	assert(bdim[0] == w->info.dim[0]);
+	assert(adim[0] == w->info.dim[1]);
+	assert(aq->info.datatype == CCV_32F && aq->info.dim[0] == 1);
+	assert(wq->info.datatype == CCV_32F && (wq->info.dim[0] == 1 || wq->info.dim[0] == bdim[0]));
+	const int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? (a_nd == 1 ? a->inc[0] : a->inc[1]) : adim[0];
+	const int b_batch_inc = CCV_IS_TENSOR_VIEW(b) ? (b_nd == 1 ? b->inc[0] : b->inc[1]) : bdim[0];
+	const int* winc = CCV_IS_TENSOR_VIEW(w) ? w->inc : w->info.dim;
+	const float a_scale = aq->data.f32[0];
+	const int a_zero_point = (int)lrintf(aq->data.f32[1]);
+	const int w_per_channel = wq->info.dim[0] > 1;
+	// The row sums of w only depend on w, compute them once for the whole batch.
+	int32_t* const wsum = (int32_t*)ccmalloc(sizeof(int32_t) * bdim[0]);
+	parallel_for(j, bdim[0]) {
+		const unsigned char* const wp = w->data.u8 + j * winc[1];
+		const int w_zero_point = (int)lrintf(wq->data.f32[w_per_channel ? j * 2 + 1 : 1]);
+		int32_t v = 0;
+		int k;
+		for (k = 0; k < adim[0]; k++)
+			v += (int32_t)wp[k] - w_zero_point;
+		wsum[j] = v;
+	} parallel_endfor
+	int i;
+	for (i = 0; i < batch_size; i++)
+	{
+		const unsigned char* const ap = a->data.u8 + i * a_batch_inc;
+		float* const bp = b->data.f32 + i * b_batch_inc;
+		parallel_for(j, bdim[0]) {
+			const unsigned char* const wp = w->data.u8 + j * winc[1];
+			const int w_zero_point = (int)lrintf(wq->data.f32[w_per_channel ? j * 2 + 1 : 1]);
+			const float scale = a_scale * wq->data.f32[w_per_channel ? j * 2 : 0];
+			int32_t v = 0;
+			int k;
+			for (k = 0; k < adim[0]; k++)
+				v += ((int32_t)wp[k] - w_zero_point) * ap[k];
+			const float y = (bias ? bias->data.f32[j] : 0) + scale * (v - a_zero_point * wsum[j]);
+			bp[j] = cmd.info.blas.relu ? ccv_max(y, 0) : y;
+		} parallel_endfor
+	}
+	ccfree(wsum);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_GEMM_FORWARD, CCV_NNC_BACKEND_CPU_INT8)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_8U | CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_gemm_forw;
+}
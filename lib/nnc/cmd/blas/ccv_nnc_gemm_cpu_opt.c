@@ -38,13 +38,19 @@ static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	assert(!bias || bdim[0] == bias->info.dim[0]);
 	assert(bdim[0] == w->info.dim[0]);
 	assert(adim[0] == w->info.dim[1]);
+	// Only the weights can be half precision, they are widened on the fly.
+	if (a->info.datatype != CCV_32F || b->info.datatype != CCV_32F || (bias && bias->info.datatype != CCV_32F) ||
+		(w->info.datatype != CCV_32F && w->info.datatype != CCV_16F))
+		return CCV_NNC_EXEC_INVALID;
+	if (w->info.datatype == CCV_16F)
+		return cmd.algorithm == CCV_NNC_CMD_OPT_GEMM_ALGO_SYSTEM ? CCV_NNC_EXEC_INVALID : _ccv_nnc_gemm_forw_cpu_opt(a, w, bias, b, cmd.info.blas.relu);
 	switch (cmd.algorithm)
 	{
 		case CCV_NNC_CMD_OPT_GEMM_ALGO_DIRECT:
-			return _ccv_nnc_gemm_forw_cpu_opt(a, w, bias, b);
+			return _ccv_nnc_gemm_forw_cpu_opt(a, w, bias, b, cmd.info.blas.relu);
 		case CCV_NNC_CMD_OPT_GEMM_ALGO_SYSTEM:
 			if (!CCV_IS_TENSOR_VIEW(a) && !CCV_IS_TENSOR_VIEW(w) && !CCV_IS_TENSOR_VIEW(bias) && !CCV_IS_TENSOR_VIEW(b))
-				return _ccv_nnc_gemm_forw_cpu_sys(a, w, bias, b);
+				return _ccv_nnc_gemm_forw_cpu_sys(a, w, bias, b, cmd.info.blas.relu);
 			return CCV_NNC_EXEC_INVALID;
 		case -1:
 			// Pass-through
@@ -52,9 +58,9 @@ static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	}
 #if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
 	if (!CCV_IS_TENSOR_VIEW(a) && !CCV_IS_TENSOR_VIEW(w) && !CCV_IS_TENSOR_VIEW(bias) && !CCV_IS_TENSOR_VIEW(b))
-		return _ccv_nnc_gemm_forw_cpu_sys(a, w, bias, b);
+		return _ccv_nnc_gemm_forw_cpu_sys(a, w, bias, b, cmd.info.blas.relu);
 #endif
-	return _ccv_nnc_gemm_forw_cpu_opt(a, w, bias, b);
+	return _ccv_nnc_gemm_forw_cpu_opt(a, w, bias, b, cmd.info.blas.relu);
 }
 
 static int _ccv_nnc_gemm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
@@ -121,7 +127,7 @@ static int _ccv_nnc_gemm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 REGISTER_COMMAND_BACKEND(CCV_NNC_GEMM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
 {
 	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
-	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_datatypes = CCV_32F | CCV_16F;
 	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
 	registry->algorithms = CCV_NNC_CMD_OPT_GEMM_ALGO_COUNT;
 	registry->exec = _ccv_nnc_gemm_forw;
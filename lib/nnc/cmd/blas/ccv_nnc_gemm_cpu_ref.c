@@ -48,7 +48,7 @@ static int _ccv_nnc_gemm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 			int k;
 			for (k = 0; k < adim[0]; k++)
 				v += wp[k] * ap[k];
-			bp[j] = v;
+			bp[j] = cmd.info.blas.relu ? ccv_max(v, 0) : v;
 		} parallel_endfor
 	}
 	return CCV_NNC_EXEC_SUCCESS;
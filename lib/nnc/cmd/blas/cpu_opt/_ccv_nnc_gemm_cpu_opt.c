@@ -17,7 +17,7 @@
 #include "../_ccv_nnc_gemm_cpu_opt.h"
 
 #ifdef HAVE_SSE2
-static int _ccv_nnc_gemm_forw_sse2(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b)
+static int _ccv_nnc_gemm_forw_sse2(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	const int* adim = (a_nd == 1) ? a->info.dim : a->info.dim + 1;
@@ -55,6 +55,8 @@ static int _ccv_nnc_gemm_forw_sse2(const ccv_nnc_tensor_view_t* const a, const c
 				v40 = _mm_add_ps(v40, v41);
 				v41 = _mm_add_ps(v40, _mm_movehl_ps(v40, v40));
 				v40 = _mm_add_ss(v41, _mm_shuffle_ps(v41, v41, 1));
+				if (relu)
+					v40 = _mm_max_ss(v40, _mm_setzero_ps());
 				_mm_store_ss(bp + j, v40);
 			} parallel_endfor
 		}
@@ -80,6 +82,8 @@ static int _ccv_nnc_gemm_forw_sse2(const ccv_nnc_tensor_view_t* const a, const c
 				v40 = _mm_add_ps(v40, v41);
 				v41 = _mm_add_ps(v40, _mm_movehl_ps(v40, v40));
 				v40 = _mm_add_ss(v41, _mm_shuffle_ps(v41, v41, 1));
+				if (relu)
+					v40 = _mm_max_ss(v40, _mm_setzero_ps());
 				_mm_store_ss(bp + j, v40);
 			} parallel_endfor
 		}
@@ -184,7 +188,7 @@ static int _ccv_nnc_gemm_back_sse2(const ccv_nnc_tensor_view_t* const g, const c
 #endif
 
 #ifdef HAVE_NEON
-static int _ccv_nnc_gemm_forw_neon(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b)
+static int _ccv_nnc_gemm_forw_neon(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	const int* adim = (a_nd == 1) ? a->info.dim : a->info.dim + 1;
@@ -218,7 +222,8 @@ static int _ccv_nnc_gemm_forw_neon(const ccv_nnc_tensor_view_t* const a, const c
 				}
 				v40 = vaddq_f32(v40, v41);
 				float32x2_t v2 = vpadd_f32(vget_high_f32(v40), vget_low_f32(v40));
-				bp[j] = vget_lane_f32(vpadd_f32(v2, v2), 0);
+				const float v = vget_lane_f32(vpadd_f32(v2, v2), 0);
+				bp[j] = relu ? ccv_max(v, 0) : v;
 			} parallel_endfor
 		}
 	} else {
@@ -242,7 +247,8 @@ static int _ccv_nnc_gemm_forw_neon(const ccv_nnc_tensor_view_t* const a, const c
 				}
 				v40 = vaddq_f32(v40, v41);
 				float32x2_t v2 = vpadd_f32(vget_high_f32(v40), vget_low_f32(v40));
-				bp[j] = vget_lane_f32(vpadd_f32(v2, v2), 0);
+				const float v = vget_lane_f32(vpadd_f32(v2, v2), 0);
+				bp[j] = relu ? ccv_max(v, 0) : v;
 			} parallel_endfor
 		}
 	}
@@ -341,18 +347,95 @@ static int _ccv_nnc_gemm_back_neon(const ccv_nnc_tensor_view_t* const g, const c
 }
 #endif
 
-int _ccv_nnc_gemm_forw_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b)
+static inline float _ccv_nnc_gemm_dot(const float* const ap, const float* const wp, const int n)
 {
+	int k = 0;
+	float v = 0;
+#if defined(HAVE_SSE2)
+	__m128 v40 = _mm_setzero_ps();
+	__m128 v41 = _mm_setzero_ps();
+	for (; k < n - 7; k += 8)
+	{
+		__m128 ap40 = _mm_loadu_ps(ap + k);
+		__m128 ap41 = _mm_loadu_ps(ap + k + 4);
+		__m128 w40 = _mm_load_ps(wp + k);
+		__m128 w41 = _mm_load_ps(wp + k + 4);
+		v40 =_mm_add_ps(_mm_mul_ps(w40, ap40), v40);
+		v41 =_mm_add_ps(_mm_mul_ps(w41, ap41), v41);
+	}
+	v40 = _mm_add_ps(v40, v41);
+	v41 = _mm_add_ps(v40, _mm_movehl_ps(v40, v40));
+	v40 = _mm_add_ss(v41, _mm_shuffle_ps(v41, v41, 1));
+	_mm_store_ss(&v, v40);
+#elif defined(HAVE_NEON)
+	float32x4_t v40 = vmovq_n_f32(0);
+	float32x4_t v41 = vmovq_n_f32(0);
+	for (; k < n - 7; k += 8)
+	{
+		v40 = vmlaq_f32(v40, vld1q_f32(wp + k), vld1q_f32(ap + k));
+		v41 = vmlaq_f32(v41, vld1q_f32(wp + k + 4), vld1q_f32(ap + k + 4));
+	}
+	v40 = vaddq_f32(v40, v41);
+	float32x2_t v2 = vpadd_f32(vget_high_f32(v40), vget_low_f32(v40));
+	v = vget_lane_f32(vpadd_f32(v2, v2), 0);
+#endif
+	for (; k < n; k++)
+		v += wp[k] * ap[k];
+	return v;
+}
+
+// Half precision weights are widened one block of a row at a time, and the block is used for the whole batch.
+// Thus, the weights are read once per call at half the bytes, the widened block stays in L1.
+#define CCV_NNC_GEMM_16F_BLOCK (256)
+
+static int _ccv_nnc_gemm_forw_16f(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b, const int relu)
+{
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	const int* adim = (a_nd == 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	const int* bdim = (b_nd == 1) ? b->info.dim : b->info.dim + 1;
+	assert(!bias || bdim[0] == bias->info.dim[0]);
+	assert(bdim[0] == w->info.dim[0]);
+	assert(adim[0] == w->info.dim[1]);
+	const int batch_size = a_nd == 1 ? 1 : ccv_max(1, a->info.dim[0]);
+	assert(batch_size == (b_nd == 1) ? 1 : ccv_max(1, b->info.dim[0]));
+	const int a_batch_inc = CCV_IS_TENSOR_VIEW(a) ? (a_nd == 1 ? a->inc[0] : a->inc[1]) : adim[0];
+	const int b_batch_inc = CCV_IS_TENSOR_VIEW(b) ? (b_nd == 1 ? b->inc[0] : b->inc[1]) : bdim[0];
+	const int* winc = CCV_IS_TENSOR_VIEW(w) ? w->inc : w->info.dim;
+	parallel_for(j, bdim[0]) {
+		float wf[CCV_NNC_GEMM_16F_BLOCK] __attribute__((aligned(16)));
+		uint16_t* const wp = w->data.f16 + j * winc[1];
+		int i, k;
+		for (i = 0; i < batch_size; i++)
+			b->data.f32[i * b_batch_inc + j] = bias ? bias->data.f32[j] : 0;
+		for (k = 0; k < adim[0]; k += CCV_NNC_GEMM_16F_BLOCK)
+		{
+			const int n = ccv_min(CCV_NNC_GEMM_16F_BLOCK, adim[0] - k);
+			ccv_half_precision_to_float(wp + k, wf, n);
+			for (i = 0; i < batch_size; i++)
+				b->data.f32[i * b_batch_inc + j] += _ccv_nnc_gemm_dot(a->data.f32 + i * a_batch_inc + k, wf, n);
+		}
+		if (relu)
+			for (i = 0; i < batch_size; i++)
+				b->data.f32[i * b_batch_inc + j] = ccv_max(b->data.f32[i * b_batch_inc + j], 0);
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+int _ccv_nnc_gemm_forw_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b, const int relu)
+{
+	if (w->info.datatype == CCV_16F)
+		return _ccv_nnc_gemm_forw_16f(a, w, bias, b, relu);
 #if defined(HAVE_SSE2) || defined(HAVE_NEON)
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	const int adim = (a_nd == 1) ? a->info.dim[0] : a->info.dim[1];
 #endif
 #if defined(HAVE_SSE2)
 	if (adim % 8 == 0)
-		return _ccv_nnc_gemm_forw_sse2(a, w, bias, b);
+		return _ccv_nnc_gemm_forw_sse2(a, w, bias, b, relu);
 #elif defined(HAVE_NEON)
 	if (adim % 8 == 0)
-		return _ccv_nnc_gemm_forw_neon(a, w, bias, b);
+		return _ccv_nnc_gemm_forw_neon(a, w, bias, b, relu);
 #endif
 	return CCV_NNC_EXEC_INVALID;
 }
@@ -5,7 +5,7 @@
 #include <nnc/ccv_nnc_internal.h>
 #include "../_ccv_nnc_gemm_cpu_opt.h"
 
-int _ccv_nnc_gemm_forw_cpu_sys(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b)
+int _ccv_nnc_gemm_forw_cpu_sys(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_view_t* const w, const ccv_nnc_tensor_view_t* const bias, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 #if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
 	assert(!CCV_IS_TENSOR_VIEW(a));
@@ -37,6 +37,13 @@ int _ccv_nnc_gemm_forw_cpu_sys(const ccv_nnc_tensor_view_t* const a, const ccv_n
 	assert(adim[0] == w->info.dim[1]);
 	ccv_dense_matrix_t wm = ccv_dense_matrix(bdim[0], adim[0], CCV_32F | CCV_C1, w->data.u8, 0);
 	ccv_gemm(&am, &wm, 1, dbm, 1, CCV_B_TRANSPOSE, (ccv_matrix_t**)&dbm, 0); // supply b as matrix C is allowed
+	// BLAS doesn't take an epilogue, apply ReLU on the output while it is still warm.
+	if (relu)
+	{
+		int i;
+		for (i = 0; i < batch_size * bdim[0]; i++)
+			bm.data.f32[i] = ccv_max(bm.data.f32[i], 0);
+	}
 	return CCV_NNC_EXEC_SUCCESS;
 #else
 	return CCV_NNC_EXEC_INVALID;
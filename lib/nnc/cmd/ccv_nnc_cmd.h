@@ -4,6 +4,18 @@ enum {
 	CCV_NNC_CUSTOM_BACKWARD,
 	CCV_NNC_GRAPH_FORWARD,
 	CCV_NNC_GRAPH_BACKWARD,
+	CCV_NNC_GEMM_FORWARD = 0x7e87d00c,
+	CCV_NNC_GEMM_BACKWARD = 0x7e87d00d,
+	CCV_NNC_ADD_FORWARD = 0x58fb3664,
+	CCV_NNC_ADD_BACKWARD = 0x58fb3665,
+	CCV_NNC_MUL_FORWARD = 0x24721a46,
+	CCV_NNC_MUL_BACKWARD = 0x24721a47,
+	CCV_NNC_SCALAR_MUL_FORWARD = 0x8b4d86aa,
+	CCV_NNC_SCALAR_MUL_BACKWARD = 0x8b4d86ab,
+	CCV_NNC_CONVOLUTION_FORWARD = 0x254d05f4,
+	CCV_NNC_CONVOLUTION_BACKWARD = 0x254d05f5,
+	CCV_NNC_DROPOUT_FORWARD = 0x7f2dc3e4,
+	CCV_NNC_DROPOUT_BACKWARD = 0x7f2dc3e5,
 	CCV_NNC_EWSUM_FORWARD = 0xe21a2c4c,
 	CCV_NNC_EWSUM_BACKWARD = 0xe21a2c4d,
 	CCV_NNC_EWPROD_FORWARD = 0xee07e8fe,
@@ -16,41 +28,39 @@ enum {
 	CCV_NNC_EWLOG_BACKWARD = 0xf4191bf3,
 	CCV_NNC_EWSQRT_FORWARD = 0x8870a61e,
 	CCV_NNC_EWSQRT_BACKWARD = 0x8870a61f,
+	CCV_NNC_EWCHAIN_FORWARD = 0xd3a6b850,
+	CCV_NNC_EWCHAIN_BACKWARD = 0xd3a6b851,
+	CCV_NNC_CATEGORICAL_CROSSENTROPY_FORWARD = 0x1eb327a2,
+	CCV_NNC_CATEGORICAL_CROSSENTROPY_BACKWARD = 0x1eb327a3,
+	CCV_NNC_BATCH_NORM_FORWARD = 0x5419819c,
+	CCV_NNC_BATCH_NORM_BACKWARD = 0x5419819d,
+	CCV_NNC_BATCH_NORM_FOLD_FORWARD = 0xaf8bdbfa,
+	CCV_NNC_BATCH_NORM_FOLD_BACKWARD = 0xaf8bdbfb,
 	CCV_NNC_MAX_POOL_FORWARD = 0x7bec9360,
 	CCV_NNC_MAX_POOL_BACKWARD = 0x7bec9361,
 	CCV_NNC_AVERAGE_POOL_FORWARD = 0x51267ab8,
 	CCV_NNC_AVERAGE_POOL_BACKWARD = 0x51267ab9,
-	CCV_NNC_CONVOLUTION_FORWARD = 0x254d05f4,
-	CCV_NNC_CONVOLUTION_BACKWARD = 0x254d05f5,
-	CCV_NNC_SGD_FORWARD = 0xe650ad26,
-	CCV_NNC_SGD_BACKWARD = 0xe650ad27,
-	CCV_NNC_SOFTMAX_FORWARD = 0xc969a252,
-	CCV_NNC_SOFTMAX_BACKWARD = 0xc969a253,
+	CCV_NNC_QUANTIZE_FORWARD = 0xb49048e,
+	CCV_NNC_QUANTIZE_BACKWARD = 0xb49048f,
+	CCV_NNC_DEQUANTIZE_FORWARD = 0x9736c488,
+	CCV_NNC_DEQUANTIZE_BACKWARD = 0x9736c489,
 	CCV_NNC_RANDOM_UNIFORM_FORWARD = 0xa0cd1d5e,
 	CCV_NNC_RANDOM_UNIFORM_BACKWARD = 0xa0cd1d5f,
-	CCV_NNC_RELU_FORWARD = 0xc51eaa80,
-	CCV_NNC_RELU_BACKWARD = 0xc51eaa81,
-	CCV_NNC_DROPOUT_FORWARD = 0x7f2dc3e4,
-	CCV_NNC_DROPOUT_BACKWARD = 0x7f2dc3e5,
 	CCV_NNC_REDUCE_SUM_FORWARD = 0x52970f06,
 	CCV_NNC_REDUCE_SUM_BACKWARD = 0x52970f07,
 	CCV_NNC_REDUCE_MAX_FORWARD = 0x80f1a506,
 	CCV_NNC_REDUCE_MAX_BACKWARD = 0x80f1a507,
-	CCV_NNC_BATCH_NORM_FORWARD = 0x5419819c,
-	CCV_NNC_BATCH_NORM_BACKWARD = 0x5419819d,
-	CCV_NNC_GEMM_FORWARD = 0x7e87d00c,
-	CCV_NNC_GEMM_BACKWARD = 0x7e87d00d,
-	CCV_NNC_ADD_FORWARD = 0x58fb3664,
-	CCV_NNC_ADD_BACKWARD = 0x58fb3665,
-	CCV_NNC_MUL_FORWARD = 0x24721a46,
-	CCV_NNC_MUL_BACKWARD = 0x24721a47,
-	CCV_NNC_SCALAR_MUL_FORWARD = 0x8b4d86aa,
-	CCV_NNC_SCALAR_MUL_BACKWARD = 0x8b4d86ab,
+	CCV_NNC_RELU_FORWARD = 0xc51eaa80,
+	CCV_NNC_RELU_BACKWARD = 0xc51eaa81,
+	CCV_NNC_SGD_FORWARD = 0xe650ad26,
+	CCV_NNC_SGD_BACKWARD = 0xe650ad27,
+	CCV_NNC_SOFTMAX_FORWARD = 0xc969a252,
+	CCV_NNC_SOFTMAX_BACKWARD = 0xc969a253,
 	CCV_NNC_SET_FORWARD = 0x2b070804,
 	CCV_NNC_SET_BACKWARD = 0x2b070805,
 	CCV_NNC_DATA_TRANSFER_FORWARD = 0x12d21e1a,
 	CCV_NNC_DATA_TRANSFER_BACKWARD = 0x12d21e1b,
 	CCV_NNC_FORMAT_TRANSFORM_FORWARD = 0xe4a2b192,
 	CCV_NNC_FORMAT_TRANSFORM_BACKWARD = 0xe4a2b193,
-	CCV_NNC_COUNT = 51,
+	CCV_NNC_COUNT = 61,
 };
@@ -0,0 +1,114 @@
+#include <ccv.h>
+#include <ccv_internal.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
+
+static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	// inputs: a (8U), w (8U), [bias (32F)], a quantization parameters, w quantization parameters (see CCV_NNC_QUANTIZE_FORWARD).
+	if (input_size != 5 || inputs[0]->info.datatype != CCV_8U || inputs[1]->info.datatype != CCV_8U)
+		return CCV_NNC_EXEC_INVALID;
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[0];
+	const ccv_nnc_tensor_t* w = inputs[1];
+	assert(!CCV_IS_TENSOR_VIEW(w));
+	const ccv_nnc_tensor_t* bias = inputs[2];
+	assert(!bias || !CCV_IS_TENSOR_VIEW(bias));
+	const ccv_nnc_tensor_t* aq = inputs[3];
+	const ccv_nnc_tensor_t* wq = inputs[4];
+	assert(aq->info.datatype == CCV_32F && aq->info.dim[0] == 1);
+	assert(wq->info.datatype == CCV_32F && (wq->info.dim[0] == 1 || wq->info.dim[0] == cmd.info.convolution.count));
+	assert(output_size == 1);
+	ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[0];
+	assert(b->info.datatype == CCV_32F);
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	assert(bdim[CCV_NNC_MAX_DIM] == cmd.info.convolution.count);
+	int i;
+	// Make sure the weights dimension matches the network dimension
+	for (i = 1; i < CCV_NNC_MAX_DIM_ALLOC; i++)
+	{
+		if (w->info.dim[i] == 0 || cmd.info.size.dim[i - 1] == 0)
+			break;
+		assert(w->info.dim[i] == cmd.info.size.dim[i - 1]);
+	}
+	const int groups = cmd.info.convolution.groups;
+	assert(w->info.dim[CCV_NNC_MAX_DIM + 1] * groups == adim[CCV_NNC_MAX_DIM]);
+	assert(cmd.info.convolution.count % groups == 0);
+	const int group_size = cmd.info.convolution.count / groups;
+	// Make sure the weights output dimension matches the network convolution kernels
+	assert(w->info.dim[0] == cmd.info.convolution.count);
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	assert(!bias || bias->info.dim[0] == cmd.info.convolution.count);
+	const int channel_size = w->info.dim[CCV_NNC_MAX_DIM + 1];
+	const float a_scale = aq->data.f32[0];
+	const int a_zero_point = (int)lrintf(aq->data.f32[1]);
+	const int w_per_channel = wq->info.dim[0] > 1;
+	parallel_for(k, cmd.info.convolution.count) {
+		int c;
+		const int gidx = k / group_size;
+		const unsigned char* ap = a->data.u8;
+		float* bp = b->data.f32 + k;
+		// kernel weight for one dim.
+		const unsigned char* wp = w->data.u8 + k * w->info.dim[1] * w->info.dim[2] * channel_size;
+		const float biasval = bias ? bias->data.f32[k] : 0;
+		const float scale = a_scale * wq->data.f32[w_per_channel ? k * 2 : 0];
+		const int w_zero_point = (int)lrintf(wq->data.f32[w_per_channel ? k * 2 + 1 : 1]);
+		// This block will be cause in each for-loop, therefore, you can use it to generate some temporary variables.
+		int i[CCV_NNC_MAX_DIM];
+		int n[CCV_NNC_MAX_DIM];
+		int m[CCV_NNC_MAX_DIM];
+		int j[CCV_NNC_MAX_DIM];
+		for (i[0] = 0; i[0] < bdim[0]; i[0]++)
+		{
+			SET_BORDER_OFFSET_SIZE_FOR(0, i, hint, w->info.dim + 1, adim, n, m);
+			const unsigned char* wpu = wp + n[0] * w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
+			for (i[1] = 0; i[1] < bdim[1]; i[1]++)
+			{
+				SET_BORDER_OFFSET_SIZE_FOR(1, i, hint, w->info.dim + 1, adim, n, m);
+				// Accumulate a * (w - w_zero_point) in int32 and subtract a_zero_point * sum(w - w_zero_point) at the end,
+				// only over the window that is inside the input, since the border is a real 0.
+				int32_t p = 0, wsum = 0;
+				const unsigned char* wpz = wpu + n[1] * channel_size;
+				const unsigned char* apz = ap + ccv_max(i[1] * hint.stride.dim[1] - hint.border.begin[1], 0) * ainc[CCV_NNC_MAX_DIM] + gidx * channel_size;
+				for (j[0] = 0; j[0] < m[0]; j[0]++)
+				{
+					for (j[1] = 0; j[1] < m[1]; j[1]++)
+						for (c = 0; c < channel_size; c++)
+						{
+							const int32_t wv = (int32_t)wpz[j[1] * channel_size + c] - w_zero_point;
+							p += wv * apz[j[1] * ainc[CCV_NNC_MAX_DIM] + c];
+							wsum += wv;
+						}
+					wpz += w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
+					apz += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM];
+				}
+				const float y = biasval + scale * (p - a_zero_point * wsum);
+				bp[i[1] * binc[CCV_NNC_MAX_DIM]] = cmd.info.convolution.relu ? ccv_max(y, 0) : y;
+			}
+			bp += binc[CCV_NNC_MAX_DIM - 1] * binc[CCV_NNC_MAX_DIM];
+			ap += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0));
+		}
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_CONVOLUTION_FORWARD, CCV_NNC_BACKEND_CPU_INT8)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_8U | CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_conv_forw;
+}
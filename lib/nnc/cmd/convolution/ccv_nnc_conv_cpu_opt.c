@@ -5,8 +5,9 @@
 #include <nnc/ccv_nnc_internal.h>
 
 #include "_ccv_nnc_conv_cpu_opt.h"
+#include <pthread.h>
 
-FIND_FILE(cpu_opt/_ccv_nnc_conv_cpu_4x4_3x3_winograd.c, cpu_opt/_ccv_nnc_conv_cpu_fft.c, cpu_opt/_ccv_nnc_conv_cpu_gemm.c, cpu_opt/_ccv_nnc_conv_cpu_opt.c)
+FIND_FILE(cpu_opt/_ccv_nnc_conv_cpu_4x4_3x3_winograd.c, cpu_opt/_ccv_nnc_conv_cpu_fft.c, cpu_opt/_ccv_nnc_conv_cpu_gemm.c, cpu_opt/_ccv_nnc_conv_cpu_opt.c, cpu_opt/_ccv_nnc_conv_cpu_nchw.c)
 
 enum {
 	CCV_NNC_CMD_OPT_CONV_ALGO_DC, // Direct convolution
@@ -16,6 +17,118 @@ enum {
 	CCV_NNC_CMD_OPT_CONV_ALGO_COUNT
 };
 
+typedef struct {
+	const void* ptr; // The constant weights last widened, 0 if they were not constant.
+	uint64_t epoch;
+	ccv_nnc_tensor_t* w32;
+} ccv_nnc_conv_w32_cache_t;
+
+// The widened weights are kept per thread, same as the FFT kernel cache, and freed when the thread exits.
+static __thread ccv_nnc_conv_w32_cache_t* conv_w32_cache = 0;
+static pthread_key_t conv_w32_cache_key;
+static pthread_once_t conv_w32_cache_once = PTHREAD_ONCE_INIT;
+
+static void _ccv_nnc_conv_w32_cache_free(void* const context)
+{
+	ccv_nnc_conv_w32_cache_t* const cache = (ccv_nnc_conv_w32_cache_t*)context;
+	if (cache->w32)
+		ccv_nnc_tensor_free(cache->w32);
+	ccfree(cache);
+}
+
+static void _ccv_nnc_conv_w32_cache_key_new(void)
+{
+	pthread_key_create(&conv_w32_cache_key, _ccv_nnc_conv_w32_cache_free);
+}
+
+// Returns the half precision weights widened to 32F. The buffer is reused across calls and only grows. If the weights
+// are flagged CCV_TENSOR_CONSTANT and are the last widened ones within the same constant epoch, they are not widened again.
+static ccv_nnc_tensor_t* _ccv_nnc_conv_w32(const ccv_nnc_tensor_t* const w)
+{
+	if (!conv_w32_cache)
+	{
+		pthread_once(&conv_w32_cache_once, _ccv_nnc_conv_w32_cache_key_new);
+		conv_w32_cache = (ccv_nnc_conv_w32_cache_t*)cccalloc(1, sizeof(ccv_nnc_conv_w32_cache_t));
+		pthread_setspecific(conv_w32_cache_key, conv_w32_cache);
+	}
+	ccv_nnc_tensor_param_t params = w->info;
+	params.datatype = CCV_32F;
+	ccv_nnc_tensor_t* w32 = conv_w32_cache->w32;
+	const int count = ccv_nnc_tensor_count(w->info);
+	const int is_constant = CCV_IS_TENSOR_CONSTANT(w);
+	const uint64_t epoch = is_constant ? ccv_nnc_tensor_constant_epoch() : 0;
+	if (is_constant && w32 && conv_w32_cache->ptr == w->data.ptr && conv_w32_cache->epoch == epoch &&
+		memcmp(&w32->info, &params, sizeof(params)) == 0)
+		return w32;
+	if (!w32 || ccv_nnc_tensor_count(w32->info) < count)
+	{
+		if (w32)
+			ccv_nnc_tensor_free(w32);
+		w32 = conv_w32_cache->w32 = ccv_nnc_tensor_new(0, params, 0);
+	}
+	w32->info = params;
+	ccv_half_precision_to_float(w->data.f16, w32->data.f32, count);
+	conv_w32_cache->ptr = is_constant ? w->data.ptr : 0;
+	conv_w32_cache->epoch = epoch;
+	return w32;
+}
+
+// If the kernel is large, no stride, and there are enough output channels to amortize the input transform, choose FFT kernel
+static int _ccv_nnc_conv_forw_prefer_fft(const ccv_nnc_hint_t hint, const ccv_nnc_tensor_t* const w)
+{
+	return w->info.dim[1] >= 5 && w->info.dim[2] >= 5 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 && w->info.dim[0] >= 16;
+}
+
+static int _ccv_nnc_conv_forw_nchw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, ccv_nnc_tensor_view_t* const b)
+{
+	// The NCHW kernels don't mix layouts and don't take tensor views.
+	if (a->info.format != CCV_TENSOR_FORMAT_NCHW || b->info.format != CCV_TENSOR_FORMAT_NCHW || w->info.format != CCV_TENSOR_FORMAT_NCHW ||
+		CCV_IS_TENSOR_VIEW(a) || CCV_IS_TENSOR_VIEW(b))
+		return CCV_NNC_EXEC_INVALID;
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	// w is in count x channel x height x width.
+	assert(w->info.dim[1] == adim[0]);
+	assert(bdim[0] == cmd.info.convolution.count);
+	const int is_gemm = (w->info.dim[2] == 1 && w->info.dim[3] == 1 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 &&
+		hint.border.begin[0] == 0 && hint.border.begin[1] == 0 && hint.border.end[0] == 0 && hint.border.end[1] == 0);
+	const int is_winograd = (w->info.dim[2] == 3 && w->info.dim[3] == 3 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 &&
+		hint.border.begin[0] <= 1 && hint.border.begin[1] <= 1);
+	switch (cmd.algorithm)
+	{
+		case CCV_NNC_CMD_OPT_CONV_ALGO_DC:
+			return _ccv_nnc_conv_forw_nchw_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+		case CCV_NNC_CMD_OPT_CONV_ALGO_GEMM:
+			if (is_gemm)
+				return _ccv_nnc_conv_forw_gemm_nchw_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+			return CCV_NNC_EXEC_INVALID;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD:
+			if (is_winograd)
+				return _ccv_nnc_conv_forw_4x4_3x3_winograd_nchw_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+			return CCV_NNC_EXEC_INVALID;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_FFT:
+			// There is no NCHW FFT kernel.
+			return CCV_NNC_EXEC_INVALID;
+		case -1:
+			// Pass-through
+			break;
+	}
+	if (is_winograd)
+		return _ccv_nnc_conv_forw_4x4_3x3_winograd_nchw_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+	if (is_gemm)
+	{
+		const int status = _ccv_nnc_conv_forw_gemm_nchw_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+		// GEMM is not available without BLAS.
+		if (status != CCV_NNC_EXEC_INVALID)
+			return status;
+	}
+	return _ccv_nnc_conv_forw_nchw_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+}
+
 static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
 {
 	assert(input_size >= 2);
@@ -26,6 +139,27 @@ static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	assert(!bias || !CCV_IS_TENSOR_VIEW(bias));
 	assert(output_size == 1);
 	ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[0];
+	if (cmd.info.convolution.groups != 1)
+		return CCV_NNC_EXEC_INVALID;
+	// Only the weights can be half precision.
+	if (a->info.datatype != CCV_32F || b->info.datatype != CCV_32F || (bias && bias->info.datatype != CCV_32F) ||
+		(w->info.datatype != CCV_32F && w->info.datatype != CCV_16F))
+		return CCV_NNC_EXEC_INVALID;
+	const int is_nchw = (a->info.format == CCV_TENSOR_FORMAT_NCHW || b->info.format == CCV_TENSOR_FORMAT_NCHW || w->info.format == CCV_TENSOR_FORMAT_NCHW);
+	if (w->info.datatype == CCV_16F)
+	{
+		// The FFT kernel widens the weights as it transforms them, thus, it caches on the half precision weights as given.
+		if (!is_nchw && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 &&
+			(cmd.algorithm == CCV_NNC_CMD_OPT_CONV_ALGO_FFT || (cmd.algorithm == -1 && _ccv_nnc_conv_forw_prefer_fft(hint, w))))
+			return _ccv_nnc_conv_forw_fft_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+		// Every other kernel reads the weights many times over, widen the half precision weights up front rather than per tile.
+		ccv_nnc_tensor_t* forw_inputs[3] = {
+			inputs[0], _ccv_nnc_conv_w32(w), input_size > 2 ? inputs[2] : 0
+		};
+		return _ccv_nnc_conv_forw(cmd, hint, flags, forw_inputs, ccv_min(input_size, 3), outputs, output_size, stream_context);
+	}
+	if (is_nchw)
+		return _ccv_nnc_conv_forw_nchw(cmd, hint, a, w, bias, b);
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
 	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
@@ -34,8 +168,6 @@ static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
 	assert(w->info.dim[CCV_NNC_MAX_DIM + 1] == adim[CCV_NNC_MAX_DIM]);
 	assert(bdim[CCV_NNC_MAX_DIM] == cmd.info.convolution.count);
-	if (cmd.info.convolution.groups != 1)
-		return CCV_NNC_EXEC_INVALID;
 	int i;
 	// Make sure the weights dimension matches the network dimension
 	for (i = 1; i < CCV_NNC_MAX_DIM_ALLOC; i++)
@@ -47,40 +179,184 @@ static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 	switch (cmd.algorithm)
 	{
 		case CCV_NNC_CMD_OPT_CONV_ALGO_DC:
-			return _ccv_nnc_conv_forw_cpu_opt(a, w, bias, hint, b);
+			return _ccv_nnc_conv_forw_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
 		case CCV_NNC_CMD_OPT_CONV_ALGO_GEMM:
 			if (w->info.dim[1] == 1 && w->info.dim[2] == 1 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 &&
 				hint.border.begin[0] == 0 && hint.border.begin[1] == 0 && hint.border.end[0] == 0 && hint.border.end[1] == 0 &&
 				!CCV_IS_TENSOR_VIEW(a) && !CCV_IS_TENSOR_VIEW(b) && !CCV_IS_TENSOR_VIEW(w) && (!bias || !CCV_IS_TENSOR_VIEW(bias)))
-				return _ccv_nnc_conv_forw_gemm_cpu_opt(a, w, bias, hint, b);
+				return _ccv_nnc_conv_forw_gemm_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
 			return CCV_NNC_EXEC_INVALID;
 		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD:
 			if (w->info.dim[1] == 3 && w->info.dim[2] == 3 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1)
-				return _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(a, w, bias, hint, b);
+				return _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
 			return CCV_NNC_EXEC_INVALID;
 		case CCV_NNC_CMD_OPT_CONV_ALGO_FFT:
-			return CCV_NNC_EXEC_INVALID; // Placeholder, for fft.
+			if (hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1)
+				return _ccv_nnc_conv_forw_fft_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+			return CCV_NNC_EXEC_INVALID;
 		case -1:
 			// Pass-through
 			break;
 	}
 	// If the size is 3x3, and no stride, choose Winograd kernel
 	if (w->info.dim[1] == 3 && w->info.dim[2] == 3 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1)
-		return _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(a, w, bias, hint, b);
+		return _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
 	// If the size is 1x1, and no stride, and not a tensor view object, no padding, choose GEMM kernel
 	if (w->info.dim[1] == 1 && w->info.dim[2] == 1 && hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1 &&
 		hint.border.begin[0] == 0 && hint.border.begin[1] == 0 && hint.border.end[0] == 0 && hint.border.end[1] == 0 &&
 		!CCV_IS_TENSOR_VIEW(a) && !CCV_IS_TENSOR_VIEW(b) && !CCV_IS_TENSOR_VIEW(w) && (!bias || !CCV_IS_TENSOR_VIEW(bias)))
-		return _ccv_nnc_conv_forw_gemm_cpu_opt(a, w, bias, hint, b);
+		return _ccv_nnc_conv_forw_gemm_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
+	if (_ccv_nnc_conv_forw_prefer_fft(hint, w))
+		return _ccv_nnc_conv_forw_fft_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
 	// Otherwise, use direct convolution kernel
-	return _ccv_nnc_conv_forw_cpu_opt(a, w, bias, hint, b);
+	return _ccv_nnc_conv_forw_cpu_opt(a, w, bias, hint, b, cmd.info.convolution.relu);
 }
 
 REGISTER_COMMAND_BACKEND(CCV_NNC_CONVOLUTION_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	registry->tensor_datatypes = CCV_32F | CCV_16F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = CCV_NNC_CMD_OPT_CONV_ALGO_COUNT;
+	registry->exec = _ccv_nnc_conv_forw;
+}
+
+static ccv_nnc_tensor_t* _ccv_nnc_conv_back_flip_weight(const ccv_nnc_tensor_t* const w)
+{
+	// The gradient w.r.t. the input of a stride 1 convolution is a convolution of the gradient with the weights rotated
+	// by 180 degrees and the input / output channels swapped. Therefore, it can run through any of the forward kernels.
+	const int* const wdim = w->info.dim;
+	ccv_nnc_tensor_t* const wt = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(wdim[3], wdim[1], wdim[2], wdim[0]), 0);
+	parallel_for(c, wdim[3]) {
+		int k, x, y;
+		for (y = 0; y < wdim[1]; y++)
+			for (x = 0; x < wdim[2]; x++)
+			{
+				float* const wtp = wt->data.f32 + ((c * wdim[1] + wdim[1] - 1 - y) * wdim[2] + wdim[2] - 1 - x) * wdim[0];
+				for (k = 0; k < wdim[0]; k++)
+					wtp[k] = w->data.f32[((k * wdim[1] + y) * wdim[2] + x) * wdim[3] + c];
+			}
+	} parallel_endfor
+	return wt;
+}
+
+static int _ccv_nnc_conv_back_data_forw(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_t* const w, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const h, const int algorithm)
+{
+	ccv_nnc_hint_t flip_hint = hint;
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM; i++)
+	{
+		flip_hint.border.begin[i] = w->info.dim[i + 1] - 1 - hint.border.begin[i];
+		flip_hint.border.end[i] = w->info.dim[i + 1] - 1 - hint.border.end[i];
+	}
+	ccv_nnc_tensor_t* const wt = _ccv_nnc_conv_back_flip_weight(w);
+	int status;
+	switch (algorithm)
+	{
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD:
+			status = _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(g, wt, 0, flip_hint, h, 0);
+			break;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_FFT:
+			status = _ccv_nnc_conv_forw_fft_cpu_opt(g, wt, 0, flip_hint, h, 0);
+			break;
+		default:
+			status = _ccv_nnc_conv_forw_cpu_opt(g, wt, 0, flip_hint, h, 0);
+			break;
+	}
+	ccv_nnc_tensor_free(wt);
+	return status;
+}
+
+static int _ccv_nnc_conv_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	// inputs: gradient, forw prop input, [w]
+	// outputs: [output gradient], weight updates, bias updates
+	assert(input_size >= 2 && output_size >= 2);
+	const ccv_nnc_tensor_view_t* g = (ccv_nnc_tensor_view_t*)inputs[0]; // gradients
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[1];
+	const ccv_nnc_tensor_t* w = input_size > 2 ? inputs[2] : 0;
+	assert(!w || !CCV_IS_TENSOR_VIEW(w));
+	ccv_nnc_tensor_t* dw = outputs[1];
+	assert(!CCV_IS_TENSOR_VIEW(dw));
+	ccv_nnc_tensor_t* dbias = output_size > 2 ? outputs[2] : 0;
+	assert(!dbias || !CCV_IS_TENSOR_VIEW(dbias));
+	ccv_nnc_tensor_view_t* h = (ccv_nnc_tensor_view_t*)outputs[0]; // output gradients
+	assert(!h || w);
+	if (cmd.info.convolution.groups != 1)
+		return CCV_NNC_EXEC_INVALID;
+	const int no_stride = hint.stride.dim[0] <= 1 && hint.stride.dim[1] <= 1;
+	const int is_gemm = dw->info.dim[1] == 1 && dw->info.dim[2] == 1 && no_stride &&
+		hint.border.begin[0] == 0 && hint.border.begin[1] == 0 && hint.border.end[0] == 0 && hint.border.end[1] == 0 &&
+		!CCV_IS_TENSOR_VIEW(g) && !CCV_IS_TENSOR_VIEW(a) && (!h || !CCV_IS_TENSOR_VIEW(h));
+	// Winograd kernel only pads 1 on each side, thus, the original convolution needs to pad at least 1.
+	const int is_winograd = h && dw->info.dim[1] == 3 && dw->info.dim[2] == 3 && no_stride &&
+		hint.border.begin[0] >= 1 && hint.border.begin[1] >= 1;
+	const int is_flip = h && no_stride &&
+		hint.border.begin[0] < dw->info.dim[1] && hint.border.begin[1] < dw->info.dim[2] &&
+		hint.border.end[0] < dw->info.dim[1] && hint.border.end[1] < dw->info.dim[2];
+	int algorithm = cmd.algorithm;
+	if (algorithm < 0)
+	{
+		// Same preferences as the forward pass, the data gradient is a forward convolution with the flipped weights.
+		if (is_winograd)
+			algorithm = CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD;
+		else if (is_gemm)
+			algorithm = CCV_NNC_CMD_OPT_CONV_ALGO_GEMM;
+		else if (is_flip && dw->info.dim[1] >= 5 && dw->info.dim[2] >= 5 && dw->info.dim[3] >= 16)
+			algorithm = CCV_NNC_CMD_OPT_CONV_ALGO_FFT;
+		else
+			algorithm = CCV_NNC_CMD_OPT_CONV_ALGO_DC;
+	}
+	switch (algorithm)
+	{
+		case CCV_NNC_CMD_OPT_CONV_ALGO_GEMM:
+			if (!is_gemm)
+				return CCV_NNC_EXEC_INVALID;
+			break;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD:
+			if (!is_winograd)
+				return CCV_NNC_EXEC_INVALID;
+			break;
+		case CCV_NNC_CMD_OPT_CONV_ALGO_FFT:
+			if (!is_flip)
+				return CCV_NNC_EXEC_INVALID;
+			break;
+	}
+	// The weight updates are packed 4 output channels at a time, same as the forward pass.
+	if (algorithm != CCV_NNC_CMD_OPT_CONV_ALGO_GEMM && dw->info.dim[0] % 4 != 0)
+		return CCV_NNC_EXEC_INVALID;
+	if (!(flags & CCV_NNC_ACCUMULATE_OUTPUT)) // reset the gradients to 0
+	{
+		memset(dw->data.u8, 0, sizeof(float) * ccv_nnc_tensor_count(dw->info));
+		if (dbias)
+			memset(dbias->data.u8, 0, sizeof(float) * ccv_nnc_tensor_count(dbias->info));
+	}
+	if (algorithm == CCV_NNC_CMD_OPT_CONV_ALGO_GEMM)
+	{
+		const int status = _ccv_nnc_conv_back_gemm_cpu_opt(g, a, w, h, dw, dbias);
+		// GEMM is not available without BLAS, fall back to the direct path unless GEMM is asked for.
+		if (status != CCV_NNC_EXEC_INVALID || cmd.algorithm >= 0 || dw->info.dim[0] % 4 != 0)
+			return status;
+		algorithm = CCV_NNC_CMD_OPT_CONV_ALGO_DC;
+	}
+	int status = _ccv_nnc_conv_back_weight_cpu_opt(g, a, hint, dw, dbias);
+	if (status != CCV_NNC_EXEC_SUCCESS || !h)
+		return status;
+	if (is_flip)
+	{
+		status = _ccv_nnc_conv_back_data_forw(g, w, hint, h, algorithm);
+		if (status != CCV_NNC_EXEC_INVALID || algorithm != CCV_NNC_CMD_OPT_CONV_ALGO_DC)
+			return status;
+	}
+	// Strided, or the channels cannot be packed, gather the gradients directly.
+	return _ccv_nnc_conv_back_data_cpu_opt(g, w, hint, h);
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_CONVOLUTION_BACKWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
 {
 	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
 	registry->tensor_datatypes = CCV_32F;
 	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
 	registry->algorithms = CCV_NNC_CMD_OPT_CONV_ALGO_COUNT;
-	registry->exec = _ccv_nnc_conv_forw;
+	registry->exec = _ccv_nnc_conv_back;
 }
@@ -76,7 +76,7 @@ static int _ccv_nnc_conv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint
 					wpz += w->info.dim[CCV_NNC_MAX_DIM] * channel_size;
 					apz += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM];
 				}
-				bp[i[1] * binc[CCV_NNC_MAX_DIM]] = p;
+				bp[i[1] * binc[CCV_NNC_MAX_DIM]] = cmd.info.convolution.relu ? ccv_max(p, 0) : p;
 			}
 			bp += binc[CCV_NNC_MAX_DIM - 1] * binc[CCV_NNC_MAX_DIM];
 			ap += ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0));
@@ -10,6 +10,12 @@ static int _ccv_nnc_conv_forw_bitmask(const int input_size, const int output_siz
 	// Ignore bias.
 	if (input_size == 2 && (input_bitmasks[0] & 3u) == ((1u << 0) | (1u << 1)) && output_bitmasks[0] == 1u)
 		return 1;
+	// Quantized, with the quantization parameters for a and w.
+	if (input_size == 5 && (input_bitmasks[0] & 31u) == ((1u << 0) | (1u << 1) | (1u << 2) | (1u << 3) | (1u << 4)) && output_bitmasks[0] == 1u)
+		return 1;
+	// Quantized, ignore bias.
+	if (input_size == 5 && (input_bitmasks[0] & 31u) == ((1u << 0) | (1u << 1) | (0u << 2) | (1u << 3) | (1u << 4)) && output_bitmasks[0] == 1u)
+		return 1;
 	return 0;
 }
 
@@ -35,18 +41,19 @@ static void _ccv_nnc_conv_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const
 	assert(output_size == 1);
 	outputs[0].type = inputs[0].type;
 	outputs[0].format = inputs[0].format;
-	outputs[0].datatype = inputs[0].datatype;
+	// The quantized convolution takes 8U inputs but always outputs 32F.
+	outputs[0].datatype = inputs[0].datatype == CCV_8U ? CCV_32F : inputs[0].datatype;
 	// Get the channel output from the weight matrix.
 	const int count = ccv_nnc_tensor_get_n(inputs[1]);
 	assert(count == cmd.convolution.count);
-	assert(count == inputs[2].dim[0]); // from the bias matrix.
+	assert(input_size < 3 || !inputs[2].dim[0] || count == inputs[2].dim[0]); // from the bias matrix.
 	ccv_nnc_tensor_set_c(outputs, ccv_nnc_tensor_nd(inputs[0].dim), count);
 	ccv_nnc_tensor_set_n(outputs, ccv_nnc_tensor_get_n(inputs[0]));
 	ccv_nnc_hint_tensor_forward(cmd, inputs[0], hint, outputs);
 }
 
 REGISTER_COMMAND(CCV_NNC_CONVOLUTION_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_conv_cpu_ref.c, ccv_nnc_conv_cpu_opt.c, gpu/ccv_nnc_conv_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_conv_cpu_ref.c, ccv_nnc_conv_cpu_opt.c, ccv_nnc_conv_cpu_int8.c, gpu/ccv_nnc_conv_gpu_cudnn.cu)
 {
 	registry->bitmask = _ccv_nnc_conv_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_conv_tensor_auto_forw;
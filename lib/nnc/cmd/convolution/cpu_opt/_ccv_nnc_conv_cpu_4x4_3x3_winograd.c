@@ -123,7 +123,7 @@ inline static void _ccv_nnc_winograd_4x4_3x3_gwtg_ref(const float* const w, cons
 	}
 }
 
-static int _ccv_nnc_conv_forw_4x4_3x3_winograd_ref(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+static int _ccv_nnc_conv_forw_4x4_3x3_winograd_ref(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
@@ -337,7 +337,7 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_ref(const ccv_nnc_tensor_view_t*
 							d[dy * 6 + 1] - d[dy * 6 + 2] + 8 * (d[dy * 6 + 3] - d[dy * 6 + 4]) + d[dy * 6 + 5] + biasval[k],
 						};
 						unroll_for(dx, z[1], 4) {
-							bpz[dx * binc[2]] = r[dx];
+							bpz[dx * binc[2]] = relu ? ccv_max(r[dx], 0) : r[dx];
 						} unroll_endfor
 						bpz += binc[1] * binc[2];
 					} unroll_endfor
@@ -518,7 +518,7 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_ref(const ccv_nnc_tensor_view_t*
 							d[dy * 6 + 1] - d[dy * 6 + 2] + 8 * (d[dy * 6 + 3] - d[dy * 6 + 4]) + d[dy * 6 + 5],
 						};
 						unroll_for(dx, z[1], 4) {
-							bpz[dx * binc[2]] = r[dx];
+							bpz[dx * binc[2]] = relu ? ccv_max(r[dx], 0) : r[dx];
 						} unroll_endfor
 						bpz += binc[1] * binc[2];
 					} unroll_endfor
@@ -531,6 +531,12 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_ref(const ccv_nnc_tensor_view_t*
 }
 
 #ifdef HAVE_SSE2
+inline static void _ccv_nnc_winograd_stream_ps(const int relu, float* const p, const __m128 v)
+{
+	// ReLU is fused into the output transform, so the output doesn't need another pass.
+	_mm_stream_ps(p, relu ? _mm_max_ps(v, _mm_setzero_ps()) : v);
+}
+
 inline static void _ccv_nnc_winograd_4x4_3x3_gwtg_sse2(const float* const w, const int* const dim, float* const gwtg)
 {
 	const int jump_dim = dim[0] / 4;
@@ -624,7 +630,7 @@ inline static void _ccv_nnc_winograd_4x4_3x3_gwtg_sse2(const float* const w, con
 	} parallel_endfor
 }
 
-static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
@@ -861,7 +867,7 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 								__m128 ds1x2 = _mm_add_ps(d1, d2);
 								__m128 ds3x4 = _mm_add_ps(d3, d4);
 								ds1x2 = _mm_add_ps(ds1x2, bias4);
-								_mm_stream_ps(bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
+								_ccv_nnc_winograd_stream_ps(relu, bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -876,12 +882,12 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 								__m128 ds1x2 = _mm_add_ps(d1, d2);
 								__m128 ds3x4 = _mm_add_ps(d3, d4);
 								ds1x2 = _mm_add_ps(ds1x2, bias4);
-								_mm_stream_ps(bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
+								_ccv_nnc_winograd_stream_ps(relu, bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
 								__m128 dn1x2 = _mm_sub_ps(d1, d2);
 								__m128 dn3x4 = _mm_sub_ps(d3, d4);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
 								dn1x2 = _mm_add_ps(dn1x2, bias4);
-								_mm_stream_ps(bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -896,15 +902,15 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 								__m128 ds1x2 = _mm_add_ps(d1, d2);
 								__m128 ds3x4 = _mm_add_ps(d3, d4);
 								ds1x2 = _mm_add_ps(ds1x2, bias4);
-								_mm_stream_ps(bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
+								_ccv_nnc_winograd_stream_ps(relu, bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
 								__m128 dn1x2 = _mm_sub_ps(d1, d2);
 								__m128 dn3x4 = _mm_sub_ps(d3, d4);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
 								dn1x2 = _mm_add_ps(dn1x2, bias4);
-								_mm_stream_ps(bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
 								ds3x4 = _mm_add_ps(ds3x4, ds3x4);
 								ds3x4 = _mm_add_ps(ds3x4, ds3x4);
-								_mm_stream_ps(bpz + 2 * binc[2], _mm_add_ps(ds1x2, ds3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + 2 * binc[2], _mm_add_ps(ds1x2, ds3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -919,19 +925,19 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 								__m128 ds1x2 = _mm_add_ps(d1, d2);
 								__m128 ds3x4 = _mm_add_ps(d3, d4);
 								ds1x2 = _mm_add_ps(ds1x2, bias4);
-								_mm_stream_ps(bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
+								_ccv_nnc_winograd_stream_ps(relu, bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
 								__m128 dn1x2 = _mm_sub_ps(d1, d2);
 								__m128 dn3x4 = _mm_sub_ps(d3, d4);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
 								dn1x2 = _mm_add_ps(dn1x2, bias4);
-								_mm_stream_ps(bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
 								ds3x4 = _mm_add_ps(ds3x4, ds3x4);
 								ds3x4 = _mm_add_ps(ds3x4, ds3x4);
-								_mm_stream_ps(bpz + 2 * binc[2], _mm_add_ps(ds1x2, ds3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + 2 * binc[2], _mm_add_ps(ds1x2, ds3x4));
 								__m128 d5 = _mm_load_ps(dz + 20);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
-								_mm_stream_ps(bpz + 3 * binc[2], _mm_add_ps(_mm_add_ps(dn1x2, d5), dn3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + 3 * binc[2], _mm_add_ps(_mm_add_ps(dn1x2, d5), dn3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1133,7 +1139,7 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 								__m128 d4 = _mm_load_ps(dz + 16);
 								__m128 ds1x2 = _mm_add_ps(d1, d2);
 								__m128 ds3x4 = _mm_add_ps(d3, d4);
-								_mm_stream_ps(bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
+								_ccv_nnc_winograd_stream_ps(relu, bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1147,11 +1153,11 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 								__m128 d4 = _mm_load_ps(dz + 16);
 								__m128 ds1x2 = _mm_add_ps(d1, d2);
 								__m128 ds3x4 = _mm_add_ps(d3, d4);
-								_mm_stream_ps(bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
+								_ccv_nnc_winograd_stream_ps(relu, bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
 								__m128 dn1x2 = _mm_sub_ps(d1, d2);
 								__m128 dn3x4 = _mm_sub_ps(d3, d4);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
-								_mm_stream_ps(bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1165,14 +1171,14 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 								__m128 d4 = _mm_load_ps(dz + 16);
 								__m128 ds1x2 = _mm_add_ps(d1, d2);
 								__m128 ds3x4 = _mm_add_ps(d3, d4);
-								_mm_stream_ps(bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
+								_ccv_nnc_winograd_stream_ps(relu, bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
 								__m128 dn1x2 = _mm_sub_ps(d1, d2);
 								__m128 dn3x4 = _mm_sub_ps(d3, d4);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
-								_mm_stream_ps(bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
 								ds3x4 = _mm_add_ps(ds3x4, ds3x4);
 								ds3x4 = _mm_add_ps(ds3x4, ds3x4);
-								_mm_stream_ps(bpz + 2 * binc[2], _mm_add_ps(ds1x2, ds3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + 2 * binc[2], _mm_add_ps(ds1x2, ds3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1186,18 +1192,18 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 								__m128 d4 = _mm_load_ps(dz + 16);
 								__m128 ds1x2 = _mm_add_ps(d1, d2);
 								__m128 ds3x4 = _mm_add_ps(d3, d4);
-								_mm_stream_ps(bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
+								_ccv_nnc_winograd_stream_ps(relu, bpz, _mm_add_ps(ds1x2, _mm_add_ps(d0, ds3x4)));
 								__m128 dn1x2 = _mm_sub_ps(d1, d2);
 								__m128 dn3x4 = _mm_sub_ps(d3, d4);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
-								_mm_stream_ps(bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + binc[2], _mm_add_ps(dn1x2, dn3x4));
 								ds3x4 = _mm_add_ps(ds3x4, ds3x4);
 								ds3x4 = _mm_add_ps(ds3x4, ds3x4);
-								_mm_stream_ps(bpz + 2 * binc[2], _mm_add_ps(ds1x2, ds3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + 2 * binc[2], _mm_add_ps(ds1x2, ds3x4));
 								__m128 d5 = _mm_load_ps(dz + 20);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
 								dn3x4 = _mm_add_ps(dn3x4, dn3x4);
-								_mm_stream_ps(bpz + 3 * binc[2], _mm_add_ps(_mm_add_ps(dn1x2, d5), dn3x4));
+								_ccv_nnc_winograd_stream_ps(relu, bpz + 3 * binc[2], _mm_add_ps(_mm_add_ps(dn1x2, d5), dn3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1212,6 +1218,12 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(const ccv_nnc_tensor_view_t*
 #endif
 
 #ifdef HAVE_NEON
+inline static void _ccv_nnc_winograd_vst1q_f32(const int relu, float* const p, const float32x4_t v)
+{
+	// ReLU is fused into the output transform, so the output doesn't need another pass.
+	vst1q_f32(p, relu ? vmaxq_f32(v, vdupq_n_f32(0)) : v);
+}
+
 inline static void _ccv_nnc_winograd_4x4_3x3_gwtg_neon(const float* const w, const int* const dim, float* const gwtg)
 {
 	const int jump_dim = dim[0] / 4;
@@ -1305,7 +1317,7 @@ inline static void _ccv_nnc_winograd_4x4_3x3_gwtg_neon(const float* const w, con
 	} parallel_endfor
 }
 
-static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
@@ -1542,7 +1554,7 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 								float32x4_t ds1x2 = vaddq_f32(d1, d2);
 								float32x4_t ds3x4 = vaddq_f32(d3, d4);
 								ds1x2 = vaddq_f32(ds1x2, bias4);
-								vst1q_f32(bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1557,12 +1569,12 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 								float32x4_t ds1x2 = vaddq_f32(d1, d2);
 								float32x4_t ds3x4 = vaddq_f32(d3, d4);
 								ds1x2 = vaddq_f32(ds1x2, bias4);
-								vst1q_f32(bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
 								float32x4_t dn1x2 = vsubq_f32(d1, d2);
 								float32x4_t dn3x4 = vsubq_f32(d3, d4);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
 								dn1x2 = vaddq_f32(dn1x2, bias4);
-								vst1q_f32(bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1577,15 +1589,15 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 								float32x4_t ds1x2 = vaddq_f32(d1, d2);
 								float32x4_t ds3x4 = vaddq_f32(d3, d4);
 								ds1x2 = vaddq_f32(ds1x2, bias4);
-								vst1q_f32(bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
 								float32x4_t dn1x2 = vsubq_f32(d1, d2);
 								float32x4_t dn3x4 = vsubq_f32(d3, d4);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
 								dn1x2 = vaddq_f32(dn1x2, bias4);
-								vst1q_f32(bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
 								ds3x4 = vaddq_f32(ds3x4, ds3x4);
 								ds3x4 = vaddq_f32(ds3x4, ds3x4);
-								vst1q_f32(bpz + 2 * binc[2], vaddq_f32(ds1x2, ds3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + 2 * binc[2], vaddq_f32(ds1x2, ds3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1600,19 +1612,19 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 								float32x4_t ds1x2 = vaddq_f32(d1, d2);
 								float32x4_t ds3x4 = vaddq_f32(d3, d4);
 								ds1x2 = vaddq_f32(ds1x2, bias4);
-								vst1q_f32(bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
 								float32x4_t dn1x2 = vsubq_f32(d1, d2);
 								float32x4_t dn3x4 = vsubq_f32(d3, d4);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
 								dn1x2 = vaddq_f32(dn1x2, bias4);
-								vst1q_f32(bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
 								ds3x4 = vaddq_f32(ds3x4, ds3x4);
 								ds3x4 = vaddq_f32(ds3x4, ds3x4);
-								vst1q_f32(bpz + 2 * binc[2], vaddq_f32(ds1x2, ds3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + 2 * binc[2], vaddq_f32(ds1x2, ds3x4));
 								float32x4_t d5 = vld1q_f32(dz + 20);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
-								vst1q_f32(bpz + 3 * binc[2], vaddq_f32(vaddq_f32(dn1x2, d5), dn3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + 3 * binc[2], vaddq_f32(vaddq_f32(dn1x2, d5), dn3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1814,7 +1826,7 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 								float32x4_t d4 = vld1q_f32(dz + 16);
 								float32x4_t ds1x2 = vaddq_f32(d1, d2);
 								float32x4_t ds3x4 = vaddq_f32(d3, d4);
-								vst1q_f32(bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1828,11 +1840,11 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 								float32x4_t d4 = vld1q_f32(dz + 16);
 								float32x4_t ds1x2 = vaddq_f32(d1, d2);
 								float32x4_t ds3x4 = vaddq_f32(d3, d4);
-								vst1q_f32(bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
 								float32x4_t dn1x2 = vsubq_f32(d1, d2);
 								float32x4_t dn3x4 = vsubq_f32(d3, d4);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
-								vst1q_f32(bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1846,14 +1858,14 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 								float32x4_t d4 = vld1q_f32(dz + 16);
 								float32x4_t ds1x2 = vaddq_f32(d1, d2);
 								float32x4_t ds3x4 = vaddq_f32(d3, d4);
-								vst1q_f32(bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
 								float32x4_t dn1x2 = vsubq_f32(d1, d2);
 								float32x4_t dn3x4 = vsubq_f32(d3, d4);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
-								vst1q_f32(bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
 								ds3x4 = vaddq_f32(ds3x4, ds3x4);
 								ds3x4 = vaddq_f32(ds3x4, ds3x4);
-								vst1q_f32(bpz + 2 * binc[2], vaddq_f32(ds1x2, ds3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + 2 * binc[2], vaddq_f32(ds1x2, ds3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1867,18 +1879,18 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 								float32x4_t d4 = vld1q_f32(dz + 16);
 								float32x4_t ds1x2 = vaddq_f32(d1, d2);
 								float32x4_t ds3x4 = vaddq_f32(d3, d4);
-								vst1q_f32(bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz, vaddq_f32(ds1x2, vaddq_f32(d0, ds3x4)));
 								float32x4_t dn1x2 = vsubq_f32(d1, d2);
 								float32x4_t dn3x4 = vsubq_f32(d3, d4);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
-								vst1q_f32(bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + binc[2], vaddq_f32(dn1x2, dn3x4));
 								ds3x4 = vaddq_f32(ds3x4, ds3x4);
 								ds3x4 = vaddq_f32(ds3x4, ds3x4);
-								vst1q_f32(bpz + 2 * binc[2], vaddq_f32(ds1x2, ds3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + 2 * binc[2], vaddq_f32(ds1x2, ds3x4));
 								float32x4_t d5 = vld1q_f32(dz + 20);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
 								dn3x4 = vaddq_f32(dn3x4, dn3x4);
-								vst1q_f32(bpz + 3 * binc[2], vaddq_f32(vaddq_f32(dn1x2, d5), dn3x4));
+								_ccv_nnc_winograd_vst1q_f32(relu, bpz + 3 * binc[2], vaddq_f32(vaddq_f32(dn1x2, d5), dn3x4));
 								bpz += binc[1] * binc[2];
 							} unroll_endfor
 							break;
@@ -1892,14 +1904,14 @@ static int _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(const ccv_nnc_tensor_view_t*
 }
 #endif
 
-int _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+int _ccv_nnc_conv_forw_4x4_3x3_winograd_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 #if defined(HAVE_SSE2)
 	if (w->info.dim[0] % 4 == 0)
-		return _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(a, w, bias, hint, b);
+		return _ccv_nnc_conv_forw_4x4_3x3_winograd_sse2(a, w, bias, hint, b, relu);
 #elif defined(HAVE_NEON)
 	if (w->info.dim[0] % 4 == 0)
-		return _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(a, w, bias, hint, b);
+		return _ccv_nnc_conv_forw_4x4_3x3_winograd_neon(a, w, bias, hint, b, relu);
 #endif
-	return _ccv_nnc_conv_forw_4x4_3x3_winograd_ref(a, w, bias, hint, b);
+	return _ccv_nnc_conv_forw_4x4_3x3_winograd_ref(a, w, bias, hint, b, relu);
 }
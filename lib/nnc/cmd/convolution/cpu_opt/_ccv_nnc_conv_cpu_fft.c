@@ -14,9 +14,278 @@
 #ifdef USE_DISPATCH
 #include <dispatch/dispatch.h>
 #endif
+#include <pthread.h>
+#include "3rdparty/kissfft/kissf_fftndr.h"
 #include "../_ccv_nnc_conv_cpu_opt.h"
 
-int _ccv_nnc_conv_forw_fft_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+// The transformed kernel is F[0] x (F[1] / 2 + 1) complex numbers for each output channel and input channel.
+typedef struct {
+	int age;
+	uint64_t epoch; // The constant epoch when the weights were transformed.
+	void* ptr;
+	int datatype;
+	int fdim[CCV_NNC_MAX_DIM];
+	int wdim[CCV_NNC_MAX_DIM + 2];
+	kissf_fft_cpx* fw;
+} ccv_nnc_conv_fft_kernel_t;
+
+#define CCV_NNC_CONV_FFT_KERNEL_CACHE_SIZE (4)
+
+typedef struct {
+	int age;
+	ccv_nnc_conv_fft_kernel_t kernels[CCV_NNC_CONV_FFT_KERNEL_CACHE_SIZE];
+} ccv_nnc_conv_fft_kernel_cache_t;
+
+// Like the matrix cache in ccv_memory.c, the kernel cache is per thread, thus, no locking is needed.
+// It is freed when the thread exits.
+static __thread ccv_nnc_conv_fft_kernel_cache_t* conv_fft_kernel_cache = 0;
+static pthread_key_t conv_fft_kernel_cache_key;
+static pthread_once_t conv_fft_kernel_cache_once = PTHREAD_ONCE_INIT;
+
+static void _ccv_nnc_conv_fft_kernel_cache_free(void* const context)
+{
+	ccv_nnc_conv_fft_kernel_cache_t* const cache = (ccv_nnc_conv_fft_kernel_cache_t*)context;
+	int i;
+	for (i = 0; i < CCV_NNC_CONV_FFT_KERNEL_CACHE_SIZE; i++)
+		if (cache->kernels[i].fw)
+			ccfree(cache->kernels[i].fw);
+	ccfree(cache);
+}
+
+static void _ccv_nnc_conv_fft_kernel_cache_key_new(void)
+{
+	pthread_key_create(&conv_fft_kernel_cache_key, _ccv_nnc_conv_fft_kernel_cache_free);
+}
+
+static int _ccv_nnc_conv_fft_size(const int k, const int out)
+{
+	// Tile is at least twice the size of the kernel, but no bigger than what the output needs.
+	int f = kissf_fft_next_fast_size(ccv_min(ccv_max(k * 2, 32), out + k - 1));
+	// The real FFT requires the last dimension to be even.
+	while (f & 1)
+		f = kissf_fft_next_fast_size(f + 1);
+	return f;
+}
+
+static void _ccv_nnc_conv_fft_kernel_transform(const ccv_nnc_tensor_t* const w, const int* const fdim, kissf_fft_cpx* const fw)
+{
+	const int fsize = fdim[0] * (fdim[1] / 2 + 1);
+	const int fdim0 = fdim[0];
+	const int fdim1 = fdim[1];
+	const int wsize = w->info.dim[1] * w->info.dim[2] * w->info.dim[3];
+	parallel_for(k, w->info.dim[0]) {
+		int c, x, y;
+		const int fdim_s[CCV_NNC_MAX_DIM] = { fdim0, fdim1 };
+		kissf_fftndr_cfg pf = kissf_fftndr_alloc(fdim_s, 2, 0, 0, 0);
+		float* const tile = (float*)cccalloc(fdim0 * fdim1 + (w->info.datatype == CCV_16F ? wsize : 0), sizeof(float));
+		const float* wp = w->data.f32 + k * wsize;
+		if (w->info.datatype == CCV_16F)
+		{
+			// Widen the half precision weights of this output channel.
+			float* const w32 = tile + fdim0 * fdim1;
+			ccv_half_precision_to_float(w->data.f16 + k * wsize, w32, wsize);
+			wp = w32;
+		}
+		for (c = 0; c < w->info.dim[3]; c++)
+		{
+			for (y = 0; y < w->info.dim[1]; y++)
+				for (x = 0; x < w->info.dim[2]; x++)
+					tile[y * fdim1 + x] = wp[(y * w->info.dim[2] + x) * w->info.dim[3] + c];
+			kissf_fftndr(pf, tile, fw + (k * w->info.dim[3] + c) * fsize);
+		}
+		ccfree(tile);
+		kissf_fft_free(pf);
+	} parallel_endfor
+}
+
+// Returns the transformed kernel. Only the weights flagged CCV_TENSOR_CONSTANT are cached, anything else can be
+// written without the kernel knowing, these are transformed into a new buffer that the caller frees (*cached is 0).
+static const kissf_fft_cpx* _ccv_nnc_conv_fft_kernel(const ccv_nnc_tensor_t* const w, const int* const fdim, int* const cached)
+{
+	int i;
+	const int fsize = fdim[0] * (fdim[1] / 2 + 1);
+	const size_t fw_size = sizeof(kissf_fft_cpx) * fsize * w->info.dim[0] * w->info.dim[3];
+	if (!CCV_IS_TENSOR_CONSTANT(w) || CCV_IS_TENSOR_VIEW(w))
+	{
+		*cached = 0;
+		kissf_fft_cpx* const fw = (kissf_fft_cpx*)ccmalloc(fw_size);
+		_ccv_nnc_conv_fft_kernel_transform(w, fdim, fw);
+		return fw;
+	}
+	*cached = 1;
+	if (!conv_fft_kernel_cache)
+	{
+		pthread_once(&conv_fft_kernel_cache_once, _ccv_nnc_conv_fft_kernel_cache_key_new);
+		conv_fft_kernel_cache = (ccv_nnc_conv_fft_kernel_cache_t*)cccalloc(1, sizeof(ccv_nnc_conv_fft_kernel_cache_t));
+		pthread_setspecific(conv_fft_kernel_cache_key, conv_fft_kernel_cache);
+	}
+	// Read the epoch before the transform, thus, an invalidation in between only makes the entry stale.
+	const uint64_t epoch = ccv_nnc_tensor_constant_epoch();
+	ccv_nnc_conv_fft_kernel_t* kernel = 0;
+	for (i = 0; i < CCV_NNC_CONV_FFT_KERNEL_CACHE_SIZE; i++)
+	{
+		ccv_nnc_conv_fft_kernel_t* const entry = conv_fft_kernel_cache->kernels + i;
+		if (entry->fw && entry->ptr == w->data.ptr && entry->epoch == epoch && entry->datatype == w->info.datatype &&
+			entry->fdim[0] == fdim[0] && entry->fdim[1] == fdim[1] &&
+			memcmp(entry->wdim, w->info.dim, sizeof(entry->wdim)) == 0)
+		{
+			entry->age = ++conv_fft_kernel_cache->age;
+			return entry->fw;
+		}
+		if (!kernel || !entry->fw || (kernel->fw && entry->age < kernel->age))
+			kernel = entry;
+	}
+	// Evict the least recently used one.
+	if (kernel->fw)
+		ccfree(kernel->fw);
+	kernel->age = ++conv_fft_kernel_cache->age;
+	kernel->epoch = epoch;
+	kernel->ptr = w->data.ptr;
+	kernel->datatype = w->info.datatype;
+	kernel->fdim[0] = fdim[0];
+	kernel->fdim[1] = fdim[1];
+	memcpy(kernel->wdim, w->info.dim, sizeof(kernel->wdim));
+	kernel->fw = (kissf_fft_cpx*)ccmalloc(fw_size);
+	_ccv_nnc_conv_fft_kernel_transform(w, fdim, kernel->fw);
+	return kernel->fw;
+}
+
+// Correlation is the product with the conjugate of the kernel transform: b += a * conj(w).
+static inline void _ccv_nnc_conv_fft_mac(kissf_fft_cpx* const b, const kissf_fft_cpx* const a, const kissf_fft_cpx* const w, const int size)
+{
+	int i = 0;
+#if defined(HAVE_SSE2)
+	const __m128 sign = _mm_set_ps(-1, 1, -1, 1);
+	for (; i < size - 1; i += 2)
+	{
+		const __m128 a2 = _mm_loadu_ps((const float*)(a + i));
+		const __m128 w2 = _mm_loadu_ps((const float*)(w + i));
+		const __m128 wr = _mm_shuffle_ps(w2, w2, 0xA0);
+		const __m128 wi = _mm_shuffle_ps(w2, w2, 0xF5);
+		const __m128 as = _mm_shuffle_ps(a2, a2, 0xB1);
+		const __m128 b2 = _mm_loadu_ps((const float*)(b + i));
+		_mm_storeu_ps((float*)(b + i), _mm_add_ps(b2, _mm_add_ps(_mm_mul_ps(a2, wr), _mm_mul_ps(sign, _mm_mul_ps(as, wi)))));
+	}
+#endif
+	for (; i < size; i++)
+	{
+		b[i].r += a[i].r * w[i].r + a[i].i * w[i].i;
+		b[i].i += a[i].i * w[i].r - a[i].r * w[i].i;
+	}
+}
+
+int _ccv_nnc_conv_forw_fft_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
-	return CCV_NNC_EXEC_INVALID;
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	// FFT only computes stride 1 convolution.
+	if (hint.stride.dim[0] > 1 || hint.stride.dim[1] > 1)
+		return CCV_NNC_EXEC_INVALID;
+	const int batch_size = (a_nd == CCV_NNC_MAX_DIM + 2) ? a->info.dim[0] : 1;
+	assert(batch_size == ((b_nd == CCV_NNC_MAX_DIM + 2) ? b->info.dim[0] : 1));
+	const int fdim_s[CCV_NNC_MAX_DIM] = {
+		_ccv_nnc_conv_fft_size(w->info.dim[1], bdim[0]),
+		_ccv_nnc_conv_fft_size(w->info.dim[2], bdim[1])
+	};
+	int cached;
+	const kissf_fft_cpx* const fw = _ccv_nnc_conv_fft_kernel(w, fdim_s, &cached);
+	// Workaround issues of dispatch_apply (cannot reference to on-stack array)
+	const int fdim0 = fdim_s[0];
+	const int fdim1 = fdim_s[1];
+	const int fsize = fdim0 * (fdim1 / 2 + 1);
+	// Each tile produces (F - k + 1) outputs in each dimension.
+	const int tile_rows = fdim0 - w->info.dim[1] + 1;
+	const int tile_cols = fdim1 - w->info.dim[2] + 1;
+	const int tile_row_count = (bdim[0] + tile_rows - 1) / tile_rows;
+	const int tile_col_count = (bdim[1] + tile_cols - 1) / tile_cols;
+	const int ch = adim[2];
+	const int count = w->info.dim[0];
+	const float scale = 1.0 / (fdim0 * fdim1);
+	parallel_for(t, batch_size * tile_row_count) {
+		int i, j, c, k, x, y;
+		const int n = t / tile_row_count;
+		const int ty = (t % tile_row_count) * tile_rows;
+		const int fdim_t[CCV_NNC_MAX_DIM] = { fdim0, fdim1 };
+		// The nd real FFT state carries temporary buffers, therefore, one per iteration.
+		kissf_fftndr_cfg pf = kissf_fftndr_alloc(fdim_t, 2, 0, 0, 0);
+		kissf_fftndr_cfg pinvf = kissf_fftndr_alloc(fdim_t, 2, 1, 0, 0);
+		float* const tile = (float*)ccmalloc(sizeof(float) * fdim0 * fdim1);
+		// Transform the whole row of tiles first, thus, the kernel transform is only read once per row.
+		kissf_fft_cpx* const fa = (kissf_fft_cpx*)ccmalloc(sizeof(kissf_fft_cpx) * fsize * (ch + 4) * tile_col_count);
+		kissf_fft_cpx* const fb = fa + fsize * ch * tile_col_count;
+		const float* const ap = a->data.f32 + n * ainc[0] * ainc[1] * ainc[2];
+		float* const bp = b->data.f32 + n * binc[0] * binc[1] * binc[2];
+		const int iy = ty - hint.border.begin[0];
+		const int rows = ccv_min(tile_rows, bdim[0] - ty);
+		for (i = 0; i < tile_col_count; i++)
+		{
+			const int ix = i * tile_cols - hint.border.begin[1];
+			// Zero padded outside of the input.
+			for (c = 0; c < ch; c++)
+			{
+				for (y = 0; y < fdim0; y++)
+				{
+					float* const tp = tile + y * fdim1;
+					if (iy + y < 0 || iy + y >= adim[0])
+					{
+						memset(tp, 0, sizeof(float) * fdim1);
+						continue;
+					}
+					const float* const apz = ap + (iy + y) * ainc[1] * ainc[2] + c;
+					for (x = 0; x < fdim1; x++)
+						tp[x] = (ix + x < 0 || ix + x >= adim[1]) ? 0 : apz[(ix + x) * ainc[2]];
+				}
+				kissf_fftndr(pf, tile, fa + (c * tile_col_count + i) * fsize);
+			}
+		}
+		for (k = 0; k < count; k += 4)
+		{
+			// Accumulate 4 output channels at a time, thus, the transformed input tiles are read once for 4 channels.
+			const int kn = ccv_min(4, count - k);
+			memset(fb, 0, sizeof(kissf_fft_cpx) * fsize * tile_col_count * kn);
+			for (c = 0; c < ch; c++)
+			{
+				const kissf_fft_cpx* fac = fa + c * tile_col_count * fsize;
+				for (i = 0; i < tile_col_count; i++)
+				{
+					for (j = 0; j < kn; j++)
+						_ccv_nnc_conv_fft_mac(fb + (j * tile_col_count + i) * fsize, fac, fw + ((k + j) * ch + c) * fsize, fsize);
+					fac += fsize;
+				}
+			}
+			for (j = 0; j < kn; j++)
+			{
+				const float biasval = bias ? bias->data.f32[k + j] : 0;
+				for (i = 0; i < tile_col_count; i++)
+				{
+					const int tx = i * tile_cols;
+					const int cols = ccv_min(tile_cols, bdim[1] - tx);
+					kissf_fftndri(pinvf, fb + (j * tile_col_count + i) * fsize, tile);
+					for (y = 0; y < rows; y++)
+					{
+						float* const bpz = bp + (ty + y) * binc[1] * binc[2] + tx * binc[2] + k + j;
+						if (relu)
+							for (x = 0; x < cols; x++)
+								bpz[x * binc[2]] = ccv_max(tile[y * fdim1 + x] * scale + biasval, 0);
+						else
+							for (x = 0; x < cols; x++)
+								bpz[x * binc[2]] = tile[y * fdim1 + x] * scale + biasval;
+					}
+				}
+			}
+		}
+		ccfree(fa);
+		ccfree(tile);
+		kissf_fft_free(pinvf);
+		kissf_fft_free(pf);
+	} parallel_endfor
+	if (!cached)
+		ccfree((void*)fw);
+	return CCV_NNC_EXEC_SUCCESS;
 }
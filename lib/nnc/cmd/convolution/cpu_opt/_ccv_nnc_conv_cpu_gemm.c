@@ -5,7 +5,7 @@
 #include <nnc/ccv_nnc_internal.h>
 #include "../_ccv_nnc_conv_cpu_opt.h"
 
-int _ccv_nnc_conv_forw_gemm_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+int _ccv_nnc_conv_forw_gemm_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 	assert(!CCV_IS_TENSOR_VIEW(a));
 	assert(!CCV_IS_TENSOR_VIEW(w));
@@ -35,5 +35,54 @@ int _ccv_nnc_conv_forw_gemm_cpu_opt(const ccv_nnc_tensor_view_t* const a, const
 		ccv_gemm(&am, &wm, 1, dbm, 1, CCV_B_TRANSPOSE, (ccv_matrix_t**)&dbm, 0); // supply b as matrix C is allowed
 	else
 		ccv_gemm(&am, &wm, 1, 0, 0, CCV_B_TRANSPOSE, (ccv_matrix_t**)&dbm, 0); // supply b as matrix C is allowed
+	// BLAS doesn't take an epilogue, apply ReLU on the output while it is still warm.
+	if (relu)
+		for (i = 0; i < bm.rows * bdim[2]; i++)
+			bm.data.f32[i] = ccv_max(bm.data.f32[i], 0);
 	return CCV_NNC_EXEC_SUCCESS;
 }
+
+int _ccv_nnc_conv_back_gemm_cpu_opt(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, ccv_nnc_tensor_view_t* const h, ccv_nnc_tensor_t* const dw, ccv_nnc_tensor_t* const dbias)
+{
+#if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
+	assert(!CCV_IS_TENSOR_VIEW(g));
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(!CCV_IS_TENSOR_VIEW(dw));
+	assert(!dbias || !CCV_IS_TENSOR_VIEW(dbias));
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == CCV_NNC_MAX_DIM + 1 || g_nd == CCV_NNC_MAX_DIM + 2);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	assert(adim[0] == gdim[0]);
+	assert(adim[1] == gdim[1]);
+	ccv_dense_matrix_t gm = ccv_dense_matrix(gdim[0] * gdim[1], gdim[2], CCV_32F | CCV_C1, g->data.u8, 0);
+	ccv_dense_matrix_t am = ccv_dense_matrix(adim[0] * adim[1], adim[2], CCV_32F | CCV_C1, a->data.u8, 0);
+	// dw = g^T * a, accumulated onto whatever dw holds.
+	ccv_dense_matrix_t dwm = ccv_dense_matrix(gdim[2], adim[2], CCV_32F | CCV_C1, dw->data.u8, 0);
+	ccv_dense_matrix_t* ddwm = &dwm;
+	ccv_gemm(&gm, &am, 1, ddwm, 1, CCV_A_TRANSPOSE, (ccv_matrix_t**)&ddwm, 0); // supply dw as matrix C is allowed
+	int i, j;
+	if (dbias)
+		for (i = 0; i < gm.rows; i++)
+			for (j = 0; j < gdim[2]; j++)
+				dbias->data.f32[j] += gm.data.f32[i * gdim[2] + j];
+	if (h)
+	{
+		assert(!CCV_IS_TENSOR_VIEW(h));
+		assert(!CCV_IS_TENSOR_VIEW(w));
+		const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
+		assert(h_nd == CCV_NNC_MAX_DIM + 1 || h_nd == CCV_NNC_MAX_DIM + 2);
+		const int* hdim = (h_nd == CCV_NNC_MAX_DIM + 1) ? h->info.dim : h->info.dim + 1;
+		// h = g * w
+		ccv_dense_matrix_t hm = ccv_dense_matrix(hdim[0] * hdim[1], hdim[2], CCV_32F | CCV_C1, h->data.u8, 0);
+		ccv_dense_matrix_t* dhm = &hm;
+		ccv_dense_matrix_t wm = ccv_dense_matrix(gdim[2], hdim[2], CCV_32F | CCV_C1, w->data.u8, 0);
+		ccv_gemm(&gm, &wm, 1, 0, 0, 0, (ccv_matrix_t**)&dhm, 0);
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+#else
+	return CCV_NNC_EXEC_INVALID;
+#endif
+}
@@ -0,0 +1,441 @@
+#include <ccv.h>
+#include <ccv_internal.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
+#include "../_ccv_nnc_conv_cpu_opt.h"
+
+// In NCHW, a row of one channel is contiguous, thus, the kernels vectorize along the width rather than the channels.
+
+inline static void _ccv_nnc_nchw_axpy(float* const y, const float* const x, const float a, const int n)
+{
+	int i = 0;
+#if defined(HAVE_SSE2)
+	const __m128 a4 = _mm_set1_ps(a);
+	for (; i < n - 3; i += 4)
+		_mm_storeu_ps(y + i, _mm_add_ps(_mm_mul_ps(a4, _mm_loadu_ps(x + i)), _mm_loadu_ps(y + i)));
+#elif defined(HAVE_NEON)
+	const float32x4_t a4 = vdupq_n_f32(a);
+	for (; i < n - 3; i += 4)
+		vst1q_f32(y + i, vmlaq_f32(vld1q_f32(y + i), a4, vld1q_f32(x + i)));
+#endif
+	for (; i < n; i++)
+		y[i] += a * x[i];
+}
+
+inline static float _ccv_nnc_nchw_dot(const float* const x, const float* const y, const int n)
+{
+	int i = 0;
+	float v = 0;
+#if defined(HAVE_SSE2)
+	__m128 v4 = _mm_setzero_ps();
+	for (; i < n - 3; i += 4)
+		v4 = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)), v4);
+	float vs[4] __attribute__ ((__aligned__(16)));
+	_mm_store_ps(vs, v4);
+	v = vs[0] + vs[1] + vs[2] + vs[3];
+#elif defined(HAVE_NEON)
+	float32x4_t v4 = vmovq_n_f32(0);
+	for (; i < n - 3; i += 4)
+		v4 = vmlaq_f32(v4, vld1q_f32(x + i), vld1q_f32(y + i));
+	float32x2_t v2 = vadd_f32(vget_low_f32(v4), vget_high_f32(v4));
+	v = vget_lane_f32(vpadd_f32(v2, v2), 0);
+#endif
+	for (; i < n; i++)
+		v += x[i] * y[i];
+	return v;
+}
+
+#define NCHW_DIM_FROM_TENSOR(x, n, c, h, w) \
+	do { \
+		const int x##_nd = ccv_nnc_tensor_nd(x->info.dim); \
+		assert(x##_nd == CCV_NNC_MAX_DIM + 1 || x##_nd == CCV_NNC_MAX_DIM + 2); \
+		const int* const x##dim = (x##_nd == CCV_NNC_MAX_DIM + 1) ? x->info.dim : x->info.dim + 1; \
+		n = (x##_nd == CCV_NNC_MAX_DIM + 1) ? 1 : x->info.dim[0]; \
+		c = x##dim[0]; \
+		h = x##dim[1]; \
+		w = x##dim[2]; \
+	} while (0)
+
+int _ccv_nnc_conv_forw_nchw_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
+{
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	int batch_size, ch, ah, aw, b_batch_size, count, bh, bw;
+	NCHW_DIM_FROM_TENSOR(a, batch_size, ch, ah, aw);
+	NCHW_DIM_FROM_TENSOR(b, b_batch_size, count, bh, bw);
+	assert(batch_size == b_batch_size);
+	// w is in count x channel x height x width.
+	assert(w->info.dim[0] == count);
+	assert(w->info.dim[1] == ch);
+	const int kh = w->info.dim[2];
+	const int kw = w->info.dim[3];
+	const int stride_y = ccv_max(hint.stride.dim[0], 1);
+	const int stride_x = ccv_max(hint.stride.dim[1], 1);
+	parallel_for(t, batch_size * count) {
+		int c, i, j, y, x;
+		const int n = t / count;
+		const int k = t % count;
+		float* const bp = b->data.f32 + t * bh * bw;
+		const float biasval = bias ? bias->data.f32[k] : 0;
+		for (i = 0; i < bh * bw; i++)
+			bp[i] = biasval;
+		for (c = 0; c < ch; c++)
+		{
+			const float* const ap = a->data.f32 + (n * ch + c) * ah * aw;
+			const float* const wp = w->data.f32 + (k * ch + c) * kh * kw;
+			for (i = 0; i < kh; i++)
+				for (j = 0; j < kw; j++)
+				{
+					const float wv = wp[i * kw + j];
+					// The range of outputs that read from within the input along the width.
+					const int x0 = ccv_max(0, (hint.border.begin[1] - j + stride_x - 1) / stride_x);
+					const int x1 = (aw - 1 + hint.border.begin[1] - j < 0) ? 0 : ccv_min(bw, (aw - 1 + hint.border.begin[1] - j) / stride_x + 1);
+					if (x0 >= x1)
+						continue;
+					for (y = 0; y < bh; y++)
+					{
+						const int iy = y * stride_y - hint.border.begin[0] + i;
+						if (iy < 0 || iy >= ah)
+							continue;
+						const float* const apz = ap + iy * aw - hint.border.begin[1] + j;
+						float* const bpz = bp + y * bw;
+						if (stride_x == 1)
+							_ccv_nnc_nchw_axpy(bpz + x0, apz + x0, wv, x1 - x0);
+						else
+							for (x = x0; x < x1; x++)
+								bpz[x] += wv * apz[x * stride_x];
+					}
+				}
+		}
+		// The output plane is done and still in cache.
+		if (relu)
+			for (i = 0; i < bh * bw; i++)
+				bp[i] = ccv_max(bp[i], 0);
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+int _ccv_nnc_conv_forw_gemm_nchw_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
+{
+#if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	int batch_size, ch, ah, aw, b_batch_size, count, bh, bw;
+	NCHW_DIM_FROM_TENSOR(a, batch_size, ch, ah, aw);
+	NCHW_DIM_FROM_TENSOR(b, b_batch_size, count, bh, bw);
+	assert(batch_size == b_batch_size);
+	assert(ah == bh && aw == bw);
+	// 1x1 convolution in NCHW is b = w * a, where a is channel x (height * width) already, no transpose needed.
+	ccv_dense_matrix_t wm = ccv_dense_matrix(count, ch, CCV_32F | CCV_C1, w->data.u8, 0);
+	int i, j;
+	for (i = 0; i < batch_size; i++)
+	{
+		ccv_dense_matrix_t am = ccv_dense_matrix(ch, ah * aw, CCV_32F | CCV_C1, a->data.f32 + i * ch * ah * aw, 0);
+		ccv_dense_matrix_t bm = ccv_dense_matrix(count, bh * bw, CCV_32F | CCV_C1, b->data.f32 + i * count * bh * bw, 0);
+		ccv_dense_matrix_t* dbm = &bm;
+		if (bias)
+		{
+			// copy bias into each row.
+			for (j = 0; j < count; j++)
+			{
+				float* const bp = bm.data.f32 + j * bh * bw;
+				int k;
+				for (k = 0; k < bh * bw; k++)
+					bp[k] = bias->data.f32[j];
+			}
+			ccv_gemm(&wm, &am, 1, dbm, 1, 0, (ccv_matrix_t**)&dbm, 0); // supply b as matrix C is allowed
+		} else
+			ccv_gemm(&wm, &am, 1, 0, 0, 0, (ccv_matrix_t**)&dbm, 0);
+		// BLAS doesn't take an epilogue, apply ReLU on this batch while it is still warm.
+		if (relu)
+			for (j = 0; j < count * bh * bw; j++)
+				bm.data.f32[j] = ccv_max(bm.data.f32[j], 0);
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+#else
+	return CCV_NNC_EXEC_INVALID;
+#endif
+}
+
+// F(4x4, 3x3), see _ccv_nnc_conv_cpu_4x4_3x3_winograd.c for the NHWC version. These are the same transforms. Like the
+// NHWC version, they work on 4 lanes at a time, a lane for each channel (or output channel for the output transform).
+// s is the stride between the rows read, rs is the stride between the rows written.
+
+// G.w, 3 rows in, 6 rows out.
+inline static void _ccv_nnc_winograd_nchw_g4(const float* const w, const int s, float* const r, const int rs)
+{
+#if defined(HAVE_SSE2)
+	const __m128 w0 = _mm_loadu_ps(w);
+	const __m128 w1 = _mm_loadu_ps(w + s);
+	const __m128 w2 = _mm_loadu_ps(w + 2 * s);
+	const __m128 w02 = _mm_add_ps(w0, w2);
+	const __m128 w04 = _mm_add_ps(w0, _mm_mul_ps(w2, _mm_set1_ps(4)));
+	const __m128 w1x2 = _mm_add_ps(w1, w1);
+	const __m128 cn1_6 = _mm_set1_ps(-1.0 / 6);
+	const __m128 c1_24 = _mm_set1_ps(1.0 / 24);
+	_mm_storeu_ps(r, _mm_mul_ps(w0, _mm_set1_ps(1.0 / 4)));
+	_mm_storeu_ps(r + rs, _mm_mul_ps(_mm_add_ps(w02, w1), cn1_6));
+	_mm_storeu_ps(r + 2 * rs, _mm_mul_ps(_mm_sub_ps(w02, w1), cn1_6));
+	_mm_storeu_ps(r + 3 * rs, _mm_mul_ps(_mm_add_ps(w04, w1x2), c1_24));
+	_mm_storeu_ps(r + 4 * rs, _mm_mul_ps(_mm_sub_ps(w04, w1x2), c1_24));
+	_mm_storeu_ps(r + 5 * rs, w2);
+#elif defined(HAVE_NEON)
+	const float32x4_t w0 = vld1q_f32(w);
+	const float32x4_t w1 = vld1q_f32(w + s);
+	const float32x4_t w2 = vld1q_f32(w + 2 * s);
+	const float32x4_t w02 = vaddq_f32(w0, w2);
+	const float32x4_t w04 = vmlaq_n_f32(w0, w2, 4);
+	const float32x4_t w1x2 = vaddq_f32(w1, w1);
+	vst1q_f32(r, vmulq_n_f32(w0, 1.0 / 4));
+	vst1q_f32(r + rs, vmulq_n_f32(vaddq_f32(w02, w1), -1.0 / 6));
+	vst1q_f32(r + 2 * rs, vmulq_n_f32(vsubq_f32(w02, w1), -1.0 / 6));
+	vst1q_f32(r + 3 * rs, vmulq_n_f32(vaddq_f32(w04, w1x2), 1.0 / 24));
+	vst1q_f32(r + 4 * rs, vmulq_n_f32(vsubq_f32(w04, w1x2), 1.0 / 24));
+	vst1q_f32(r + 5 * rs, w2);
+#else
+	int i;
+	for (i = 0; i < 4; i++)
+	{
+		const float w0 = w[i], w1 = w[s + i], w2 = w[2 * s + i];
+		r[i] = w0 * (1.0 / 4);
+		r[rs + i] = (w0 + w1 + w2) * (-1.0 / 6);
+		r[2 * rs + i] = (w0 - w1 + w2) * (-1.0 / 6);
+		r[3 * rs + i] = (w0 + 2 * w1 + 4 * w2) * (1.0 / 24);
+		r[4 * rs + i] = (w0 - 2 * w1 + 4 * w2) * (1.0 / 24);
+		r[5 * rs + i] = w2;
+	}
+#endif
+}
+
+// BT.d, 6 rows in, 6 rows out.
+inline static void _ccv_nnc_winograd_nchw_bt4(const float* const d, const int s, float* const r, const int rs)
+{
+#if defined(HAVE_SSE2)
+	const __m128 d0 = _mm_loadu_ps(d);
+	const __m128 d1 = _mm_loadu_ps(d + s);
+	const __m128 d2 = _mm_loadu_ps(d + 2 * s);
+	const __m128 d3 = _mm_loadu_ps(d + 3 * s);
+	const __m128 d4 = _mm_loadu_ps(d + 4 * s);
+	const __m128 d5 = _mm_loadu_ps(d + 5 * s);
+	const __m128 c4 = _mm_set1_ps(4);
+	const __m128 c5 = _mm_set1_ps(5);
+	_mm_storeu_ps(r, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(d0, c4), d4), _mm_mul_ps(d2, c5)));
+	_mm_storeu_ps(r + rs, _mm_sub_ps(_mm_add_ps(d3, d4), _mm_mul_ps(_mm_add_ps(d1, d2), c4)));
+	_mm_storeu_ps(r + 2 * rs, _mm_add_ps(_mm_sub_ps(d4, d3), _mm_mul_ps(_mm_sub_ps(d1, d2), c4)));
+	const __m128 d42 = _mm_sub_ps(d4, d2);
+	__m128 d31x2 = _mm_sub_ps(d3, d1);
+	d31x2 = _mm_add_ps(d31x2, d31x2);
+	_mm_storeu_ps(r + 3 * rs, _mm_add_ps(d42, d31x2));
+	_mm_storeu_ps(r + 4 * rs, _mm_sub_ps(d42, d31x2));
+	_mm_storeu_ps(r + 5 * rs, _mm_sub_ps(_mm_add_ps(_mm_mul_ps(d1, c4), d5), _mm_mul_ps(d3, c5)));
+#elif defined(HAVE_NEON)
+	const float32x4_t d0 = vld1q_f32(d);
+	const float32x4_t d1 = vld1q_f32(d + s);
+	const float32x4_t d2 = vld1q_f32(d + 2 * s);
+	const float32x4_t d3 = vld1q_f32(d + 3 * s);
+	const float32x4_t d4 = vld1q_f32(d + 4 * s);
+	const float32x4_t d5 = vld1q_f32(d + 5 * s);
+	vst1q_f32(r, vmlsq_n_f32(vmlaq_n_f32(d4, d0, 4), d2, 5));
+	vst1q_f32(r + rs, vmlsq_n_f32(vaddq_f32(d3, d4), vaddq_f32(d1, d2), 4));
+	vst1q_f32(r + 2 * rs, vmlaq_n_f32(vsubq_f32(d4, d3), vsubq_f32(d1, d2), 4));
+	const float32x4_t d42 = vsubq_f32(d4, d2);
+	float32x4_t d31x2 = vsubq_f32(d3, d1);
+	d31x2 = vaddq_f32(d31x2, d31x2);
+	vst1q_f32(r + 3 * rs, vaddq_f32(d42, d31x2));
+	vst1q_f32(r + 4 * rs, vsubq_f32(d42, d31x2));
+	vst1q_f32(r + 5 * rs, vmlsq_n_f32(vmlaq_n_f32(d5, d1, 4), d3, 5));
+#else
+	int i;
+	for (i = 0; i < 4; i++)
+	{
+		const float d0 = d[i], d1 = d[s + i], d2 = d[2 * s + i], d3 = d[3 * s + i], d4 = d[4 * s + i], d5 = d[5 * s + i];
+		r[i] = 4 * d0 - 5 * d2 + d4;
+		r[rs + i] = d3 + d4 - 4 * (d1 + d2);
+		r[2 * rs + i] = d4 - d3 + 4 * (d1 - d2);
+		r[3 * rs + i] = d4 - d2 + 2 * (d3 - d1);
+		r[4 * rs + i] = d4 - d2 - 2 * (d3 - d1);
+		r[5 * rs + i] = 4 * d1 - 5 * d3 + d5;
+	}
+#endif
+}
+
+// AT.m, 6 rows in, 4 rows out.
+inline static void _ccv_nnc_winograd_nchw_at4(const float* const m, const int s, float* const r, const int rs)
+{
+#if defined(HAVE_SSE2)
+	const __m128 m0 = _mm_loadu_ps(m);
+	const __m128 m1 = _mm_loadu_ps(m + s);
+	const __m128 m2 = _mm_loadu_ps(m + 2 * s);
+	const __m128 m3 = _mm_loadu_ps(m + 3 * s);
+	const __m128 m4 = _mm_loadu_ps(m + 4 * s);
+	const __m128 m5 = _mm_loadu_ps(m + 5 * s);
+	const __m128 ms12 = _mm_add_ps(m1, m2);
+	const __m128 ms34 = _mm_add_ps(m3, m4);
+	const __m128 mn12 = _mm_sub_ps(m1, m2);
+	const __m128 mn34 = _mm_sub_ps(m3, m4);
+	_mm_storeu_ps(r, _mm_add_ps(_mm_add_ps(m0, ms12), ms34));
+	_mm_storeu_ps(r + rs, _mm_add_ps(mn12, _mm_mul_ps(mn34, _mm_set1_ps(2))));
+	_mm_storeu_ps(r + 2 * rs, _mm_add_ps(ms12, _mm_mul_ps(ms34, _mm_set1_ps(4))));
+	_mm_storeu_ps(r + 3 * rs, _mm_add_ps(_mm_add_ps(mn12, m5), _mm_mul_ps(mn34, _mm_set1_ps(8))));
+#elif defined(HAVE_NEON)
+	const float32x4_t m0 = vld1q_f32(m);
+	const float32x4_t m1 = vld1q_f32(m + s);
+	const float32x4_t m2 = vld1q_f32(m + 2 * s);
+	const float32x4_t m3 = vld1q_f32(m + 3 * s);
+	const float32x4_t m4 = vld1q_f32(m + 4 * s);
+	const float32x4_t m5 = vld1q_f32(m + 5 * s);
+	const float32x4_t ms12 = vaddq_f32(m1, m2);
+	const float32x4_t ms34 = vaddq_f32(m3, m4);
+	const float32x4_t mn12 = vsubq_f32(m1, m2);
+	const float32x4_t mn34 = vsubq_f32(m3, m4);
+	vst1q_f32(r, vaddq_f32(vaddq_f32(m0, ms12), ms34));
+	vst1q_f32(r + rs, vmlaq_n_f32(mn12, mn34, 2));
+	vst1q_f32(r + 2 * rs, vmlaq_n_f32(ms12, ms34, 4));
+	vst1q_f32(r + 3 * rs, vmlaq_n_f32(vaddq_f32(mn12, m5), mn34, 8));
+#else
+	int i;
+	for (i = 0; i < 4; i++)
+	{
+		const float m0 = m[i], m1 = m[s + i], m2 = m[2 * s + i], m3 = m[3 * s + i], m4 = m[4 * s + i], m5 = m[5 * s + i];
+		r[i] = m0 + m1 + m2 + m3 + m4;
+		r[rs + i] = m1 - m2 + 2 * (m3 - m4);
+		r[2 * rs + i] = m1 + m2 + 4 * (m3 + m4);
+		r[3 * rs + i] = m1 - m2 + 8 * (m3 - m4) + m5;
+	}
+#endif
+}
+
+int _ccv_nnc_conv_forw_4x4_3x3_winograd_nchw_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
+{
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	int batch_size, ch, ah, aw, b_batch_size, count, bh, bw;
+	NCHW_DIM_FROM_TENSOR(a, batch_size, ch, ah, aw);
+	NCHW_DIM_FROM_TENSOR(b, b_batch_size, count, bh, bw);
+	assert(batch_size == b_batch_size);
+	assert(w->info.dim[0] == count);
+	assert(w->info.dim[1] == ch);
+	assert(w->info.dim[2] == 3);
+	assert(w->info.dim[3] == 3);
+	assert(hint.border.begin[0] <= 1);
+	assert(hint.border.begin[1] <= 1);
+	// Transform the weights to count x 36 x channel, thus, the product over channels for one of the 36 positions is contiguous.
+	float* gwtg = 0;
+	ccmemalign((void **)&gwtg, 16, sizeof(float) * count * 36 * ch);
+	if (!gwtg)
+		return CCV_NNC_EXEC_OOM;
+	parallel_for(k, count) {
+		int c, i, j;
+		float* const gp = gwtg + k * 36 * ch;
+		for (c = 0; c < ch; c += 4)
+		{
+			const int lanes = ccv_min(4, ch - c);
+			float x9w[9 * 4] __attribute__ ((__aligned__(16)));
+			for (j = 0; j < 9; j++)
+				for (i = 0; i < 4; i++)
+					x9w[j * 4 + i] = i < lanes ? w->data.f32[(k * ch + c + i) * 9 + j] : 0;
+			float gw[18 * 4] __attribute__ ((__aligned__(16)));
+			/* G.w */
+			for (j = 0; j < 3; j++)
+				_ccv_nnc_winograd_nchw_g4(x9w + j * 4, 12, gw + j * 4, 12);
+			/* G.w.T(G), each of the 36 positions is a channel apart */
+			if (lanes == 4)
+				for (i = 0; i < 6; i++)
+					_ccv_nnc_winograd_nchw_g4(gw + i * 12, 4, gp + i * 6 * ch + c, ch);
+			else {
+				float g[36 * 4] __attribute__ ((__aligned__(16)));
+				for (i = 0; i < 6; i++)
+					_ccv_nnc_winograd_nchw_g4(gw + i * 12, 4, g + i * 24, 4);
+				for (i = 0; i < 36; i++)
+					for (j = 0; j < lanes; j++)
+						gp[i * ch + c + j] = g[i * 4 + j];
+			}
+		}
+	} parallel_endfor
+	const int tile_rows = (bh + 3) / 4;
+	const int tile_cols = (bw + 3) / 4;
+	parallel_for(t, batch_size * tile_rows) {
+		int c, i, j, k, l, x;
+		const int n = t / tile_rows;
+		const int ty = (t % tile_rows) * 4;
+		const int iy = ty - hint.border.begin[0];
+		// Transformed input tile, 36 x channel.
+		float* const btdb = (float*)ccmalloc(sizeof(float) * 36 * ch);
+		for (x = 0; x < tile_cols; x++)
+		{
+			const int tx = x * 4;
+			const int ix = tx - hint.border.begin[1];
+			for (c = 0; c < ch; c += 4)
+			{
+				const int lanes = ccv_min(4, ch - c);
+				float d[36 * 4] __attribute__ ((__aligned__(16)));
+				// Zero padded outside of the input.
+				for (l = 0; l < 4; l++)
+				{
+					const float* const ap = a->data.f32 + (n * ch + c + l) * ah * aw;
+					for (i = 0; i < 6; i++)
+						for (j = 0; j < 6; j++)
+							d[(i * 6 + j) * 4 + l] = (l < lanes && iy + i >= 0 && iy + i < ah && ix + j >= 0 && ix + j < aw) ? ap[(iy + i) * aw + ix + j] : 0;
+				}
+				float bd[36 * 4] __attribute__ ((__aligned__(16)));
+				/* BT.d */
+				for (j = 0; j < 6; j++)
+					_ccv_nnc_winograd_nchw_bt4(d + j * 4, 24, bd + j * 4, 24);
+				/* BT.d.B, each of the 36 positions is a channel apart */
+				if (lanes == 4)
+					for (i = 0; i < 6; i++)
+						_ccv_nnc_winograd_nchw_bt4(bd + i * 24, 4, btdb + i * 6 * ch + c, ch);
+				else {
+					for (i = 0; i < 6; i++)
+						_ccv_nnc_winograd_nchw_bt4(bd + i * 24, 4, d + i * 24, 4);
+					for (i = 0; i < 36; i++)
+						for (j = 0; j < lanes; j++)
+							btdb[i * ch + c + j] = d[i * 4 + j];
+				}
+			}
+			const int rows = ccv_min(4, bh - ty);
+			const int cols = ccv_min(4, bw - tx);
+			for (k = 0; k < count; k += 4)
+			{
+				const int lanes = ccv_min(4, count - k);
+				float m[36 * 4] __attribute__ ((__aligned__(16)));
+				for (i = 0; i < 36; i++)
+					for (l = 0; l < 4; l++)
+						m[i * 4 + l] = l < lanes ? _ccv_nnc_nchw_dot(gwtg + (k + l) * 36 * ch + i * ch, btdb + i * ch, ch) : 0;
+				float am[24 * 4] __attribute__ ((__aligned__(16)));
+				/* AT.m */
+				for (j = 0; j < 6; j++)
+					_ccv_nnc_winograd_nchw_at4(m + j * 4, 24, am + j * 4, 24);
+				/* AT.m.A */
+				for (i = 0; i < 4; i++)
+					_ccv_nnc_winograd_nchw_at4(am + i * 24, 4, m + i * 16, 4);
+				for (l = 0; l < lanes; l++)
+				{
+					float* const bp = b->data.f32 + ((n * count + k + l) * bh + ty) * bw + tx;
+					const float biasval = bias ? bias->data.f32[k + l] : 0;
+					for (i = 0; i < rows; i++)
+						for (j = 0; j < cols; j++)
+						{
+							const float v = m[(i * 4 + j) * 4 + l] + biasval;
+							bp[i * bw + j] = relu ? ccv_max(v, 0) : v;
+						}
+				}
+			}
+		}
+		ccfree(btdb);
+	} parallel_endfor
+	ccfree(gwtg);
+	return CCV_NNC_EXEC_SUCCESS;
+}
@@ -47,7 +47,7 @@ inline static void _ccv_nnc_x4w_sse2(const float* const w, const int* const dim,
 	} parallel_endfor
 }
 
-static int _ccv_nnc_conv_forw_sse2(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+static int _ccv_nnc_conv_forw_sse2(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
@@ -125,6 +125,8 @@ static int _ccv_nnc_conv_forw_sse2(const ccv_nnc_tensor_view_t* const a, const c
 					apz += ainc[1] * ainc[2]; \
 				} \
 				__m128 v4 = _mm_add_ps(_mm_add_ps(v40, v41), _mm_add_ps(v42, v43)); \
+				if (relu) \
+					v4 = _mm_max_ps(v4, _mm_setzero_ps()); \
 				_mm_stream_ps(bp + i[1] * binc[2], v4); \
 			} \
 			bp += binc[1] * binc[2]; \
@@ -205,7 +207,7 @@ inline static void _ccv_nnc_x4w_neon(const float* const w, const int* const dim,
 	} parallel_endfor
 }
 
-static int _ccv_nnc_conv_forw_neon(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+static int _ccv_nnc_conv_forw_neon(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
 	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
@@ -283,7 +285,10 @@ static int _ccv_nnc_conv_forw_neon(const ccv_nnc_tensor_view_t* const a, const c
 				} \
 				v40 = vaddq_f32(v40, v41); \
 				v42 = vaddq_f32(v42, v43); \
-				vst1q_f32(bp + i[1] * binc[2], vaddq_f32(v40, v42)); \
+				if (relu) \
+					vst1q_f32(bp + i[1] * binc[2], vmaxq_f32(vaddq_f32(v40, v42), vdupq_n_f32(0))); \
+				else \
+					vst1q_f32(bp + i[1] * binc[2], vaddq_f32(v40, v42)); \
 			} \
 			bp += binc[1] * binc[2]; \
 			ap += ainc[1] * ainc[2] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0)); \
@@ -334,14 +339,340 @@ static int _ccv_nnc_conv_forw_neon(const ccv_nnc_tensor_view_t* const a, const c
 }
 #endif
 
-int _ccv_nnc_conv_forw_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b)
+#ifdef HAVE_SSE2
+static int _ccv_nnc_conv_back_weight_sse2(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_hint_t hint, ccv_nnc_tensor_t* const dw, ccv_nnc_tensor_t* const dbias)
+{
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == CCV_NNC_MAX_DIM + 1 || g_nd == CCV_NNC_MAX_DIM + 2);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* ginc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == CCV_NNC_MAX_DIM + 1) ? g->inc : g->inc + 1) : gdim;
+	const int* wdim = dw->info.dim;
+	assert(wdim[0] % 4 == 0);
+	const int ch = wdim[3];
+	const int wsize = wdim[1] * wdim[2] * ch;
+	// The weight updates are accumulated in the same 4-output-channel interleaved layout the forward pass packs its weights to.
+	float* x4dw = 0;
+	ccmemalign((void **)&x4dw, 16, sizeof(float) * wsize * wdim[0]);
+	if (!x4dw)
+		return CCV_NNC_EXEC_OOM;
+	int jump_dim = wdim[0] / 4;
+	parallel_for(k, jump_dim) {
+		int c;
+		const float* ap = a->data.f32;
+		const float* gp = g->data.f32 + k * 4;
+		float* const x4dwp = x4dw + k * 4 * wsize;
+		memset(x4dwp, 0, sizeof(float) * 4 * wsize);
+		__m128 vb = _mm_setzero_ps();
+		int i[CCV_NNC_MAX_DIM];
+		int n[CCV_NNC_MAX_DIM];
+		int m[CCV_NNC_MAX_DIM];
+		int j[CCV_NNC_MAX_DIM];
+		for (i[0] = 0; i[0] < gdim[0]; i[0]++)
+		{
+			SET_BORDER_OFFSET_SIZE_FOR(0, i, hint, wdim + 1, adim, n, m);
+			float* const dwu = x4dwp + n[0] * wdim[2] * ch * 4;
+			for (i[1] = 0; i[1] < gdim[1]; i[1]++)
+			{
+				SET_BORDER_OFFSET_SIZE_FOR(1, i, hint, wdim + 1, adim, n, m);
+				const __m128 g4 = _mm_loadu_ps(gp + i[1] * ginc[2]);
+				vb = _mm_add_ps(vb, g4);
+				float* dwz = dwu + n[1] * ch * 4;
+				const float* apz = ap + ccv_max(i[1] * hint.stride.dim[1] - hint.border.begin[1], 0) * ainc[2];
+				for (j[0] = 0; j[0] < m[0]; j[0]++)
+				{
+					for (j[1] = 0; j[1] < m[1]; j[1]++)
+					{
+						float* const dwzu = dwz + j[1] * ch * 4;
+						const float* const apzu = apz + j[1] * ainc[2];
+						for (c = 0; c < ch - 3; c += 4)
+						{
+							__m128 apz4 = _mm_loadu_ps(apzu + c);
+							float* const dwzc = dwzu + c * 4;
+							_mm_store_ps(dwzc, _mm_add_ps(_mm_mul_ps(g4, _mm_shuffle_ps(apz4, apz4, 0x00)), _mm_load_ps(dwzc)));
+							_mm_store_ps(dwzc + 4, _mm_add_ps(_mm_mul_ps(g4, _mm_shuffle_ps(apz4, apz4, 0x55)), _mm_load_ps(dwzc + 4)));
+							_mm_store_ps(dwzc + 8, _mm_add_ps(_mm_mul_ps(g4, _mm_shuffle_ps(apz4, apz4, 0xAA)), _mm_load_ps(dwzc + 8)));
+							_mm_store_ps(dwzc + 12, _mm_add_ps(_mm_mul_ps(g4, _mm_shuffle_ps(apz4, apz4, 0xFF)), _mm_load_ps(dwzc + 12)));
+						}
+						for (; c < ch; c++)
+							_mm_store_ps(dwzu + c * 4, _mm_add_ps(_mm_mul_ps(g4, _mm_load1_ps(apzu + c)), _mm_load_ps(dwzu + c * 4)));
+					}
+					dwz += wdim[2] * ch * 4;
+					apz += ainc[1] * ainc[2];
+				}
+			}
+			gp += ginc[1] * ginc[2];
+			ap += ainc[1] * ainc[2] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0));
+		}
+		// Unpack the interleaved updates back to the weight layout.
+		float* const dwp = dw->data.f32 + k * 4 * wsize;
+		for (c = 0; c < wsize; c++)
+		{
+			dwp[c] += x4dwp[c * 4];
+			dwp[wsize + c] += x4dwp[c * 4 + 1];
+			dwp[wsize * 2 + c] += x4dwp[c * 4 + 2];
+			dwp[wsize * 3 + c] += x4dwp[c * 4 + 3];
+		}
+		if (dbias)
+		{
+			float biasval[4] __attribute__ ((__aligned__(16)));
+			_mm_store_ps(biasval, vb);
+			dbias->data.f32[k * 4] += biasval[0];
+			dbias->data.f32[k * 4 + 1] += biasval[1];
+			dbias->data.f32[k * 4 + 2] += biasval[2];
+			dbias->data.f32[k * 4 + 3] += biasval[3];
+		}
+	} parallel_endfor
+	ccfree(x4dw);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_conv_back_data_sse2(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_t* const w, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const h)
+{
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == CCV_NNC_MAX_DIM + 1 || g_nd == CCV_NNC_MAX_DIM + 2);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
+	assert(h_nd == CCV_NNC_MAX_DIM + 1 || h_nd == CCV_NNC_MAX_DIM + 2);
+	const int* hdim = (h_nd == CCV_NNC_MAX_DIM + 1) ? h->info.dim : h->info.dim + 1;
+	const int* ginc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == CCV_NNC_MAX_DIM + 1) ? g->inc : g->inc + 1) : gdim;
+	const int* hinc = CCV_IS_TENSOR_VIEW(h) ? ((h_nd == CCV_NNC_MAX_DIM + 1) ? h->inc : h->inc + 1) : hdim;
+	const int* wdim = w->info.dim;
+	const int count = wdim[0];
+	const int ch = wdim[3];
+	// Reorder the weights to [h][w][count][channel], thus, all output channels for a kernel position are adjacent.
+	float* xw = 0;
+	ccmemalign((void **)&xw, 16, sizeof(float) * count * wdim[1] * wdim[2] * ch);
+	if (!xw)
+		return CCV_NNC_EXEC_OOM;
+	parallel_for(k, count) {
+		int i;
+		for (i = 0; i < wdim[1] * wdim[2]; i++)
+			memcpy(xw + (i * count + k) * ch, w->data.f32 + (k * wdim[1] * wdim[2] + i) * ch, sizeof(float) * ch);
+	} parallel_endfor
+	const int stride_y = ccv_max(hint.stride.dim[0], 1);
+	const int stride_x = ccv_max(hint.stride.dim[1], 1);
+	// Gather rather than scatter, thus, every row of the output gradient is written by one thread only.
+	parallel_for(y, hdim[0]) {
+		int x, c, k, dy, dx;
+		float* const hp = h->data.f32 + y * hinc[1] * hinc[2];
+		for (x = 0; x < hdim[1]; x++)
+		{
+			float* const hpz = hp + x * hinc[2];
+			memset(hpz, 0, sizeof(float) * ch);
+			for (dy = 0; dy < wdim[1]; dy++)
+			{
+				const int gy = y + hint.border.begin[0] - dy;
+				if (gy < 0 || gy % stride_y != 0 || gy / stride_y >= gdim[0])
+					continue;
+				for (dx = 0; dx < wdim[2]; dx++)
+				{
+					const int gx = x + hint.border.begin[1] - dx;
+					if (gx < 0 || gx % stride_x != 0 || gx / stride_x >= gdim[1])
+						continue;
+					const float* const gpz = g->data.f32 + ((gy / stride_y) * ginc[1] + gx / stride_x) * ginc[2];
+					const float* wpz = xw + (dy * wdim[2] + dx) * count * ch;
+					for (k = 0; k < count; k++)
+					{
+						const __m128 g4 = _mm_load1_ps(gpz + k);
+						for (c = 0; c < ch - 3; c += 4)
+							_mm_storeu_ps(hpz + c, _mm_add_ps(_mm_mul_ps(g4, _mm_loadu_ps(wpz + c)), _mm_loadu_ps(hpz + c)));
+						for (; c < ch; c++)
+							hpz[c] += gpz[k] * wpz[c];
+						wpz += ch;
+					}
+				}
+			}
+		}
+	} parallel_endfor
+	ccfree(xw);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+#endif
+
+#ifdef HAVE_NEON
+static int _ccv_nnc_conv_back_weight_neon(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_hint_t hint, ccv_nnc_tensor_t* const dw, ccv_nnc_tensor_t* const dbias)
+{
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == CCV_NNC_MAX_DIM + 1 || g_nd == CCV_NNC_MAX_DIM + 2);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* ginc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == CCV_NNC_MAX_DIM + 1) ? g->inc : g->inc + 1) : gdim;
+	const int* wdim = dw->info.dim;
+	assert(wdim[0] % 4 == 0);
+	const int ch = wdim[3];
+	const int wsize = wdim[1] * wdim[2] * ch;
+	float* x4dw = 0;
+	ccmemalign((void **)&x4dw, 16, sizeof(float) * wsize * wdim[0]);
+	if (!x4dw)
+		return CCV_NNC_EXEC_OOM;
+	int jump_dim = wdim[0] / 4;
+	parallel_for(k, jump_dim) {
+		int c;
+		const float* ap = a->data.f32;
+		const float* gp = g->data.f32 + k * 4;
+		float* const x4dwp = x4dw + k * 4 * wsize;
+		memset(x4dwp, 0, sizeof(float) * 4 * wsize);
+		float32x4_t vb = vmovq_n_f32(0);
+		int i[CCV_NNC_MAX_DIM];
+		int n[CCV_NNC_MAX_DIM];
+		int m[CCV_NNC_MAX_DIM];
+		int j[CCV_NNC_MAX_DIM];
+		for (i[0] = 0; i[0] < gdim[0]; i[0]++)
+		{
+			SET_BORDER_OFFSET_SIZE_FOR(0, i, hint, wdim + 1, adim, n, m);
+			float* const dwu = x4dwp + n[0] * wdim[2] * ch * 4;
+			for (i[1] = 0; i[1] < gdim[1]; i[1]++)
+			{
+				SET_BORDER_OFFSET_SIZE_FOR(1, i, hint, wdim + 1, adim, n, m);
+				const float32x4_t g4 = vld1q_f32(gp + i[1] * ginc[2]);
+				vb = vaddq_f32(vb, g4);
+				float* dwz = dwu + n[1] * ch * 4;
+				const float* apz = ap + ccv_max(i[1] * hint.stride.dim[1] - hint.border.begin[1], 0) * ainc[2];
+				for (j[0] = 0; j[0] < m[0]; j[0]++)
+				{
+					for (j[1] = 0; j[1] < m[1]; j[1]++)
+					{
+						float* const dwzu = dwz + j[1] * ch * 4;
+						const float* const apzu = apz + j[1] * ainc[2];
+						for (c = 0; c < ch - 3; c += 4)
+						{
+							float32x2x2_t apz4 = vld2_f32(apzu + c);
+							float* const dwzc = dwzu + c * 4;
+							vst1q_f32(dwzc, vmlaq_f32(vld1q_f32(dwzc), g4, vdupq_lane_f32(apz4.val[0], 0)));
+							vst1q_f32(dwzc + 4, vmlaq_f32(vld1q_f32(dwzc + 4), g4, vdupq_lane_f32(apz4.val[1], 0)));
+							vst1q_f32(dwzc + 8, vmlaq_f32(vld1q_f32(dwzc + 8), g4, vdupq_lane_f32(apz4.val[0], 1)));
+							vst1q_f32(dwzc + 12, vmlaq_f32(vld1q_f32(dwzc + 12), g4, vdupq_lane_f32(apz4.val[1], 1)));
+						}
+						for (; c < ch; c++)
+							vst1q_f32(dwzu + c * 4, vmlaq_f32(vld1q_f32(dwzu + c * 4), g4, vld1q_dup_f32(apzu + c)));
+					}
+					dwz += wdim[2] * ch * 4;
+					apz += ainc[1] * ainc[2];
+				}
+			}
+			gp += ginc[1] * ginc[2];
+			ap += ainc[1] * ainc[2] * (ccv_max((i[0] + 1) * hint.stride.dim[0] - hint.border.begin[0], 0) - ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0));
+		}
+		float* const dwp = dw->data.f32 + k * 4 * wsize;
+		for (c = 0; c < wsize; c++)
+		{
+			dwp[c] += x4dwp[c * 4];
+			dwp[wsize + c] += x4dwp[c * 4 + 1];
+			dwp[wsize * 2 + c] += x4dwp[c * 4 + 2];
+			dwp[wsize * 3 + c] += x4dwp[c * 4 + 3];
+		}
+		if (dbias)
+		{
+			float biasval[4] __attribute__ ((__aligned__(16)));
+			vst1q_f32(biasval, vb);
+			dbias->data.f32[k * 4] += biasval[0];
+			dbias->data.f32[k * 4 + 1] += biasval[1];
+			dbias->data.f32[k * 4 + 2] += biasval[2];
+			dbias->data.f32[k * 4 + 3] += biasval[3];
+		}
+	} parallel_endfor
+	ccfree(x4dw);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_conv_back_data_neon(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_t* const w, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const h)
+{
+	const int g_nd = ccv_nnc_tensor_nd(g->info.dim);
+	assert(g_nd == CCV_NNC_MAX_DIM + 1 || g_nd == CCV_NNC_MAX_DIM + 2);
+	const int* gdim = (g_nd == CCV_NNC_MAX_DIM + 1) ? g->info.dim : g->info.dim + 1;
+	const int h_nd = ccv_nnc_tensor_nd(h->info.dim);
+	assert(h_nd == CCV_NNC_MAX_DIM + 1 || h_nd == CCV_NNC_MAX_DIM + 2);
+	const int* hdim = (h_nd == CCV_NNC_MAX_DIM + 1) ? h->info.dim : h->info.dim + 1;
+	const int* ginc = CCV_IS_TENSOR_VIEW(g) ? ((g_nd == CCV_NNC_MAX_DIM + 1) ? g->inc : g->inc + 1) : gdim;
+	const int* hinc = CCV_IS_TENSOR_VIEW(h) ? ((h_nd == CCV_NNC_MAX_DIM + 1) ? h->inc : h->inc + 1) : hdim;
+	const int* wdim = w->info.dim;
+	const int count = wdim[0];
+	const int ch = wdim[3];
+	float* xw = 0;
+	ccmemalign((void **)&xw, 16, sizeof(float) * count * wdim[1] * wdim[2] * ch);
+	if (!xw)
+		return CCV_NNC_EXEC_OOM;
+	parallel_for(k, count) {
+		int i;
+		for (i = 0; i < wdim[1] * wdim[2]; i++)
+			memcpy(xw + (i * count + k) * ch, w->data.f32 + (k * wdim[1] * wdim[2] + i) * ch, sizeof(float) * ch);
+	} parallel_endfor
+	const int stride_y = ccv_max(hint.stride.dim[0], 1);
+	const int stride_x = ccv_max(hint.stride.dim[1], 1);
+	parallel_for(y, hdim[0]) {
+		int x, c, k, dy, dx;
+		float* const hp = h->data.f32 + y * hinc[1] * hinc[2];
+		for (x = 0; x < hdim[1]; x++)
+		{
+			float* const hpz = hp + x * hinc[2];
+			memset(hpz, 0, sizeof(float) * ch);
+			for (dy = 0; dy < wdim[1]; dy++)
+			{
+				const int gy = y + hint.border.begin[0] - dy;
+				if (gy < 0 || gy % stride_y != 0 || gy / stride_y >= gdim[0])
+					continue;
+				for (dx = 0; dx < wdim[2]; dx++)
+				{
+					const int gx = x + hint.border.begin[1] - dx;
+					if (gx < 0 || gx % stride_x != 0 || gx / stride_x >= gdim[1])
+						continue;
+					const float* const gpz = g->data.f32 + ((gy / stride_y) * ginc[1] + gx / stride_x) * ginc[2];
+					const float* wpz = xw + (dy * wdim[2] + dx) * count * ch;
+					for (k = 0; k < count; k++)
+					{
+						const float32x4_t g4 = vld1q_dup_f32(gpz + k);
+						for (c = 0; c < ch - 3; c += 4)
+							vst1q_f32(hpz + c, vmlaq_f32(vld1q_f32(hpz + c), g4, vld1q_f32(wpz + c)));
+						for (; c < ch; c++)
+							hpz[c] += gpz[k] * wpz[c];
+						wpz += ch;
+					}
+				}
+			}
+		}
+	} parallel_endfor
+	ccfree(xw);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+#endif
+
+int _ccv_nnc_conv_forw_cpu_opt(const ccv_nnc_tensor_view_t* const a, const ccv_nnc_tensor_t* const w, const ccv_nnc_tensor_t* const bias, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const b, const int relu)
 {
 #if defined(HAVE_SSE2)
 	if (w->info.dim[0] % 4 == 0)
-		return _ccv_nnc_conv_forw_sse2(a, w, bias, hint, b);
+		return _ccv_nnc_conv_forw_sse2(a, w, bias, hint, b, relu);
 #elif defined(HAVE_NEON)
 	if (w->info.dim[0] % 4 == 0)
-		return _ccv_nnc_conv_forw_neon(a, w, bias, hint, b);
+		return _ccv_nnc_conv_forw_neon(a, w, bias, hint, b, relu);
+#endif
+	return CCV_NNC_EXEC_INVALID;
+}
+
+int _ccv_nnc_conv_back_weight_cpu_opt(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_view_t* const a, const ccv_nnc_hint_t hint, ccv_nnc_tensor_t* const dw, ccv_nnc_tensor_t* const dbias)
+{
+#if defined(HAVE_SSE2)
+	if (dw->info.dim[0] % 4 == 0)
+		return _ccv_nnc_conv_back_weight_sse2(g, a, hint, dw, dbias);
+#elif defined(HAVE_NEON)
+	if (dw->info.dim[0] % 4 == 0)
+		return _ccv_nnc_conv_back_weight_neon(g, a, hint, dw, dbias);
+#endif
+	return CCV_NNC_EXEC_INVALID;
+}
+
+int _ccv_nnc_conv_back_data_cpu_opt(const ccv_nnc_tensor_view_t* const g, const ccv_nnc_tensor_t* const w, const ccv_nnc_hint_t hint, ccv_nnc_tensor_view_t* const h)
+{
+#if defined(HAVE_SSE2)
+	return _ccv_nnc_conv_back_data_sse2(g, w, hint, h);
+#elif defined(HAVE_NEON)
+	return _ccv_nnc_conv_back_data_neon(g, w, hint, h);
 #endif
 	return CCV_NNC_EXEC_INVALID;
 }
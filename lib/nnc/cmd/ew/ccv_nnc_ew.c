@@ -68,7 +68,7 @@ static int _ccv_nnc_ewsum_back_bitmask(const int input_size, const int output_si
 }
 
 REGISTER_COMMAND(CCV_NNC_EWSUM_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c)
+	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c, ccv_nnc_ew_cpu_opt.c)
 {
 	registry->bitmask = _ccv_nnc_ewsum_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -165,7 +165,7 @@ static int _ccv_nnc_ewprod_back_bitmask(const int input_size, const int output_s
 }
 
 REGISTER_COMMAND(CCV_NNC_EWPROD_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c)
+	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c, ccv_nnc_ew_cpu_opt.c)
 {
 	registry->bitmask = _ccv_nnc_ewprod_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -208,7 +208,7 @@ static int _ccv_nnc_ewdiv_back_bitmask(const int input_size, const int output_si
 }
 
 REGISTER_COMMAND(CCV_NNC_EWDIV_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c)
+	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c, ccv_nnc_ew_cpu_opt.c)
 {
 	registry->flags = CCV_NNC_CMD_ATTR_NULL_IS_ONES;
 	registry->bitmask = _ccv_nnc_ewdiv_forw_bitmask;
@@ -245,7 +245,7 @@ static int _ccv_nnc_ewexp_back_bitmask(const int input_size, const int output_si
 }
 
 REGISTER_COMMAND(CCV_NNC_EWEXP_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c)
+	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c, ccv_nnc_ew_cpu_opt.c)
 {
 	registry->bitmask = _ccv_nnc_ewexp_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -282,7 +282,7 @@ static int _ccv_nnc_ewlog_back_bitmask(const int input_size, const int output_si
 }
 
 REGISTER_COMMAND(CCV_NNC_EWLOG_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c)
+	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c, ccv_nnc_ew_cpu_opt.c)
 {
 	registry->bitmask = _ccv_nnc_ewlog_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -319,7 +319,7 @@ static int _ccv_nnc_ewsqrt_back_bitmask(const int input_size, const int output_s
 }
 
 REGISTER_COMMAND(CCV_NNC_EWSQRT_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c)
+	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c, ccv_nnc_ew_cpu_opt.c)
 {
 	registry->bitmask = _ccv_nnc_ewsqrt_forw_bitmask;
 	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
@@ -339,3 +339,33 @@ REGISTER_COMMAND(CCV_NNC_EWSQRT_BACKWARD)(ccv_nnc_cmd_registry_t* const registry
 #define CMD_EWSQRT_FORWARD() ccv_nnc_cmd(CCV_NNC_EWSQRT_FORWARD, 0, ccv_nnc_cmd_auto, 0)
 //@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_EWSQRT_BACKWARD)
 #define CMD_EWSQRT_BACKWARD() ccv_nnc_cmd(CCV_NNC_EWSQRT_BACKWARD, 0, ccv_nnc_cmd_auto, 0)
+
+static int _ccv_nnc_ewchain_forw_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// The extra inputs are for the binary commands in the chain.
+	if ((input_bitmasks[0] & 1u) == 1u && output_bitmasks[0] == 1u)
+		return 1;
+	return 0;
+}
+
+static int _ccv_nnc_ewchain_back_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// The chain is only formed for inference, there is no gradient.
+	return 0;
+}
+
+REGISTER_COMMAND(CCV_NNC_EWCHAIN_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_ewchain_forw_bitmask;
+	registry->tensor_auto = ccv_nnc_hint_tensor_auto_forward_from_inputs;
+	// Each block of the output is written after all the inputs of that block are read.
+	registry->allow_inplace = _ccv_nnc_arbitary_inplace;
+}
+
+REGISTER_COMMAND(CCV_NNC_EWCHAIN_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_ew_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_ewchain_back_bitmask;
+	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_gradient;
+}
@@ -0,0 +1,285 @@
+#include <ccv.h>
+#include <ccv_internal.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
+
+// Each thread takes a block this size, big enough to amortize the dispatch, small enough to spread the work.
+#define CCV_NNC_EW_BLOCK_SIZE (4096)
+
+static int _ccv_nnc_ew_check_tensors(ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size)
+{
+	assert(output_size == 1);
+	if (!outputs[0] || CCV_IS_TENSOR_VIEW(outputs[0]))
+		return 0;
+	const int tensor_count = ccv_nnc_tensor_count(outputs[0]->info);
+	int i;
+	for (i = 0; i < input_size; i++)
+		if (inputs[i])
+		{
+			if (CCV_IS_TENSOR_VIEW(inputs[i]))
+				return 0;
+			assert(ccv_nnc_tensor_count(inputs[i]->info) == tensor_count);
+		}
+	return 1;
+}
+
+static inline void _ccv_nnc_ew_add(const float* const ap, const float* const bp, float* const cp, const int count)
+{
+	int x = 0;
+#if defined(HAVE_SSE2)
+	for (; x < count - 3; x += 4)
+		_mm_storeu_ps(cp + x, _mm_add_ps(_mm_loadu_ps(ap + x), _mm_loadu_ps(bp + x)));
+#elif defined(HAVE_NEON)
+	for (; x < count - 3; x += 4)
+		vst1q_f32(cp + x, vaddq_f32(vld1q_f32(ap + x), vld1q_f32(bp + x)));
+#endif
+	for (; x < count; x++)
+		cp[x] = ap[x] + bp[x];
+}
+
+static inline void _ccv_nnc_ew_mul(const float* const ap, const float* const bp, float* const cp, const int count)
+{
+	int x = 0;
+#if defined(HAVE_SSE2)
+	for (; x < count - 3; x += 4)
+		_mm_storeu_ps(cp + x, _mm_mul_ps(_mm_loadu_ps(ap + x), _mm_loadu_ps(bp + x)));
+#elif defined(HAVE_NEON)
+	for (; x < count - 3; x += 4)
+		vst1q_f32(cp + x, vmulq_f32(vld1q_f32(ap + x), vld1q_f32(bp + x)));
+#endif
+	for (; x < count; x++)
+		cp[x] = ap[x] * bp[x];
+}
+
+static int _ccv_nnc_ewsum_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	if (!_ccv_nnc_ew_check_tensors(inputs, input_size, outputs, output_size))
+		return CCV_NNC_EXEC_INVALID;
+	ccv_nnc_tensor_t* const c = outputs[0];
+	const int tensor_count = ccv_nnc_tensor_count(c->info);
+	if (input_size == 1)
+	{
+		if (inputs[0]->data.f32 != c->data.f32)
+			memcpy(c->data.f32, inputs[0]->data.f32, sizeof(float) * tensor_count);
+		return CCV_NNC_EXEC_SUCCESS;
+	}
+	// If the output is one of the inputs, start from that one, thus, it is read before the output is written.
+	int z, first = 0;
+	for (z = 1; z < input_size; z++)
+		if (inputs[z]->data.f32 == c->data.f32)
+		{
+			first = z;
+			break;
+		}
+	const int second = first == 0 ? 1 : 0;
+	const int block_count = (tensor_count + CCV_NNC_EW_BLOCK_SIZE - 1) / CCV_NNC_EW_BLOCK_SIZE;
+	parallel_for(k, block_count) {
+		const int start = k * CCV_NNC_EW_BLOCK_SIZE;
+		const int size = ccv_min(CCV_NNC_EW_BLOCK_SIZE, tensor_count - start);
+		float* const cp = c->data.f32 + start;
+		int x;
+		_ccv_nnc_ew_add(inputs[first]->data.f32 + start, inputs[second]->data.f32 + start, cp, size);
+		for (x = second + 1; x < input_size; x++)
+			if (x != first)
+				_ccv_nnc_ew_add(cp, inputs[x]->data.f32 + start, cp, size);
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_ewprod_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	if (!_ccv_nnc_ew_check_tensors(inputs, input_size, outputs, output_size))
+		return CCV_NNC_EXEC_INVALID;
+	ccv_nnc_tensor_t* const c = outputs[0];
+	const int tensor_count = ccv_nnc_tensor_count(c->info);
+	if (input_size == 1)
+	{
+		if (inputs[0]->data.f32 != c->data.f32)
+			memcpy(c->data.f32, inputs[0]->data.f32, sizeof(float) * tensor_count);
+		return CCV_NNC_EXEC_SUCCESS;
+	}
+	// If the output is one of the inputs, start from that one, thus, it is read before the output is written.
+	int z, first = 0;
+	for (z = 1; z < input_size; z++)
+		if (inputs[z]->data.f32 == c->data.f32)
+		{
+			first = z;
+			break;
+		}
+	const int second = first == 0 ? 1 : 0;
+	const int block_count = (tensor_count + CCV_NNC_EW_BLOCK_SIZE - 1) / CCV_NNC_EW_BLOCK_SIZE;
+	parallel_for(k, block_count) {
+		const int start = k * CCV_NNC_EW_BLOCK_SIZE;
+		const int size = ccv_min(CCV_NNC_EW_BLOCK_SIZE, tensor_count - start);
+		float* const cp = c->data.f32 + start;
+		int x;
+		_ccv_nnc_ew_mul(inputs[first]->data.f32 + start, inputs[second]->data.f32 + start, cp, size);
+		for (x = second + 1; x < input_size; x++)
+			if (x != first)
+				_ccv_nnc_ew_mul(cp, inputs[x]->data.f32 + start, cp, size);
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_ewdiv_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 2);
+	if (!_ccv_nnc_ew_check_tensors(inputs, input_size, outputs, output_size))
+		return CCV_NNC_EXEC_INVALID;
+	const ccv_nnc_tensor_t* const a = inputs[0]; // Take 0 as all ones tensor.
+	const ccv_nnc_tensor_t* const b = inputs[1];
+	ccv_nnc_tensor_t* const c = outputs[0];
+	const int tensor_count = ccv_nnc_tensor_count(c->info);
+	const int block_count = (tensor_count + CCV_NNC_EW_BLOCK_SIZE - 1) / CCV_NNC_EW_BLOCK_SIZE;
+	parallel_for(k, block_count) {
+		const int start = k * CCV_NNC_EW_BLOCK_SIZE;
+		const int size = ccv_min(CCV_NNC_EW_BLOCK_SIZE, tensor_count - start);
+		const float* const ap = a ? a->data.f32 + start : 0;
+		const float* const bp = b->data.f32 + start;
+		float* const cp = c->data.f32 + start;
+		int x = 0;
+#if defined(HAVE_SSE2)
+		const __m128 one4 = _mm_set1_ps(1);
+		for (; x < size - 3; x += 4)
+			_mm_storeu_ps(cp + x, _mm_div_ps(ap ? _mm_loadu_ps(ap + x) : one4, _mm_loadu_ps(bp + x)));
+#endif
+		if (ap)
+			for (; x < size; x++)
+				cp[x] = ap[x] / bp[x];
+		else
+			for (; x < size; x++)
+				cp[x] = 1 / bp[x];
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_ewexp_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	if (!_ccv_nnc_ew_check_tensors(inputs, 1, outputs, output_size))
+		return CCV_NNC_EXEC_INVALID;
+	const ccv_nnc_tensor_t* const a = inputs[0];
+	ccv_nnc_tensor_t* const b = outputs[0];
+	const int tensor_count = ccv_nnc_tensor_count(b->info);
+	const int block_count = (tensor_count + CCV_NNC_EW_BLOCK_SIZE - 1) / CCV_NNC_EW_BLOCK_SIZE;
+	// There is no vector exp in SSE2 / NEON, the libm one is what the reference uses too, only spread it over threads.
+	parallel_for(k, block_count) {
+		const int start = k * CCV_NNC_EW_BLOCK_SIZE;
+		const int size = ccv_min(CCV_NNC_EW_BLOCK_SIZE, tensor_count - start);
+		const float* const ap = a->data.f32 + start;
+		float* const bp = b->data.f32 + start;
+		int x;
+		for (x = 0; x < size; x++)
+			bp[x] = exp(ap[x]);
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_ewlog_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	if (!_ccv_nnc_ew_check_tensors(inputs, 1, outputs, output_size))
+		return CCV_NNC_EXEC_INVALID;
+	const ccv_nnc_tensor_t* const a = inputs[0];
+	ccv_nnc_tensor_t* const b = outputs[0];
+	const int tensor_count = ccv_nnc_tensor_count(b->info);
+	const int block_count = (tensor_count + CCV_NNC_EW_BLOCK_SIZE - 1) / CCV_NNC_EW_BLOCK_SIZE;
+	parallel_for(k, block_count) {
+		const int start = k * CCV_NNC_EW_BLOCK_SIZE;
+		const int size = ccv_min(CCV_NNC_EW_BLOCK_SIZE, tensor_count - start);
+		const float* const ap = a->data.f32 + start;
+		float* const bp = b->data.f32 + start;
+		int x;
+		for (x = 0; x < size; x++)
+			bp[x] = log(ap[x]);
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_ewsqrt_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	if (!_ccv_nnc_ew_check_tensors(inputs, 1, outputs, output_size))
+		return CCV_NNC_EXEC_INVALID;
+	const ccv_nnc_tensor_t* const a = inputs[0];
+	ccv_nnc_tensor_t* const b = outputs[0];
+	const int tensor_count = ccv_nnc_tensor_count(b->info);
+	const int block_count = (tensor_count + CCV_NNC_EW_BLOCK_SIZE - 1) / CCV_NNC_EW_BLOCK_SIZE;
+	parallel_for(k, block_count) {
+		const int start = k * CCV_NNC_EW_BLOCK_SIZE;
+		const int size = ccv_min(CCV_NNC_EW_BLOCK_SIZE, tensor_count - start);
+		const float* const ap = a->data.f32 + start;
+		float* const bp = b->data.f32 + start;
+		int x = 0;
+#if defined(HAVE_SSE2)
+		for (; x < size - 3; x += 4)
+			_mm_storeu_ps(bp + x, _mm_sqrt_ps(_mm_loadu_ps(ap + x)));
+#endif
+		for (; x < size; x++)
+			bp[x] = sqrt(ap[x]);
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_EWSUM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_ewsum_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_EWPROD_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_ewprod_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_EWDIV_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_ewdiv_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_EWEXP_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_ewexp_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_EWLOG_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_ewlog_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_EWSQRT_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_ewsqrt_forw;
+}
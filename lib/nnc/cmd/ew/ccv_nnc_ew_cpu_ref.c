@@ -1096,6 +1096,91 @@ static int _ccv_nnc_ewsqrt_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hi
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
+#define CCV_NNC_EWCHAIN_BLOCK_SIZE (256)
+
+static int _ccv_nnc_ewchain_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* const b = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	const int tensor_count = ccv_nnc_tensor_count(b->info);
+	int i;
+	for (i = 0; i < input_size; i++)
+	{
+		assert(inputs[i] && !CCV_IS_TENSOR_VIEW(inputs[i]));
+		assert(ccv_nnc_tensor_count(inputs[i]->info) == tensor_count);
+	}
+	const int chain_count = cmd.info.ewchain.count;
+	assert(chain_count > 0 && chain_count <= CCV_NNC_MAX_DIM_ALLOC);
+	// Work on blocks that stay in cache, so each command in the chain doesn't make another pass over the memory.
+	const int block_count = (tensor_count + CCV_NNC_EWCHAIN_BLOCK_SIZE - 1) / CCV_NNC_EWCHAIN_BLOCK_SIZE;
+	parallel_for(k, block_count) {
+		const int start = k * CCV_NNC_EWCHAIN_BLOCK_SIZE;
+		const int size = ccv_min(CCV_NNC_EWCHAIN_BLOCK_SIZE, tensor_count - start);
+		// The result so far is kept in a block of its own, the output may share the memory with any of the inputs
+		// (x * exp(x) reads x after exp), thus, it is only written out once the whole chain is applied.
+		float bp[CCV_NNC_EWCHAIN_BLOCK_SIZE];
+		int j, x, input_idx = 1;
+		memcpy(bp, inputs[0]->data.f32 + start, sizeof(float) * size);
+		for (j = 0; j < chain_count; j++)
+		{
+			const float* cp = 0;
+			switch (cmd.info.ewchain.cmds[j])
+			{
+				case CCV_NNC_EWEXP_FORWARD:
+					for (x = 0; x < size; x++)
+						bp[x] = exp(bp[x]);
+					break;
+				case CCV_NNC_EWLOG_FORWARD:
+					for (x = 0; x < size; x++)
+						bp[x] = log(bp[x]);
+					break;
+				case CCV_NNC_EWSQRT_FORWARD:
+					for (x = 0; x < size; x++)
+						bp[x] = sqrt(bp[x]);
+					break;
+				case CCV_NNC_RELU_FORWARD:
+					for (x = 0; x < size; x++)
+						bp[x] = ccv_max(bp[x], 0);
+					break;
+				case CCV_NNC_SCALAR_MUL_FORWARD: {
+					const float a = cmd.info.ewchain.a[j];
+					for (x = 0; x < size; x++)
+						bp[x] *= a;
+					break;
+				}
+				case CCV_NNC_EWSUM_FORWARD:
+					assert(input_idx < input_size);
+					cp = inputs[input_idx++]->data.f32 + start;
+					for (x = 0; x < size; x++)
+						bp[x] += cp[x];
+					break;
+				case CCV_NNC_EWPROD_FORWARD:
+					assert(input_idx < input_size);
+					cp = inputs[input_idx++]->data.f32 + start;
+					for (x = 0; x < size; x++)
+						bp[x] *= cp[x];
+					break;
+				case CCV_NNC_EWDIV_FORWARD:
+					assert(input_idx < input_size);
+					cp = inputs[input_idx++]->data.f32 + start;
+					for (x = 0; x < size; x++)
+						bp[x] = bp[x] / cp[x];
+					break;
+				default:
+					assert(0 && "unsupported command in the element-wise chain");
+			}
+		}
+		memcpy(b->data.f32 + start, bp, sizeof(float) * size);
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_ewchain_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	return CCV_NNC_EXEC_INVALID;
+}
+
 REGISTER_COMMAND_BACKEND(CCV_NNC_EWSUM_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
 {
 	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
@@ -1203,3 +1288,21 @@ REGISTER_COMMAND_BACKEND(CCV_NNC_EWSQRT_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_n
 	registry->algorithms = 1;
 	registry->exec = _ccv_nnc_ewsqrt_back;
 }
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_EWCHAIN_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_ewchain_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_EWCHAIN_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_ewchain_back;
+}
@@ -0,0 +1,103 @@
+#include <ccv.h>
+#include <ccv_internal.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
+
+// Keep the log finite if the prediction saturates at 0.
+#define CCV_NNC_CATEGORICAL_CROSSENTROPY_EPSILON (1e-7)
+
+static int _ccv_nnc_categorical_crossentropy_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 2);
+	const ccv_nnc_tensor_t* a = inputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	const ccv_nnc_tensor_t* b = inputs[1];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	assert(output_size == 1);
+	ccv_nnc_tensor_t* c = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(c));
+	const int axis_count = ccv_nnc_tensor_nd(a->info.dim);
+	const int batch_size = axis_count < 2 ? 1 : a->info.dim[0];
+	const int count = ccv_nnc_tensor_count(a->info) / batch_size;
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
+		{ assert(a->info.dim[i] == b->info.dim[i]); }
+	assert(ccv_nnc_tensor_count(c->info) == batch_size);
+	parallel_for(i, batch_size) {
+		int j;
+		const float* const ap = a->data.f32 + i * count;
+		const float* const bp = b->data.f32 + i * count;
+		double loss = 0;
+		for (j = 0; j < count; j++)
+			if (bp[j] != 0)
+				loss -= bp[j] * log(ccv_max(ap[j], CCV_NNC_CATEGORICAL_CROSSENTROPY_EPSILON));
+		c->data.f32[i] = loss;
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_categorical_crossentropy_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size >= 3);
+	assert(output_size >= 1);
+	const ccv_nnc_tensor_t* g = inputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(g));
+	const ccv_nnc_tensor_t* a = inputs[1];
+	assert(!CCV_IS_TENSOR_VIEW(a));
+	const ccv_nnc_tensor_t* b = inputs[2];
+	assert(!CCV_IS_TENSOR_VIEW(b));
+	ccv_nnc_tensor_t* h = outputs[0];
+	assert(!CCV_IS_TENSOR_VIEW(h));
+	ccv_nnc_tensor_t* hb = output_size > 1 ? outputs[1] : 0;
+	assert(!hb || !CCV_IS_TENSOR_VIEW(hb));
+	const int axis_count = ccv_nnc_tensor_nd(a->info.dim);
+	const int batch_size = axis_count < 2 ? 1 : a->info.dim[0];
+	const int count = ccv_nnc_tensor_count(a->info) / batch_size;
+	int i;
+	for (i = 0; i < CCV_NNC_MAX_DIM_ALLOC && a->info.dim[i] > 0; i++)
+		{ assert(a->info.dim[i] == b->info.dim[i] && a->info.dim[i] == h->info.dim[i]); }
+	assert(ccv_nnc_tensor_count(g->info) == batch_size);
+	parallel_for(i, batch_size) {
+		int j;
+		const float gp = g->data.f32[i];
+		const float* const ap = a->data.f32 + i * count;
+		const float* const bp = b->data.f32 + i * count;
+		float* const hp = h->data.f32 + i * count;
+		// D[-b * log(a), a] = -b / a
+		for (j = 0; j < count; j++)
+			hp[j] = -gp * bp[j] / ccv_max(ap[j], CCV_NNC_CATEGORICAL_CROSSENTROPY_EPSILON);
+		if (hb)
+		{
+			// D[-b * log(a), b] = -log(a)
+			float* const hbp = hb->data.f32 + i * count;
+			for (j = 0; j < count; j++)
+				hbp[j] = -gp * logf(ccv_max(ap[j], CCV_NNC_CATEGORICAL_CROSSENTROPY_EPSILON));
+		}
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_CATEGORICAL_CROSSENTROPY_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_categorical_crossentropy_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_CATEGORICAL_CROSSENTROPY_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_categorical_crossentropy_back;
+}
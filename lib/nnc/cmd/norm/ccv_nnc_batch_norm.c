@@ -66,7 +66,7 @@ static void _ccv_nnc_batch_norm_tensor_auto_back(const ccv_nnc_cmd_param_t cmd,
 }
 
 REGISTER_COMMAND(CCV_NNC_BATCH_NORM_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
-	FIND_BACKEND(ccv_nnc_batch_norm_cpu_ref.c, gpu/ccv_nnc_batch_norm_gpu_cudnn.cu)
+	FIND_BACKEND(ccv_nnc_batch_norm_cpu_ref.c, ccv_nnc_batch_norm_cpu_opt.c, gpu/ccv_nnc_batch_norm_gpu_cudnn.cu)
 {
 	registry->bitmask = _ccv_nnc_batch_norm_forw_bitmask;
 	registry->tensor_auto = _ccv_nnc_batch_norm_tensor_auto_forw;
@@ -84,3 +84,45 @@ REGISTER_COMMAND(CCV_NNC_BATCH_NORM_BACKWARD)(ccv_nnc_cmd_registry_t* const regi
 #define CMD_BATCH_NORM_FORWARD(_epsilon, _is_test, _momentum, ...) ccv_nnc_cmd(CCV_NNC_BATCH_NORM_FORWARD, 0, ((ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.bnorm={.epsilon=_epsilon,.is_test=_is_test,.momentum=_momentum,.count=LIST_COUNT(__VA_ARGS__),.axis={__VA_ARGS__}}}), 0)
 //@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_BATCH_NORM_BACKWARD)
 #define CMD_BATCH_NORM_BACKWARD(_epsilon, _is_test, _momentum, ...) ccv_nnc_cmd(CCV_NNC_BATCH_NORM_BACKWARD, 0, ((ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.bnorm={.epsilon=_epsilon,.is_test=_is_test,.momentum=_momentum,.count=LIST_COUNT(__VA_ARGS__),.axis={__VA_ARGS__}}}), 0)
+
+static int _ccv_nnc_batch_norm_fold_forw_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// 6 inputs (w, [bias], scale, bias, mean, var)
+	// 2 outputs (w, bias)
+	if ((input_bitmasks[0] & 61u) == 61u && output_bitmasks[0] == 3u)
+		return 1;
+	return 0;
+}
+
+static int _ccv_nnc_batch_norm_fold_back_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// Folding is for inference only, there is no gradient.
+	return 0;
+}
+
+static void _ccv_nnc_batch_norm_fold_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_hint_t hint, ccv_nnc_tensor_param_t* const outputs, const int output_size)
+{
+	assert(input_size == 6);
+	assert(output_size == 2);
+	outputs[0] = inputs[0];
+	outputs[1] = inputs[0];
+	memset(outputs[1].dim, 0, sizeof(outputs[1].dim));
+	outputs[1].dim[0] = inputs[0].dim[0];
+}
+
+REGISTER_COMMAND(CCV_NNC_BATCH_NORM_FOLD_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_batch_norm_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_batch_norm_fold_forw_bitmask;
+	registry->tensor_auto = _ccv_nnc_batch_norm_fold_tensor_auto_forw;
+}
+
+REGISTER_COMMAND(CCV_NNC_BATCH_NORM_FOLD_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_batch_norm_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_batch_norm_fold_back_bitmask;
+	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_inputs;
+}
+
+//@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_BATCH_NORM_FOLD_FORWARD)
+#define CMD_BATCH_NORM_FOLD_FORWARD(_epsilon) ccv_nnc_cmd(CCV_NNC_BATCH_NORM_FOLD_FORWARD, 0, ((ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.bnorm={.epsilon=_epsilon,.is_test=1}}), 0)
@@ -0,0 +1,130 @@
+#include <ccv.h>
+#include <ccv_internal.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
+
+// b = a * scale + bias, with one scale / bias per element.
+static inline void _ccv_nnc_batch_norm_scale_bias(const float* const ap, const float* const scalep, const float* const biasp, float* const bp, const int count)
+{
+	int x = 0;
+#if defined(HAVE_SSE2)
+	for (; x < count - 3; x += 4)
+		_mm_storeu_ps(bp + x, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ap + x), _mm_loadu_ps(scalep + x)), _mm_loadu_ps(biasp + x)));
+#elif defined(HAVE_NEON)
+	for (; x < count - 3; x += 4)
+		vst1q_f32(bp + x, vmlaq_f32(vld1q_f32(biasp + x), vld1q_f32(ap + x), vld1q_f32(scalep + x)));
+#endif
+	for (; x < count; x++)
+		bp[x] = ap[x] * scalep[x] + biasp[x];
+}
+
+// b = a * scale + bias, with the same scale / bias for all elements.
+static inline void _ccv_nnc_batch_norm_scale_bias_1(const float* const ap, const float scale, const float bias, float* const bp, const int count)
+{
+	int x = 0;
+#if defined(HAVE_SSE2)
+	const __m128 scale4 = _mm_set1_ps(scale);
+	const __m128 bias4 = _mm_set1_ps(bias);
+	for (; x < count - 3; x += 4)
+		_mm_storeu_ps(bp + x, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ap + x), scale4), bias4));
+#elif defined(HAVE_NEON)
+	const float32x4_t scale4 = vmovq_n_f32(scale);
+	const float32x4_t bias4 = vmovq_n_f32(bias);
+	for (; x < count - 3; x += 4)
+		vst1q_f32(bp + x, vmlaq_f32(bias4, vld1q_f32(ap + x), scale4));
+#endif
+	for (; x < count; x++)
+		bp[x] = ap[x] * scale + bias;
+}
+
+static int _ccv_nnc_batch_norm_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 5);
+	// Only the inference path is optimized, training updates the running statistics in the reference backend.
+	if (!cmd.info.bnorm.is_test)
+		return CCV_NNC_EXEC_INVALID;
+	assert(output_size == 1);
+	int i;
+	for (i = 0; i < input_size; i++)
+		if (CCV_IS_TENSOR_VIEW(inputs[i]))
+			return CCV_NNC_EXEC_INVALID;
+	if (CCV_IS_TENSOR_VIEW(outputs[0]))
+		return CCV_NNC_EXEC_INVALID;
+	ccv_nnc_tensor_view_t* const a = (ccv_nnc_tensor_view_t*)inputs[0];
+	ccv_nnc_tensor_view_t* const scale = (ccv_nnc_tensor_view_t*)inputs[1];
+	ccv_nnc_tensor_view_t* const bias = (ccv_nnc_tensor_view_t*)inputs[2];
+	ccv_nnc_tensor_view_t* const mean = (ccv_nnc_tensor_view_t*)inputs[3];
+	ccv_nnc_tensor_view_t* const var = (ccv_nnc_tensor_view_t*)inputs[4];
+	ccv_nnc_tensor_view_t* const b = (ccv_nnc_tensor_view_t*)outputs[0];
+	assert(a->info.dim[CCV_NNC_MAX_DIM + 2] == 0);
+	assert(b->info.dim[CCV_NNC_MAX_DIM + 2] == 0);
+	int adim[CCV_NNC_MAX_DIM_ALLOC];
+	int rdim[CCV_NNC_MAX_DIM_ALLOC];
+	ccv_nnc_tensor_view_get_dim(a, adim);
+	ccv_nnc_tensor_view_get_dim(scale, rdim);
+	assert(ccv_nnc_tensor_view_check_dim(bias, rdim));
+	assert(ccv_nnc_tensor_view_check_dim(mean, rdim));
+	assert(ccv_nnc_tensor_view_check_dim(var, rdim));
+	assert(ccv_nnc_tensor_view_check_dim(b, adim));
+	// The statistics have to be along one axis (the channel), which splits the tensor into outer x channels x inner.
+	int axis = -1;
+	for (i = 0; i < CCV_NNC_MAX_DIM + 2; i++)
+		if (rdim[i] != 1)
+		{
+			if (axis >= 0)
+				return CCV_NNC_EXEC_INVALID;
+			assert(rdim[i] == adim[i]);
+			axis = i;
+		}
+	int outer = 1, inner = 1;
+	for (i = 0; i < axis; i++)
+		outer *= adim[i];
+	for (i = axis + 1; i < CCV_NNC_MAX_DIM + 2; i++)
+		inner *= adim[i];
+	const int channels = axis >= 0 ? adim[axis] : 1;
+	const float epsilon = cmd.info.bnorm.epsilon;
+	float* const nscalep = (float*)ccmalloc(sizeof(float) * channels * 2);
+	float* const nbiasp = nscalep + channels;
+	for (i = 0; i < channels; i++)
+	{
+		const float w = scale->data.f32[i] / (sqrtf(var->data.f32[i]) + epsilon);
+		nscalep[i] = w;
+		nbiasp[i] = bias->data.f32[i] - mean->data.f32[i] * w;
+	}
+	if (inner == 1)
+	{
+		// Channels are the innermost dimension (NHWC), vectorize over channels.
+		parallel_for(k, outer) {
+			_ccv_nnc_batch_norm_scale_bias(a->data.f32 + k * channels, nscalep, nbiasp, b->data.f32 + k * channels, channels);
+		} parallel_endfor
+	} else {
+		// Channels are outside of the spatial dimensions (NCHW), vectorize over the plane of each channel.
+		parallel_for(k, outer * channels) {
+			const int c = k % channels;
+			_ccv_nnc_batch_norm_scale_bias_1(a->data.f32 + k * inner, nscalep[c], nbiasp[c], b->data.f32 + k * inner, inner);
+		} parallel_endfor
+	}
+	ccfree(nscalep);
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_BATCH_NORM_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_batch_norm_forw;
+}
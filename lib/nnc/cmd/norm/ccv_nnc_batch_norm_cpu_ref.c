@@ -490,6 +490,49 @@ static int _ccv_nnc_batch_norm_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_
 	return CCV_NNC_EXEC_SUCCESS;
 }
 
+static int _ccv_nnc_batch_norm_fold_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 6);
+	assert(output_size == 2);
+	// Batch norm in test mode is y = (x - mean) / (sqrt(var) + epsilon) * scale + bias, therefore, if x comes from
+	// a convolution / GEMM, it can be folded into its weights and bias along the first dimension of the weights.
+	const ccv_nnc_tensor_t* const w = inputs[0];
+	const ccv_nnc_tensor_t* const w_bias = inputs[1];
+	const ccv_nnc_tensor_t* const scale = inputs[2];
+	const ccv_nnc_tensor_t* const bias = inputs[3];
+	const ccv_nnc_tensor_t* const mean = inputs[4];
+	const ccv_nnc_tensor_t* const var = inputs[5];
+	ccv_nnc_tensor_t* const fw = outputs[0];
+	ccv_nnc_tensor_t* const fbias = outputs[1];
+	assert(!CCV_IS_TENSOR_VIEW(w) && !CCV_IS_TENSOR_VIEW(fw) && !CCV_IS_TENSOR_VIEW(fbias));
+	assert(!w_bias || !CCV_IS_TENSOR_VIEW(w_bias));
+	assert(!CCV_IS_TENSOR_VIEW(scale) && !CCV_IS_TENSOR_VIEW(bias) && !CCV_IS_TENSOR_VIEW(mean) && !CCV_IS_TENSOR_VIEW(var));
+	const int count = w->info.dim[0];
+	assert(ccv_nnc_tensor_count(scale->info) == count);
+	assert(ccv_nnc_tensor_count(bias->info) == count);
+	assert(ccv_nnc_tensor_count(mean->info) == count);
+	assert(ccv_nnc_tensor_count(var->info) == count);
+	assert(ccv_nnc_tensor_count(fbias->info) == count);
+	assert(ccv_nnc_tensor_count(fw->info) == ccv_nnc_tensor_count(w->info));
+	const int size = ccv_nnc_tensor_count(w->info) / count;
+	const float epsilon = cmd.info.bnorm.epsilon;
+	parallel_for(i, count) {
+		const float inv_std = scale->data.f32[i] / (sqrtf(var->data.f32[i]) + epsilon);
+		const float* const wp = w->data.f32 + i * size;
+		float* const fwp = fw->data.f32 + i * size;
+		int j;
+		for (j = 0; j < size; j++)
+			fwp[j] = wp[j] * inv_std;
+		fbias->data.f32[i] = ((w_bias ? w_bias->data.f32[i] : 0) - mean->data.f32[i]) * inv_std + bias->data.f32[i];
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_batch_norm_fold_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	return CCV_NNC_EXEC_INVALID;
+}
+
 REGISTER_COMMAND_BACKEND(CCV_NNC_BATCH_NORM_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
 {
 	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
@@ -507,3 +550,21 @@ REGISTER_COMMAND_BACKEND(CCV_NNC_BATCH_NORM_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(c
 	registry->algorithms = 1;
 	registry->exec = _ccv_nnc_batch_norm_back;
 }
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_BATCH_NORM_FOLD_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_batch_norm_fold_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_BATCH_NORM_FOLD_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_batch_norm_fold_back;
+}
@@ -0,0 +1,96 @@
+#include <ccv.h>
+#include <ccv_internal.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+#if defined(HAVE_SSE2)
+#include <xmmintrin.h>
+#elif defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
+
+static inline void _ccv_nnc_max_pool_window(const float* const ap, const int* const m, const int row_inc, const int col_inc, float* const bp, const int ch)
+{
+	int c = 0, x, y;
+#if defined(HAVE_SSE2)
+	for (; c < ch - 3; c += 4)
+	{
+		__m128 v = _mm_loadu_ps(ap + c);
+		for (y = 0; y < m[0]; y++)
+			for (x = 0; x < m[1]; x++)
+				v = _mm_max_ps(v, _mm_loadu_ps(ap + y * row_inc + x * col_inc + c));
+		_mm_storeu_ps(bp + c, v);
+	}
+#elif defined(HAVE_NEON)
+	for (; c < ch - 3; c += 4)
+	{
+		float32x4_t v = vld1q_f32(ap + c);
+		for (y = 0; y < m[0]; y++)
+			for (x = 0; x < m[1]; x++)
+				v = vmaxq_f32(v, vld1q_f32(ap + y * row_inc + x * col_inc + c));
+		vst1q_f32(bp + c, v);
+	}
+#endif
+	for (; c < ch; c++)
+	{
+		float v = ap[c];
+		for (y = 0; y < m[0]; y++)
+			for (x = 0; x < m[1]; x++)
+				if (ap[y * row_inc + x * col_inc + c] > v)
+					v = ap[y * row_inc + x * col_inc + c];
+		bp[c] = v;
+	}
+}
+
+static int _ccv_nnc_max_pool_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 1);
+	const ccv_nnc_tensor_view_t* a = (ccv_nnc_tensor_view_t*)inputs[0];
+	assert(output_size == 1);
+	ccv_nnc_tensor_view_t* b = (ccv_nnc_tensor_view_t*)outputs[0];
+	const int* dim = cmd.info.size.dim;
+	const int a_nd = ccv_nnc_tensor_nd(a->info.dim);
+	assert(a_nd == CCV_NNC_MAX_DIM + 1 || a_nd == CCV_NNC_MAX_DIM + 2);
+	const int* adim = (a_nd == CCV_NNC_MAX_DIM + 1) ? a->info.dim : a->info.dim + 1;
+	const int b_nd = ccv_nnc_tensor_nd(b->info.dim);
+	assert(b_nd == CCV_NNC_MAX_DIM + 1 || b_nd == CCV_NNC_MAX_DIM + 2);
+	const int* bdim = (b_nd == CCV_NNC_MAX_DIM + 1) ? b->info.dim : b->info.dim + 1;
+	assert(adim[CCV_NNC_MAX_DIM] == bdim[CCV_NNC_MAX_DIM]);
+	const int* ainc = CCV_IS_TENSOR_VIEW(a) ? ((a_nd == CCV_NNC_MAX_DIM + 1) ? a->inc : a->inc + 1) : adim;
+	const int* binc = CCV_IS_TENSOR_VIEW(b) ? ((b_nd == CCV_NNC_MAX_DIM + 1) ? b->inc : b->inc + 1) : bdim;
+	const int batch_size = (a_nd == CCV_NNC_MAX_DIM + 1) ? 1 : ccv_max(1, a->info.dim[0]);
+	assert(batch_size == ((b_nd == CCV_NNC_MAX_DIM + 1) ? 1 : ccv_max(1, b->info.dim[0])));
+	const int a_row_inc = ainc[CCV_NNC_MAX_DIM - 1] * ainc[CCV_NNC_MAX_DIM];
+	const int b_row_inc = binc[CCV_NNC_MAX_DIM - 1] * binc[CCV_NNC_MAX_DIM];
+	// Each output row reads its own windows, therefore, rows of all images in the batch can run in parallel.
+	parallel_for(k, batch_size * bdim[0]) {
+		int i[CCV_NNC_MAX_DIM];
+		int n[CCV_NNC_MAX_DIM];
+		int m[CCV_NNC_MAX_DIM];
+		i[0] = k % bdim[0];
+		SET_BORDER_OFFSET_SIZE_FOR(0, i, hint, dim, adim, n, m);
+		const float* const ap = a->data.f32 + (k / bdim[0]) * ainc[0] * a_row_inc + ccv_max(i[0] * hint.stride.dim[0] - hint.border.begin[0], 0) * a_row_inc;
+		float* const bp = b->data.f32 + (k / bdim[0]) * binc[0] * b_row_inc + i[0] * b_row_inc;
+		for (i[1] = 0; i[1] < bdim[1]; i[1]++)
+		{
+			SET_BORDER_OFFSET_SIZE_FOR(1, i, hint, dim, adim, n, m);
+			_ccv_nnc_max_pool_window(ap + ccv_max(i[1] * hint.stride.dim[1] - hint.border.begin[1], 0) * ainc[CCV_NNC_MAX_DIM], m, a_row_inc, ainc[CCV_NNC_MAX_DIM], bp + i[1] * binc[CCV_NNC_MAX_DIM], bdim[CCV_NNC_MAX_DIM]);
+		}
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_MAX_POOL_FORWARD, CCV_NNC_BACKEND_CPU_OPT)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NHWC;
+	registry->tensor_datatypes = CCV_32F;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_max_pool_forw;
+}
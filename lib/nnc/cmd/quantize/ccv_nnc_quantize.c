@@ -0,0 +1,93 @@
+#include <ccv.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+
+// Quantized tensors are stored as CCV_8U, and carry their parameters in a separate 32F tensor of [n, 2], each row is
+// a (scale, zero point) pair, such that x = (y - zero point) * scale. For n == 1, the parameters apply to the whole
+// tensor. Otherwise, n has to match the first dimension of the quantized tensor and each row applies to one slice
+// along that dimension.
+
+static int _ccv_nnc_quantize_forw_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// Quantize x into y and its quantization parameters.
+	if ((input_bitmasks[0] & 1u) == 1u && output_bitmasks[0] == ((1u << 0) | (1u << 1)))
+		return 1;
+	return 0;
+}
+
+static int _ccv_nnc_quantize_back_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// Quantization is for inference only, there is no gradient.
+	return 0;
+}
+
+static void _ccv_nnc_quantize_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_hint_t hint, ccv_nnc_tensor_param_t* const outputs, const int output_size)
+{
+	assert(input_size >= 1 && output_size >= 1);
+	outputs[0] = inputs[0];
+	outputs[0].datatype = CCV_8U;
+	if (output_size > 1)
+	{
+		memset(outputs[1].dim, 0, sizeof(outputs[1].dim));
+		outputs[1].type = inputs[0].type;
+		outputs[1].format = inputs[0].format;
+		outputs[1].datatype = CCV_32F;
+		outputs[1].dim[0] = cmd.quantize.per_channel ? inputs[0].dim[0] : 1;
+		outputs[1].dim[1] = 2;
+	}
+}
+
+REGISTER_COMMAND(CCV_NNC_QUANTIZE_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_quantize_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_quantize_forw_bitmask;
+	registry->tensor_auto = _ccv_nnc_quantize_tensor_auto_forw;
+}
+
+REGISTER_COMMAND(CCV_NNC_QUANTIZE_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_quantize_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_quantize_back_bitmask;
+	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_inputs;
+}
+
+//@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_QUANTIZE_FORWARD)
+#define CMD_QUANTIZE_FORWARD(_per_channel) ccv_nnc_cmd(CCV_NNC_QUANTIZE_FORWARD, 0, ((ccv_nnc_cmd_param_t){.size={.dim={1,1,1}},.quantize={.per_channel=_per_channel}}), 0)
+
+static int _ccv_nnc_dequantize_forw_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	// Restore x from y and its quantization parameters.
+	if ((input_bitmasks[0] & 3u) == ((1u << 0) | (1u << 1)) && output_bitmasks[0] == 1u)
+		return 1;
+	return 0;
+}
+
+static int _ccv_nnc_dequantize_back_bitmask(const int input_size, const int output_size, const uint64_t* const input_bitmasks, const int input_bitmask_size, const uint64_t* const output_bitmasks, const int output_bitmask_size)
+{
+	return 0;
+}
+
+static void _ccv_nnc_dequantize_tensor_auto_forw(const ccv_nnc_cmd_param_t cmd, const ccv_nnc_tensor_param_t* const inputs, const int input_size, const ccv_nnc_hint_t hint, ccv_nnc_tensor_param_t* const outputs, const int output_size)
+{
+	assert(input_size >= 1 && output_size == 1);
+	outputs[0] = inputs[0];
+	outputs[0].datatype = CCV_32F;
+}
+
+REGISTER_COMMAND(CCV_NNC_DEQUANTIZE_FORWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_quantize_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_dequantize_forw_bitmask;
+	registry->tensor_auto = _ccv_nnc_dequantize_tensor_auto_forw;
+}
+
+REGISTER_COMMAND(CCV_NNC_DEQUANTIZE_BACKWARD)(ccv_nnc_cmd_registry_t* const registry)
+	FIND_BACKEND(ccv_nnc_quantize_cpu_ref.c)
+{
+	registry->bitmask = _ccv_nnc_dequantize_back_bitmask;
+	registry->tensor_auto = ccv_nnc_hint_tensor_auto_backward_from_inputs;
+}
+
+//@REGISTER_EASY_COMMAND_MACRO(CCV_NNC_DEQUANTIZE_FORWARD)
+#define CMD_DEQUANTIZE_FORWARD() ccv_nnc_cmd(CCV_NNC_DEQUANTIZE_FORWARD, 0, ccv_nnc_cmd_auto, 0)
@@ -0,0 +1,140 @@
+#include <ccv.h>
+#include <ccv_internal.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <nnc/ccv_nnc_internal.h>
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+#ifdef USE_DISPATCH
+#include <dispatch/dispatch.h>
+#endif
+
+static int _ccv_nnc_quantize_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size >= 1);
+	assert(output_size == 2);
+	const ccv_nnc_tensor_t* const x = inputs[0];
+	ccv_nnc_tensor_t* const y = outputs[0];
+	ccv_nnc_tensor_t* const q = outputs[1];
+	if (x->info.datatype != CCV_32F || y->info.datatype != CCV_8U || q->info.datatype != CCV_32F)
+		return CCV_NNC_EXEC_INVALID;
+	assert(!CCV_IS_TENSOR_VIEW(x));
+	assert(!CCV_IS_TENSOR_VIEW(y));
+	assert(!CCV_IS_TENSOR_VIEW(q));
+	const int count = ccv_nnc_tensor_count(x->info);
+	assert(count == ccv_nnc_tensor_count(y->info));
+	const int n = cmd.info.quantize.per_channel ? x->info.dim[0] : 1;
+	assert(q->info.dim[0] == n && q->info.dim[1] == 2);
+	assert(count % n == 0);
+	const int slice = count / n;
+	if (cmd.info.quantize.per_channel)
+	{
+		// Symmetric, the zero point is fixed at 128 such that the stored value is an offset binary int8 in [-127, 127].
+		parallel_for(i, n) {
+			int j;
+			const float* const xp = x->data.f32 + i * slice;
+			unsigned char* const yp = y->data.u8 + i * slice;
+			float amax = 0;
+			for (j = 0; j < slice; j++)
+				amax = ccv_max(amax, fabsf(xp[j]));
+			const float scale = amax > 0 ? amax / 127 : 1;
+			const float inv = 1 / scale;
+			for (j = 0; j < slice; j++)
+				yp[j] = (unsigned char)(ccv_clamp((int)lrintf(xp[j] * inv), -127, 127) + 128);
+			q->data.f32[i * 2] = scale;
+			q->data.f32[i * 2 + 1] = 128;
+		} parallel_endfor
+	} else {
+		// Asymmetric, the range always includes 0 so that 0 (padding, ReLU output) is represented exactly.
+		int i;
+		float xmin = 0, xmax = 0;
+		for (i = 0; i < count; i++)
+			xmin = ccv_min(xmin, x->data.f32[i]), xmax = ccv_max(xmax, x->data.f32[i]);
+		const float scale = xmax > xmin ? (xmax - xmin) / 255 : 1;
+		const float inv = 1 / scale;
+		const int zero_point = ccv_clamp((int)lrintf(-xmin * inv), 0, 255);
+		for (i = 0; i < count; i++)
+			y->data.u8[i] = (unsigned char)ccv_clamp((int)lrintf(x->data.f32[i] * inv) + zero_point, 0, 255);
+		q->data.f32[0] = scale;
+		q->data.f32[1] = zero_point;
+	}
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_quantize_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	return CCV_NNC_EXEC_INVALID;
+}
+
+static int _ccv_nnc_dequantize_forw(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	assert(input_size == 2);
+	assert(output_size == 1);
+	const ccv_nnc_tensor_t* const y = inputs[0];
+	const ccv_nnc_tensor_t* const q = inputs[1];
+	ccv_nnc_tensor_t* const x = outputs[0];
+	if (y->info.datatype != CCV_8U || q->info.datatype != CCV_32F || x->info.datatype != CCV_32F)
+		return CCV_NNC_EXEC_INVALID;
+	assert(!CCV_IS_TENSOR_VIEW(x));
+	assert(!CCV_IS_TENSOR_VIEW(y));
+	assert(!CCV_IS_TENSOR_VIEW(q));
+	const int count = ccv_nnc_tensor_count(y->info);
+	assert(count == ccv_nnc_tensor_count(x->info));
+	const int n = q->info.dim[0];
+	assert(q->info.dim[1] == 2);
+	assert(n == 1 || n == y->info.dim[0]);
+	assert(count % n == 0);
+	const int slice = count / n;
+	parallel_for(i, n) {
+		int j;
+		const float scale = q->data.f32[i * 2];
+		const float zero_point = q->data.f32[i * 2 + 1];
+		const unsigned char* const yp = y->data.u8 + i * slice;
+		float* const xp = x->data.f32 + i * slice;
+		for (j = 0; j < slice; j++)
+			xp[j] = (yp[j] - zero_point) * scale;
+	} parallel_endfor
+	return CCV_NNC_EXEC_SUCCESS;
+}
+
+static int _ccv_nnc_dequantize_back(const ccv_nnc_cmd_t cmd, const ccv_nnc_hint_t hint, const int flags, ccv_nnc_tensor_t* const* const inputs, const int input_size, ccv_nnc_tensor_t* const* const outputs, const int output_size, const ccv_nnc_stream_context_t* const stream_context)
+{
+	return CCV_NNC_EXEC_INVALID;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_QUANTIZE_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F | CCV_8U;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_quantize_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_QUANTIZE_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F | CCV_8U;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_quantize_back;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_DEQUANTIZE_FORWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F | CCV_8U;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_dequantize_forw;
+}
+
+REGISTER_COMMAND_BACKEND(CCV_NNC_DEQUANTIZE_BACKWARD, CCV_NNC_BACKEND_CPU_REF)(ccv_nnc_cmd_backend_registry_t* const registry)
+{
+	registry->tensor_formats = CCV_TENSOR_FORMAT_NCHW | CCV_TENSOR_FORMAT_NHWC | CCV_TENSOR_FORMAT_CHWN;
+	registry->tensor_datatypes = CCV_32F | CCV_8U;
+	registry->tensor_memory = CCV_TENSOR_CPU_MEMORY;
+	registry->algorithms = 1;
+	registry->exec = _ccv_nnc_dequantize_back;
+}
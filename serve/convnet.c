@@ -3,6 +3,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <errno.h>
+#include <sys/time.h>
+#include <pthread.h>
 
 static void uri_convnet_on_model_string(void* context, char* string);
 static void uri_convnet_on_source_blob(void* context, ebb_buf data);
@@ -27,9 +30,30 @@ static const param_dispatch_t param_map[] = {
 	},
 };
 
+// requests that arrive close to each other are classified together in one ccv_convnet_classify call. The first
+// request that finds no one collecting becomes the collector, it waits until there are batch_size requests or
+// batch_wait milliseconds passed, takes them, runs the batch and hands the ranks back to each request.
+typedef struct {
+	ccv_dense_matrix_t* input;
+	int top;
+	int taken; // a collector has taken this request into its batch
+	int done;
+	ccv_array_t* rank;
+} convnet_batch_request_t;
+
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t notify;
+	int collecting;
+	int batch_size;
+	int batch_wait; // in milliseconds
+	ccv_array_t* pending; // convnet_batch_request_t*
+} convnet_batcher_t;
+
 typedef struct {
 	ccv_convnet_t* convnet;
 	ccv_array_t* words;
+	convnet_batcher_t batcher;
 } convnet_and_words_t;
 
 typedef struct {
@@ -92,6 +116,108 @@ static ccv_array_t* uri_convnet_words_read(char* filename)
 	return 0;
 }
 
+static int uri_convnet_getenv_int(const char* name, int default_value)
+{
+	const char* value = getenv(name);
+	if (!value || !*value)
+		return default_value;
+	int result = atoi(value);
+	return result > 0 ? result : default_value;
+}
+
+static void uri_convnet_batcher_init(convnet_batcher_t* batcher)
+{
+	pthread_mutex_init(&batcher->mutex, 0);
+	pthread_cond_init(&batcher->notify, 0);
+	batcher->collecting = 0;
+	// can be tuned from the environment, batch_size of 1 disables batching
+	batcher->batch_size = uri_convnet_getenv_int("CCV_SERVE_CONVNET_BATCH_SIZE", 16);
+	batcher->batch_wait = uri_convnet_getenv_int("CCV_SERVE_CONVNET_BATCH_WAIT", 5);
+	batcher->pending = ccv_array_new(sizeof(convnet_batch_request_t*), batcher->batch_size, 0);
+}
+
+static void uri_convnet_batcher_destroy(convnet_batcher_t* batcher)
+{
+	assert(batcher->pending->rnum == 0);
+	ccv_array_free(batcher->pending);
+	pthread_cond_destroy(&batcher->notify);
+	pthread_mutex_destroy(&batcher->mutex);
+}
+
+// collect a batch, this has to be called with the mutex held, and returns with it held
+static void uri_convnet_batcher_collect(convnet_batcher_t* batcher, ccv_convnet_t* convnet)
+{
+	batcher->collecting = 1;
+	struct timeval now;
+	gettimeofday(&now, 0);
+	struct timespec deadline;
+	deadline.tv_sec = now.tv_sec + batcher->batch_wait / 1000;
+	deadline.tv_nsec = now.tv_usec * 1000 + (batcher->batch_wait % 1000) * 1000000;
+	if (deadline.tv_nsec >= 1000000000)
+	{
+		deadline.tv_sec += 1;
+		deadline.tv_nsec -= 1000000000;
+	}
+	while (batcher->pending->rnum < batcher->batch_size)
+		if (pthread_cond_timedwait(&batcher->notify, &batcher->mutex, &deadline) == ETIMEDOUT)
+			break;
+	const int batch = ccv_min(batcher->pending->rnum, batcher->batch_size);
+	convnet_batch_request_t** requests = (convnet_batch_request_t**)alloca(sizeof(convnet_batch_request_t*) * batch);
+	memcpy(requests, ccv_array_get(batcher->pending, 0), sizeof(convnet_batch_request_t*) * batch);
+	memmove(ccv_array_get(batcher->pending, 0), ccv_array_get(batcher->pending, batch), sizeof(convnet_batch_request_t*) * (batcher->pending->rnum - batch));
+	batcher->pending->rnum -= batch;
+	int i, top = 0;
+	for (i = 0; i < batch; i++)
+	{
+		requests[i]->taken = 1;
+		top = ccv_max(top, requests[i]->top);
+	}
+	batcher->collecting = 0;
+	// if there are requests left, one of them will become the next collector
+	pthread_cond_broadcast(&batcher->notify);
+	pthread_mutex_unlock(&batcher->mutex);
+	ccv_dense_matrix_t** inputs = (ccv_dense_matrix_t**)alloca(sizeof(ccv_dense_matrix_t*) * batch);
+	ccv_array_t** ranks = (ccv_array_t**)alloca(sizeof(ccv_array_t*) * batch);
+	for (i = 0; i < batch; i++)
+		inputs[i] = requests[i]->input;
+	ccv_convnet_classify(convnet, inputs, 1, ranks, top, batch);
+	pthread_mutex_lock(&batcher->mutex);
+	for (i = 0; i < batch; i++)
+	{
+		// the ranks are ordered by confidence, cut them to what is asked for
+		if (ranks[i]->rnum > requests[i]->top)
+			ranks[i]->rnum = requests[i]->top;
+		requests[i]->rank = ranks[i];
+		requests[i]->done = 1;
+	}
+	pthread_cond_broadcast(&batcher->notify);
+}
+
+static ccv_array_t* uri_convnet_batcher_classify(convnet_batcher_t* batcher, ccv_convnet_t* convnet, ccv_dense_matrix_t* input, int top)
+{
+	convnet_batch_request_t request = {
+		.input = input,
+		.top = top,
+		.taken = 0,
+		.done = 0,
+		.rank = 0,
+	};
+	convnet_batch_request_t* request_ref = &request;
+	pthread_mutex_lock(&batcher->mutex);
+	ccv_array_push(batcher->pending, &request_ref);
+	if (batcher->pending->rnum >= batcher->batch_size)
+		pthread_cond_broadcast(&batcher->notify);
+	while (!request.done)
+	{
+		if (!batcher->collecting && !request.taken)
+			uri_convnet_batcher_collect(batcher, convnet);
+		else
+			pthread_cond_wait(&batcher->notify, &batcher->mutex);
+	}
+	pthread_mutex_unlock(&batcher->mutex);
+	return request.rank;
+}
+
 void* uri_convnet_classify_init(void)
 {
 	convnet_context_t* context = (convnet_context_t*)malloc(sizeof(convnet_context_t));
@@ -102,6 +228,8 @@ void* uri_convnet_classify_init(void)
 	context->image_net[1].words = uri_convnet_words_read("../samples/image-net-2012.words");
 	assert(context->image_net[1].words);
 	context->image_net[1].convnet = ccv_convnet_read(0, "../samples/image-net-2012-vgg-d.sqlite3");
+	uri_convnet_batcher_init(&context->image_net[0].batcher);
+	uri_convnet_batcher_init(&context->image_net[1].batcher);
 	assert(param_parser_map_alphabet(param_map, sizeof(param_map) / sizeof(param_dispatch_t)) == 0);
 	context->desc = param_parser_map_http_body(param_map, sizeof(param_map) / sizeof(param_dispatch_t),
 		"[{"
@@ -124,6 +252,7 @@ void uri_convnet_classify_destroy(void* context)
 			free(word);
 		}
 		ccv_array_free(convnet_context->image_net[i].words);
+		uri_convnet_batcher_destroy(&convnet_context->image_net[i].batcher);
 	}
 	free(convnet_context->desc.data);
 	free(convnet_context);
@@ -202,8 +331,7 @@ int uri_convnet_classify(const void* context, const void* parsed, ebb_buf* buf)
 	ccv_dense_matrix_t* input = 0;
 	ccv_convnet_input_formation(convnet->input, image, &input);
 	ccv_matrix_free(image);
-	ccv_array_t* rank = 0;
-	ccv_convnet_classify(convnet, &input, 1, &rank, parser->top, 1);
+	ccv_array_t* rank = uri_convnet_batcher_classify(&parser->convnet_and_words->batcher, convnet, input, parser->top);
 	// print out
 	buf->len = 192 + rank->rnum * 30 + 2;
 	char* data = (char*)malloc(buf->len);
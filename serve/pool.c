@@ -0,0 +1,161 @@
+#include "pool.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef struct {
+	void* context;
+	void (*cb)(void*);
+	uint64_t submitted;
+} request_pool_task_t;
+
+struct request_pool_s {
+	pthread_mutex_t mutex;
+	pthread_cond_t notify;
+	int destroying;
+	int worker_size;
+	int queue_size;
+	int reserved;
+	int running;
+	// the circular buffer holds no more than the reserved slots, which are at most worker_size + queue_size
+	int queue_length;
+	int queue_head;
+	int queue_pending;
+	request_pool_task_t* queue;
+	uint64_t rejected;
+	request_pool_timing_t wait;
+	request_pool_timing_t service;
+	pthread_t* workers;
+};
+
+static uint64_t request_pool_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void request_pool_timing_add(request_pool_timing_t* timing, uint64_t elapsed)
+{
+	++timing->count;
+	timing->total += elapsed;
+	if (elapsed > timing->max)
+		timing->max = elapsed;
+}
+
+static void* request_pool_worker(void* arg)
+{
+	request_pool_t* pool = (request_pool_t*)arg;
+	pthread_mutex_lock(&pool->mutex);
+	for (;;)
+	{
+		while (pool->queue_pending == 0 && !pool->destroying)
+			pthread_cond_wait(&pool->notify, &pool->mutex);
+		if (pool->queue_pending == 0) // destroying, and nothing left
+			break;
+		request_pool_task_t task = pool->queue[pool->queue_head];
+		pool->queue_head = (pool->queue_head + 1) % pool->queue_length;
+		--pool->queue_pending;
+		++pool->running;
+		const uint64_t start = request_pool_now();
+		request_pool_timing_add(&pool->wait, start - task.submitted);
+		pthread_mutex_unlock(&pool->mutex);
+		// run the request outside the lock
+		task.cb(task.context);
+		const uint64_t elapsed = request_pool_now() - start;
+		pthread_mutex_lock(&pool->mutex);
+		request_pool_timing_add(&pool->service, elapsed);
+		--pool->running;
+		--pool->reserved;
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return 0;
+}
+
+request_pool_t* request_pool_new(int worker_size, int queue_size)
+{
+	if (worker_size <= 0)
+		worker_size = sysconf(_SC_NPROCESSORS_ONLN);
+	if (worker_size <= 0)
+		worker_size = 1;
+	if (queue_size < 0)
+		queue_size = worker_size * 4;
+	request_pool_t* pool = (request_pool_t*)calloc(1, sizeof(request_pool_t));
+	pthread_mutex_init(&pool->mutex, 0);
+	pthread_cond_init(&pool->notify, 0);
+	pool->worker_size = worker_size;
+	pool->queue_size = queue_size;
+	pool->queue_length = worker_size + queue_size;
+	pool->queue = (request_pool_task_t*)malloc(sizeof(request_pool_task_t) * pool->queue_length);
+	pool->workers = (pthread_t*)malloc(sizeof(pthread_t) * worker_size);
+	int i;
+	for (i = 0; i < worker_size; i++)
+		pthread_create(pool->workers + i, 0, request_pool_worker, pool);
+	return pool;
+}
+
+int request_pool_reserve(request_pool_t* pool)
+{
+	pthread_mutex_lock(&pool->mutex);
+	const int available = pool->reserved < pool->worker_size + pool->queue_size;
+	if (available)
+		++pool->reserved;
+	else
+		++pool->rejected;
+	pthread_mutex_unlock(&pool->mutex);
+	return available;
+}
+
+void request_pool_release(request_pool_t* pool)
+{
+	pthread_mutex_lock(&pool->mutex);
+	assert(pool->reserved > 0);
+	--pool->reserved;
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+void request_pool_submit(request_pool_t* pool, void* context, void (*cb)(void*))
+{
+	assert(cb);
+	pthread_mutex_lock(&pool->mutex);
+	assert(pool->queue_pending + pool->running < pool->reserved);
+	request_pool_task_t* task = pool->queue + (pool->queue_head + pool->queue_pending) % pool->queue_length;
+	task->context = context;
+	task->cb = cb;
+	task->submitted = request_pool_now();
+	++pool->queue_pending;
+	pthread_cond_signal(&pool->notify);
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+void request_pool_stats(request_pool_t* pool, request_pool_stats_t* stats)
+{
+	pthread_mutex_lock(&pool->mutex);
+	stats->worker_size = pool->worker_size;
+	stats->queue_size = pool->queue_size;
+	stats->reserved = pool->reserved;
+	stats->queued = pool->queue_pending;
+	stats->running = pool->running;
+	stats->rejected = pool->rejected;
+	stats->wait = pool->wait;
+	stats->service = pool->service;
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+void request_pool_free(request_pool_t* pool)
+{
+	pthread_mutex_lock(&pool->mutex);
+	pool->destroying = 1;
+	pthread_cond_broadcast(&pool->notify);
+	pthread_mutex_unlock(&pool->mutex);
+	int i;
+	for (i = 0; i < pool->worker_size; i++)
+		pthread_join(pool->workers[i], 0);
+	pthread_cond_destroy(&pool->notify);
+	pthread_mutex_destroy(&pool->mutex);
+	free(pool->workers);
+	free(pool->queue);
+	free(pool);
+}
@@ -0,0 +1,40 @@
+#ifndef _GUARD_pool_h_
+#define _GUARD_pool_h_
+
+#include <stdint.h>
+
+// a fixed number of worker threads fed from a bounded FIFO queue. A slot has to be reserved (on the main thread, as soon
+// as we know which endpoint the request is for) before the request is submitted, so that a request that won't fit can
+// be turned away before its body is uploaded and parsed.
+typedef struct request_pool_s request_pool_t;
+
+typedef struct {
+	uint64_t count;
+	uint64_t total; // in microseconds
+	uint64_t max; // in microseconds
+} request_pool_timing_t;
+
+typedef struct {
+	int worker_size;
+	int queue_size;
+	int reserved; // requests that hold a slot, whether still uploading, queued or running
+	int queued;
+	int running;
+	uint64_t rejected;
+	request_pool_timing_t wait; // from submit to a worker picks it up
+	request_pool_timing_t service; // time spent on a worker
+} request_pool_stats_t;
+
+// worker_size <= 0 defaults to the number of online processors, queue_size < 0 defaults to 4 times the workers
+request_pool_t* request_pool_new(int worker_size, int queue_size);
+// returns 0 if all workers are busy and the queue is at its capacity
+int request_pool_reserve(request_pool_t* pool);
+// give up a reserved slot without submitting a request, for example, the connection is gone
+void request_pool_release(request_pool_t* pool);
+// runs cb(context) on a worker, the slot is released once cb returns
+void request_pool_submit(request_pool_t* pool, void* context, void (*cb)(void*));
+void request_pool_stats(request_pool_t* pool, request_pool_stats_t* stats);
+// waits for the queued requests to finish
+void request_pool_free(request_pool_t* pool);
+
+#endif
@@ -1,6 +1,5 @@
 #include <ccv.h>
 #include <ev.h>
-#include <dispatch/dispatch.h>
 #include "ebb.h"
 #include "uri.h"
 #include "async.h"
@@ -13,6 +12,8 @@ typedef struct {
 	ebb_connection* connection;
 	int resource;
 	uri_dispatch_t* dispatcher;
+	int reserved; // holds a slot in the dispatcher's pool that is not submitted yet
+	int rejected; // the dispatcher's pool is full
 	void* context;
 	ebb_buf response;
 	char uri[256];
@@ -53,6 +54,16 @@ static void on_request_headers_complete(ebb_request* request)
 		request_extras->dispatcher = find_uri_dispatch(uri);
 		request_extras->resource = resource;
 		request_extras->context = 0;
+		// reserve a slot before parsing the body, if the pool is full, fail fast without buffering the upload
+		if (request_extras->dispatcher)
+		{
+			if (request_pool_reserve(request_extras->dispatcher->pool))
+				request_extras->reserved = 1;
+			else {
+				request_extras->dispatcher = 0;
+				request_extras->rejected = 1;
+			}
+		}
 		if (resource >= 0 && request_extras->dispatcher && request_extras->dispatcher->parse)
 			request_extras->context = request_extras->dispatcher->parse(request_extras->dispatcher->context, request_extras->context, request_extras->resource, uri, len, URI_PARSE_TERMINATE, 0); // this kicks off resource id
 		request_extras->cursor = 0; // done work, reset cursor
@@ -103,6 +114,7 @@ static void on_connection_response_continue(ebb_connection* connection)
 	// call custom release function for the buffer
 	if (request_extras->response.data && request_extras->response.on_release)
 		request_extras->response.on_release(&request_extras->response);
+	connection_extras->request = 0;
 	ebb_connection_schedule_close(connection);
 	free(request);
 }
@@ -164,8 +176,14 @@ static void on_request_dispatch(ebb_request* request)
 	ebb_request_extras* request_extras = (ebb_request_extras*)request->data;
 	ebb_connection* connection = request_extras->connection;
 	if (request_extras->dispatcher)
-		dispatch_async_f(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), request, on_request_execute);
-	else { // write 404
+	{
+		assert(request_extras->reserved);
+		request_extras->reserved = 0; // the slot is released by the pool once the request is executed
+		request_pool_submit(request_extras->dispatcher->pool, request, on_request_execute);
+	} else if (request_extras->rejected) { // write 503
+		request_extras->response.data = 0;
+		ebb_connection_write(connection, ebb_http_503, sizeof(ebb_http_503), on_connection_response_continue);
+	} else { // write 404
 		request_extras->response.data = 0;
 		ebb_connection_write(connection, ebb_http_404, sizeof(ebb_http_404), on_connection_response_continue);
 	}
@@ -182,6 +200,8 @@ static ebb_request* new_request(ebb_connection* connection)
 	request_extras->cursor = 0;
 	memset(request_extras->uri, 0, sizeof(request_extras->uri));
 	request_extras->dispatcher = 0;
+	request_extras->reserved = 0;
+	request_extras->rejected = 0;
 	request->data = request_extras;
 	request->on_path = on_request_path;
 	request->on_part_data = on_request_part_data;
@@ -196,6 +216,18 @@ static ebb_request* new_request(ebb_connection* connection)
 
 static void on_connection_close(ebb_connection* connection)
 {
+	ebb_connection_extras* connection_extras = (ebb_connection_extras*)(connection->data);
+	ebb_request* request = connection_extras->request;
+	// the connection is gone before the request is complete, give the slot back
+	if (request)
+	{
+		ebb_request_extras* request_extras = (ebb_request_extras*)request->data;
+		if (request_extras->reserved)
+		{
+			request_pool_release(request_extras->dispatcher->pool);
+			request_extras->reserved = 0;
+		}
+	}
 	free(connection);
 }
 
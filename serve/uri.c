@@ -23,6 +23,8 @@ static uri_dispatch_t uri_map[] = {
 		.post = 0,
 		.delete = 0,
 		.destroy = uri_root_destroy,
+		.worker_size = 1,
+		.queue_size = 16,
 	},
 	{
 		.uri = "/bbf/detect.objects",
@@ -32,6 +34,8 @@ static uri_dispatch_t uri_map[] = {
 		.post = uri_bbf_detect_objects,
 		.delete = 0,
 		.destroy = uri_bbf_detect_objects_destroy,
+		.worker_size = 0,
+		.queue_size = -1,
 	},
 	{
 		.uri = "/convnet/classify",
@@ -41,6 +45,8 @@ static uri_dispatch_t uri_map[] = {
 		.post = uri_convnet_classify,
 		.delete = 0,
 		.destroy = uri_convnet_classify_destroy,
+		.worker_size = 16, // workers mostly wait for their batch to fill up, let enough of them in to make a batch (see convnet.c)
+		.queue_size = 16,
 	},
 	{
 		.uri = "/dpm/detect.objects",
@@ -50,6 +56,8 @@ static uri_dispatch_t uri_map[] = {
 		.post = uri_dpm_detect_objects,
 		.delete = 0,
 		.destroy = uri_dpm_detect_objects_destroy,
+		.worker_size = 0,
+		.queue_size = -1,
 	},
 	{
 		.uri = "/icf/detect.objects",
@@ -59,6 +67,8 @@ static uri_dispatch_t uri_map[] = {
 		.post = uri_icf_detect_objects,
 		.delete = 0,
 		.destroy = uri_icf_detect_objects_destroy,
+		.worker_size = 0,
+		.queue_size = -1,
 	},
 	{
 		.uri = "/scd/detect.objects",
@@ -68,6 +78,8 @@ static uri_dispatch_t uri_map[] = {
 		.post = uri_scd_detect_objects,
 		.delete = 0,
 		.destroy = uri_scd_detect_objects_destroy,
+		.worker_size = 0,
+		.queue_size = -1,
 	},
 	{
 		.uri = "/sift",
@@ -77,6 +89,19 @@ static uri_dispatch_t uri_map[] = {
 		.post = uri_sift,
 		.delete = 0,
 		.destroy = uri_sift_destroy,
+		.worker_size = 0,
+		.queue_size = -1,
+	},
+	{
+		.uri = "/stats",
+		.init = 0,
+		.parse = 0,
+		.get = uri_stats,
+		.post = 0,
+		.delete = 0,
+		.destroy = 0,
+		.worker_size = 1,
+		.queue_size = 16,
 	},
 	{
 		.uri = "/swt/detect.words",
@@ -86,6 +111,8 @@ static uri_dispatch_t uri_map[] = {
 		.post = uri_swt_detect_words,
 		.delete = 0,
 		.destroy = uri_swt_detect_words_destroy,
+		.worker_size = 0,
+		.queue_size = -1,
 	},
 	{
 		.uri = "/tld/track.object",
@@ -95,6 +122,8 @@ static uri_dispatch_t uri_map[] = {
 		.post = uri_tld_track_object,
 		.delete = uri_tld_track_object_free,
 		.destroy = uri_tld_track_object_destroy,
+		.worker_size = 0,
+		.queue_size = -1,
 	},
 };
 
@@ -128,6 +157,7 @@ void uri_init(void)
 			uri_map[i].context = uri_map[i].init();
 		} else
 			uri_map[i].context = 0;
+		uri_map[i].pool = request_pool_new(uri_map[i].worker_size, uri_map[i].queue_size);
 	}
 }
 
@@ -137,6 +167,9 @@ void uri_destroy(void)
 	size_t len = sizeof(uri_map) / sizeof(uri_dispatch_t);
 	for (i = 0; i < len; i++)
 	{
+		// drain the requests before destroying the context they use
+		request_pool_free(uri_map[i].pool);
+		uri_map[i].pool = 0;
 		if (uri_map[i].destroy)
 		{
 			printf("destroy context for %s\n", uri_map[i].uri);
@@ -186,3 +219,49 @@ void uri_root_destroy(void* context)
 {
 	free(context);
 }
+
+int uri_stats(const void* context, const void* parsed, ebb_buf* buf)
+{
+	int i;
+	size_t len = sizeof(uri_map) / sizeof(uri_dispatch_t);
+	buf->len = 192 + len * 384;
+	char* data = (char*)malloc(buf->len);
+	data[0] = '{';
+	buf->written = 1;
+	for (i = 0; i < len; i++)
+	{
+		char cell[384];
+		request_pool_stats_t stats;
+		request_pool_stats(uri_map[i].pool, &stats);
+		snprintf(cell, 384, "\"%s\":{\"workers\":%d,\"queue_size\":%d,\"reserved\":%d,\"queued\":%d,\"running\":%d,\"rejected\":%llu,"
+			"\"wait\":{\"count\":%llu,\"total_us\":%llu,\"max_us\":%llu},\"service\":{\"count\":%llu,\"total_us\":%llu,\"max_us\":%llu}}",
+			uri_map[i].uri, stats.worker_size, stats.queue_size, stats.reserved, stats.queued, stats.running, (unsigned long long)stats.rejected,
+			(unsigned long long)stats.wait.count, (unsigned long long)stats.wait.total, (unsigned long long)stats.wait.max,
+			(unsigned long long)stats.service.count, (unsigned long long)stats.service.total, (unsigned long long)stats.service.max);
+		size_t cell_len = strnlen(cell, 384);
+		while (buf->written + cell_len + 1 >= buf->len)
+		{
+			buf->len = (buf->len * 3 + 1) / 2;
+			data = (char*)realloc(data, buf->len);
+		}
+		memcpy(data + buf->written, cell, cell_len);
+		buf->written += cell_len + 1;
+		data[buf->written - 1] = (i == len - 1) ? '}' : ',';
+	}
+	char http_header[192];
+	snprintf(http_header, 192, ebb_http_header, buf->written + 1);
+	size_t header_len = strnlen(http_header, 192);
+	if (buf->written + header_len + 1 >= buf->len)
+	{
+		buf->len = buf->written + header_len + 1;
+		data = (char*)realloc(data, buf->len);
+	}
+	memmove(data + header_len, data, buf->written);
+	memcpy(data, http_header, header_len);
+	buf->written += header_len + 1;
+	data[buf->written - 1] = '\n';
+	buf->data = data;
+	buf->len = buf->written;
+	buf->on_release = uri_ebb_buf_free;
+	return 0;
+}
@@ -2,12 +2,14 @@
 #define _GUARD_uri_h_
 
 #include "ebb.h"
+#include "pool.h"
 #include <stddef.h>
 
 /* have to be static const char so that can use sizeof */
 static const char ebb_http_404[] = "HTTP/1.0 404 Not Found\r\nCache-Control: no-cache\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 6\r\n\r\nfalse\n";
 static const char ebb_http_empty_object[] = "HTTP/1.0 201 Created\r\nCache-Control: no-cache\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 3\r\n\r\n{}\n";
 static const char ebb_http_empty_array[] = "HTTP/1.0 201 Created\r\nCache-Control: no-cache\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 3\r\n\r\n[]\n";
+static const char ebb_http_503[] = "HTTP/1.0 503 Service Unavailable\r\nCache-Control: no-cache\r\nRetry-After: 1\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 6\r\n\r\nfalse\n";
 static const char ebb_http_ok_true[] = "HTTP/1.0 200 OK\r\nCache-Control: no-cache\r\nContent-Type: application/json; charset=utf-8\r\nContent-Length: 5\r\n\r\ntrue\n";
 /* we should never sizeof ebb_http_header */
 extern const char ebb_http_header[];
@@ -200,6 +202,9 @@ typedef struct {
 	int (*post)(const void*, const void*, ebb_buf*); // this runs off thread
 	int (*delete)(const void*, const void*, ebb_buf*); // this runs off thread
 	void (*destroy)(void*); // this runs on server shutdown
+	int worker_size; // the number of threads serving this uri, 0 for the number of online processors
+	int queue_size; // the requests that can wait for a worker, beyond that, it responds with 503, -1 for 4 times the workers
+	request_pool_t* pool;
 } uri_dispatch_t;
 
 uri_dispatch_t* find_uri_dispatch(const char* path);
@@ -210,6 +215,8 @@ void* uri_root_init(void);
 void uri_root_destroy(void* context);
 int uri_root_discovery(const void* context, const void* parsed, ebb_buf* buf);
 
+int uri_stats(const void* context, const void* parsed, ebb_buf* buf);
+
 void* uri_bbf_detect_objects_init(void);
 void uri_bbf_detect_objects_destroy(void* context);
 void* uri_bbf_detect_objects_parse(const void* context, void* parsed, int resource_id, const char* buf, size_t len, uri_parse_state_t state, int header_index);
@@ -2,6 +2,7 @@
 #include "case.h"
 #include "ccv_case.h"
 #include "3rdparty/dsfmt/dSFMT.h"
+#include <unistd.h>
 
 TEST_CASE("convolutional network of 11x11 on 225x225 with uniform weights")
 {
@@ -882,6 +883,113 @@ TEST_CASE("local response normalization with partitioned by 2")
 	ccv_convnet_free(partitioned_convnet);
 }
 
+TEST_CASE("convolutional network round trip through a memory-mapped flat file")
+{
+	ccv_convnet_layer_param_t params[] = {
+		{
+			.type = CCV_CONVNET_CONVOLUTIONAL,
+			.bias = 0,
+			.glorot = sqrtf(2),
+			.input = {
+				.matrix = {
+					.rows = 27,
+					.cols = 27,
+					.channels = 1,
+					.partition = 1,
+				},
+			},
+			.output = {
+				.convolutional = {
+					.count = 4,
+					.strides = 1,
+					.border = 2,
+					.rows = 5,
+					.cols = 5,
+					.channels = 1,
+					.partition = 1,
+				},
+			},
+		},
+		{
+			.type = CCV_CONVNET_MAX_POOL,
+			.input = {
+				.matrix = {
+					.rows = 27,
+					.cols = 27,
+					.channels = 4,
+					.partition = 1,
+				},
+			},
+			.output = {
+				.pool = {
+					.size = 3,
+					.strides = 3,
+					.border = 0,
+				},
+			},
+		},
+		{
+			.type = CCV_CONVNET_FULL_CONNECT,
+			.bias = 0,
+			.glorot = sqrtf(2),
+			.input = {
+				.matrix = {
+					.rows = 9,
+					.cols = 9,
+					.channels = 4,
+					.partition = 1,
+				},
+				.node = {
+					.count = 9 * 9 * 4,
+				},
+			},
+			.output = {
+				.full_connect = {
+					.relu = 0,
+					.count = 10,
+				},
+			},
+		},
+	};
+	ccv_convnet_t* convnet = ccv_convnet_new(0, ccv_size(27, 27), params, 3);
+	int i;
+	for (i = 0; i < convnet->layers[0].wnum; i++)
+		convnet->layers[0].w[i] = (i % 7) * 0.01 - 0.03;
+	for (i = 0; i < 4; i++)
+		convnet->layers[0].bias[i] = i * 0.1;
+	for (i = 0; i < convnet->layers[2].wnum; i++)
+		convnet->layers[2].w[i] = (i % 13) * 0.001 - 0.006;
+	for (i = 0; i < 10; i++)
+		convnet->layers[2].bias[i] = i * 0.5;
+	for (i = 0; i < 27 * 27; i++)
+		convnet->mean_activity->data.f32[i] = 0.5;
+	const char* filename = "convnet.flat.tmp";
+	REQUIRE(ccv_convnet_write_flat(convnet, filename) == 0, "should write the flat file");
+	ccv_convnet_t* mapped = ccv_convnet_read_flat(0, filename);
+	REQUIRE(mapped, "should read back the flat file");
+	REQUIRE(mapped->count == 3 && mapped->mapped, "should have 3 layers backed by the mapping");
+	REQUIRE(((uintptr_t)mapped->layers[0].w & 63) == 0 && ((uintptr_t)mapped->layers[2].w & 63) == 0, "weights should be aligned in the mapping");
+	REQUIRE_ARRAY_EQ(float, mapped->layers[0].w, convnet->layers[0].w, convnet->layers[0].wnum, "convolutional weights should match");
+	REQUIRE_ARRAY_EQ(float, mapped->layers[0].bias, convnet->layers[0].bias, 4, "convolutional bias should match");
+	REQUIRE_ARRAY_EQ(float, mapped->layers[2].w, convnet->layers[2].w, convnet->layers[2].wnum, "full connect weights should match");
+	REQUIRE_ARRAY_EQ(float, mapped->layers[2].bias, convnet->layers[2].bias, 10, "full connect bias should match");
+	REQUIRE_MATRIX_EQ(mapped->mean_activity, convnet->mean_activity, "mean activity should match");
+	ccv_dense_matrix_t* a = ccv_dense_matrix_new(27, 27, CCV_32F | CCV_C1, 0, 0);
+	for (i = 0; i < 27 * 27; i++)
+		a->data.f32[i] = (i % 11) * 0.1;
+	ccv_dense_matrix_t* b = 0;
+	ccv_convnet_encode(convnet, &a, &b, 1);
+	ccv_dense_matrix_t* c = 0;
+	ccv_convnet_encode(mapped, &a, &c, 1);
+	ccv_matrix_free(a);
+	REQUIRE_MATRIX_EQ(b, c, "encoded output should match between the original and the mapped network");
+	ccv_matrix_free(b);
+	ccv_matrix_free(c);
+	ccv_convnet_free(mapped);
+	ccv_convnet_free(convnet);
+	unlink(filename);
+}
+
 // we probably won't cover all static functions in this test, disable annoying warnings
 #pragma GCC diagnostic ignored "-Wunused-function"
 // so that we can test static functions, note that CASE_TESTS is defined in case.h, which will disable all extern functions
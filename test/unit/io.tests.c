@@ -1,6 +1,7 @@
 #include "ccv.h"
 #include "case.h"
 #include "ccv_case.h"
+#include <zlib.h>
 
 TEST_CASE("read raw memory, rgb => gray")
 {
@@ -372,4 +373,155 @@ TEST_CASE("read PNG from memory")
 	ccv_matrix_free(x);
 }
 
+TEST_CASE("read JPEG with region of interest")
+{
+	ccv_dense_matrix_t* x = 0;
+	ccv_read("../../samples/cmyk-jpeg-format.jpg", &x, CCV_IO_ANY_FILE);
+	ccv_dense_matrix_t* slice = 0;
+	ccv_slice(x, (ccv_matrix_t**)&slice, 0, 301, 517, 400, 611);
+	ccv_dense_matrix_t* y = 0;
+	ccv_read_param_t params = {
+		.x = 517,
+		.y = 301,
+		.width = 611,
+		.height = 400,
+	};
+	ccv_read_scaled("../../samples/cmyk-jpeg-format.jpg", &y, CCV_IO_ANY_FILE, 0, params);
+	REQUIRE_MATRIX_EQ(slice, y, "read cmyk-jpeg-format.jpg with region of interest should be the same as slice it from the full image");
+	ccv_matrix_free(y);
+	ccv_matrix_free(slice);
+	ccv_matrix_free(x);
+}
+
+TEST_CASE("read JPEG scaled down at decode time")
+{
+	ccv_dense_matrix_t* x = 0;
+	ccv_read("../../samples/cmyk-jpeg-format.jpg", &x, CCV_IO_ANY_FILE);
+	ccv_dense_matrix_t* y = 0;
+	ccv_read_param_t params = {
+		.rows = 225,
+		.cols = 225,
+	};
+	ccv_read_scaled("../../samples/cmyk-jpeg-format.jpg", &y, CCV_IO_ANY_FILE | CCV_IO_GRAY, 0, params);
+	// 2400x1745 decodes at 2 / 8, the 1 / 8 scale has only 219 rows
+	REQUIRE_EQ(y->rows, (x->rows * 2 + 7) / 8, "decoded image should be the smallest scale at least as large as requested");
+	REQUIRE_EQ(y->cols, (x->cols * 2 + 7) / 8, "decoded image should be the smallest scale at least as large as requested");
+	REQUIRE_EQ(CCV_GET_CHANNEL(y->type), CCV_C1, "decoded image should be converted to grayscale");
+	ccv_matrix_free(y);
+	ccv_matrix_free(x);
+}
+
+TEST_CASE("read PNG with region of interest")
+{
+	ccv_dense_matrix_t* x = 0;
+	ccv_read("../../samples/nature.png", &x, CCV_IO_ANY_FILE);
+	ccv_dense_matrix_t* slice = 0;
+	ccv_slice(x, (ccv_matrix_t**)&slice, 0, 12, 37, 100, 150);
+	ccv_dense_matrix_t* y = 0;
+	ccv_read_param_t params = {
+		.x = 37,
+		.y = 12,
+		.width = 150,
+		.height = 100,
+	};
+	ccv_read_scaled("../../samples/nature.png", &y, CCV_IO_ANY_FILE, 0, params);
+	REQUIRE_MATRIX_EQ(slice, y, "read nature.png with region of interest should be the same as slice it from the full image");
+	ccv_matrix_free(y);
+	ccv_matrix_free(slice);
+	ccv_matrix_free(x);
+}
+
+TEST_CASE("read deflate compressed matrix from memory")
+{
+	ccv_dense_matrix_t* x = 0;
+	ccv_read("../../samples/nature.png", &x, CCV_IO_ANY_FILE);
+	// lay out the matrix the same way as CCV_IO_BINARY_FILE, and deflate it
+	const int ctype = x->type & 0xFFFFF;
+	const size_t size = 20 + x->step * x->rows;
+	unsigned char* data = (unsigned char*)ccmalloc(size);
+	memcpy(data, "CCVBINDM", 8);
+	memcpy(data + 8, &ctype, 4);
+	memcpy(data + 12, &x->rows, 4);
+	memcpy(data + 16, &x->cols, 4);
+	memcpy(data + 20, x->data.u8, x->step * x->rows);
+	uLongf len = compressBound(size);
+	unsigned char* compressed = (unsigned char*)ccmalloc(len);
+	compress(compressed, &len, data, size);
+	ccfree(data);
+	ccv_dense_matrix_t* y = 0;
+	ccv_read(compressed, &y, CCV_IO_DEFLATE_STREAM, (int)len);
+	REQUIRE_MATRIX_EQ(x, y, "read nature.png from a deflate compressed stream should be the same");
+	// deflate streams are only inflated when asked for
+	ccv_dense_matrix_t* z = 0;
+	ccv_read(compressed, &z, CCV_IO_ANY_STREAM, (int)len);
+	REQUIRE(z == 0, "a deflate compressed stream should not be inflated as any stream");
+	// and only one level deep
+	uLongf twice_len = compressBound(len);
+	unsigned char* twice = (unsigned char*)ccmalloc(twice_len);
+	compress(twice, &twice_len, compressed, len);
+	ccfree(compressed);
+	ccv_read(twice, &z, CCV_IO_DEFLATE_STREAM, (int)twice_len);
+	ccfree(twice);
+	REQUIRE(z == 0, "a deflate stream inside a deflate stream should not be inflated");
+	ccv_matrix_free(y);
+	ccv_matrix_free(x);
+}
+
+TEST_CASE("read JPEG with region of interest from memory")
+{
+	ccv_read_param_t params = {
+		.x = 517,
+		.y = 301,
+		.width = 611,
+		.height = 400,
+		.rows = 100,
+		.cols = 100,
+	};
+	ccv_dense_matrix_t* x = 0;
+	ccv_read_scaled("../../samples/cmyk-jpeg-format.jpg", &x, CCV_IO_ANY_FILE, 0, params);
+	FILE* rb = fopen("../../samples/cmyk-jpeg-format.jpg", "rb");
+	fseek(rb, 0, SEEK_END);
+	long size = ftell(rb);
+	char* data = (char*)ccmalloc(size);
+	fseek(rb, 0, SEEK_SET);
+	fread(data, 1, size, rb);
+	fclose(rb);
+	ccv_dense_matrix_t* y = 0;
+	ccv_read_scaled(data, &y, CCV_IO_ANY_STREAM, size, params);
+	ccfree(data);
+	REQUIRE_MATRIX_EQ(x, y, "read cmyk-jpeg-format.jpg with region of interest from file system and memory should be the same");
+	ccv_matrix_free(y);
+	ccv_matrix_free(x);
+}
+
+TEST_CASE("read a batch of images")
+{
+	const char* files[] = {
+		"../../samples/cmyk-jpeg-format.jpg",
+		"../../samples/nature.png",
+		"../../samples/does-not-exist.png",
+	};
+	ccv_dense_matrix_t* x[3] = {0};
+	int decoded = ccv_read_batch((const void* const*)files, 0, x, 3, CCV_IO_ANY_FILE | CCV_IO_RGB_COLOR, 0, 0);
+	REQUIRE_EQ(decoded, 2, "the missing file should fail to decode");
+	REQUIRE(x[2] == 0, "the missing file should fail to decode");
+	int i;
+	for (i = 0; i < 2; i++)
+	{
+		ccv_dense_matrix_t* y = 0;
+		ccv_read(files[i], &y, CCV_IO_ANY_FILE | CCV_IO_RGB_COLOR);
+		REQUIRE_MATRIX_EQ(x[i], y, "read in a batch should be the same as read one by one");
+		ccv_matrix_free(y);
+		ccv_matrix_free(x[i]);
+	}
+	ccv_dense_matrix_t* z[2] = {0};
+	decoded = ccv_read_batch((const void* const*)files, 0, z, 2, CCV_IO_ANY_FILE | CCV_IO_RGB_COLOR, 225, 225);
+	REQUIRE_EQ(decoded, 2, "both images should be decoded");
+	for (i = 0; i < 2; i++)
+	{
+		REQUIRE(z[i]->rows == 225 && z[i]->cols == 225, "images should be resized to 225x225");
+		ccv_matrix_free(z[i]);
+	}
+}
+
 #include "case_main.h"
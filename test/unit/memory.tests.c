@@ -1,6 +1,7 @@
 #include "ccv.h"
 #include "ccv_internal.h"
 #include "case.h"
+#include <pthread.h>
 
 uint64_t uniqid()
 {
@@ -173,4 +174,56 @@ TEST_CASE("multi-type garbage collector 92\% hit rate")
 	ccv_disable_cache();
 }
 
+static void* _shared_cache_fill(void* arg)
+{
+	int i;
+	const int start = *(int*)arg;
+	for (i = start; i < N; i += 2)
+	{
+		ccv_dense_matrix_t* dmt = ccv_dense_matrix_new(1, 1, CCV_32S | CCV_C1, 0, 0);
+		dmt->data.i32[0] = i;
+		dmt->sig = ccv_cache_generate_signature((const char*)&i, 4, CCV_EOF_SIGN);
+		dmt->type |= CCV_REUSABLE;
+		ccv_matrix_free(dmt);
+	}
+	return 0;
+}
+
+TEST_CASE("shared garbage collector across threads 90\% hit rate")
+{
+	int i;
+	const size_t size = ccv_compute_dense_matrix_size(1, 1, CCV_32S | CCV_C1);
+	ccv_enable_shared_cache(size * N * 9 / 10);
+	// fill the cache from two other threads, and hit it from this one
+	pthread_t threads[2];
+	int starts[2] = {0, 1};
+	for (i = 0; i < 2; i++)
+		pthread_create(threads + i, 0, _shared_cache_fill, starts + i);
+	for (i = 0; i < 2; i++)
+		pthread_join(threads[i], 0);
+	ccv_cache_stats_t stats;
+	ccv_get_cache_stats(&stats);
+	REQUIRE(stats.size <= size * N * 9 / 10, "the shared cache should stay within its limit");
+	REQUIRE_EQ(stats.rnum + stats.evict, N, "every matrix is either cached or evicted");
+	REQUIRE_EQ(stats.size, stats.rnum * size, "the size should account for every cached matrix");
+	int percent = 0, total = 0;
+	for (i = N - 1; i >= 0; i--)
+	{
+		uint64_t sig = ccv_cache_generate_signature((const char*)&i, 4, CCV_EOF_SIGN);
+		ccv_dense_matrix_t* dmt = ccv_dense_matrix_new(1, 1, CCV_32S | CCV_C1, 0, sig);
+		if (i == dmt->data.i32[0])
+			++percent;
+		++total;
+		ccv_matrix_free_immediately(dmt);
+	}
+	REQUIRE((double)percent / (double)total > 0.85, "the cache hit (%lf) should be greater than 85%%", (double)percent / (double)total);
+	ccv_cache_stats_t after;
+	ccv_get_cache_stats(&after);
+	REQUIRE_EQ(after.hit - stats.hit, percent, "the hit counter should match the matrices found");
+	REQUIRE_EQ(after.miss - stats.miss, total - percent, "the miss counter should match the matrices not found");
+	REQUIRE_EQ(after.rnum, 0, "all cached matrices are taken out");
+	REQUIRE_EQ(after.size, 0, "the shared cache should be empty");
+	ccv_disable_cache();
+}
+
 #include "case_main.h"
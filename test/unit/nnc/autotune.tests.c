@@ -0,0 +1,69 @@
+#include "case.h"
+#include "ccv_case.h"
+#include "ccv_nnc_case.h"
+#include <ccv.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+
+TEST_SETUP()
+{
+	ccv_nnc_init();
+}
+
+static int _tensor_is_zero(const ccv_nnc_tensor_t* const tensor, const int size)
+{
+	int i;
+	for (i = 0; i < size; i++)
+		if (tensor->data.f32[i] != 0)
+			return 0;
+	return 1;
+}
+
+TEST_CASE("autotune cache skips measurement on a warm start")
+{
+	static const char fn[] = "autotune.cache.sqlite3";
+	remove(fn);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16, 64), 0);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(32, 64), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(32), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16, 32), 0);
+	int i;
+	for (i = 0; i < 16 * 64; i++)
+		a->data.f32[i] = i % 7;
+	for (i = 0; i < 32 * 64; i++)
+		w->data.f32[i] = i % 5;
+	for (i = 0; i < 32; i++)
+		bias->data.f32[i] = 1;
+	const ccv_nnc_cmd_t cmd = CMD_GEMM_FORWARD(32);
+	REQUIRE_EQ(ccv_nnc_cmd_autotune_cache_open(fn), 0, "should open the cache");
+	memset(b->data.f32, 0, sizeof(float) * 16 * 32);
+	const ccv_nnc_cmd_t cold = ccv_nnc_cmd_autotune(cmd, 0, ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	REQUIRE(!_tensor_is_zero(b, 16 * 32), "cold start should measure the candidates");
+	ccv_nnc_cmd_autotune_cache_close();
+	// Start over, as if it is a new process.
+	REQUIRE_EQ(ccv_nnc_cmd_autotune_cache_open(fn), 0, "should reopen the cache");
+	memset(b->data.f32, 0, sizeof(float) * 16 * 32);
+	const ccv_nnc_cmd_t warm = ccv_nnc_cmd_autotune(cmd, 0, ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	REQUIRE(_tensor_is_zero(b, 16 * 32), "warm start should not run the command");
+	REQUIRE_EQ(warm.backend, cold.backend, "should pick the same backend");
+	REQUIRE_EQ(warm.algorithm, cold.algorithm, "should pick the same algorithm");
+	// A different shape is a different entry.
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 64), 0);
+	ccv_nnc_tensor_t* const d = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 32), 0);
+	for (i = 0; i < 8 * 64; i++)
+		c->data.f32[i] = i % 3;
+	memset(d->data.f32, 0, sizeof(float) * 8 * 32);
+	const ccv_nnc_cmd_t other = ccv_nnc_cmd_autotune(cmd, 0, ccv_nnc_no_hint, 0, TENSOR_LIST(c, w, bias), TENSOR_LIST(d), 0);
+	REQUIRE(!_tensor_is_zero(d, 8 * 32), "a new shape should measure the candidates");
+	REQUIRE(ccv_nnc_cmd_ok(other.cmd, other.backend), "should pick a backend for the new shape");
+	ccv_nnc_cmd_autotune_cache_close();
+	remove(fn);
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(d);
+}
+
+#include "case_main.h"
@@ -4,6 +4,7 @@
 #include <ccv.h>
 #include <nnc/ccv_nnc.h>
 #include <nnc/ccv_nnc_easy.h>
+#include <3rdparty/dsfmt/dSFMT.h>
 
 TEST_SETUP()
 {
@@ -66,6 +67,86 @@ TEST_CASE("convolutional network of 3x5 on 21x31 for error backward propagation"
 	ccv_nnc_tensor_free(gbias);
 }
 
+// Returns the largest absolute difference between the optimized and the reference implementation, or -1 if the optimized one cannot run.
+static float _convolution_backward_opt_vs_ref(const int ah, const int aw, const int ch, const int count, const int kh, const int kw, const ccv_nnc_hint_t hint, const int algorithm)
+{
+	ccv_nnc_cmd_t forw_cmd = CMD_CONVOLUTION_FORWARD(1, count, kh, kw, ch);
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(ah, aw, ch), 0);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(count, kh, kw, ch), 0);
+	ccv_nnc_tensor_param_t g_info;
+	ccv_nnc_hint_tensor_auto(forw_cmd, (ccv_nnc_tensor_param_t []){ a->info, w->info }, 2, hint, &g_info, 1);
+	ccv_nnc_tensor_t* g = ccv_nnc_tensor_new(0, g_info, 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i;
+	for (i = 0; i < ah * aw * ch; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	const int gcount = ccv_nnc_tensor_count(g_info);
+	for (i = 0; i < gcount; i++)
+		g->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+	for (i = 0; i < count * kh * kw * ch; i++)
+		w->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) - 0.5) / (kh * kw);
+	ccv_nnc_cmd_t back_cmd = CMD_CONVOLUTION_BACKWARD(1, count, kh, kw, ch);
+	ccv_nnc_tensor_t* h = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(ah, aw, ch), 0);
+	ccv_nnc_tensor_t* gw = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(count, kh, kw, ch), 0);
+	ccv_nnc_tensor_t* gbias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(count), 0);
+	back_cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(h, gw, gbias), 0);
+	ccv_nnc_tensor_t* oh = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(ah, aw, ch), 0);
+	ccv_nnc_tensor_t* ogw = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(count, kh, kw, ch), 0);
+	ccv_nnc_tensor_t* ogbias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(count), 0);
+	back_cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	back_cmd.algorithm = algorithm;
+	float diff = -1;
+	if (ccv_nnc_cmd_exec(back_cmd, hint, 0, TENSOR_LIST(g, a, w), TENSOR_LIST(oh, ogw, ogbias), 0) == CCV_NNC_EXEC_SUCCESS)
+	{
+		diff = 0;
+		for (i = 0; i < ah * aw * ch; i++)
+			diff = ccv_max(diff, fabsf(h->data.f32[i] - oh->data.f32[i]));
+		for (i = 0; i < count * kh * kw * ch; i++)
+			diff = ccv_max(diff, fabsf(gw->data.f32[i] - ogw->data.f32[i]));
+		for (i = 0; i < count; i++)
+			diff = ccv_max(diff, fabsf(gbias->data.f32[i] - ogbias->data.f32[i]));
+	}
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(g);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(h);
+	ccv_nnc_tensor_free(gw);
+	ccv_nnc_tensor_free(gbias);
+	ccv_nnc_tensor_free(oh);
+	ccv_nnc_tensor_free(ogw);
+	ccv_nnc_tensor_free(ogbias);
+	return diff;
+}
+
+TEST_CASE("optimized convolution backward of 3x3 on 28x28 matches reference")
+{
+	const ccv_nnc_hint_t hint = HINT((1, 1), (1, 1));
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(28, 28, 16, 32, 3, 3, hint, -1)) < 1e-4, "should match the reference implementation");
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(28, 28, 16, 32, 3, 3, hint, 0)) < 1e-4, "should match the reference implementation"); // CCV_NNC_CMD_OPT_CONV_ALGO_DC
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(28, 28, 16, 32, 3, 3, hint, 2)) < 1e-4, "should match the reference implementation"); // CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(28, 28, 16, 32, 3, 3, hint, 3)) < 1e-4, "should match the reference implementation"); // CCV_NNC_CMD_OPT_CONV_ALGO_FFT
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(27, 25, 3, 8, 3, 3, hint, 0)) < 1e-4, "should match the reference implementation");
+}
+
+TEST_CASE("optimized convolution backward with strides and large kernels matches reference")
+{
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(27, 31, 12, 16, 5, 5, HINT((2, 2), (2, 2)), -1)) < 1e-4, "should match the reference implementation");
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(27, 31, 3, 8, 5, 3, HINT((2, 3), (1, 1)), 0)) < 1e-4, "should match the reference implementation");
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(21, 21, 8, 16, 7, 7, HINT((1, 1), (3, 3)), 3)) < 1e-4, "should match the reference implementation"); // CCV_NNC_CMD_OPT_CONV_ALGO_FFT
+}
+
+TEST_CASE("optimized convolution backward of 1x1 matches reference")
+{
+#if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(14, 14, 32, 24, 1, 1, HINT((1, 1), (0, 0)), 1)) < 1e-4, "should match the reference implementation"); // CCV_NNC_CMD_OPT_CONV_ALGO_GEMM
+#endif
+	// Picks GEMM when BLAS is available, otherwise falls back to the direct path.
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(14, 14, 32, 24, 1, 1, HINT((1, 1), (0, 0)), -1)) < 1e-4, "should match the reference implementation");
+	REQUIRE(fabsf(_convolution_backward_opt_vs_ref(14, 14, 30, 24, 1, 1, HINT((1, 1), (0, 0)), 0)) < 1e-4, "should match the reference implementation");
+}
+
 TEST_CASE("full connect back propagation")
 {
 	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(5), 0);
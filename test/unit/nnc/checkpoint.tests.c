@@ -0,0 +1,174 @@
+#include "case.h"
+#include "ccv_case.h"
+#include "ccv_nnc_case.h"
+#include <ccv.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include "3rdparty/dsfmt/dSFMT.h"
+
+TEST_SETUP()
+{
+	ccv_nnc_init();
+}
+
+#define LAYERS (16)
+
+static ccv_nnc_symbolic_graph_t* _mlp_graph(ccv_nnc_tensor_symbol_t* const x, ccv_nnc_tensor_symbol_t* const w, ccv_nnc_tensor_symbol_t* const bias, ccv_nnc_tensor_symbol_t* const s, ccv_nnc_graph_exec_symbol_t* const source, ccv_nnc_graph_exec_symbol_t* const destination)
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	*x = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32, 128), "x");
+	ccv_nnc_tensor_symbol_t h = *x;
+	int i;
+	for (i = 0; i < LAYERS; i++)
+	{
+		w[i] = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(128, 128), "w");
+		bias[i] = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(128), "bias");
+		const ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32, 128), "y");
+		const ccv_nnc_graph_exec_symbol_t gemm = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(128), TENSOR_SYMBOL_LIST(h, w[i], bias[i]), TENSOR_SYMBOL_LIST(y), "gemm");
+		if (i == 0)
+			*source = gemm;
+		h = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NHWC(32, 128), "h");
+		ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(y), TENSOR_SYMBOL_LIST(h), "relu");
+	}
+	*s = ccv_nnc_tensor_symbol_new(symbolic_graph, ccv_nnc_tensor_auto, "s");
+	*destination = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_REDUCE_SUM_FORWARD(0, 1), TENSOR_SYMBOL_LIST(h), TENSOR_SYMBOL_LIST(*s), "sum");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	return symbolic_graph;
+}
+
+// Count the blocks alive at the same time that overlap in memory.
+static int _overlapped_blocks(const ccv_nnc_tensor_arena_report_t* const report)
+{
+	int i, j, overlapped = 0;
+	for (i = 0; i < report->block_size; i++)
+		for (j = i + 1; j < report->block_size; j++)
+			if (report->blocks[i].buffer == report->blocks[j].buffer &&
+				report->blocks[i].head <= report->blocks[j].tail && report->blocks[j].head <= report->blocks[i].tail &&
+				report->blocks[i].offset < report->blocks[j].offset + report->blocks[j].size &&
+				report->blocks[j].offset < report->blocks[i].offset + report->blocks[i].size)
+				++overlapped;
+	return overlapped;
+}
+
+static void _mlp_run(const int checkpoint, const int compile_flags, ccv_nnc_tensor_t* const dw, ccv_nnc_tensor_arena_report_t* const report, int* const overlapped)
+{
+	ccv_nnc_tensor_symbol_t x, w[LAYERS], bias[LAYERS], s;
+	ccv_nnc_graph_exec_symbol_t source, destination;
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = _mlp_graph(&x, w, bias, &s, &source, &destination);
+	ccv_nnc_symbolic_graph_backward(symbolic_graph, TENSOR_SYMBOL_LIST(s), TENSOR_SYMBOL_LIST(w[0]), GRAPH_EXEC_SYMBOL_LIST(source), GRAPH_EXEC_SYMBOL_LIST(destination));
+	const ccv_nnc_tensor_symbol_t dw0 = ccv_nnc_tensor_symbol_for_backward(symbolic_graph, w[0]);
+	const ccv_nnc_graph_exec_symbol_t dw0_exec = ccv_nnc_graph_exec_symbol_for_backward(symbolic_graph, dw0);
+	const ccv_nnc_tensor_symbol_t ds = ccv_nnc_tensor_symbol_for_backward(symbolic_graph, s);
+	if (checkpoint)
+		ccv_nnc_symbolic_graph_checkpoint(symbolic_graph, 0, GRAPH_EXEC_SYMBOL_LIST(source), GRAPH_EXEC_SYMBOL_LIST(destination));
+	ccv_nnc_symbolic_graph_set_compile_flags(symbolic_graph, compile_flags);
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, 0, 0, TENSOR_SYMBOL_LIST(dw0), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), GRAPH_EXEC_SYMBOL_LIST(dw0_exec), &graph, &tensor_arena, &graph_exec_arena);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i, j;
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	for (i = 0; i < 32 * 128; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < LAYERS; i++)
+	{
+		ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, w[i]);
+		for (j = 0; j < 128 * 128; j++)
+			w_tensor->data.f32[j] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) * 0.15;
+		ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, bias[i]);
+		for (j = 0; j < 128; j++)
+			bias_tensor->data.f32[j] = 0.01;
+	}
+	ccv_nnc_tensor_from_symbol(tensor_arena, ds)->data.f32[0] = 1;
+	ccv_nnc_graph_run(graph, 0, 0, TRAVERSE_FULL);
+	memcpy(dw->data.f32, ccv_nnc_tensor_from_symbol(tensor_arena, dw0)->data.f32, sizeof(float) * 128 * 128);
+	*report = ccv_nnc_tensor_arena_report(tensor_arena);
+	*overlapped = _overlapped_blocks(report);
+	report->blocks = 0; // Freed with the arena.
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+TEST_CASE("report the memory layout of a tensor arena")
+{
+	ccv_nnc_tensor_symbol_t x, w[LAYERS], bias[LAYERS], s;
+	ccv_nnc_graph_exec_symbol_t source, destination;
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = _mlp_graph(&x, w, bias, &s, &source, &destination);
+	ccv_nnc_graph_t* graph;
+	ccv_nnc_tensor_arena_t* tensor_arena;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, 0, 0, 0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	const ccv_nnc_tensor_arena_report_t report = ccv_nnc_tensor_arena_report(tensor_arena);
+	REQUIRE_EQ(report.exec_size, LAYERS * 2 + 1, "every exec is counted");
+	REQUIRE(report.block_size > 0, "should have blocks");
+	REQUIRE(report.peak_size <= report.total_size, "cannot allocate less than the peak");
+	REQUIRE(report.total_size < report.unshared_size, "activations of the forward pass should share memory");
+	REQUIRE(report.fragmentation >= 0 && report.fragmentation < 1, "fragmentation is a ratio");
+	// The weights are alive all the time, plus the activations one exec reads and writes.
+	const uint64_t weight_size = sizeof(float) * LAYERS * (128 * 128 + 128);
+	const uint64_t activation_size = sizeof(float) * 32 * 128;
+	REQUIRE(report.peak_size >= weight_size + activation_size * 2 && report.peak_size <= weight_size + activation_size * 3, "peak should be the weights plus the activations one exec reads and writes");
+	int i;
+	for (i = 0; i < report.block_size; i++)
+	{
+		REQUIRE(report.blocks[i].head <= report.blocks[i].tail, "head should be before tail");
+		REQUIRE(report.blocks[i].tail < report.exec_size, "tail should be one of the execs");
+		REQUIRE(report.blocks[i].buffer >= 0 && report.blocks[i].buffer < report.buffer_size, "block should be in a buffer");
+	}
+	REQUIRE_EQ(_overlapped_blocks(&report), 0, "blocks alive at the same time should not overlap");
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+TEST_CASE("recompute activations to train in less memory")
+{
+	ccv_nnc_tensor_t* const dw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(128, 128), 0);
+	ccv_nnc_tensor_t* const checkpoint_dw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(128, 128), 0);
+	ccv_nnc_tensor_arena_report_t report, checkpoint_report;
+	int overlapped, checkpoint_overlapped;
+	// The default placement leaves gaps where the recomputed activations go, place them by size to close these.
+	_mlp_run(0, CCV_NNC_SYMBOLIC_GRAPH_COMPILE_BEST_FIT, dw, &report, &overlapped);
+	_mlp_run(1, CCV_NNC_SYMBOLIC_GRAPH_COMPILE_BEST_FIT, checkpoint_dw, &checkpoint_report, &checkpoint_overlapped);
+	REQUIRE_EQ(overlapped, 0, "blocks alive at the same time should not overlap");
+	REQUIRE_EQ(checkpoint_overlapped, 0, "blocks alive at the same time should not overlap");
+	REQUIRE(checkpoint_report.exec_size > report.exec_size, "should recompute some execs");
+	REQUIRE(checkpoint_report.peak_size < report.peak_size, "peak should be lower with checkpoints");
+	REQUIRE(checkpoint_report.total_size < report.total_size, "arena should be smaller with checkpoints");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, checkpoint_dw->data.f32, dw->data.f32, 128 * 128, 1e-5, "gradient should be the same");
+	ccv_nnc_tensor_free(dw);
+	ccv_nnc_tensor_free(checkpoint_dw);
+}
+
+TEST_CASE("compare the best fit placement with the default placement")
+{
+	ccv_nnc_tensor_t* const dw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(128, 128), 0);
+	ccv_nnc_tensor_t* const best_fit_dw = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(128, 128), 0);
+	ccv_nnc_tensor_arena_report_t report, best_fit_report;
+	int overlapped, best_fit_overlapped;
+	int checkpoint;
+	for (checkpoint = 0; checkpoint < 2; checkpoint++)
+	{
+		_mlp_run(checkpoint, 0, dw, &report, &overlapped);
+		_mlp_run(checkpoint, CCV_NNC_SYMBOLIC_GRAPH_COMPILE_BEST_FIT, best_fit_dw, &best_fit_report, &best_fit_overlapped);
+		REQUIRE_EQ(overlapped, 0, "blocks alive at the same time should not overlap");
+		REQUIRE_EQ(best_fit_overlapped, 0, "blocks alive at the same time should not overlap with best fit");
+		REQUIRE_EQ(best_fit_report.block_size, report.block_size, "both should place the same blocks");
+		REQUIRE_EQ(best_fit_report.peak_size, report.peak_size, "the placement doesn't change the peak");
+		REQUIRE(best_fit_report.total_size <= report.total_size, "best fit is only kept if it needs less memory");
+		REQUIRE(best_fit_report.peak_size <= best_fit_report.total_size, "cannot allocate less than the peak");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, best_fit_dw->data.f32, dw->data.f32, 128 * 128, 1e-5, "gradient should be the same");
+	}
+	// The recomputed activations leave gaps in the default placement.
+	REQUIRE(best_fit_report.total_size < report.total_size, "best fit should need less memory with checkpoints");
+	REQUIRE_EQ(best_fit_report.buffer_size, 1, "best fit puts all blocks in one buffer");
+	ccv_nnc_tensor_free(dw);
+	ccv_nnc_tensor_free(best_fit_dw);
+}
+
+#include "case_main.h"
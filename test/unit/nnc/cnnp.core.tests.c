@@ -4,6 +4,7 @@
 #include <ccv.h>
 #include <nnc/ccv_nnc.h>
 #include <nnc/ccv_nnc_easy.h>
+#include "3rdparty/dsfmt/dSFMT.h"
 
 TEST_SETUP()
 {
@@ -40,7 +41,7 @@ TEST_CASE("compile simple cifar-10 model")
 		})
 	));
 	const ccv_nnc_tensor_param_t input = GPU_TENSOR_NCHW(000, 128, 3, 31, 31);
-	ccv_cnnp_model_compile(sequential, &input, 1);
+	ccv_cnnp_model_compile(sequential, &input, 1, CMD_SGD_FORWARD(0.001, 0.995, 0.9, 0.9), CMD_CATEGORICAL_CROSSENTROPY_FORWARD());
 	ccv_cnnp_model_free(sequential);
 }
 
@@ -77,8 +78,56 @@ TEST_CASE("inception layer for model")
 
 	ccv_cnnp_model_t* inception = ccv_cnnp_model_new(MODEL_IO_LIST(x), MODEL_IO_LIST(output));
 	const ccv_nnc_tensor_param_t input = GPU_TENSOR_NCHW(000, 1, 3, 256, 256);
-	ccv_cnnp_model_compile(inception, &input, 1);
+	ccv_cnnp_model_compile(inception, &input, 1, CMD_SGD_FORWARD(0.001, 0.995, 0.9, 0.9), CMD_CATEGORICAL_CROSSENTROPY_FORWARD());
 	ccv_cnnp_model_free(inception);
 }
 
+TEST_CASE("fit a dense model on a minibatch split into 4 threads")
+{
+	ccv_cnnp_model_t* const sequential = ccv_cnnp_sequential_new(MODEL_LIST(
+		ccv_cnnp_dense(8, (ccv_cnnp_param_t){
+			.activation = CCV_CNNP_ACTIVATION_RELU,
+		}),
+		ccv_cnnp_dense(2, (ccv_cnnp_param_t){
+			.activation = CCV_CNNP_ACTIVATION_SOFTMAX,
+		})
+	));
+	ccv_cnnp_model_set_parallel(sequential, 4);
+	const ccv_nnc_tensor_param_t input = CPU_TENSOR_NHWC(64, 2);
+	ccv_cnnp_model_compile(sequential, &input, 1, CMD_SGD_FORWARD(0.1, 0, 0.9, 0.9), CMD_CATEGORICAL_CROSSENTROPY_FORWARD());
+	ccv_nnc_tensor_t* const x = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(64, 2), 0);
+	ccv_nnc_tensor_t* const y = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(64, 2), 0);
+	ccv_nnc_tensor_t* const z = ccv_nnc_tensor_new(0, CPU_TENSOR_NHWC(64, 2), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i, j;
+	int correct = 0;
+	for (i = 0; i < 500; i++)
+	{
+		// Points inside the circle of radius 0.5 is one class, the ones outside are the other.
+		for (j = 0; j < 64; j++)
+		{
+			const float px = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+			const float py = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+			x->data.f32[j * 2] = px;
+			x->data.f32[j * 2 + 1] = py;
+			const int inside = (px * px + py * py < 0.25);
+			y->data.f32[j * 2] = inside;
+			y->data.f32[j * 2 + 1] = !inside;
+		}
+		if (i == 400)
+			ccv_cnnp_model_set_minimizer(sequential, CMD_SGD_FORWARD(0.01, 0, 0.9, 0.9));
+		ccv_cnnp_model_fit(sequential, TENSOR_LIST(x), TENSOR_LIST(y), TENSOR_LIST(z));
+		// Count how many are correct in the last 20 minibatches.
+		if (i >= 480)
+			for (j = 0; j < 64; j++)
+				correct += ((z->data.f32[j * 2] > z->data.f32[j * 2 + 1]) == (y->data.f32[j * 2] > 0.5));
+	}
+	REQUIRE(correct > 20 * 64 * 0.9, "should classify at least 90%% of the points correctly, got %d of %d", correct, 20 * 64);
+	ccv_nnc_tensor_free(x);
+	ccv_nnc_tensor_free(y);
+	ccv_nnc_tensor_free(z);
+	ccv_cnnp_model_free(sequential);
+}
+
 #include "case_main.h"
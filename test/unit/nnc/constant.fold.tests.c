@@ -0,0 +1,176 @@
+#include "case.h"
+#include "ccv_case.h"
+#include "ccv_nnc_case.h"
+#include <ccv.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include "3rdparty/dsfmt/dSFMT.h"
+
+TEST_SETUP()
+{
+	ccv_nnc_init();
+}
+
+TEST_CASE("fold execs that only read constants")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 16), "x");
+	ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 16), "w");
+	ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10), "bias");
+	// The bias is bound but not marked as constant, it can change between runs.
+	ccv_nnc_tensor_symbol_set_flags(symbolic_graph, w, CCV_NNC_TENSOR_SYMBOL_CONSTANT);
+	ccv_nnc_tensor_symbol_t w1 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 16), "w1");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(w), TENSOR_SYMBOL_LIST(w1), "exp");
+	ccv_nnc_tensor_symbol_t w2 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 16), "w2");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SCALAR_MUL_FORWARD(0.5), TENSOR_SYMBOL_LIST(w1), TENSOR_SYMBOL_LIST(w2), "scale");
+	ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 10), "z");
+	ccv_nnc_graph_exec_symbol_t gemm = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(10), TENSOR_SYMBOL_LIST(x, w2, bias), TENSOR_SYMBOL_LIST(z), "gemm");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(10, 16), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(10), 0);
+	int i;
+	for (i = 0; i < 10 * 16; i++)
+		w_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 10; i++)
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_tensor_bind_t* folded_binds = 0;
+	int folded_bind_size = 0;
+	ccv_nnc_symbolic_graph_constant_fold(symbolic_graph, TENSOR_BIND_MAP(KV(w, w_tensor), KV(bias, bias_tensor)), TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &folded_binds, &folded_bind_size);
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	REQUIRE_EQ(folded_bind_size, 1, "only w2 is read by the rest of the graph");
+	REQUIRE_EQ(folded_binds[0].symbol.d, w2.d, "only w2 is read by the rest of the graph");
+	REQUIRE(ccv_nnc_tensor_symbol_flags(symbolic_graph, w2) & CCV_NNC_TENSOR_SYMBOL_CONSTANT, "w2 should be a constant now");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 1, "gemm should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_sources(symbolic_graph)[0].d, gemm.d, "gemm should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_destination_size(symbolic_graph), 1, "gemm should be the only destination");
+	for (i = 0; i < 10 * 16; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(folded_binds[0].tensor->data.f32[i], expf(w_tensor->data.f32[i]) * 0.5, 1e-5, "w2 should be computed");
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, TENSOR_BIND_MAP(KV(w, w_tensor), KV(bias, bias_tensor), KV(w2, folded_binds[0].tensor)), TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	GRAPH_GEN(graph, CCV_NNC_LONG_DOT_GRAPH);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	for (i = 0; i < 2 * 16; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_graph_run(graph, 0, 0, 0, 0, 0, 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	int j, k;
+	for (i = 0; i < 2; i++)
+		for (j = 0; j < 10; j++)
+		{
+			float v = bias_tensor->data.f32[j];
+			for (k = 0; k < 16; k++)
+				v += x_tensor->data.f32[i * 16 + k] * expf(w_tensor->data.f32[j * 16 + k]) * 0.5;
+			REQUIRE_EQ_WITH_TOLERANCE(z_tensor->data.f32[i * 10 + j], v, 1e-4, "result should be equal");
+		}
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	ccv_nnc_tensor_free((ccv_nnc_tensor_t*)folded_binds[0].tensor);
+	ccfree(folded_binds);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+}
+
+TEST_CASE("dropout on a constant input is not folded")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 16), "w");
+	ccv_nnc_tensor_symbol_set_flags(symbolic_graph, w, CCV_NNC_TENSOR_SYMBOL_CONSTANT);
+	ccv_nnc_tensor_symbol_t w1 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 16), "w1");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(w), TENSOR_SYMBOL_LIST(w1), "exp");
+	ccv_nnc_tensor_symbol_t w2 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 16), "w2");
+	const ccv_nnc_tensor_param_t w1_params = ONE_CPU_TENSOR(10, 16);
+	ccv_nnc_tensor_param_t output_params[2];
+	ccv_nnc_hint_tensor_auto(CMD_DROPOUT_FORWARD(0.5), &w1_params, 1, ccv_nnc_no_hint, output_params, 2);
+	ccv_nnc_tensor_symbol_t mask = ccv_nnc_tensor_symbol_new(symbolic_graph, output_params[1], "mask");
+	ccv_nnc_graph_exec_symbol_t dropout = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_DROPOUT_FORWARD(0.5), TENSOR_SYMBOL_LIST(w1), TENSOR_SYMBOL_LIST(w2, mask), "dropout");
+	ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 16), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SCALAR_MUL_FORWARD(0.5), TENSOR_SYMBOL_LIST(w2), TENSOR_SYMBOL_LIST(z), "scale");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(10, 16), 0);
+	ccv_nnc_cmd_exec(CMD_RANDOM_UNIFORM_FORWARD(-1, 1), ccv_nnc_no_hint, 0, 0, 0, TENSOR_LIST(w_tensor), 0);
+	ccv_nnc_tensor_bind_t* folded_binds = 0;
+	int folded_bind_size = 0;
+	ccv_nnc_symbolic_graph_constant_fold(symbolic_graph, TENSOR_BIND_MAP(KV(w, w_tensor)), TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &folded_binds, &folded_bind_size);
+	REQUIRE_EQ(folded_bind_size, 1, "only exp is folded, dropout reads its output");
+	REQUIRE_EQ(folded_binds[0].symbol.d, w1.d, "only exp is folded, dropout reads its output");
+	REQUIRE(!(ccv_nnc_tensor_symbol_flags(symbolic_graph, w2) & CCV_NNC_TENSOR_SYMBOL_CONSTANT), "the dropout output should not be a constant");
+	REQUIRE(!(ccv_nnc_tensor_symbol_flags(symbolic_graph, z) & CCV_NNC_TENSOR_SYMBOL_CONSTANT), "what reads the dropout output should not be a constant");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 1, "dropout should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_sources(symbolic_graph)[0].d, dropout.d, "dropout should be the only source");
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_tensor_free((ccv_nnc_tensor_t*)folded_binds[0].tensor);
+	ccfree(folded_binds);
+	ccv_nnc_tensor_free(w_tensor);
+}
+
+TEST_CASE("fold the weight quantization of a quantized convolution")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t a = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(15, 11, 8), "a");
+	ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(16, 3, 3, 8), "w");
+	ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(16), "bias");
+	// The quantize pass flags the weight as constant, the bias is read by the convolution as is.
+	ccv_nnc_tensor_symbol_set_flags(symbolic_graph, bias, CCV_NNC_TENSOR_SYMBOL_CONSTANT);
+	ccv_nnc_tensor_symbol_t b = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(15, 11, 16), "b");
+	ccv_nnc_graph_exec_symbol_t conv = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_CONVOLUTION_FORWARD(1, 16, 3, 3, 8), TENSOR_SYMBOL_LIST(a, w, bias), TENSOR_SYMBOL_LIST(b), "conv");
+	ccv_nnc_graph_exec_symbol_set_hint(symbolic_graph, conv, HINT((1, 1), (1, 1)));
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_quantize(symbolic_graph, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 2, "both the activation and the weight are quantized");
+	REQUIRE(ccv_nnc_tensor_symbol_flags(symbolic_graph, w) & CCV_NNC_TENSOR_SYMBOL_CONSTANT, "the weight should be flagged as constant");
+	REQUIRE(!(ccv_nnc_tensor_symbol_flags(symbolic_graph, a) & CCV_NNC_TENSOR_SYMBOL_CONSTANT), "the activation is not a constant");
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16, 3, 3, 8), 0);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i;
+	for (i = 0; i < 16 * 3 * 3 * 8; i++)
+		w_tensor->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) / (3 * 3 * 8);
+	for (i = 0; i < 16; i++)
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_tensor_bind_t* folded_binds = 0;
+	int folded_bind_size = 0;
+	ccv_nnc_symbolic_graph_constant_fold(symbolic_graph, TENSOR_BIND_MAP(KV(w, w_tensor), KV(bias, bias_tensor)), TENSOR_SYMBOL_LIST(b), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &folded_binds, &folded_bind_size);
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	REQUIRE_EQ(folded_bind_size, 2, "the quantized weight and its quantization parameters are folded");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 1, "only the activation is quantized when the graph runs");
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, ccv_nnc_symbolic_graph_sources(symbolic_graph)[0]).cmd, CCV_NNC_QUANTIZE_FORWARD, "only the activation is quantized when the graph runs");
+	ccv_nnc_tensor_bind_t tensor_binds[4] = {
+		{ .symbol = w, .tensor = w_tensor },
+		{ .symbol = bias, .tensor = bias_tensor },
+		folded_binds[0],
+		folded_binds[1],
+	};
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, tensor_binds, 4, TENSOR_SYMBOL_LIST(b), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	GRAPH_GEN(graph, CCV_NNC_LONG_DOT_GRAPH);
+	ccv_nnc_tensor_t* const a_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, a);
+	for (i = 0; i < 15 * 11 * 8; i++)
+		a_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	// Compute the convolution in float before running the graph, the memory of a can be reused by the graph.
+	ccv_nnc_tensor_t* const b_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(15, 11, 16), 0);
+	ccv_nnc_cmd_exec(CMD_CONVOLUTION_FORWARD(1, 16, 3, 3, 8), HINT((1, 1), (1, 1)), 0, TENSOR_LIST(a_tensor, w_tensor, bias_tensor), TENSOR_LIST(b_tensor), 0);
+	ccv_nnc_graph_run(graph, 0, 0, 0, 0, 0, 0);
+	ccv_nnc_tensor_t* const qb_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, b);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b_tensor->data.f32, qb_tensor->data.f32, 15 * 11 * 16, 1e-2, "int8 convolution with folded weights should be close to the float one");
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+	for (i = 0; i < folded_bind_size; i++)
+		ccv_nnc_tensor_free((ccv_nnc_tensor_t*)folded_binds[i].tensor);
+	ccfree(folded_binds);
+	ccv_nnc_tensor_free(w_tensor);
+	ccv_nnc_tensor_free(bias_tensor);
+	ccv_nnc_tensor_free(b_tensor);
+}
+
+#include "case_main.h"
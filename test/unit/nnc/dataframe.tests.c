@@ -0,0 +1,123 @@
+#include "case.h"
+#include "ccv_case.h"
+#include "ccv_nnc_case.h"
+#include <ccv.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+
+TEST_SETUP()
+{
+	ccv_nnc_init();
+}
+
+static void _ccv_iter_int_double(void*** const column_data, const int column_size, const int batch_size, void** const data, void* const context)
+{
+	int i;
+	for (i = 0; i < batch_size; i++)
+	{
+		if (!data[i])
+			data[i] = ccmalloc(sizeof(int));
+		*(int*)data[i] = *(int*)column_data[0][i] * 2;
+	}
+}
+
+static void _ccv_iter_int_free(void* const data, void* const context)
+{
+	ccfree(data);
+}
+
+TEST_CASE("iterate through a dataframe with derived column")
+{
+	ccv_array_t* const array = ccv_array_new(sizeof(int), 8, 0);
+	int i;
+	for (i = 0; i < 8; i++)
+		ccv_array_push(array, &i);
+	ccv_cnnp_dataframe_t* const dataframe = ccv_cnnp_dataframe_from_array_new(array);
+	const int derived = ccv_cnnp_dataframe_map(dataframe, _ccv_iter_int_double, _ccv_iter_int_free, COLUMN_ID_LIST(0), 0, 0);
+	REQUIRE_EQ(derived, 1, "derived column should be the second one");
+	REQUIRE_EQ(ccv_cnnp_dataframe_row_count(dataframe), 8, "should have 8 rows");
+	ccv_cnnp_dataframe_iter_t* const iter = ccv_cnnp_dataframe_iter_new(dataframe, COLUMN_ID_LIST(0, derived));
+	void* data[2];
+	int result[8];
+	int expected[8];
+	for (i = 0; i < 8; i++)
+	{
+		REQUIRE_EQ(ccv_cnnp_dataframe_iter_next(iter, data, 2), 0, "should have the next row");
+		REQUIRE_EQ(*(int*)data[1], *(int*)data[0] * 2, "derived column should match");
+		result[i] = *(int*)data[1];
+		expected[i] = i * 2;
+	}
+	REQUIRE_ARRAY_EQ(int, result, expected, 8, "should iterate in order");
+	REQUIRE_EQ(ccv_cnnp_dataframe_iter_next(iter, data, 2), -1, "should reach the end");
+	ccv_cnnp_dataframe_shuffle(dataframe);
+	ccv_cnnp_dataframe_iter_set_cursor(iter, 0);
+	int seen[8] = {0};
+	for (i = 0; i < 8; i++)
+	{
+		REQUIRE_EQ(ccv_cnnp_dataframe_iter_next(iter, data, 1), 0, "should have the next row after shuffle");
+		++seen[*(int*)data[0]];
+	}
+	int ones[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+	REQUIRE_ARRAY_EQ(int, seen, ones, 8, "shuffled rows should be a permutation");
+	ccv_cnnp_dataframe_iter_free(iter);
+	ccv_cnnp_dataframe_free(dataframe);
+	ccv_array_free(array);
+}
+
+static void _ccv_iter_tensor_enum(const int column_idx, const int* const row_idxs, const int row_size, void** const data, void* const context)
+{
+	int i, j;
+	for (i = 0; i < row_size; i++)
+	{
+		if (!data[i])
+			data[i] = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(2, 3), 0);
+		ccv_nnc_tensor_t* const tensor = (ccv_nnc_tensor_t*)data[i];
+		for (j = 0; j < 6; j++)
+			tensor->data.f32[j] = row_idxs[i] * 10 + j;
+	}
+}
+
+static void _ccv_iter_tensor_free(void* const data, void* const context)
+{
+	ccv_nnc_tensor_free((ccv_nnc_tensor_t*)data);
+}
+
+TEST_CASE("batching tensors with prefetch")
+{
+	const ccv_cnnp_column_data_t column_data = {
+		.data_enum = _ccv_iter_tensor_enum,
+		.data_deinit = _ccv_iter_tensor_free,
+	};
+	ccv_cnnp_dataframe_t* const dataframe = ccv_cnnp_dataframe_new(&column_data, 1, 35);
+	ccv_cnnp_dataframe_t* const batch = ccv_cnnp_dataframe_batching_new(dataframe, COLUMN_ID_LIST(0), 4);
+	REQUIRE_EQ(ccv_cnnp_dataframe_row_count(batch), 8, "the last 3 rows are dropped");
+	ccv_cnnp_dataframe_iter_t* const iter = ccv_cnnp_dataframe_iter_new(batch, COLUMN_ID_LIST(0));
+	ccv_cnnp_dataframe_iter_prefetch(iter, 3, 2);
+	int i, j, k;
+	float expected[4 * 6];
+	int epoch;
+	for (epoch = 0; epoch < 2; epoch++)
+	{
+		for (i = 0; i < 8; i++)
+		{
+			void* data;
+			REQUIRE_EQ(ccv_cnnp_dataframe_iter_next(iter, &data, 1), 0, "should have the next batch");
+			ccv_nnc_tensor_t* const tensor = ((ccv_nnc_tensor_t**)data)[0];
+			REQUIRE_EQ(tensor->info.dim[0], 4, "batch dimension");
+			REQUIRE_EQ(tensor->info.dim[1], 2, "first dimension");
+			REQUIRE_EQ(tensor->info.dim[2], 3, "second dimension");
+			for (j = 0; j < 4; j++)
+				for (k = 0; k < 6; k++)
+					expected[j * 6 + k] = (i * 4 + j) * 10 + k;
+			REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, tensor->data.f32, expected, 4 * 6, 1e-5, "batch should be filled in order");
+		}
+		void* data;
+		REQUIRE_EQ(ccv_cnnp_dataframe_iter_next(iter, &data, 1), -1, "should reach the end");
+		ccv_cnnp_dataframe_iter_set_cursor(iter, 0);
+	}
+	ccv_cnnp_dataframe_iter_free(iter);
+	ccv_cnnp_dataframe_free(batch);
+	ccv_cnnp_dataframe_free(dataframe);
+}
+
+#include "case_main.h"
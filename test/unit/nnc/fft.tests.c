@@ -0,0 +1,225 @@
+#include "case.h"
+#include "ccv_case.h"
+#include "ccv_nnc_case.h"
+#include <ccv.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include <3rdparty/dsfmt/dSFMT.h>
+
+TEST_SETUP()
+{
+	ccv_nnc_init();
+}
+
+TEST_CASE("convolutional network of 7x7 on 56x56 with fft")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(56, 56, 32), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(56, 56, 64), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 64, 7, 7, 32);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(64, 7, 7, 32), 0);
+	ccv_nnc_tensor_t* bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(64), 0);
+	// configure the inlets.
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i;
+	for (i = 0; i < 64 * 7 * 7 * 32; i++)
+		w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) / (7 * 7 * 32);
+	for (i = 0; i < 56 * 56 * 32; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	for (i = 0; i < 64; i++)
+		bias->data.f32[i] = (float)i / 64;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(56, 56, 64), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.algorithm = 3; // CCV_NNC_CMD_OPT_CONV_ALGO_FFT
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(c), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, c->data.f32, 56 * 56 * 64, 1e-4, "56x56 matrix should be the same from reference implementation and fft.");
+	// Run again with the cached kernel transform.
+	ccv_nnc_tensor_t* d = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(56, 56, 64), 0);
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(d), 0);
+	REQUIRE_TENSOR_EQ(c, d, "fft with cached kernel should be exactly the same.");
+	ccv_nnc_tensor_free(d);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(a);
+}
+
+TEST_CASE("convolutional network of 11x11 on 55x61 with fft and no bias")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(55, 61, 3), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(55, 61, 8), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 8, 11, 11, 3);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 11, 11, 3), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i;
+	for (i = 0; i < 8 * 11 * 11 * 3; i++)
+		w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) / (11 * 11 * 3);
+	for (i = 0; i < 55 * 61 * 3; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(55, 61, 8), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.algorithm = 3; // CCV_NNC_CMD_OPT_CONV_ALGO_FFT
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(c), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, c->data.f32, 55 * 61 * 8, 1e-4, "55x61 matrix should be the same from reference implementation and fft.");
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(a);
+}
+
+TEST_CASE("fft convolution follows weights written by commands")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 4), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 8), 0);
+	ccv_nnc_tensor_t* c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 8), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 8, 5, 5, 4);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* w0 = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 5, 5, 4), 0);
+	ccv_nnc_tensor_t* w1 = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 5, 5, 4), 0);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 5, 5, 4), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 2);
+	int i, j;
+	for (i = 0; i < 8 * 5 * 5 * 4; i++)
+		w0->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) / (5 * 5 * 4);
+	for (i = 0; i < 8 * 5 * 5 * 4; i++)
+		w1->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) / (5 * 5 * 4);
+	for (i = 0; i < 31 * 29 * 4; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	ccv_nnc_tensor_t* const ws[] = { w0, w1, w0 };
+	for (j = 0; j < 3; j++)
+	{
+		// Update the weights in place, the cached transform has to follow.
+		ccv_nnc_cmd_exec(CMD_DATA_TRANSFER_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(ws[j]), TENSOR_LIST(w), 0);
+		cmd.backend = CCV_NNC_NO_BACKEND;
+		cmd.algorithm = 0;
+		ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, ws[j]), TENSOR_LIST(b), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		cmd.algorithm = 3; // CCV_NNC_CMD_OPT_CONV_ALGO_FFT
+		ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(c), 0);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, c->data.f32, 31 * 29 * 8, 1e-4, "fft with updated weights should match the reference implementation.");
+	}
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(w1);
+	ccv_nnc_tensor_free(w0);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(a);
+}
+
+TEST_CASE("fft convolution sees weights overwritten outside of commands")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 3), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 16), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 16, 5, 5, 3);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.algorithm = -1; // Stride 1, 5x5 and 16 output channels, the backend picks FFT.
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16, 5, 5, 3), 0);
+	ccv_nnc_cmd_exec(CMD_RANDOM_UNIFORM_FORWARD(-1, 1), ccv_nnc_no_hint, 0, 0, 0, TENSOR_LIST(a), 0);
+	ccv_nnc_cmd_exec(CMD_RANDOM_UNIFORM_FORWARD(-1, 1), ccv_nnc_no_hint, 0, 0, 0, TENSOR_LIST(w), 0);
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(b), 0);
+	int i;
+	float sum = 0;
+	for (i = 0; i < 31 * 29 * 16; i++)
+		sum += b->data.f32[i] * b->data.f32[i];
+	REQUIRE(sum > 0, "the convolution should produce something with random weights");
+	ccv_nnc_tensor_zero(w);
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(b), 0);
+	sum = 0;
+	for (i = 0; i < 31 * 29 * 16; i++)
+		sum += b->data.f32[i] * b->data.f32[i];
+	REQUIRE_EQ_WITH_TOLERANCE(sum, 0, 1e-6, "the convolution should produce zeros once the weights are zeroed");
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(a);
+}
+
+TEST_CASE("fft kernel cache of constant weights is dropped on invalidation")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 3), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 16), 0);
+	ccv_nnc_tensor_t* c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 16), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 16, 5, 5, 3);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16, 5, 5, 3), 0);
+	w->type |= CCV_TENSOR_CONSTANT;
+	int i, j;
+	for (j = 0; j < 2; j++)
+	{
+		// Overwrite the weights directly, then let the kernels know.
+		ccv_nnc_cmd_exec(CMD_RANDOM_UNIFORM_FORWARD(-1, 1), ccv_nnc_no_hint, 0, 0, 0, TENSOR_LIST(a), 0);
+		dsfmt_t dsfmt;
+		dsfmt_init_gen_rand(&dsfmt, j);
+		for (i = 0; i < 16 * 5 * 5 * 3; i++)
+			w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+		ccv_nnc_tensor_constant_invalidate();
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		cmd.algorithm = 0;
+		ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(b), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		cmd.algorithm = 3; // CCV_NNC_CMD_OPT_CONV_ALGO_FFT
+		ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(c), 0);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, c->data.f32, 31 * 29 * 16, 1e-4, "fft with constant weights should match the reference implementation.");
+		// The second run reads the cached transform.
+		ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(c), 0);
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, c->data.f32, 31 * 29 * 16, 1e-4, "fft with cached constant weights should match the reference implementation.");
+	}
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(a);
+}
+
+TEST_CASE("fft convolution with half precision weights rewritten in place")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 3), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 16), 0);
+	ccv_nnc_tensor_t* c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 16), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 16, 5, 5, 3);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16, 5, 5, 3), 0);
+	ccv_nnc_tensor_param_t w16_params = ONE_CPU_TENSOR(16, 5, 5, 3);
+	w16_params.datatype = CCV_16F;
+	ccv_nnc_tensor_t* w16 = ccv_nnc_tensor_new(0, w16_params, 0);
+	ccv_nnc_cmd_exec(CMD_RANDOM_UNIFORM_FORWARD(-1, 1), ccv_nnc_no_hint, 0, 0, 0, TENSOR_LIST(a), 0);
+	int i, j;
+	for (j = 0; j < 4; j++)
+	{
+		// The last two rounds flag the weights as constant and invalidate after the rewrite.
+		if (j == 2)
+			w16->type |= CCV_TENSOR_CONSTANT;
+		dsfmt_t dsfmt;
+		dsfmt_init_gen_rand(&dsfmt, j);
+		for (i = 0; i < 16 * 5 * 5 * 3; i++)
+			w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+		ccv_float_to_half_precision(w->data.f32, w16->data.f16, 16 * 5 * 5 * 3);
+		ccv_half_precision_to_float(w16->data.f16, w->data.f32, 16 * 5 * 5 * 3);
+		if (j >= 2)
+			ccv_nnc_tensor_constant_invalidate();
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		cmd.algorithm = 0;
+		ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(b), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		cmd.algorithm = -1;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w16), TENSOR_LIST(c), 0), CCV_NNC_EXEC_SUCCESS, "should run with half precision weights");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, c->data.f32, 31 * 29 * 16, 1e-4, "fft with rewritten half precision weights should match the reference implementation.");
+		// Widened for the direct convolution, the widened copy has to follow the rewrite too.
+		cmd.algorithm = 0;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w16), TENSOR_LIST(c), 0), CCV_NNC_EXEC_SUCCESS, "should run with half precision weights");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, c->data.f32, 31 * 29 * 16, 1e-4, "direct convolution with rewritten half precision weights should match the reference implementation.");
+	}
+	ccv_nnc_tensor_free(w16);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(a);
+}
+
+#include "case_main.h"
@@ -331,6 +331,161 @@ TEST_CASE("convolution with no bias")
 	ccv_nnc_tensor_free(bias);
 }
 
+static float _convolution_nchw_vs_nhwc(const int ah, const int aw, const int ch, const int count, const int kh, const int kw, const int stride, const int algorithm)
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(ah, aw, ch), 0);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(count, kh, kw, ch), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(count), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, count, kh, kw, ch);
+	ccv_nnc_tensor_param_t b_info;
+	ccv_nnc_hint_t hint = HINT((stride, stride), (kh / 2, kw / 2));
+	ccv_nnc_hint_tensor_auto(cmd, TENSOR_PARAM_LIST(a->info, w->info), hint, &b_info, 1);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, b_info, 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i;
+	for (i = 0; i < ah * aw * ch; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	for (i = 0; i < count * kh * kw * ch; i++)
+		w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) / (kh * kw * ch);
+	for (i = 0; i < count; i++)
+		bias->data.f32[i] = (float)i / count;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const na = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(ch, ah, aw), 0);
+	ccv_nnc_tensor_t* const nw = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(count, ch, kh, kw), 0);
+	ccv_nnc_tensor_t* const nb = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(count, b_info.dim[0], b_info.dim[1]), 0);
+	ccv_nnc_tensor_t* const nbb = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(b_info.dim[0], b_info.dim[1], count), 0);
+	ccv_nnc_cmd_exec(CMD_FORMAT_TRANSFORM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(na, nw), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.algorithm = algorithm;
+	float diff = -1;
+	if (ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(na, nw, bias), TENSOR_LIST(nb), 0) == CCV_NNC_EXEC_SUCCESS)
+	{
+		ccv_nnc_cmd_exec(CMD_FORMAT_TRANSFORM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(nb), TENSOR_LIST(nbb), 0);
+		diff = 0;
+		for (i = 0; i < ccv_nnc_tensor_count(b->info); i++)
+			diff = ccv_max(diff, fabsf(b->data.f32[i] - nbb->data.f32[i]));
+	}
+	ccv_nnc_tensor_free(nbb);
+	ccv_nnc_tensor_free(nb);
+	ccv_nnc_tensor_free(nw);
+	ccv_nnc_tensor_free(na);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(a);
+	return diff;
+}
+
+TEST_CASE("convolution in NCHW with direct, gemm and winograd algorithms")
+{
+	// CCV_NNC_CMD_OPT_CONV_ALGO_DC
+	float diff = _convolution_nchw_vs_nhwc(27, 29, 5, 7, 3, 5, 1, 0);
+	REQUIRE(diff >= 0 && diff < 1e-5, "direct convolution in NCHW should match the reference, diff %f", diff);
+	diff = _convolution_nchw_vs_nhwc(31, 30, 4, 6, 5, 5, 2, 0);
+	REQUIRE(diff >= 0 && diff < 1e-5, "strided direct convolution in NCHW should match the reference, diff %f", diff);
+#if (defined HAVE_CBLAS || defined HAVE_ACCELERATE_FRAMEWORK)
+	// CCV_NNC_CMD_OPT_CONV_ALGO_GEMM
+	diff = _convolution_nchw_vs_nhwc(17, 19, 32, 16, 1, 1, 1, 1);
+	REQUIRE(diff >= 0 && diff < 1e-5, "1x1 convolution in NCHW should match the reference, diff %f", diff);
+#endif
+	// CCV_NNC_CMD_OPT_CONV_ALGO_WINOGRAD
+	diff = _convolution_nchw_vs_nhwc(55, 54, 16, 12, 3, 3, 1, 2);
+	REQUIRE(diff >= 0 && diff < 1e-4, "winograd convolution in NCHW should match the reference, diff %f", diff);
+	// Channels that are not a multiple of 4.
+	diff = _convolution_nchw_vs_nhwc(23, 21, 6, 7, 3, 3, 1, 2);
+	REQUIRE(diff >= 0 && diff < 1e-4, "winograd convolution in NCHW with odd channels should match the reference, diff %f", diff);
+	// CCV_NNC_CMD_OPT_CONV_ALGO_FFT has no NCHW kernel.
+	diff = _convolution_nchw_vs_nhwc(27, 27, 4, 4, 5, 5, 1, 3);
+	REQUIRE(diff < 0, "FFT convolution should reject NCHW tensors");
+	// Let the backend choose.
+	diff = _convolution_nchw_vs_nhwc(28, 28, 8, 8, 3, 3, 1, -1);
+	REQUIRE(diff >= 0 && diff < 1e-4, "convolution in NCHW should match the reference, diff %f", diff);
+}
+
+TEST_CASE("fully connected layer with half precision weights")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 600), 0);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(33, 600), 0);
+	ccv_nnc_tensor_param_t w16_params = ONE_CPU_TENSOR(33, 600);
+	w16_params.datatype = CCV_16F;
+	ccv_nnc_tensor_t* w16 = ccv_nnc_tensor_new(0, w16_params, 0);
+	ccv_nnc_tensor_t* bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(33), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 33), 0);
+	ccv_nnc_tensor_t* bg = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 33), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 4 * 600; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 33 * 600; i++)
+		w->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) * 0.1;
+	for (i = 0; i < 33; i++)
+		bias->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	// Round the weights to half precision first, thus, both runs see the same weights.
+	ccv_float_to_half_precision(w->data.f32, w16->data.f16, 33 * 600);
+	ccv_half_precision_to_float(w16->data.f16, w->data.f32, 33 * 600);
+	ccv_nnc_cmd_t cmd = CMD_GEMM_FORWARD(33);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(bg), 0);
+	cmd = CMD_GEMM_FORWARD(33);
+	REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, w16, bias), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "should run with half precision weights");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bg->data.f32, 4 * 33, 1e-4, "half precision weights should give the same result as the widened weights");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(w16);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bg);
+}
+
+TEST_CASE("convolution with half precision weights")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 3), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 8), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 8, 3, 3, 3);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 3, 3, 3), 0);
+	ccv_nnc_tensor_param_t w16_params = ONE_CPU_TENSOR(8, 3, 3, 3);
+	w16_params.datatype = CCV_16F;
+	ccv_nnc_tensor_t* w16 = ccv_nnc_tensor_new(0, w16_params, 0);
+	ccv_nnc_tensor_t* bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8), 0);
+	ccv_nnc_tensor_t* bg = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 29, 8), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 31 * 29 * 3; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	for (i = 0; i < 8 * 3 * 3 * 3; i++)
+		w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 8; i++)
+		bias->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	ccv_float_to_half_precision(w->data.f32, w16->data.f16, 8 * 3 * 3 * 3);
+	ccv_half_precision_to_float(w16->data.f16, w->data.f32, 8 * 3 * 3 * 3);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(bg), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.algorithm = -1;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w16, bias), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "should run with half precision weights");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bg->data.f32, 31 * 29 * 8, 1e-4, "half precision weights should give the same result as the widened weights");
+	// Weights changed in place should be widened again.
+	for (i = 0; i < 8 * 3 * 3 * 3; i++)
+		w->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_float_to_half_precision(w->data.f32, w16->data.f16, 8 * 3 * 3 * 3);
+	ccv_half_precision_to_float(w16->data.f16, w->data.f32, 8 * 3 * 3 * 3);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(bg), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w16, bias), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "should run with updated half precision weights");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bg->data.f32, 31 * 29 * 8, 1e-4, "updated half precision weights should give the same result as the widened weights");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(w16);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(bg);
+}
+
 TEST_CASE("maximum pool network of 55x55 with window of 3x3 and stride of 2")
 {
 	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(55, 55, 1), 0);
@@ -463,4 +618,214 @@ TEST_CASE("average pool network of 54x54 with window of 2x2 and stride of 2")
 	ccv_nnc_tensor_free(a);
 }
 
+TEST_CASE("maximum and average pool with the optimized backend")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(2, 33, 31, 7), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(2, 17, 16, 7), 0);
+	ccv_nnc_tensor_t* bg = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(2, 17, 16, 7), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 2 * 33 * 31 * 7; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_cmd_t cmd = CMD_MAX_POOL_FORWARD(3, 3);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	int k;
+	for (k = 0; k < 2; k++)
+	{
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		// The reference backend does one image at a time.
+		ccv_nnc_tensor_t* const a0 = ccv_nnc_tensor_new(a->data.f32 + k * 33 * 31 * 7, ONE_CPU_TENSOR(33, 31, 7), 0);
+		ccv_nnc_tensor_t* const bg0 = ccv_nnc_tensor_new(bg->data.f32 + k * 17 * 16 * 7, ONE_CPU_TENSOR(17, 16, 7), 0);
+		ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a0), TENSOR_LIST(bg0), 0);
+		ccv_nnc_tensor_free(a0);
+		ccv_nnc_tensor_free(bg0);
+	}
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+	REQUIRE_ARRAY_EQ(float, b->data.f32, bg->data.f32, 2 * 17 * 16 * 7, "max pool should match the reference");
+	cmd = CMD_AVERAGE_POOL_FORWARD(3, 3);
+	for (k = 0; k < 2; k++)
+	{
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		ccv_nnc_tensor_t* const a0 = ccv_nnc_tensor_new(a->data.f32 + k * 33 * 31 * 7, ONE_CPU_TENSOR(33, 31, 7), 0);
+		ccv_nnc_tensor_t* const bg0 = ccv_nnc_tensor_new(bg->data.f32 + k * 17 * 16 * 7, ONE_CPU_TENSOR(17, 16, 7), 0);
+		ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a0), TENSOR_LIST(bg0), 0);
+		ccv_nnc_tensor_free(a0);
+		ccv_nnc_tensor_free(bg0);
+	}
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bg->data.f32, 2 * 17 * 16 * 7, 1e-5, "average pool should match the reference");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bg);
+}
+
+TEST_CASE("batch norm in inference with the optimized backend")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(2, 9, 9, 11), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(2, 9, 9, 11), 0);
+	ccv_nnc_tensor_t* bg = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(2, 9, 9, 11), 0);
+	ccv_nnc_tensor_t* scale = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(11), 0);
+	ccv_nnc_tensor_t* bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(11), 0);
+	ccv_nnc_tensor_t* mean = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(11), 0);
+	ccv_nnc_tensor_t* var = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(11), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 2 * 9 * 9 * 11; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 11; i++)
+	{
+		scale->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+		bias->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		mean->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		var->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	}
+	ccv_nnc_cmd_t cmd = CMD_BATCH_NORM_FORWARD(1e-4, 1, 0.9, 0, 1, 2);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, scale, bias, mean, var), TENSOR_LIST(bg), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, scale, bias, mean, var), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "should run batch norm in inference");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bg->data.f32, 2 * 9 * 9 * 11, 1e-5, "batch norm should match the reference");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bg);
+	ccv_nnc_tensor_free(scale);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(mean);
+	ccv_nnc_tensor_free(var);
+}
+
+TEST_CASE("batch norm in inference with the optimized backend in NCHW")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(2, 11, 9, 9), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(2, 11, 9, 9), 0);
+	ccv_nnc_tensor_t* bg = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(2, 11, 9, 9), 0);
+	ccv_nnc_tensor_t* scale = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(11, 1, 1), 0);
+	ccv_nnc_tensor_t* bias = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(11, 1, 1), 0);
+	ccv_nnc_tensor_t* mean = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(11, 1, 1), 0);
+	ccv_nnc_tensor_t* var = ccv_nnc_tensor_new(0, CPU_TENSOR_NCHW(11, 1, 1), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 2 * 11 * 9 * 9; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 11; i++)
+	{
+		scale->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+		bias->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		mean->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		var->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	}
+	ccv_nnc_cmd_t cmd = CMD_BATCH_NORM_FORWARD(1e-4, 1, 0.9, 0, 2, 3);
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, scale, bias, mean, var), TENSOR_LIST(bg), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, scale, bias, mean, var), TENSOR_LIST(b), 0), CCV_NNC_EXEC_SUCCESS, "should run batch norm in inference");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, bg->data.f32, 2 * 11 * 9 * 9, 1e-5, "batch norm should match the reference");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(bg);
+	ccv_nnc_tensor_free(scale);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(mean);
+	ccv_nnc_tensor_free(var);
+}
+
+TEST_CASE("convolution with folded batch norm matches convolution followed by batch norm")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 9, 9, 3), 0);
+	ccv_nnc_tensor_t* w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 3, 3, 3), 0);
+	ccv_nnc_tensor_t* wbias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8), 0);
+	ccv_nnc_tensor_t* scale = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8), 0);
+	ccv_nnc_tensor_t* bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8), 0);
+	ccv_nnc_tensor_t* mean = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8), 0);
+	ccv_nnc_tensor_t* var = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 9 * 9 * 3; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 8 * 3 * 3 * 3; i++)
+		w->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) / 27;
+	for (i = 0; i < 8; i++)
+	{
+		wbias->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		scale->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.5;
+		bias->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		mean->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) - 0.5;
+		// Small variances with a large epsilon, where epsilon inside or outside of the square root makes a difference.
+		var->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 0.01;
+	}
+	const ccv_nnc_hint_t hint = HINT((1, 1), (1, 1));
+	ccv_nnc_tensor_t* y = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 9, 9, 8), 0);
+	ccv_nnc_cmd_exec(CMD_CONVOLUTION_FORWARD(1, 8, 3, 3, 3), hint, 0, TENSOR_LIST(a, w, wbias), TENSOR_LIST(y), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 9, 9, 8), 0);
+	ccv_nnc_cmd_exec(CMD_BATCH_NORM_FORWARD(0.1, 1, 0.9, 0, 1, 2), ccv_nnc_no_hint, 0, TENSOR_LIST(y, scale, bias, mean, var), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* fw = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 3, 3, 3), 0);
+	ccv_nnc_tensor_t* fbias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8), 0);
+	REQUIRE_EQ(ccv_nnc_cmd_exec(CMD_BATCH_NORM_FOLD_FORWARD(0.1), ccv_nnc_no_hint, 0, TENSOR_LIST(w, wbias, scale, bias, mean, var), TENSOR_LIST(fw, fbias), 0), CCV_NNC_EXEC_SUCCESS, "should fold batch norm into the weights");
+	ccv_nnc_tensor_t* fb = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 9, 9, 8), 0);
+	ccv_nnc_cmd_exec(CMD_CONVOLUTION_FORWARD(1, 8, 3, 3, 3), hint, 0, TENSOR_LIST(a, fw, fbias), TENSOR_LIST(fb), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, fb->data.f32, b->data.f32, 9 * 9 * 8, 1e-4, "folded batch norm should match the unfused one");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(wbias);
+	ccv_nnc_tensor_free(scale);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(mean);
+	ccv_nnc_tensor_free(var);
+	ccv_nnc_tensor_free(y);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(fw);
+	ccv_nnc_tensor_free(fbias);
+	ccv_nnc_tensor_free(fb);
+}
+
+TEST_CASE("element-wise ops with the optimized backend")
+{
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(5, 2001), 0);
+	ccv_nnc_tensor_t* b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(5, 2001), 0);
+	ccv_nnc_tensor_t* c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(5, 2001), 0);
+	ccv_nnc_tensor_t* d = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(5, 2001), 0);
+	ccv_nnc_tensor_t* dg = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(5, 2001), 0);
+	dsfmt_t dsfmt;
+	int i;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	for (i = 0; i < 5 * 2001; i++)
+	{
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.5;
+		b->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.5;
+		c->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.5;
+	}
+	const uint32_t cmds[] = {
+		CCV_NNC_EWSUM_FORWARD, CCV_NNC_EWPROD_FORWARD, CCV_NNC_EWDIV_FORWARD, CCV_NNC_EWEXP_FORWARD, CCV_NNC_EWLOG_FORWARD, CCV_NNC_EWSQRT_FORWARD
+	};
+	int k;
+	for (k = 0; k < sizeof(cmds) / sizeof(cmds[0]); k++)
+	{
+		ccv_nnc_cmd_t cmd = ccv_nnc_cmd(cmds[k], 0, ccv_nnc_cmd_auto, 0);
+		const int input_size = (cmds[k] == CCV_NNC_EWSUM_FORWARD || cmds[k] == CCV_NNC_EWPROD_FORWARD) ? 3 : (cmds[k] == CCV_NNC_EWDIV_FORWARD ? 2 : 1);
+		cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+		ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, (ccv_nnc_tensor_t*[]){a, b, c}, input_size, TENSOR_LIST(dg), 0);
+		cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+		REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, (ccv_nnc_tensor_t*[]){a, b, c}, input_size, TENSOR_LIST(d), 0), CCV_NNC_EXEC_SUCCESS, "should run the element-wise op");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, d->data.f32, dg->data.f32, 5 * 2001, 1e-5, "element-wise op should match the reference");
+	}
+	// In place, the output is the last input.
+	ccv_nnc_cmd_t cmd = CMD_EWSUM_FORWARD();
+	cmd.backend = CCV_NNC_BACKEND_CPU_REF;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, b, c), TENSOR_LIST(dg), 0);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(a, b, c), TENSOR_LIST(c), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, c->data.f32, dg->data.f32, 5 * 2001, 1e-5, "in place sum should match the reference");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(d);
+	ccv_nnc_tensor_free(dg);
+}
+
 #include "case_main.h"
@@ -92,4 +92,43 @@ TEST_CASE("numerical gradient versus analytical gradient for convolutional netwo
 	ccv_nnc_tensor_free(gbias);
 }
 
+TEST_CASE("categorical crossentropy after softmax has the gradient of prediction minus label")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 10), 0);
+	ccv_nnc_tensor_t* const m = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 10), 0);
+	ccv_nnc_tensor_t* const y = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 10), 0);
+	ccv_nnc_tensor_t* const loss = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i, j;
+	for (i = 0; i < 4 * 10; i++)
+	{
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+		y->data.f32[i] = (i % 10 == i / 10 * 3);
+	}
+	ccv_nnc_cmd_exec(CMD_SOFTMAX_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(m), 0);
+	ccv_nnc_cmd_exec(CMD_CATEGORICAL_CROSSENTROPY_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(m, y), TENSOR_LIST(loss), 0);
+	for (i = 0; i < 4; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(loss->data.f32[i], -logf(m->data.f32[i * 10 + i * 3]), 1e-5, "loss should be the negative log of the prediction for the label");
+	ccv_nnc_tensor_t* const g = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4), 0);
+	ccv_nnc_tensor_t* const gm = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 10), 0);
+	ccv_nnc_tensor_t* const ga = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 10), 0);
+	for (i = 0; i < 4; i++)
+		g->data.f32[i] = 1;
+	ccv_nnc_cmd_exec(CMD_CATEGORICAL_CROSSENTROPY_BACKWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(g, m, y), TENSOR_LIST(gm), 0);
+	ccv_nnc_cmd_exec(CMD_SOFTMAX_BACKWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(gm, 0, m), TENSOR_LIST(ga), 0);
+	float dx[4 * 10];
+	for (i = 0; i < 4; i++)
+		for (j = 0; j < 10; j++)
+			dx[i * 10 + j] = m->data.f32[i * 10 + j] - y->data.f32[i * 10 + j];
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, ga->data.f32, dx, 4 * 10, 1e-4, "gradient should be the prediction minus the label");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(m);
+	ccv_nnc_tensor_free(y);
+	ccv_nnc_tensor_free(loss);
+	ccv_nnc_tensor_free(g);
+	ccv_nnc_tensor_free(gm);
+	ccv_nnc_tensor_free(ga);
+}
+
 #include "case_main.h"
@@ -102,4 +102,142 @@ TEST_CASE("run simple graph network")
 	ccv_nnc_tensor_free(vgbias);
 }
 
+TEST_CASE("run wide graph in parallel should match serial run")
+{
+	ccv_nnc_graph_t* graph = ccv_nnc_graph_new();
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 21, 2), 0);
+	ccv_nnc_cmd_t forw_cmd = CMD_CONVOLUTION_FORWARD(1, 4, 5, 3, 2);
+	ccv_nnc_tensor_t* w[8];
+	ccv_nnc_tensor_t* b[8];
+	ccv_nnc_tensor_t* fb[8];
+	ccv_nnc_tensor_t* bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4), 0);
+	ccv_nnc_tensor_t* c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31 * 21 * 4), 0);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(forw_cmd.info, a->info, ONE_CPU_TENSOR(31, 21, 4));
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i, j;
+	for (i = 0; i < 21 * 31 * 2; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4; i++)
+		bias->data.f32[i] = 0;
+	ccv_nnc_graph_exec_t source = ccv_nnc_graph_exec_new(graph, CMD_NOOP(), ccv_nnc_no_hint, 0, 0, 0, 0);
+	ccv_nnc_graph_exec_t forw_nodes[8];
+	for (i = 0; i < 8; i++)
+	{
+		w[i] = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 5, 3, 2), 0);
+		for (j = 0; j < 2 * 3 * 5 * 4; j++)
+			w[i]->data.f32[j] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+		b[i] = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 21, 4), 0);
+		fb[i] = ccv_nnc_tensor_new(b[i]->data.f32, c->info, 0); // Flat view to sum up.
+		forw_nodes[i] = ccv_nnc_graph_exec_new(graph, forw_cmd, hint, TENSOR_LIST(a, w[i], bias), TENSOR_LIST(b[i]));
+		ccv_nnc_graph_exec_concat(graph, source, forw_nodes[i]);
+	}
+	ccv_nnc_graph_exec_t sum = ccv_nnc_graph_exec_new(graph, CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, fb, 8, TENSOR_LIST(c));
+	for (i = 0; i < 8; i++)
+		ccv_nnc_graph_exec_concat(graph, forw_nodes[i], sum);
+	ccv_nnc_graph_run(graph, 0, 0, &source, 1, &sum, 1);
+	ccv_nnc_tensor_t* vc = ccv_nnc_tensor_new(0, c->info, 0);
+	memcpy(vc->data.f32, c->data.f32, sizeof(float) * 21 * 31 * 4);
+	memset(c->data.f32, 0, sizeof(float) * 21 * 31 * 4);
+	ccv_nnc_graph_set_worker_size(graph, 4);
+	for (i = 0; i < 3; i++) // Reuse the same worker pool.
+	{
+		ccv_nnc_graph_run(graph, 0, CCV_NNC_GRAPH_RUN_PARALLEL, &source, 1, &sum, 1);
+		REQUIRE_TENSOR_EQ(c, vc, "Parallel run should have the same result as serial run.");
+	}
+	ccv_nnc_graph_free(graph);
+	for (i = 0; i < 8; i++)
+	{
+		ccv_nnc_tensor_free(w[i]);
+		ccv_nnc_tensor_free(b[i]);
+		ccv_nnc_tensor_free(fb[i]);
+	}
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(c);
+	ccv_nnc_tensor_free(vc);
+}
+
+TEST_CASE("profile graph run with per exec time and traffic")
+{
+	ccv_nnc_graph_t* graph = ccv_nnc_graph_new();
+	ccv_nnc_tensor_t* a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 21, 2), 0);
+	ccv_nnc_cmd_t forw_cmd = CMD_CONVOLUTION_FORWARD(1, 4, 5, 3, 2);
+	ccv_nnc_tensor_t* w[4];
+	ccv_nnc_tensor_t* b[4];
+	ccv_nnc_tensor_t* fb[4];
+	ccv_nnc_tensor_t* bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4), 0);
+	ccv_nnc_tensor_t* c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31 * 21 * 4), 0);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(forw_cmd.info, a->info, ONE_CPU_TENSOR(31, 21, 4));
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i, j;
+	for (i = 0; i < 21 * 31 * 2; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4; i++)
+		bias->data.f32[i] = 0;
+	ccv_nnc_graph_exec_t source = ccv_nnc_graph_exec_new(graph, CMD_NOOP(), ccv_nnc_no_hint, 0, 0, 0, 0);
+	ccv_nnc_graph_exec_t forw_nodes[4];
+	for (i = 0; i < 4; i++)
+	{
+		w[i] = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 5, 3, 2), 0);
+		for (j = 0; j < 2 * 3 * 5 * 4; j++)
+			w[i]->data.f32[j] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+		b[i] = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 21, 4), 0);
+		fb[i] = ccv_nnc_tensor_new(b[i]->data.f32, c->info, 0);
+		forw_nodes[i] = ccv_nnc_graph_exec_new(graph, forw_cmd, hint, TENSOR_LIST(a, w[i], bias), TENSOR_LIST(b[i]));
+		ccv_nnc_graph_exec_concat(graph, source, forw_nodes[i]);
+	}
+	ccv_nnc_graph_exec_t sum = ccv_nnc_graph_exec_new(graph, CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, fb, 4, TENSOR_LIST(c));
+	for (i = 0; i < 4; i++)
+		ccv_nnc_graph_exec_concat(graph, forw_nodes[i], sum);
+	ccv_nnc_graph_run(graph, 0, 0, &source, 1, &sum, 1);
+	REQUIRE_EQ(ccv_nnc_graph_profile_entry_size(graph), 0, "should not profile without the flag");
+	ccv_nnc_graph_set_worker_size(graph, 2);
+	ccv_nnc_graph_run(graph, 0, CCV_NNC_GRAPH_RUN_PARALLEL | CCV_NNC_GRAPH_RUN_PROFILE, &source, 1, &sum, 1);
+	REQUIRE_EQ(ccv_nnc_graph_profile_entry_size(graph), 6, "every exec should be profiled");
+	const ccv_nnc_graph_profile_entry_t* const entries = ccv_nnc_graph_profile_entries(graph);
+	int conv_count = 0;
+	for (i = 0; i < 6; i++)
+	{
+		REQUIRE(entries[i].exec.graph == graph, "should point to the exec in the graph");
+		if (entries[i].cmd == CCV_NNC_CONVOLUTION_FORWARD)
+		{
+			++conv_count;
+			REQUIRE(entries[i].backend != CCV_NNC_NO_BACKEND, "should record the backend it runs with");
+			REQUIRE_EQ(entries[i].bytes_read, sizeof(float) * (31 * 21 * 2 + 4 * 5 * 3 * 2 + 4), "read the input, weights and bias");
+			REQUIRE_EQ(entries[i].bytes_written, sizeof(float) * 31 * 21 * 4, "write the output");
+		} else if (entries[i].cmd == CCV_NNC_EWSUM_FORWARD) {
+			REQUIRE_EQ(entries[i].exec.d, sum.d, "sum is the last exec");
+			REQUIRE_EQ(entries[i].bytes_read, sizeof(float) * 31 * 21 * 4 * 4, "read all the outputs");
+		}
+	}
+	REQUIRE_EQ(conv_count, 4, "should have all the convolutions");
+	FILE* out = tmpfile();
+	ccv_nnc_graph_profile_trace(graph, out);
+	rewind(out);
+	char trace[4096];
+	const size_t trace_size = fread(trace, 1, sizeof(trace) - 1, out);
+	trace[trace_size] = 0;
+	fclose(out);
+	REQUIRE(strncmp(trace, "{\"traceEvents\":[", 16) == 0, "should be a trace event file");
+	int event_count = 0;
+	const char* event = trace;
+	while ((event = strstr(event, "\"ph\":\"X\"")))
+		++event_count, ++event;
+	REQUIRE_EQ(event_count, 6, "should have one complete event per exec");
+	ccv_nnc_graph_profile_clear(graph);
+	REQUIRE_EQ(ccv_nnc_graph_profile_entry_size(graph), 0, "should clear the profile");
+	ccv_nnc_graph_free(graph);
+	for (i = 0; i < 4; i++)
+	{
+		ccv_nnc_tensor_free(w[i]);
+		ccv_nnc_tensor_free(b[i]);
+		ccv_nnc_tensor_free(fb[i]);
+	}
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(c);
+}
+
 #include "case_main.h"
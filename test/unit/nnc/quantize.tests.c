@@ -0,0 +1,191 @@
+#include "case.h"
+#include "ccv_case.h"
+#include "ccv_nnc_case.h"
+#include <ccv.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+#include "3rdparty/dsfmt/dSFMT.h"
+
+TEST_SETUP()
+{
+	ccv_nnc_init();
+}
+
+static ccv_nnc_tensor_param_t _8u_params(ccv_nnc_tensor_param_t params)
+{
+	params.datatype = CCV_8U;
+	return params;
+}
+
+TEST_CASE("quantize and dequantize a tensor per tensor and per channel")
+{
+	ccv_nnc_tensor_t* const x = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 3, 5), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	int i;
+	for (i = 0; i < 4 * 3 * 5; i++)
+		x->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_tensor_t* const y = ccv_nnc_tensor_new(0, _8u_params(ONE_CPU_TENSOR(4, 3, 5)), 0);
+	ccv_nnc_tensor_t* const q = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 2), 0);
+	ccv_nnc_tensor_t* const z = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 3, 5), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST(x), TENSOR_LIST(y, q), 0);
+	ccv_nnc_cmd_exec(CMD_DEQUANTIZE_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(y, q), TENSOR_LIST(z), 0);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, x->data.f32, z->data.f32, 4 * 3 * 5, q->data.f32[0] * 0.5 + 1e-6, "per tensor quantization should be within half a step");
+	ccv_nnc_tensor_t* const qc = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 2), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(1), ccv_nnc_no_hint, 0, TENSOR_LIST(x), TENSOR_LIST(y, qc), 0);
+	ccv_nnc_cmd_exec(CMD_DEQUANTIZE_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(y, qc), TENSOR_LIST(z), 0);
+	for (i = 0; i < 4; i++)
+	{
+		REQUIRE_EQ_WITH_TOLERANCE(qc->data.f32[i * 2 + 1], 128, 1e-6, "per channel quantization is symmetric");
+		REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, x->data.f32 + i * 15, z->data.f32 + i * 15, 15, qc->data.f32[i * 2] * 0.5 + 1e-6, "per channel quantization should be within half a step");
+	}
+	ccv_nnc_tensor_free(x);
+	ccv_nnc_tensor_free(y);
+	ccv_nnc_tensor_free(q);
+	ccv_nnc_tensor_free(qc);
+	ccv_nnc_tensor_free(z);
+}
+
+TEST_CASE("int8 convolution should match the float convolution")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 23, 8), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 23, 16), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 16, 5, 5, 8);
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16, 5, 5, 8), 0);
+	ccv_nnc_tensor_t* const bias = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 1);
+	int i;
+	for (i = 0; i < 31 * 23 * 8; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt);
+	for (i = 0; i < 16 * 5 * 5 * 8; i++)
+		w->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) / (5 * 5 * 8);
+	for (i = 0; i < 16; i++)
+		bias->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w, bias), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const qa = ccv_nnc_tensor_new(0, _8u_params(a->info), 0);
+	ccv_nnc_tensor_t* const aq = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 2), 0);
+	ccv_nnc_tensor_t* const qw = ccv_nnc_tensor_new(0, _8u_params(w->info), 0);
+	ccv_nnc_tensor_t* const wq = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(16, 2), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(qa, aq), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(1), ccv_nnc_no_hint, 0, TENSOR_LIST(w), TENSOR_LIST(qw, wq), 0);
+	ccv_nnc_tensor_t* const qb = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(31, 23, 16), 0);
+	REQUIRE_EQ(CCV_NNC_EXEC_SUCCESS, ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(qa, qw, bias, aq, wq), TENSOR_LIST(qb), 0), "int8 convolution should run");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, qb->data.f32, 31 * 23 * 16, 1e-2, "int8 convolution should be close to the float one");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(bias);
+	ccv_nnc_tensor_free(qa);
+	ccv_nnc_tensor_free(aq);
+	ccv_nnc_tensor_free(qw);
+	ccv_nnc_tensor_free(wq);
+	ccv_nnc_tensor_free(qb);
+}
+
+TEST_CASE("int8 gemm should match the float gemm")
+{
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 128), 0);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(64, 128), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 64), 0);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 2);
+	int i;
+	for (i = 0; i < 4 * 128; i++)
+		a->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 64 * 128; i++)
+		w->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) / 128;
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(64), ccv_nnc_no_hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(b), 0);
+	ccv_nnc_tensor_t* const qa = ccv_nnc_tensor_new(0, _8u_params(a->info), 0);
+	ccv_nnc_tensor_t* const aq = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 2), 0);
+	ccv_nnc_tensor_t* const qw = ccv_nnc_tensor_new(0, _8u_params(w->info), 0);
+	ccv_nnc_tensor_t* const wq = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(64, 2), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(0), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(qa, aq), 0);
+	ccv_nnc_cmd_exec(CMD_QUANTIZE_FORWARD(1), ccv_nnc_no_hint, 0, TENSOR_LIST(w), TENSOR_LIST(qw, wq), 0);
+	ccv_nnc_tensor_t* const qb = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 64), 0);
+	REQUIRE_EQ(CCV_NNC_EXEC_SUCCESS, ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(64), ccv_nnc_no_hint, 0, TENSOR_LIST(qa, qw, 0, aq, wq), TENSOR_LIST(qb), 0), "int8 gemm should run");
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, b->data.f32, qb->data.f32, 4 * 64, 1e-2, "int8 gemm should be close to the float one");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(qa);
+	ccv_nnc_tensor_free(aq);
+	ccv_nnc_tensor_free(qw);
+	ccv_nnc_tensor_free(wq);
+	ccv_nnc_tensor_free(qb);
+}
+
+TEST_CASE("quantize a symbolic graph of convolution and gemm")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(8, 8, 3), "x");
+	ccv_nnc_tensor_symbol_t w1 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(4, 3, 3, 3), "w1");
+	ccv_nnc_tensor_symbol_t bias1 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(4), "bias1");
+	ccv_nnc_tensor_symbol_t h = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(8, 8, 4), "h");
+	const ccv_nnc_graph_exec_symbol_t conv = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_CONVOLUTION_FORWARD(1, 4, 3, 3, 3), TENSOR_SYMBOL_LIST(x, w1, bias1), TENSOR_SYMBOL_LIST(h), "conv");
+	ccv_nnc_graph_exec_symbol_set_hint(symbolic_graph, conv, HINT((1, 1), (1, 1)));
+	ccv_nnc_tensor_symbol_t r = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(8, 8, 4), "r");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(h), TENSOR_SYMBOL_LIST(r), "relu");
+	ccv_nnc_tensor_symbol_t rv = ccv_nnc_tensor_symbol_alias_new(symbolic_graph, r, DIM_ALLOC(0), DIM_ALLOC(1, 8 * 8 * 4), ONE_CPU_TENSOR(1, 8 * 8 * 4), "rv");
+	ccv_nnc_tensor_symbol_t w2 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 8 * 8 * 4), "w2");
+	ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 10), "y");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(10), TENSOR_SYMBOL_LIST(rv, w2), TENSOR_SYMBOL_LIST(y), "fc");
+	ccv_nnc_tensor_symbol_t r2 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 8 * 8 * 4), "r2");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_DATA_TRANSFER_FORWARD(), TENSOR_SYMBOL_LIST(rv), TENSOR_SYMBOL_LIST(r2), "copy");
+	ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 10), "z");
+	const ccv_nnc_graph_exec_symbol_t fc2 = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(10), TENSOR_SYMBOL_LIST(r2, w2), TENSOR_SYMBOL_LIST(z), "fc2");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	const int exec_symbol_count = ccv_nnc_graph_exec_symbol_count(symbolic_graph);
+	ccv_nnc_symbolic_graph_quantize(symbolic_graph, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	// x, w1 for the convolution, r2, w2 for the second gemm, the first gemm takes an alias and stays float.
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_count(symbolic_graph), exec_symbol_count + 4, "should insert 4 quantize commands");
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, conv).backend, CCV_NNC_BACKEND_CPU_INT8, "convolution should use the quantized backend");
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, fc2).backend, CCV_NNC_BACKEND_CPU_INT8, "gemm should use the quantized backend");
+	// The convolution was the only source, the quantize commands for x, w1 and w2 take its place.
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 3, "quantize commands for x, w1 and w2 should be the sources");
+	int i;
+	for (i = 0; i < 3; i++)
+		REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, ccv_nnc_symbolic_graph_sources(symbolic_graph)[i]).cmd, CCV_NNC_QUANTIZE_FORWARD, "quantize commands should be the sources");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_destination_size(symbolic_graph), 2, "both gemms should still be the destinations");
+	REQUIRE(ccv_nnc_tensor_symbol_flags(symbolic_graph, w1) & CCV_NNC_TENSOR_SYMBOL_CONSTANT, "w1 should be flagged as constant");
+	REQUIRE(ccv_nnc_tensor_symbol_flags(symbolic_graph, w2) & CCV_NNC_TENSOR_SYMBOL_CONSTANT, "w2 should be flagged as constant");
+	REQUIRE(!(ccv_nnc_tensor_symbol_flags(symbolic_graph, r2) & CCV_NNC_TENSOR_SYMBOL_CONSTANT), "r2 is written by the graph");
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, 0, 0, TENSOR_SYMBOL_LIST(h, y, z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	GRAPH_GEN(graph, CCV_NNC_LONG_DOT_GRAPH);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 3);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	ccv_nnc_tensor_t* const w1_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, w1);
+	ccv_nnc_tensor_t* const bias1_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, bias1);
+	ccv_nnc_tensor_t* const w2_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, w2);
+	for (i = 0; i < 8 * 8 * 3; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4 * 3 * 3 * 3; i++)
+		w1_tensor->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) / 27;
+	for (i = 0; i < 4; i++)
+		bias1_tensor->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) * 0.1;
+	for (i = 0; i < 10 * 8 * 8 * 4; i++)
+		w2_tensor->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) / 16;
+	// Compute the convolution in float before running the graph, the inputs can be reused by the graph afterwards.
+	ccv_nnc_tensor_t* const h_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 8, 4), 0);
+	ccv_nnc_cmd_exec(CMD_CONVOLUTION_FORWARD(1, 4, 3, 3, 3), HINT((1, 1), (1, 1)), 0, TENSOR_LIST(x_tensor, w1_tensor, bias1_tensor), TENSOR_LIST(h_tensor), 0);
+	ccv_nnc_graph_run(graph, 0, 0, TRAVERSE_FULL);
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, y);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	// The first gemm is still float, with the same inputs, the quantized gemm should come close.
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, y_tensor->data.f32, z_tensor->data.f32, 10, 1e-2, "quantized gemm should be close to the float one");
+	ccv_nnc_tensor_t* const qh_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, h);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, h_tensor->data.f32, qh_tensor->data.f32, 8 * 8 * 4, 1e-2, "quantized convolution should be close to the float one");
+	ccv_nnc_tensor_free(h_tensor);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+#include "case_main.h"
@@ -4,6 +4,7 @@
 #include <ccv.h>
 #include <nnc/ccv_nnc.h>
 #include <nnc/ccv_nnc_easy.h>
+#include "3rdparty/dsfmt/dSFMT.h"
 
 TEST_SETUP()
 {
@@ -305,4 +306,309 @@ TEST_CASE("simplify graph with while, variant 3")
 	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
 }
 
+TEST_CASE("simplify graph with format transforms that cancel out")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 2, 3, 4), "x");
+	ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(1, 4, 2, 3), "y");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(y), "transform1");
+	ccv_nnc_tensor_symbol_t u = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(1, 4, 2, 3), "u");
+	ccv_nnc_graph_exec_symbol_t relu = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(y), TENSOR_SYMBOL_LIST(u), "relu");
+	ccv_nnc_tensor_symbol_t v = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 2, 3, 4), "v");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(u), TENSOR_SYMBOL_LIST(v), "transform2");
+	ccv_nnc_tensor_symbol_t p = ccv_nnc_tensor_symbol_new(symbolic_graph, CPU_TENSOR_NCHW(1, 4, 2, 3), "p");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(v), TENSOR_SYMBOL_LIST(p), "transform3");
+	ccv_nnc_tensor_symbol_t q = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 2, 3, 4), "q");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_FORMAT_TRANSFORM_FORWARD(), TENSOR_SYMBOL_LIST(p), TENSOR_SYMBOL_LIST(q), "transform4");
+	ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 2, 3, 4), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(q), TENSOR_SYMBOL_LIST(z), "exp");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_FORMAT_TRANSFORM_OPT,
+			CCV_NNC_SIMPLIFY_GRAPH_PRUNING),
+		TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	// All transforms are gone, relu reads x directly and exp reads the output of relu directly.
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 1, "relu should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_sources(symbolic_graph)[0].d, relu.d, "relu should be the only source");
+	const int* inputs;
+	int input_size;
+	const int* outputs;
+	int output_size;
+	ccv_nnc_graph_exec_symbol_io(symbolic_graph, relu, &inputs, &input_size, &outputs, &output_size);
+	REQUIRE_EQ(inputs[0], x.d, "relu should read x");
+	REQUIRE_EQ(outputs[0], v.d, "relu should write v");
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, 0, 0, 0, 0, SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	GRAPH_GEN(graph, CCV_NNC_LONG_DOT_GRAPH);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	int i;
+	for (i = 0; i < 2 * 3 * 4; i++)
+		x_tensor->data.f32[i] = i - 12;
+	ccv_nnc_graph_run(graph, 0, 0, 0, 0, 0, 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	for (i = 0; i < 2 * 3 * 4; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(z_tensor->data.f32[i], expf(ccv_max(i - 12, 0)), 1e-5, "result should be equal");
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+TEST_CASE("simplify graph by fusing batch norm, bias add and relu into convolution and gemm")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 8, 8, 3), "x");
+	ccv_nnc_tensor_symbol_t w = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(4, 3, 3, 3), "w");
+	ccv_nnc_tensor_symbol_t bias = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(4), "bias");
+	ccv_nnc_tensor_symbol_t y = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 8, 8, 4), "y");
+	ccv_nnc_graph_exec_symbol_t conv = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_CONVOLUTION_FORWARD(1, 4, 3, 3, 3), TENSOR_SYMBOL_LIST(x, w, bias), TENSOR_SYMBOL_LIST(y), "conv");
+	ccv_nnc_graph_exec_symbol_set_hint(symbolic_graph, conv, HINT((1, 1), (1, 1)));
+	ccv_nnc_tensor_symbol_t scale = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 1, 1, 4), "scale");
+	ccv_nnc_tensor_symbol_t bnbias = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 1, 1, 4), "bnbias");
+	ccv_nnc_tensor_symbol_t mean = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 1, 1, 4), "mean");
+	ccv_nnc_tensor_symbol_t var = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 1, 1, 4), "var");
+	ccv_nnc_tensor_symbol_t u = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 8, 8, 4), "u");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_BATCH_NORM_FORWARD(1e-4, 1, 0.9, 0, 1, 2), TENSOR_SYMBOL_LIST(y, scale, bnbias, mean, var), TENSOR_SYMBOL_LIST(u), "bnorm");
+	ccv_nnc_tensor_symbol_t v = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 8, 8, 4), "v");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(u), TENSOR_SYMBOL_LIST(v), "relu");
+	ccv_nnc_tensor_symbol_t vv = ccv_nnc_tensor_symbol_alias_new(symbolic_graph, v, DIM_ALLOC(0), DIM_ALLOC(1, 8 * 8 * 4), ONE_CPU_TENSOR(1, 8 * 8 * 4), "vv");
+	ccv_nnc_tensor_symbol_t w2 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10, 8 * 8 * 4), "w2");
+	ccv_nnc_tensor_symbol_t p = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 10), "p");
+	ccv_nnc_graph_exec_symbol_t fc = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_GEMM_FORWARD(10), TENSOR_SYMBOL_LIST(vv, w2), TENSOR_SYMBOL_LIST(p), "fc");
+	ccv_nnc_tensor_symbol_t bias2 = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(10), "bias2");
+	ccv_nnc_tensor_symbol_t q = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 10), "q");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_ADD_FORWARD(1, 1), TENSOR_SYMBOL_LIST(p, bias2), TENSOR_SYMBOL_LIST(q), "add");
+	ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(1, 10), "z");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_RELU_FORWARD(), TENSOR_SYMBOL_LIST(q), TENSOR_SYMBOL_LIST(z), "relu2");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	// The batch norm is folded into the convolution parameters by a new command ahead of it.
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 1, "the batch norm fold should be the only source");
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, ccv_nnc_symbolic_graph_sources(symbolic_graph)[0]).cmd, CCV_NNC_BATCH_NORM_FOLD_FORWARD, "the batch norm fold should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_destination_size(symbolic_graph), 1, "gemm should be the only destination");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_destinations(symbolic_graph)[0].d, fc.d, "gemm should be the only destination");
+	REQUIRE(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, conv).info.convolution.relu, "convolution should apply relu");
+	REQUIRE(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, fc).info.blas.relu, "gemm should apply relu");
+	const int* inputs;
+	int input_size;
+	const int* outputs;
+	int output_size;
+	ccv_nnc_graph_exec_symbol_io(symbolic_graph, conv, &inputs, &input_size, &outputs, &output_size);
+	REQUIRE_EQ(outputs[0], v.d, "convolution should write v");
+	ccv_nnc_graph_exec_symbol_io(symbolic_graph, fc, &inputs, &input_size, &outputs, &output_size);
+	REQUIRE_EQ(input_size, 3, "gemm should take bias2 as its bias");
+	REQUIRE_EQ(inputs[2], bias2.d, "gemm should take bias2 as its bias");
+	REQUIRE_EQ(outputs[0], z.d, "gemm should write z");
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, 0, 0, TENSOR_SYMBOL_LIST(v, z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	GRAPH_GEN(graph, CCV_NNC_LONG_DOT_GRAPH);
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	ccv_nnc_tensor_t* const w_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, w);
+	ccv_nnc_tensor_t* const bias_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, bias);
+	ccv_nnc_tensor_t* const scale_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, scale);
+	ccv_nnc_tensor_t* const bnbias_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, bnbias);
+	ccv_nnc_tensor_t* const mean_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, mean);
+	ccv_nnc_tensor_t* const var_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, var);
+	ccv_nnc_tensor_t* const w2_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, w2);
+	ccv_nnc_tensor_t* const bias2_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, bias2);
+	int i;
+	for (i = 0; i < 8 * 8 * 3; i++)
+		x_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	for (i = 0; i < 4 * 3 * 3 * 3; i++)
+		w_tensor->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) / 27;
+	for (i = 0; i < 4; i++)
+	{
+		bias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+		scale_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.5;
+		bnbias_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+		mean_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+		var_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) + 0.1;
+	}
+	for (i = 0; i < 10 * 8 * 8 * 4; i++)
+		w2_tensor->data.f32[i] = (dsfmt_genrand_open_close(&dsfmt) * 2 - 1) / 16;
+	for (i = 0; i < 10; i++)
+		bias2_tensor->data.f32[i] = dsfmt_genrand_open_close(&dsfmt) * 2 - 1;
+	// Compute the same thing command by command.
+	ccv_nnc_tensor_t* const y_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 8, 8, 4), 0);
+	ccv_nnc_cmd_exec(CMD_CONVOLUTION_FORWARD(1, 4, 3, 3, 3), HINT((1, 1), (1, 1)), 0, TENSOR_LIST(x_tensor, w_tensor, bias_tensor), TENSOR_LIST(y_tensor), 0);
+	ccv_nnc_tensor_t* const u_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 8, 8, 4), 0);
+	ccv_nnc_cmd_exec(CMD_BATCH_NORM_FORWARD(1e-4, 1, 0.9, 0, 1, 2), ccv_nnc_no_hint, 0, TENSOR_LIST(y_tensor, scale_tensor, bnbias_tensor, mean_tensor, var_tensor), TENSOR_LIST(u_tensor), 0);
+	ccv_nnc_tensor_t* const v_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 8, 8, 4), 0);
+	ccv_nnc_cmd_exec(CMD_RELU_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(u_tensor), TENSOR_LIST(v_tensor), 0);
+	ccv_nnc_tensor_t vv_tensor = ccv_nnc_tensor(v_tensor->data.f32, ONE_CPU_TENSOR(1, 8 * 8 * 4), 0);
+	ccv_nnc_tensor_t* const p_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 10), 0);
+	ccv_nnc_cmd_exec(CMD_GEMM_FORWARD(10), ccv_nnc_no_hint, 0, TENSOR_LIST(&vv_tensor, w2_tensor, bias2_tensor), TENSOR_LIST(p_tensor), 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1, 10), 0);
+	ccv_nnc_cmd_exec(CMD_RELU_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(p_tensor), TENSOR_LIST(z_tensor), 0);
+	ccv_nnc_graph_run(graph, 0, 0, 0, 0, 0, 0);
+	ccv_nnc_tensor_t* const fv_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, v);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, fv_tensor->data.f32, v_tensor->data.f32, 8 * 8 * 4, 1e-4, "fused convolution should match");
+	ccv_nnc_tensor_t* const fz_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, fz_tensor->data.f32, z_tensor->data.f32, 10, 1e-4, "fused gemm should match");
+	ccv_nnc_tensor_free(y_tensor);
+	ccv_nnc_tensor_free(u_tensor);
+	ccv_nnc_tensor_free(v_tensor);
+	ccv_nnc_tensor_free(p_tensor);
+	ccv_nnc_tensor_free(z_tensor);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+TEST_CASE("simplify graph by fusing a chain of element-wise commands")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 3, 4, 5), "x");
+	ccv_nnc_tensor_symbol_t s = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 3, 4, 5), "s");
+	ccv_nnc_tensor_symbol_t d = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 3, 4, 5), "d");
+	ccv_nnc_tensor_symbol_t a = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 3, 4, 5), "a");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(a), "exp");
+	ccv_nnc_tensor_symbol_t b = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 3, 4, 5), "b");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWPROD_FORWARD(), TENSOR_SYMBOL_LIST(s, a), TENSOR_SYMBOL_LIST(b), "prod");
+	ccv_nnc_tensor_symbol_t c = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 3, 4, 5), "c");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWDIV_FORWARD(), TENSOR_SYMBOL_LIST(b, d), TENSOR_SYMBOL_LIST(c), "div");
+	ccv_nnc_tensor_symbol_t e = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 3, 4, 5), "e");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SCALAR_MUL_FORWARD(0.5), TENSOR_SYMBOL_LIST(c), TENSOR_SYMBOL_LIST(e), "scale");
+	ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 3, 4, 5), "z");
+	ccv_nnc_graph_exec_symbol_t last = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWSQRT_FORWARD(), TENSOR_SYMBOL_LIST(e), TENSOR_SYMBOL_LIST(z), "sqrt");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 1, "the chain should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_sources(symbolic_graph)[0].d, last.d, "the chain should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_destination_size(symbolic_graph), 1, "the chain should be the only destination");
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, last).cmd, CCV_NNC_EWCHAIN_FORWARD, "the last command should become the chain");
+	const int* inputs;
+	int input_size;
+	const int* outputs;
+	int output_size;
+	ccv_nnc_graph_exec_symbol_io(symbolic_graph, last, &inputs, &input_size, &outputs, &output_size);
+	REQUIRE_EQ(input_size, 3, "the chain should read x, s and d");
+	REQUIRE_EQ(inputs[0], x.d, "the chain should read x first");
+	REQUIRE_EQ(outputs[0], z.d, "the chain should write z");
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, 0, 0, TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	GRAPH_GEN(graph, CCV_NNC_LONG_DOT_GRAPH);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	ccv_nnc_tensor_t* const s_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, s);
+	ccv_nnc_tensor_t* const d_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, d);
+	int i;
+	for (i = 0; i < 2 * 3 * 4 * 5; i++)
+	{
+		x_tensor->data.f32[i] = (i - 60) * 0.05;
+		s_tensor->data.f32[i] = i + 1;
+		d_tensor->data.f32[i] = 120 - i;
+	}
+	ccv_nnc_graph_run(graph, 0, 0, 0, 0, 0, 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	for (i = 0; i < 2 * 3 * 4 * 5; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(z_tensor->data.f32[i], sqrtf(expf((i - 60) * 0.05) * (i + 1) / (120 - i) * 0.5), 1e-5, "result should be equal");
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
+TEST_CASE("fused element-wise chain reads an input again after it is overwritten in place")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 300), "x");
+	ccv_nnc_tensor_symbol_t a = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 300), "a");
+	ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(a), "exp");
+	ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 300), "z");
+	ccv_nnc_graph_exec_symbol_t last = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWPROD_FORWARD(), TENSOR_SYMBOL_LIST(x, a), TENSOR_SYMBOL_LIST(z), "prod");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph));
+	const ccv_nnc_cmd_t cmd = ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, last);
+	REQUIRE_EQ(cmd.cmd, CCV_NNC_EWCHAIN_FORWARD, "x * exp(x) should become the chain");
+	const int* inputs;
+	int input_size;
+	const int* outputs;
+	int output_size;
+	ccv_nnc_graph_exec_symbol_io(symbolic_graph, last, &inputs, &input_size, &outputs, &output_size);
+	REQUIRE_EQ(input_size, 2, "the chain should read x twice");
+	REQUIRE_EQ(inputs[0], x.d, "the chain should read x first");
+	REQUIRE_EQ(inputs[1], x.d, "the chain should read x again for the product");
+	// Run the chain in place, the output is the same memory as both inputs.
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(2, 300), 0);
+	int i;
+	for (i = 0; i < 2 * 300; i++)
+		x_tensor->data.f32[i] = (i - 300) * 0.01;
+	REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, ccv_nnc_no_hint, 0, TENSOR_LIST(x_tensor, x_tensor), TENSOR_LIST(x_tensor), 0), CCV_NNC_EXEC_SUCCESS, "should run the chain in place");
+	for (i = 0; i < 2 * 300; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(x_tensor->data.f32[i], (i - 300) * 0.01 * expf((i - 300) * 0.01), 1e-5, "result should be equal");
+	ccv_nnc_tensor_free(x_tensor);
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+}
+
+TEST_CASE("fuse element-wise commands only within the given sources and destinations")
+{
+	ccv_nnc_symbolic_graph_t* const symbolic_graph = ccv_nnc_symbolic_graph_new();
+	ccv_nnc_tensor_symbol_t x = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 30), "x");
+	ccv_nnc_tensor_symbol_t a = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 30), "a");
+	ccv_nnc_graph_exec_symbol_t exp_exec = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWEXP_FORWARD(), TENSOR_SYMBOL_LIST(x), TENSOR_SYMBOL_LIST(a), "exp");
+	ccv_nnc_tensor_symbol_t b = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 30), "b");
+	ccv_nnc_graph_exec_symbol_t log_exec = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWLOG_FORWARD(), TENSOR_SYMBOL_LIST(a), TENSOR_SYMBOL_LIST(b), "log");
+	ccv_nnc_tensor_symbol_t c = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 30), "c");
+	ccv_nnc_graph_exec_symbol_t sqrt_exec = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_EWSQRT_FORWARD(), TENSOR_SYMBOL_LIST(b), TENSOR_SYMBOL_LIST(c), "sqrt");
+	ccv_nnc_tensor_symbol_t z = ccv_nnc_tensor_symbol_new(symbolic_graph, ONE_CPU_TENSOR(2, 30), "z");
+	ccv_nnc_graph_exec_symbol_t scale_exec = ccv_nnc_graph_exec_symbol_new(symbolic_graph, CMD_SCALAR_MUL_FORWARD(0.5), TENSOR_SYMBOL_LIST(c), TENSOR_SYMBOL_LIST(z), "scale");
+	ccv_nnc_graph_exec_symbol_autogen(symbolic_graph, 0, 0, CCV_NNC_AUTOGEN_ALL_EXECS | CCV_NNC_AUTOGEN_SOURCES_AND_DESTINATIONS);
+	// Only log and sqrt are in the range, exp and scale are left as is.
+	ccv_nnc_symbolic_graph_simplify(symbolic_graph,
+		SYMBOLIC_GRAPH_PASSES(CCV_NNC_SIMPLIFY_OPS_FUSION),
+		TENSOR_SYMBOL_LIST(z), GRAPH_EXEC_SYMBOL_LIST(log_exec), GRAPH_EXEC_SYMBOL_LIST(sqrt_exec));
+	SYMBOLIC_GRAPH_GEN(symbolic_graph, CCV_NNC_LONG_DOT_GRAPH);
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, exp_exec).cmd, CCV_NNC_EWEXP_FORWARD, "exp is out of the range");
+	REQUIRE_EQ(ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, scale_exec).cmd, CCV_NNC_SCALAR_MUL_FORWARD, "scale is out of the range");
+	const ccv_nnc_cmd_t cmd = ccv_nnc_graph_exec_symbol_cmd(symbolic_graph, sqrt_exec);
+	REQUIRE_EQ(cmd.cmd, CCV_NNC_EWCHAIN_FORWARD, "log and sqrt should become the chain");
+	REQUIRE_EQ(cmd.info.ewchain.count, 2, "the chain should only have log and sqrt");
+	const int* inputs;
+	int input_size;
+	const int* outputs;
+	int output_size;
+	ccv_nnc_graph_exec_symbol_io(symbolic_graph, sqrt_exec, &inputs, &input_size, &outputs, &output_size);
+	REQUIRE_EQ(input_size, 1, "the chain should read a only");
+	REQUIRE_EQ(inputs[0], a.d, "the chain should read a");
+	REQUIRE_EQ(outputs[0], c.d, "the chain should write c");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_source_size(symbolic_graph), 1, "exp should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_sources(symbolic_graph)[0].d, exp_exec.d, "exp should be the only source");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_destination_size(symbolic_graph), 1, "scale should be the only destination");
+	REQUIRE_EQ(ccv_nnc_symbolic_graph_destinations(symbolic_graph)[0].d, scale_exec.d, "scale should be the only destination");
+	ccv_nnc_graph_t* graph = 0;
+	ccv_nnc_tensor_arena_t* tensor_arena = 0;
+	ccv_nnc_graph_exec_arena_t* graph_exec_arena = 0;
+	ccv_nnc_symbolic_graph_compile(symbolic_graph, 0, 0, TENSOR_SYMBOL_LIST(z), SYMBOLIC_GRAPH_SOURCES(symbolic_graph), SYMBOLIC_GRAPH_DESTINATIONS(symbolic_graph), &graph, &tensor_arena, &graph_exec_arena);
+	ccv_nnc_tensor_t* const x_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, x);
+	int i;
+	for (i = 0; i < 2 * 30; i++)
+		x_tensor->data.f32[i] = (i + 1) * 0.05;
+	ccv_nnc_graph_run(graph, 0, 0, 0, 0, 0, 0);
+	ccv_nnc_tensor_t* const z_tensor = ccv_nnc_tensor_from_symbol(tensor_arena, z);
+	for (i = 0; i < 2 * 30; i++)
+		REQUIRE_EQ_WITH_TOLERANCE(z_tensor->data.f32[i], sqrtf((i + 1) * 0.05) * 0.5, 1e-5, "result should be equal");
+	ccv_nnc_symbolic_graph_free(symbolic_graph);
+	ccv_nnc_graph_free(graph);
+	ccv_nnc_tensor_arena_free(tensor_arena);
+	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
+}
+
 #include "case_main.h"
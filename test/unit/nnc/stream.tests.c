@@ -0,0 +1,85 @@
+#include "case.h"
+#include "ccv_case.h"
+#include "ccv_nnc_case.h"
+#include <ccv.h>
+#include <nnc/ccv_nnc.h>
+#include <nnc/ccv_nnc_easy.h>
+
+TEST_SETUP()
+{
+	ccv_nnc_init();
+}
+
+TEST_CASE("commands on a CPU stream execute in order")
+{
+	ccv_nnc_stream_context_t* const stream = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1024), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(1024), 0);
+	int i;
+	for (i = 0; i < 1024; i++)
+		a->data.f32[i] = i;
+	for (i = 0; i < 10; i++)
+	{
+		ccv_nnc_cmd_exec(CMD_SCALAR_MUL_FORWARD(2), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), stream);
+		ccv_nnc_cmd_exec(CMD_DATA_TRANSFER_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(b), TENSOR_LIST(a), stream);
+	}
+	ccv_nnc_stream_context_wait(stream);
+	float expected[1024];
+	for (i = 0; i < 1024; i++)
+		expected[i] = i * 1024;
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, a->data.f32, expected, 1024, 1e-5, "should be doubled 10 times");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_stream_context_free(stream);
+}
+
+TEST_CASE("signal synchronizes two CPU streams")
+{
+	ccv_nnc_stream_context_t* const stream_a = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_context_t* const stream_b = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_stream_signal_t* const signal = ccv_nnc_stream_signal_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4096), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4096), 0);
+	ccv_nnc_tensor_t* const c = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4096), 0);
+	int i;
+	for (i = 0; i < 4096; i++)
+		a->data.f32[i] = 1;
+	for (i = 0; i < 20; i++)
+		ccv_nnc_cmd_exec(CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a, a), TENSOR_LIST(a), stream_a);
+	ccv_nnc_stream_context_emit_signal(stream_a, signal);
+	ccv_nnc_stream_context_wait_signal(stream_b, signal);
+	ccv_nnc_cmd_exec(CMD_DATA_TRANSFER_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(a), TENSOR_LIST(b), stream_b);
+	ccv_nnc_cmd_exec(CMD_EWSUM_FORWARD(), ccv_nnc_no_hint, 0, TENSOR_LIST(b, b), TENSOR_LIST(c), stream_b);
+	ccv_nnc_stream_context_wait(stream_b);
+	float expected[4096];
+	for (i = 0; i < 4096; i++)
+		expected[i] = 1 << 21;
+	REQUIRE_ARRAY_EQ_WITH_TOLERANCE(float, c->data.f32, expected, 4096, 1e-5, "stream b should see the result from stream a");
+	ccv_nnc_stream_context_free(stream_a);
+	ccv_nnc_stream_context_free(stream_b);
+	ccv_nnc_stream_signal_free(signal);
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_tensor_free(c);
+}
+
+TEST_CASE("wait on a CPU stream reports the failure from a queued command")
+{
+	ccv_nnc_stream_context_t* const stream = ccv_nnc_stream_context_new(CCV_STREAM_CONTEXT_CPU);
+	ccv_nnc_tensor_t* const a = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 8, 4), 0);
+	ccv_nnc_tensor_t* const w = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(4, 3, 3, 4), 0);
+	ccv_nnc_tensor_t* const b = ccv_nnc_tensor_new(0, ONE_CPU_TENSOR(8, 8, 4), 0);
+	ccv_nnc_cmd_t cmd = CMD_CONVOLUTION_FORWARD(1, 4, 3, 3, 4);
+	cmd.backend = CCV_NNC_BACKEND_CPU_OPT;
+	cmd.algorithm = 1; // CCV_NNC_CMD_OPT_CONV_ALGO_GEMM only takes 1x1 kernels.
+	ccv_nnc_hint_t hint = ccv_nnc_hint_auto(cmd.info, a->info, b->info);
+	REQUIRE_EQ(ccv_nnc_cmd_exec(cmd, hint, 0, TENSOR_LIST(a, w), TENSOR_LIST(b), stream), CCV_NNC_EXEC_SUCCESS, "the command should be queued");
+	REQUIRE_EQ(ccv_nnc_stream_context_wait(stream), CCV_NNC_EXEC_INVALID, "wait should report the kernel cannot run");
+	REQUIRE_EQ(ccv_nnc_stream_context_wait(stream), CCV_NNC_EXEC_SUCCESS, "the failure is reported once");
+	ccv_nnc_tensor_free(a);
+	ccv_nnc_tensor_free(w);
+	ccv_nnc_tensor_free(b);
+	ccv_nnc_stream_context_free(stream);
+}
+
+#include "case_main.h"
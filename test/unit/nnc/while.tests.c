@@ -170,6 +170,11 @@ TEST_CASE("symbolic graph for a while loop to compute x ^ 5 * y")
 	z0_tensor->data.f32[0] = 1;
 	ccv_nnc_graph_run(graph, 0, 0, 0, 0, 0, 0);
 	REQUIRE_EQ_WITH_TOLERANCE(z_tensor->data.f32[0], 0.92 * 0.92 * 0.92 * 0.92 * 0.92 * 3.2, 1e-6, "z should be equal to x ^ 5 * y");
+	z_tensor->data.f32[0] = 0;
+	z0_tensor->data.f32[0] = 1;
+	ccv_nnc_graph_set_worker_size(graph, 2);
+	ccv_nnc_graph_run(graph, 0, CCV_NNC_GRAPH_RUN_PARALLEL, 0, 0, 0, 0);
+	REQUIRE_EQ_WITH_TOLERANCE(z_tensor->data.f32[0], 0.92 * 0.92 * 0.92 * 0.92 * 0.92 * 3.2, 1e-6, "z should be equal to x ^ 5 * y when run in parallel");
 	ccv_nnc_symbolic_graph_free(symbolic_graph);
 	ccv_nnc_graph_exec_arena_free(graph_exec_arena);
 	ccv_nnc_tensor_arena_free(tensor_arena);
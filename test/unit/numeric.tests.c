@@ -2,6 +2,8 @@
 #include "case.h"
 #include "ccv_case.h"
 #include "3rdparty/dsfmt/dSFMT.h"
+#include <pthread.h>
+#include <sched.h>
 
 /* numeric tests are more like functional tests rather than unit tests:
  * the following tests contain:
@@ -107,6 +109,103 @@ TEST_CASE("Gaussian blur with kernel size even & odd")
 	ccv_matrix_free(y);
 }
 
+TEST_CASE("Gaussian blur with measured and reused FFT plans")
+{
+	ccv_filter_plan_mode(CCV_FILTER_PLAN_MEASURE);
+	ccv_dense_matrix_t* image = 0;
+	ccv_read("../../samples/street.png", &image, CCV_IO_ANY_FILE);
+	ccv_dense_matrix_t* kernel = ccv_dense_matrix_new(100, 100, CCV_32F | CCV_GET_CHANNEL(image->type), 0, 0);
+	ccv_filter_kernel(kernel, gaussian, 0);
+	double sum = ccv_sum(kernel, CCV_UNSIGNED);
+	ccv_scale(kernel, (ccv_matrix_t**)&kernel, 0, CCV_GET_CHANNEL(image->type) / sum);
+	ccv_dense_matrix_t* x = 0;
+	ccv_filter(image, kernel, &x, CCV_32F, 0);
+#ifdef HAVE_FFTW3
+	REQUIRE_EQ(0, ccv_filter_plan_export("street.wisdom"), "should save the wisdom from planning");
+	ccv_filter_plan_drain();
+	REQUIRE_EQ(0, ccv_filter_plan_import("street.wisdom"), "should load the wisdom back");
+	remove("street.wisdom");
+	remove("street.wisdomf");
+#endif
+	// the second one plans from the wisdom (or reuses the cached plan)
+	ccv_dense_matrix_t* y = 0;
+	ccv_filter(image, kernel, &y, CCV_32F, 0);
+	ccv_matrix_free(kernel);
+	ccv_matrix_free(image);
+	ccv_filter_plan_mode(CCV_FILTER_PLAN_ESTIMATE);
+	ccv_filter_plan_drain();
+	REQUIRE_MATRIX_FILE_EQ(x, "data/street.g100.bin", "should be Gaussian blur of 100x100 on street.png");
+	ccv_matrix_free(x);
+	REQUIRE_MATRIX_FILE_EQ(y, "data/street.g100.bin", "should be Gaussian blur of 100x100 on street.png with the reused plan");
+	ccv_matrix_free(y);
+}
+
+typedef struct {
+	ccv_dense_matrix_t* image;
+	ccv_dense_matrix_t* kernel;
+	ccv_dense_matrix_t* expected;
+	int type;
+	int mismatch;
+} filter_thread_t;
+
+static void* filter_thread(void* arg)
+{
+	filter_thread_t* filter = (filter_thread_t*)arg;
+	int i;
+	for (i = 0; i < 32; i++)
+	{
+		ccv_dense_matrix_t* y = 0;
+		ccv_filter(filter->image, filter->kernel, &y, filter->type, 0);
+		if (ccv_matrix_eq(y, filter->expected) != 0)
+			++filter->mismatch;
+		ccv_matrix_free(y);
+	}
+	return 0;
+}
+
+TEST_CASE("ccv_filter on many threads while the FFT plans are drained")
+{
+	dsfmt_t dsfmt;
+	dsfmt_init_gen_rand(&dsfmt, 0xbeef);
+	ccv_dense_matrix_t* image = ccv_dense_matrix_new(97, 89, CCV_32F | CCV_C1, 0, 0);
+	int i;
+	for (i = 0; i < 97 * 89; i++)
+		image->data.f32[i] = dsfmt_genrand_close_open(&dsfmt);
+	ccv_dense_matrix_t* kernel = ccv_dense_matrix_new(15, 15, CCV_32F | CCV_C1, 0, 0);
+	ccv_filter_kernel(kernel, gaussian, 0);
+	// both precisions have their own plans
+	ccv_dense_matrix_t* expected[2] = {0, 0};
+	ccv_filter(image, kernel, &expected[0], CCV_32F, 0);
+	ccv_filter(image, kernel, &expected[1], CCV_64F, 0);
+	pthread_t threads[8];
+	filter_thread_t filters[8];
+	for (i = 0; i < 8; i++)
+	{
+		filters[i].image = image;
+		filters[i].kernel = kernel;
+		filters[i].expected = expected[i & 1];
+		filters[i].type = (i & 1) ? CCV_64F : CCV_32F;
+		filters[i].mismatch = 0;
+		pthread_create(threads + i, 0, filter_thread, filters + i);
+	}
+	// drain the plans the other threads are executing, these are destroyed once they finish with them
+	for (i = 0; i < 256; i++)
+	{
+		ccv_filter_plan_drain();
+		sched_yield();
+	}
+	for (i = 0; i < 8; i++)
+	{
+		pthread_join(threads[i], 0);
+		REQUIRE_EQ(filters[i].mismatch, 0, "filter on thread %d should give the same result", i);
+	}
+	ccv_filter_plan_drain();
+	ccv_matrix_free(expected[0]);
+	ccv_matrix_free(expected[1]);
+	ccv_matrix_free(kernel);
+	ccv_matrix_free(image);
+}
+
 TEST_CASE("ccv_filter centre point for even number window size, hint: (size - 1) / 2")
 {
 	ccv_dense_matrix_t* x = ccv_dense_matrix_new(10, 10, CCV_32F | CCV_C1, 0, 0);
@@ -103,6 +103,41 @@ TEST_CASE("group array with is_equal function")
 	ccv_array_free(idx);
 }
 
+static int is_overlap(const void* _r1, const void* _r2, void* data)
+{
+	const ccv_comp_t* r1 = (const ccv_comp_t*)_r1;
+	const ccv_comp_t* r2 = (const ccv_comp_t*)_r2;
+	int i = ccv_max(ccv_min(r2->rect.x + r2->rect.width, r1->rect.x + r1->rect.width) - ccv_max(r2->rect.x, r1->rect.x), 0) * ccv_max(ccv_min(r2->rect.y + r2->rect.height, r1->rect.y + r1->rect.height) - ccv_max(r2->rect.y, r1->rect.y), 0);
+	return i > 0.3 * ccv_min(r2->rect.width * r2->rect.height, r1->rect.width * r1->rect.height);
+}
+
+TEST_CASE("group rectangles with grid should match pairwise group")
+{
+	ccv_array_t* array = ccv_array_new(sizeof(ccv_comp_t), 1024, 0);
+	int i;
+	unsigned int seed = 1;
+	for (i = 0; i < 1024; i++)
+	{
+		ccv_comp_t comp = {};
+		seed = seed * 1103515245 + 12345;
+		comp.rect.width = comp.rect.height = 8 + (seed >> 16) % 64;
+		seed = seed * 1103515245 + 12345;
+		comp.rect.x = (seed >> 16) % 1000;
+		seed = seed * 1103515245 + 12345;
+		comp.rect.y = (seed >> 16) % 1000;
+		ccv_array_push(array, &comp);
+	}
+	ccv_array_t* idx = 0;
+	int ncomp = ccv_array_group(array, &idx, is_overlap, 0);
+	ccv_array_t* idx_rect = 0;
+	int ncomp_rect = ccv_array_group_rect(array, &idx_rect, is_overlap, 0);
+	REQUIRE_EQ(ncomp, ncomp_rect, "should have the same number of groups");
+	REQUIRE_ARRAY_EQ(int, ccv_array_get(idx, 0), ccv_array_get(idx_rect, 0), 1024, "should have the same group index");
+	ccv_array_free(array);
+	ccv_array_free(idx);
+	ccv_array_free(idx_rect);
+}
+
 TEST_CASE("specific sparse matrix insertion")
 {
 	ccv_sparse_matrix_t* mat = ccv_sparse_matrix_new(1, 70, CCV_32S | CCV_C1, CCV_SPARSE_ROW_MAJOR, 0);